@@ -0,0 +1,58 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+cbuffer TexDecal
+{
+	float4 modCol;
+	uint4 flags; // xyz: 0 = Don't swizzle, 1+ = Swizzle RGB of texA/B/C
+	float4 gbcs; // r: Gamma g: Brightness b: Contrast a: Saturation
+};
+
+Texture2D texA : register(t0);
+Texture2D texB : register(t1);
+Texture2D texC : register(t2);
+SamplerState texSampler;
+
+struct PSInput
+{
+	float4 pos : SV_POSITION;
+	float2 uv : TEXCOORD0;
+	float4 col : COLOR;
+	nointerpolation float slot : SLOT;
+};
+
+float4 main(PSInput input) : SV_TARGET
+{
+	// Sample every texture outside of flow control so that gradients are
+	// always valid and select the one that the instance uses. Negative slots
+	// are solid colour.
+	float4 colA = texA.Sample(texSampler, input.uv);
+	float4 colB = texB.Sample(texSampler, input.uv);
+	float4 colC = texC.Sample(texSampler, input.uv);
+	float4 texCol = float4(1.0f, 1.0f, 1.0f, 1.0f);
+	if(input.slot >= 0.0f) {
+		texCol = (input.slot < 0.5f) ? colA :
+			((input.slot < 1.5f) ? colB : colC);
+		uint swizzle = (input.slot < 0.5f) ? flags.x :
+			((input.slot < 1.5f) ? flags.y : flags.z);
+
+		// Swizzle if we're storing BGRA data in a RGBA texture
+		texCol.rgb = swizzle ? texCol.bgr : texCol.rgb;
+	}
+
+	return texCol * input.col * modCol;
+}
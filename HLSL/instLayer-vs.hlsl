@@ -0,0 +1,59 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+cbuffer Camera
+{
+	matrix viewMat;
+	matrix projMat;
+};
+
+struct VSInput
+{
+	float2 corner : POSITION; // Unit quad, per vertex
+	float4 rect : RECT; // Everything else is per instance
+	float4 uvRect : UVRECT;
+	float4 col : COLOR;
+	float slot : SLOT;
+};
+
+struct PSInput
+{
+	float4 pos : SV_POSITION;
+	float2 uv : TEXCOORD0;
+	float4 col : COLOR;
+	nointerpolation float slot : SLOT;
+};
+
+PSInput main(VSInput input)
+{
+	PSInput output;
+
+	// Place the unit quad at the instance's rectangle
+	float2 pos = input.rect.xy + input.corner * input.rect.zw;
+
+	// Transform to viewport space
+	output.pos = float4(pos, 0.0f, 1.0f);
+	output.pos = mul(output.pos, viewMat);
+	output.pos = mul(output.pos, projMat);
+
+	// Forward instance data
+	output.uv = input.uvRect.xy + input.corner * input.uvRect.zw;
+	output.col = input.col;
+	output.slot = input.slot;
+
+	return output;
+}
@@ -0,0 +1,54 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+cbuffer Camera
+{
+	matrix viewMat;
+	matrix projMat;
+};
+
+cbuffer Resize : register(b1)
+{
+	float4 texRect;
+	float4 gizmoRect;
+};
+
+struct VSInput
+{
+	float4 pos : POSITION; // XY = offset, ZW = position in unit space
+};
+
+struct PSInput
+{
+	float4 pos : SV_POSITION;
+	float4 wPos : TEXCOORD0;
+};
+
+PSInput main(VSInput input)
+{
+	PSInput output;
+
+	// Transform from gizmo space to world space
+	float2 pos = gizmoRect.xy + input.pos.zw * gizmoRect.zw + input.pos.xy;
+	output.wPos = float4(pos, 0.0f, 1.0f);
+
+	// Transform to viewport space
+	output.pos = mul(output.wPos, viewMat);
+	output.pos = mul(output.pos, projMat);
+
+	return output;
+}
@@ -0,0 +1,63 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+// Designed for use with the "texDecal-vs.hlsl" vertex shader. Used to create
+// mipmaps of images that have a meaningful alpha channel. The four source
+// texels that are covered by each output pixel are fetched with point
+// sampling and averaged with premultiplied alpha so that the colour of fully
+// transparent texels doesn't bleed into the visible ones. The result is
+// converted back to straight alpha.
+
+cbuffer TexDecal
+{
+	float4 modCol;
+	uint4 flags; // x: 0 = Don't swizzle, 1+ = Swizzle RGB
+	float4 gbcs; // r: Gamma g: Brightness b: Contrast a: Saturation
+};
+
+Texture2D texTexture;
+SamplerState texSampler;
+
+struct PSInput
+{
+	float4 pos : SV_POSITION;
+	float2 uv : TEXCOORD0;
+};
+
+float4 main(PSInput input) : SV_TARGET
+{
+	// Offsets to the centre of each quarter of the output pixel
+	float2 dx = ddx(input.uv) * 0.25f;
+	float2 dy = ddy(input.uv) * 0.25f;
+
+	float4 texA = texTexture.Sample(texSampler, input.uv - dx - dy);
+	float4 texB = texTexture.Sample(texSampler, input.uv + dx - dy);
+	float4 texC = texTexture.Sample(texSampler, input.uv - dx + dy);
+	float4 texD = texTexture.Sample(texSampler, input.uv + dx + dy);
+
+	// Average with premultiplied alpha and then convert back to straight alpha
+	float3 rgb = texA.rgb * texA.a + texB.rgb * texB.a + texC.rgb * texC.a
+		+ texD.rgb * texD.a;
+	float alpha = texA.a + texB.a + texC.a + texD.a;
+	rgb = (alpha > 0.0f) ? rgb / alpha : float3(0.0f, 0.0f, 0.0f);
+	float4 texCol = float4(rgb, alpha * 0.25f);
+
+	// Swizzle if we're storing BGRA data in a RGBA texture
+	texCol.rgb = flags.x ? texCol.bgr : texCol.rgb;
+
+	return texCol * modCol;
+}
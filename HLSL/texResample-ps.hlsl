@@ -0,0 +1,113 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+// Designed for use with the "texDecal-vs.hlsl" vertex shader. Does one pass of
+// a separable bicubic (Catmull-Rom) or Lanczos-3 rescale along a single axis
+// using the same kernels as the CPU `ImageScaler`. The vertex UVs are in
+// source texel units instead of normalized coordinates so that the kernel can
+// be evaluated at exact texel centres. Every tap is fetched with point
+// sampling, taps outside of the valid range are discarded and the remaining
+// weights are renormalized so that edges do not darken.
+
+cbuffer TexDecal
+{
+	float4 modCol;
+	uint4 flags; // x: 0 = Don't swizzle, 1+ = Swizzle RGB
+	float4 gbcs; // r: Gamma g: Brightness b: Contrast a: Saturation
+};
+
+cbuffer Resample : register(b1)
+{
+	float4 texelToUv; // xy: Size of a single texel in UV coordinates
+	float4 range; // x: First texel y: End texel z: Kernel scale w: Support
+	uint4 options; // x: 1 = Vertical y: 1 = Lanczos z: 1 = Weight by alpha
+};
+
+Texture2D texTexture;
+SamplerState texSampler;
+
+struct PSInput
+{
+	float4 pos : SV_POSITION;
+	float2 uv : TEXCOORD0;
+};
+
+static const float PI = 3.14159265f;
+
+float sinc(float x)
+{
+	if(x < 0.00001f)
+		return 1.0f;
+	x *= PI;
+	return sin(x) / x;
+}
+
+float kernelWeight(float dist)
+{
+	if(options.y) {
+		// Lanczos-3
+		return (dist < 3.0f) ? sinc(dist) * sinc(dist / 3.0f) : 0.0f;
+	}
+
+	// Keys cubic convolution with a = -0.5 (Catmull-Rom)
+	const float a = -0.5f;
+	if(dist < 1.0f)
+		return ((a + 2.0f) * dist - (a + 3.0f)) * dist * dist + 1.0f;
+	if(dist < 2.0f)
+		return (((dist - 5.0f) * dist + 8.0f) * dist - 4.0f) * a;
+	return 0.0f;
+}
+
+float4 main(PSInput input) : SV_TARGET
+{
+	// Position of the output pixel centre along the filtered axis in source
+	// texels. Texel `x` has its centre at `x + 0.5`.
+	float center = options.x ? input.uv.y : input.uv.x;
+	float first = max(range.x, floor(center - range.w + 0.5f));
+	float last = min(range.y, floor(center + range.w + 0.5f));
+
+	float3 rgb = float3(0.0f, 0.0f, 0.0f);
+	float alpha = 0.0f;
+	float total = 0.0f;
+	[loop] for(float x = first; x < last; x += 1.0f) {
+		float w = kernelWeight(abs((x + 0.5f - center) / range.z));
+		float2 texel = options.x
+			? float2(input.uv.x, x + 0.5f) : float2(x + 0.5f, input.uv.y);
+		float4 col = texTexture.SampleLevel(
+			texSampler, texel * texelToUv.xy, 0.0f);
+
+		// Accumulate with premultiplied alpha if the alpha is meaningful so
+		// that the colour of fully transparent texels doesn't bleed into the
+		// visible ones
+		float cw = options.z ? w * col.a : w;
+		rgb += col.rgb * cw;
+		alpha += col.a * w;
+		total += w;
+	}
+	if(total != 0.0f) {
+		rgb /= total;
+		alpha /= total;
+	}
+	if(options.z)
+		rgb = (alpha > 0.0f) ? rgb / alpha : float3(0.0f, 0.0f, 0.0f);
+	float4 texCol = saturate(float4(rgb, alpha));
+
+	// Swizzle if we're storing BGRA data in a RGBA texture
+	texCol.rgb = flags.x ? texCol.bgr : texCol.rgb;
+
+	return texCol * modCol;
+}
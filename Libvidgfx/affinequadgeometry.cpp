@@ -0,0 +1,164 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#include "affinequadgeometry.h"
+#include <emmintrin.h>
+
+//=============================================================================
+// Helpers
+
+/// <summary>
+/// Transforms the 4 corners of `rect` by the affine part of `transform`. The
+/// X and Y coordinates of the top-left, top-right, bottom-left and
+/// bottom-right corners are returned in lanes 0-3 of `x` and `y`.
+/// </summary>
+static inline void transformCorners(
+	const QRectF &rect, const QTransform &transform, __m128 *x, __m128 *y)
+{
+	const float l = rect.left();
+	const float r = rect.right();
+	const float t = rect.top();
+	const float b = rect.bottom();
+	const __m128 cx = _mm_setr_ps(l, r, l, r);
+	const __m128 cy = _mm_setr_ps(t, t, b, b);
+
+	// X' = m11 * X + m21 * Y + dx, Y' = m12 * X + m22 * Y + dy
+	*x = _mm_add_ps(_mm_add_ps(
+		_mm_mul_ps(cx, _mm_set1_ps((float)transform.m11())),
+		_mm_mul_ps(cy, _mm_set1_ps((float)transform.m21()))),
+		_mm_set1_ps((float)transform.dx()));
+	*y = _mm_add_ps(_mm_add_ps(
+		_mm_mul_ps(cx, _mm_set1_ps((float)transform.m12())),
+		_mm_mul_ps(cy, _mm_set1_ps((float)transform.m22()))),
+		_mm_set1_ps((float)transform.dy()));
+}
+
+/// <summary>
+/// Writes the 4 vertices of a quad in the format X, Y, Z, -, A0, A1, A2, A3
+/// where `attribs` holds the 4 attributes of each corner.
+/// </summary>
+/// <returns>A pointer to just after the last written float</returns>
+static inline float *writeQuad(
+	float *out, __m128 x, __m128 y, const __m128 *attribs)
+{
+	const __m128 zw = _mm_setr_ps(0.0f, 1.0f, 0.0f, 1.0f);
+	const __m128 xy01 = _mm_unpacklo_ps(x, y); // X0 Y0 X1 Y1
+	const __m128 xy23 = _mm_unpackhi_ps(x, y); // X2 Y2 X3 Y3
+
+	_mm_storeu_ps(&out[0], _mm_movelh_ps(xy01, zw)); // X0 Y0 0 1
+	_mm_storeu_ps(&out[4], attribs[0]);
+	_mm_storeu_ps(&out[8], _mm_movehl_ps(zw, xy01)); // X1 Y1 0 1
+	_mm_storeu_ps(&out[12], attribs[1]);
+	_mm_storeu_ps(&out[16], _mm_movelh_ps(xy23, zw)); // X2 Y2 0 1
+	_mm_storeu_ps(&out[20], attribs[2]);
+	_mm_storeu_ps(&out[24], _mm_movehl_ps(zw, xy23)); // X3 Y3 0 1
+	_mm_storeu_ps(&out[28], attribs[3]);
+	return &out[32];
+}
+
+//=============================================================================
+// AffineQuadGeometry class
+
+/// <summary>
+/// Returns the axis-aligned bounding rectangle of `rect` after it has been
+/// transformed. Used for culling transformed rectangles.
+/// </summary>
+QRectF AffineQuadGeometry::mapBounds(
+	const QRectF &rect, const QTransform &transform)
+{
+	__m128 x, y;
+	transformCorners(rect, transform, &x, &y);
+
+	// Horizontal min/max of the 4 lanes
+	__m128 minX = _mm_min_ps(x, _mm_movehl_ps(x, x));
+	__m128 maxX = _mm_max_ps(x, _mm_movehl_ps(x, x));
+	__m128 minY = _mm_min_ps(y, _mm_movehl_ps(y, y));
+	__m128 maxY = _mm_max_ps(y, _mm_movehl_ps(y, y));
+	minX = _mm_min_ss(minX, _mm_shuffle_ps(minX, minX, 1));
+	maxX = _mm_max_ss(maxX, _mm_shuffle_ps(maxX, maxX, 1));
+	minY = _mm_min_ss(minY, _mm_shuffle_ps(minY, minY, 1));
+	maxY = _mm_max_ss(maxY, _mm_shuffle_ps(maxY, maxY, 1));
+
+	return QRectF(
+		QPointF(_mm_cvtss_f32(minX), _mm_cvtss_f32(minY)),
+		QPointF(_mm_cvtss_f32(maxX), _mm_cvtss_f32(maxY)));
+}
+
+/// <summary>
+/// Writes `numQuads` transformed solid rectangles to `data` in the vertex
+/// format of `GraphicsContext::createSolidRect()`. `cols` must contain 4
+/// colours for each quad in the order top-left, top-right, bottom-left and
+/// bottom-right.
+/// </summary>
+/// <returns>The number of floats that were written</returns>
+int AffineQuadGeometry::writeSolidQuads(
+	float *data, const QRectF *rects, const QTransform *transforms,
+	int numQuads, const QColor *cols)
+{
+	if(data == NULL || rects == NULL || transforms == NULL || cols == NULL)
+		return 0;
+
+	float *out = data;
+	for(int i = 0; i < numQuads; i++) {
+		__m128 attribs[4];
+		for(int j = 0; j < 4; j++) {
+			const QColor &col = cols[i * 4 + j];
+			attribs[j] = _mm_setr_ps(
+				col.redF(), col.greenF(), col.blueF(), col.alphaF());
+		}
+		__m128 x, y;
+		transformCorners(rects[i], transforms[i], &x, &y);
+		out = writeQuad(out, x, y, attribs);
+	}
+	return (int)(out - data);
+}
+
+/// <summary>
+/// Writes `numQuads` transformed texture decal rectangles to `data` in the
+/// vertex format of `GraphicsContext::createTexDecalRect()`. If `uvs` is not
+/// NULL then it must contain 4 texture coordinates for each quad in the order
+/// top-left, top-right, bottom-left and bottom-right, otherwise every quad
+/// displays the entire texture.
+/// </summary>
+/// <returns>The number of floats that were written</returns>
+int AffineQuadGeometry::writeTexDecalQuads(
+	float *data, const QRectF *rects, const QTransform *transforms,
+	int numQuads, const QPointF *uvs)
+{
+	if(data == NULL || rects == NULL || transforms == NULL)
+		return 0;
+
+	__m128 attribs[4] = {
+		_mm_setr_ps(0.0f, 0.0f, 0.0f, 0.0f),
+		_mm_setr_ps(1.0f, 0.0f, 0.0f, 0.0f),
+		_mm_setr_ps(0.0f, 1.0f, 0.0f, 0.0f),
+		_mm_setr_ps(1.0f, 1.0f, 0.0f, 0.0f)
+	};
+	float *out = data;
+	for(int i = 0; i < numQuads; i++) {
+		if(uvs != NULL) {
+			for(int j = 0; j < 4; j++) {
+				const QPointF &uv = uvs[i * 4 + j];
+				attribs[j] = _mm_setr_ps(uv.x(), uv.y(), 0.0f, 0.0f);
+			}
+		}
+		__m128 x, y;
+		transformCorners(rects[i], transforms[i], &x, &y);
+		out = writeQuad(out, x, y, attribs);
+	}
+	return (int)(out - data);
+}
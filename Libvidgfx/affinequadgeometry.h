@@ -0,0 +1,58 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#ifndef AFFINEQUADGEOMETRY_H
+#define AFFINEQUADGEOMETRY_H
+
+#include "include/libvidgfx.h"
+#include <QtCore/QRectF>
+#include <QtGui/QColor>
+#include <QtGui/QTransform>
+
+//=============================================================================
+/// <summary>
+/// Generates the vertices of rectangles that have been rotated, skewed or
+/// scaled by a 2x3 affine transform. Transforming the corners on the CPU
+/// instead of with the view matrix allows layers with different transforms
+/// to share a single vertex buffer, draw call and camera constant buffer.
+/// Only the affine part of each `QTransform` is used. All 4 corners of a
+/// rectangle are transformed at once with SSE2 and the vertices are output
+/// in the order top-left, top-right, bottom-left and bottom-right of the
+/// untransformed rectangle so that each rectangle is a single quad for
+/// `GfxQuadListTopology` or a strip for `GfxTriangleStripTopology`.
+/// </summary>
+class AffineQuadGeometry
+{
+public: // Constants ----------------------------------------------------------
+
+	// Every quad is 4 vertices in the full vertex format (1 vertex = 8 floats)
+	static const int	NumVertsPerQuad = 4;
+	static const int	NumFloatsPerVert = 8;
+	static const int	NumFloatsPerQuad = NumVertsPerQuad * NumFloatsPerVert;
+
+public: // Static methods -----------------------------------------------------
+	static QRectF	mapBounds(const QRectF &rect, const QTransform &transform);
+	static int		writeSolidQuads(
+		float *data, const QRectF *rects, const QTransform *transforms,
+		int numQuads, const QColor *cols);
+	static int		writeTexDecalQuads(
+		float *data, const QRectF *rects, const QTransform *transforms,
+		int numQuads, const QPointF *uvs = NULL);
+};
+//=============================================================================
+
+#endif // AFFINEQUADGEOMETRY_H
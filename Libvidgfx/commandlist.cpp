@@ -0,0 +1,400 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#include "commandlist.h"
+#include "graphicscontext.h"
+#include <algorithm>
+
+//=============================================================================
+// Helpers
+
+template<typename T>
+static inline int compareValues(T a, T b)
+{
+	if(a < b)
+		return -1;
+	if(b < a)
+		return 1;
+	return 0;
+}
+
+//=============================================================================
+// CommandList class
+
+/// <summary>
+/// Orders the commands of a sort group. Render targets are the most
+/// expensive to switch followed by shaders and textures so they are compared
+/// first. Commands with identical state keep the order that they were
+/// recorded in as the sort is stable.
+/// </summary>
+struct CommandList::CommandLess {
+	const CommandList *	list;
+
+	bool operator()(int a, int b) const
+	{
+		const int sa = list->m_cmds.at(a).state;
+		const int sb = list->m_cmds.at(b).state;
+		if(sa == sb)
+			return false;
+		const State &x = list->m_states.at(sa);
+		const State &y = list->m_states.at(sb);
+		int res = compareValues(x.setFlags, y.setFlags);
+		if(res == 0)
+			res = compareValues((int)x.target, (int)y.target);
+		if(res == 0)
+			res = compareValues((int)x.shader, (int)y.shader);
+		for(int i = 0; res == 0 && i < 3; i++)
+			res = compareValues((quintptr)x.tex[i], (quintptr)y.tex[i]);
+		if(res == 0)
+			res = compareValues((int)x.filter, (int)y.filter);
+		if(res == 0)
+			res = compareValues((int)x.addressMode, (int)y.addressMode);
+		if(res == 0)
+			res = compareValues((int)x.blending, (int)y.blending);
+		if(res == 0)
+			res = compareValues((int)x.topology, (int)y.topology);
+		return res < 0;
+	}
+};
+
+CommandList::CommandList()
+	: m_states()
+	, m_cmds()
+	, m_order()
+	, m_orderDirty(false)
+	//, m_state() // Initialized by `reset()`
+	, m_stateDirty(true)
+	, m_sortGroup(-1)
+	, m_nextSortGroup(0)
+	, m_numBinds(0)
+{
+	reset();
+}
+
+CommandList::~CommandList()
+{
+}
+
+/// <summary>
+/// Removes every recorded command and forgets all recorded state. Commands
+/// that are recorded afterwards use whatever state the context has when the
+/// list is submitted until the state is set again.
+/// </summary>
+void CommandList::reset()
+{
+	m_states.clear();
+	m_cmds.clear();
+	m_order.clear();
+	m_orderDirty = false;
+
+	m_state.setFlags = 0;
+	m_state.target = GfxScreenTarget;
+	m_state.shader = GfxNoShader;
+	m_state.topology = GfxTriangleListTopology;
+	m_state.blending = GfxNoBlending;
+	m_state.tex[0] = m_state.tex[1] = m_state.tex[2] = NULL;
+	m_state.filter = GfxBilinearFilter;
+	m_state.addressMode = GfxClampAddressing;
+	m_stateDirty = true;
+
+	m_sortGroup = -1;
+	m_nextSortGroup = 0;
+}
+
+/// <summary>
+/// Replays the list to `context`. Only the state that differs from the
+/// previous command is bound. As `GraphicsContext::drawInstanced()` binds its
+/// own shader and topology both are rebound after every instanced draw.
+/// </summary>
+void CommandList::submit(GraphicsContext *context)
+{
+	m_numBinds = 0;
+	if(m_cmds.isEmpty())
+		return; // Nothing to render
+	if(context == NULL || !context->isValid())
+		return; // No context operations can be done
+	if(m_orderDirty)
+		sortCommands();
+
+	int prevIdx = -1;
+	uint staleFlags = 0; // State that the context changed behind our back
+	for(int i = 0; i < m_order.size(); i++) {
+		const Command &cmd = m_cmds.at(m_order.at(i));
+		if(cmd.state != prevIdx || staleFlags != 0) {
+			applyState(context, m_states.at(cmd.state),
+				(prevIdx >= 0) ? &m_states.at(prevIdx) : NULL, staleFlags);
+			prevIdx = cmd.state;
+			staleFlags = 0;
+		}
+
+		switch(cmd.type) {
+		case ClearCommand:
+			context->clear(cmd.color);
+			break;
+		case DrawCommand:
+			context->drawBuffer(cmd.vertBuf, cmd.num, cmd.start);
+			break;
+		case DrawIndexedCommand:
+			context->drawBuffer(
+				cmd.vertBuf, cmd.idxBuf, cmd.num, cmd.start, cmd.baseVertex);
+			break;
+		case DrawInstancedCommand:
+			context->drawInstanced(cmd.vertBuf, cmd.num, cmd.start);
+			staleFlags = ShaderFlag | TopologyFlag;
+			break;
+		}
+	}
+}
+
+/// <summary>
+/// Starts a group of draws that can be rendered in any order. Does nothing
+/// if a group has already been started.
+/// </summary>
+void CommandList::beginSortGroup()
+{
+	if(m_sortGroup >= 0)
+		return; // Already in a group
+	m_sortGroup = m_nextSortGroup++;
+}
+
+void CommandList::endSortGroup()
+{
+	m_sortGroup = -1;
+}
+
+void CommandList::setRenderTarget(VidgfxRendTarget target)
+{
+	if((m_state.setFlags & TargetFlag) && m_state.target == target)
+		return; // Nothing to do
+	m_state.setFlags |= TargetFlag;
+	m_state.target = target;
+	m_stateDirty = true;
+}
+
+void CommandList::setShader(VidgfxShader shader)
+{
+	if((m_state.setFlags & ShaderFlag) && m_state.shader == shader)
+		return; // Nothing to do
+	m_state.setFlags |= ShaderFlag;
+	m_state.shader = shader;
+	m_stateDirty = true;
+}
+
+void CommandList::setTopology(VidgfxTopology topology)
+{
+	if((m_state.setFlags & TopologyFlag) && m_state.topology == topology)
+		return; // Nothing to do
+	m_state.setFlags |= TopologyFlag;
+	m_state.topology = topology;
+	m_stateDirty = true;
+}
+
+void CommandList::setBlending(VidgfxBlending blending)
+{
+	if((m_state.setFlags & BlendingFlag) && m_state.blending == blending)
+		return; // Nothing to do
+	m_state.setFlags |= BlendingFlag;
+	m_state.blending = blending;
+	m_stateDirty = true;
+}
+
+void CommandList::setTexture(Texture *texA, Texture *texB, Texture *texC)
+{
+	if((m_state.setFlags & TextureFlag) && m_state.tex[0] == texA &&
+		m_state.tex[1] == texB && m_state.tex[2] == texC)
+	{
+		return; // Nothing to do
+	}
+	m_state.setFlags |= TextureFlag;
+	m_state.tex[0] = texA;
+	m_state.tex[1] = texB;
+	m_state.tex[2] = texC;
+	m_stateDirty = true;
+}
+
+void CommandList::setTextureFilter(
+	VidgfxFilter filter, VidgfxAddressMode mode)
+{
+	if((m_state.setFlags & FilterFlag) && m_state.filter == filter &&
+		m_state.addressMode == mode)
+	{
+		return; // Nothing to do
+	}
+	m_state.setFlags |= FilterFlag;
+	m_state.filter = filter;
+	m_state.addressMode = mode;
+	m_stateDirty = true;
+}
+
+/// <summary>
+/// Records a clear of the current render target. Clears are never reordered
+/// and split sort groups into two.
+/// </summary>
+void CommandList::clear(const QColor &color)
+{
+	Command cmd;
+	cmd.type = ClearCommand;
+	cmd.vertBuf = NULL;
+	cmd.idxBuf = NULL;
+	cmd.num = cmd.start = cmd.baseVertex = 0;
+	cmd.color = color;
+	appendCommand(cmd, false);
+}
+
+void CommandList::drawBuffer(
+	VertexBuffer *buf, int numVertices, int startVertex)
+{
+	if(buf == NULL)
+		return;
+	Command cmd;
+	cmd.type = DrawCommand;
+	cmd.vertBuf = buf;
+	cmd.idxBuf = NULL;
+	cmd.num = numVertices;
+	cmd.start = startVertex;
+	cmd.baseVertex = 0;
+	appendCommand(cmd, true);
+}
+
+void CommandList::drawBuffer(
+	VertexBuffer *buf, IndexBuffer *idxBuf, int numIndices, int startIndex,
+	int baseVertex)
+{
+	if(buf == NULL || idxBuf == NULL)
+		return;
+	Command cmd;
+	cmd.type = DrawIndexedCommand;
+	cmd.vertBuf = buf;
+	cmd.idxBuf = idxBuf;
+	cmd.num = numIndices;
+	cmd.start = startIndex;
+	cmd.baseVertex = baseVertex;
+	appendCommand(cmd, true);
+}
+
+void CommandList::drawInstanced(
+	VertexBuffer *instBuf, int numInstances, int startInstance)
+{
+	if(instBuf == NULL)
+		return;
+	Command cmd;
+	cmd.type = DrawInstancedCommand;
+	cmd.vertBuf = instBuf;
+	cmd.idxBuf = NULL;
+	cmd.num = numInstances;
+	cmd.start = startInstance;
+	cmd.baseVertex = 0;
+	appendCommand(cmd, true);
+}
+
+/// <summary>
+/// Appends `cmd` with the current state, only storing the state if it
+/// differs from the state of the previous command.
+/// </summary>
+void CommandList::appendCommand(Command &cmd, bool sortable)
+{
+	if(m_stateDirty || m_states.isEmpty()) {
+		m_states.append(m_state);
+		m_stateDirty = false;
+	}
+	cmd.state = m_states.size() - 1;
+	cmd.sortGroup = sortable ? m_sortGroup : -1;
+	m_cmds.append(cmd);
+	m_orderDirty = true;
+}
+
+/// <summary>
+/// Calculates the replay order. Each run of consecutive commands that belong
+/// to the same sort group is sorted by state while everything else keeps its
+/// recorded position.
+/// </summary>
+void CommandList::sortCommands()
+{
+	const int numCmds = m_cmds.size();
+	m_order.resize(numCmds);
+	for(int i = 0; i < numCmds; i++)
+		m_order[i] = i;
+
+	CommandLess less;
+	less.list = this;
+	int start = 0;
+	while(start < numCmds) {
+		const int group = m_cmds.at(start).sortGroup;
+		int end = start + 1;
+		while(end < numCmds && m_cmds.at(end).sortGroup == group)
+			end++;
+		if(group >= 0 && end - start > 1) {
+			std::stable_sort(
+				m_order.begin() + start, m_order.begin() + end, less);
+		}
+		start = end;
+	}
+	m_orderDirty = false;
+}
+
+/// <summary>
+/// Binds every part of `state` that has been set and differs from `prev`.
+/// If `prev` is NULL then the context's state is unknown and everything that
+/// has been set is bound. The parts of `prev` in `staleFlags` are no longer
+/// bound in the context and are treated as unknown.
+/// </summary>
+void CommandList::applyState(
+	GraphicsContext *context, const State &state, const State *prev,
+	uint staleFlags)
+{
+	const uint flags = state.setFlags;
+	const uint prevFlags = (prev != NULL) ? prev->setFlags & ~staleFlags : 0;
+
+	if((flags & TargetFlag) && (!(prevFlags & TargetFlag) ||
+		prev->target != state.target))
+	{
+		context->setRenderTarget(state.target);
+		m_numBinds++;
+	}
+	if((flags & ShaderFlag) && (!(prevFlags & ShaderFlag) ||
+		prev->shader != state.shader))
+	{
+		context->setShader(state.shader);
+		m_numBinds++;
+	}
+	if((flags & TopologyFlag) && (!(prevFlags & TopologyFlag) ||
+		prev->topology != state.topology))
+	{
+		context->setTopology(state.topology);
+		m_numBinds++;
+	}
+	if((flags & BlendingFlag) && (!(prevFlags & BlendingFlag) ||
+		prev->blending != state.blending))
+	{
+		context->setBlending(state.blending);
+		m_numBinds++;
+	}
+	if((flags & TextureFlag) && (!(prevFlags & TextureFlag) ||
+		prev->tex[0] != state.tex[0] || prev->tex[1] != state.tex[1] ||
+		prev->tex[2] != state.tex[2]))
+	{
+		context->setTexture(state.tex[0], state.tex[1], state.tex[2]);
+		m_numBinds++;
+	}
+	if((flags & FilterFlag) && (!(prevFlags & FilterFlag) ||
+		prev->filter != state.filter ||
+		prev->addressMode != state.addressMode))
+	{
+		context->setTextureFilter(state.filter, state.addressMode);
+		m_numBinds++;
+	}
+}
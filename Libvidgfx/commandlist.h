@@ -0,0 +1,173 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#ifndef COMMANDLIST_H
+#define COMMANDLIST_H
+
+#include "include/libvidgfx.h"
+#include <QtCore/QVector>
+#include <QtGui/QColor>
+
+class GraphicsContext;
+class IndexBuffer;
+class Texture;
+class VertexBuffer;
+
+//=============================================================================
+/// <summary>
+/// Records render target, pipeline state, clear and draw calls without
+/// touching the graphics context so that a scene can be built independently
+/// of the device and replayed later with `submit()`. State changes are not
+/// recorded as separate commands, instead every clear and draw remembers the
+/// state that was set when it was recorded and redundant binds are dropped
+/// during replay. Commands are replayed in the order that they were recorded
+/// except for the draws between `beginSortGroup()` and `endSortGroup()`
+/// which the caller guarantees to be order-independent (E.g. they don't
+/// overlap). Those draws are grouped by render target, shader, textures and
+/// the remaining state to minimise state changes. Clears are never moved.
+/// The list is kept until `reset()` is called so the same list can be
+/// submitted every frame while the scene is static, the sorted order is only
+/// recalculated after new commands are recorded. Only the state listed here
+/// is recorded, any other context state such as the view matrix applies to
+/// the whole list when it is submitted. It is up to the user to make sure
+/// that every buffer and texture that is referenced by the list remains
+/// valid until the list is reset or deleted.
+/// </summary>
+class CommandList
+{
+protected: // Datatypes -------------------------------------------------------
+	enum StateFlag {
+		TargetFlag = 0x01,
+		ShaderFlag = 0x02,
+		TopologyFlag = 0x04,
+		BlendingFlag = 0x08,
+		TextureFlag = 0x10,
+		FilterFlag = 0x20
+	};
+
+	struct State {
+		uint				setFlags; // Which members have been set
+		VidgfxRendTarget	target;
+		VidgfxShader		shader;
+		VidgfxTopology		topology;
+		VidgfxBlending		blending;
+		Texture *			tex[3];
+		VidgfxFilter		filter;
+		VidgfxAddressMode	addressMode;
+	};
+
+	enum CommandType {
+		ClearCommand = 0,
+		DrawCommand,
+		DrawIndexedCommand,
+		DrawInstancedCommand
+	};
+
+	struct Command {
+		CommandType		type;
+		int				state; // Index into `m_states`
+		int				sortGroup; // -1 if the command cannot be moved
+		VertexBuffer *	vertBuf; // Instance buffer for instanced draws
+		IndexBuffer *	idxBuf;
+		int				num;
+		int				start;
+		int				baseVertex;
+		QColor			color;
+	};
+
+	struct CommandLess;
+
+protected: // Members ---------------------------------------------------------
+	QVector<State>		m_states;
+	QVector<Command>	m_cmds;
+	QVector<int>		m_order;
+	bool				m_orderDirty;
+	State				m_state; // State of commands that are recorded next
+	bool				m_stateDirty; // `m_state` isn't in `m_states` yet
+	int					m_sortGroup;
+	int					m_nextSortGroup;
+	int					m_numBinds;
+
+public: // Constructor/destructor ---------------------------------------------
+	CommandList();
+	virtual ~CommandList();
+
+public: // Methods ------------------------------------------------------------
+	void	reset();
+	int		getNumCommands() const;
+	int		getNumStates() const;
+	void	submit(GraphicsContext *context);
+	int		getNumBinds() const;
+
+	// Ordering
+	void	beginSortGroup();
+	void	endSortGroup();
+	bool	isInSortGroup() const;
+
+	// Recording
+	void	setRenderTarget(VidgfxRendTarget target);
+	void	setShader(VidgfxShader shader);
+	void	setTopology(VidgfxTopology topology);
+	void	setBlending(VidgfxBlending blending);
+	void	setTexture(
+		Texture *texA, Texture *texB = NULL, Texture *texC = NULL);
+	void	setTextureFilter(
+		VidgfxFilter filter, VidgfxAddressMode mode = GfxClampAddressing);
+	void	clear(const QColor &color);
+	void	drawBuffer(
+		VertexBuffer *buf, int numVertices = -1, int startVertex = 0);
+	void	drawBuffer(
+		VertexBuffer *buf, IndexBuffer *idxBuf, int numIndices = -1,
+		int startIndex = 0, int baseVertex = 0);
+	void	drawInstanced(
+		VertexBuffer *instBuf, int numInstances = -1,
+		int startInstance = 0);
+
+private:
+	void	appendCommand(Command &cmd, bool sortable);
+	void	sortCommands();
+	void	applyState(
+		GraphicsContext *context, const State &state, const State *prev,
+		uint staleFlags);
+};
+//=============================================================================
+
+inline int CommandList::getNumCommands() const
+{
+	return m_cmds.size();
+}
+
+inline int CommandList::getNumStates() const
+{
+	return m_states.size();
+}
+
+/// <summary>
+/// Returns the number of state changes that the last `submit()` issued to
+/// the graphics context.
+/// </summary>
+inline int CommandList::getNumBinds() const
+{
+	return m_numBinds;
+}
+
+inline bool CommandList::isInSortGroup() const
+{
+	return m_sortGroup >= 0;
+}
+
+#endif // COMMANDLIST_H
@@ -17,7 +17,9 @@
 
 #include "d3dcontext.h"
 #include "gfxlog.h"
+#include "imagescaler.h"
 #include "pciidparser.h"
+#include "vertexlayout.h"
 #include "versionhelpers.h"
 #include <d3d10_1.h>
 #include <QtCore/QFile>
@@ -247,11 +249,49 @@ bool updateDXBuffer(
 	return true;
 }
 
+DXGI_FORMAT vertElementToDxgiFormat(VertElementFormat format)
+{
+	switch(format) {
+	default:
+	case Float2Element:
+		return DXGI_FORMAT_R32G32_FLOAT;
+	case Float3Element:
+		return DXGI_FORMAT_R32G32B32_FLOAT;
+	case Float4Element:
+		return DXGI_FORMAT_R32G32B32A32_FLOAT;
+	case Unorm8x4Element:
+		return DXGI_FORMAT_R8G8B8A8_UNORM;
+	case Unorm16x2Element:
+		return DXGI_FORMAT_R16G16_UNORM;
+	}
+}
+
+/// <summary>
+/// Fills `desc` with the per-vertex input layout description of `Layout` in
+/// slot 0. `desc` must have space for `Layout::NumElements` elements.
+/// </summary>
+template<typename Layout>
+void describeInputLayout(D3D10_INPUT_ELEMENT_DESC *desc)
+{
+	VertElement elems[Layout::NumElements];
+	Layout::getElements(elems);
+	for(int i = 0; i < Layout::NumElements; i++) {
+		desc[i].SemanticName = elems[i].semantic;
+		desc[i].SemanticIndex = 0;
+		desc[i].Format = vertElementToDxgiFormat(elems[i].format);
+		desc[i].InputSlot = 0;
+		desc[i].AlignedByteOffset = elems[i].offset;
+		desc[i].InputSlotClass = D3D10_INPUT_PER_VERTEX_DATA;
+		desc[i].InstanceDataStepRate = 0;
+	}
+}
+
 //=============================================================================
 // D3DVertexBuffer class
 
-D3DVertexBuffer::D3DVertexBuffer(D3DContext *context, int numFloats)
-	: VertexBuffer(numFloats)
+D3DVertexBuffer::D3DVertexBuffer(
+	D3DContext *context, int numFloats, VidgfxBufStorage storage)
+	: VertexBuffer(numFloats, storage)
 	, m_context(context)
 	, m_buffer(NULL)
 {
@@ -261,10 +301,19 @@ D3DVertexBuffer::D3DVertexBuffer(D3DContext *context, int numFloats)
 	// Create hardware buffer
 	D3D10_BUFFER_DESC desc;
 	desc.ByteWidth = numFloats * sizeof(float);
-	desc.Usage = D3D10_USAGE_DYNAMIC;
 	desc.BindFlags = D3D10_BIND_VERTEX_BUFFER;
-	desc.CPUAccessFlags = D3D10_CPU_ACCESS_WRITE;
 	desc.MiscFlags = 0;
+	if(m_storage == GfxShadowedStorage) {
+		// A default usage buffer is used so that `update()` can upload only
+		// the dirty ranges with `UpdateSubresource()` as dynamic buffers can
+		// only be rewritten in full.
+		desc.Usage = D3D10_USAGE_DEFAULT;
+		desc.CPUAccessFlags = 0;
+	} else {
+		// Write-through buffers are always rewritten in full with `map()`
+		desc.Usage = D3D10_USAGE_DYNAMIC;
+		desc.CPUAccessFlags = D3D10_CPU_ACCESS_WRITE;
+	}
 	if(!createDXBuffer(device, &desc, m_data, &m_buffer)) {
 		// Failed to create buffer
 		return;
@@ -273,6 +322,7 @@ D3DVertexBuffer::D3DVertexBuffer(D3DContext *context, int numFloats)
 
 D3DVertexBuffer::~D3DVertexBuffer()
 {
+	unmap();
 	if(m_buffer)
 		m_buffer->Release();
 }
@@ -287,8 +337,135 @@ void D3DVertexBuffer::update()
 	// Get device
 	ID3D10Device *device = m_context->getDevice();
 
+	// Upload only the modified ranges of the hardware buffer
+	D3D10_BOX box;
+	box.top = 0;
+	box.bottom = 1;
+	box.front = 0;
+	box.back = 1;
+	for(int i = 0; i < m_numDirtyRanges; i++) {
+		const DirtyRange &range = m_dirtyRanges[i];
+		box.left = range.firstFloat * sizeof(float);
+		box.right = (range.firstFloat + range.numFloats) * sizeof(float);
+		device->UpdateSubresource(
+			m_buffer, 0, &box, &m_data[range.firstFloat], 0, 0);
+	}
+
+	setDirty(false);
+}
+
+/// <summary>
+/// Binds the buffer to the specified input assembler slot.
+/// </summary>
+void D3DVertexBuffer::bind(uint slot)
+{
+	if(m_buffer == NULL)
+		return; // Buffer doesn't exist
+
+	// Make sure the buffer isn't mapped or dirty
+	if(m_isMapped)
+		unmap();
+	if(m_dirty)
+		update();
+
+	// Get device
+	ID3D10Device *device = m_context->getDevice();
+
+	// Bind the buffer
+	if(m_vertSize <= 0)
+		return; // Invalid stride
+	uint stride = m_vertSize * sizeof(float);
+	uint offset = 0;
+	device->IASetVertexBuffers(slot, 1, &m_buffer, &stride, &offset);
+}
+
+/// <summary>
+/// Returns a pointer to the buffer's data that can be written to. For
+/// shadowed buffers this is the system memory copy and the caller must mark
+/// what it modifies as dirty. For write-through buffers this is the hardware
+/// buffer itself, its previous contents are discarded and it cannot be read.
+/// </summary>
+float *D3DVertexBuffer::map()
+{
+	if(m_buffer == NULL)
+		return NULL; // Buffer doesn't exist
+	if(m_isMapped)
+		return m_data; // Already mapped
+	if(m_storage == GfxShadowedStorage) {
+		m_isMapped = true;
+		return m_data;
+	}
+
+	void *data = NULL;
+	HRESULT res = m_buffer->Map(D3D10_MAP_WRITE_DISCARD, 0, &data);
+	if(FAILED(res)) {
+		gfxLog(LOG_CAT, GfxLog::Warning)
+			<< "Failed to map DirectX buffer into RAM. "
+			<< "Reason = " << getDXErrorCode(res);
+		return NULL;
+	}
+
+	m_data = reinterpret_cast<float *>(data);
+	m_isMapped = true;
+	return m_data;
+}
+
+void D3DVertexBuffer::unmap()
+{
+	if(m_buffer == NULL)
+		return; // Buffer doesn't exist
+	if(!m_isMapped)
+		return;
+
+	m_isMapped = false;
+	if(m_storage == GfxShadowedStorage)
+		return; // Data remains in system memory
+	m_data = NULL;
+	m_buffer->Unmap();
+}
+
+//=============================================================================
+// D3DIndexBuffer class
+
+D3DIndexBuffer::D3DIndexBuffer(D3DContext *context, int maxIndices)
+	: IndexBuffer(maxIndices)
+	, m_context(context)
+	, m_buffer(NULL)
+{
+	// Get device
+	ID3D10Device *device = m_context->getDevice();
+
+	// Create hardware buffer
+	D3D10_BUFFER_DESC desc;
+	desc.ByteWidth = maxIndices * sizeof(quint16);
+	desc.Usage = D3D10_USAGE_DYNAMIC;
+	desc.BindFlags = D3D10_BIND_INDEX_BUFFER;
+	desc.CPUAccessFlags = D3D10_CPU_ACCESS_WRITE;
+	desc.MiscFlags = 0;
+	if(!createDXBuffer(device, &desc, m_data, &m_buffer)) {
+		// Failed to create buffer
+		return;
+	}
+}
+
+D3DIndexBuffer::~D3DIndexBuffer()
+{
+	if(m_buffer)
+		m_buffer->Release();
+}
+
+void D3DIndexBuffer::update()
+{
+	if(m_buffer == NULL)
+		return; // Buffer doesn't exist
+	if(!m_dirty)
+		return; // Buffer is up-to-date
+
+	// Get device
+	ID3D10Device *device = m_context->getDevice();
+
 	// Update hardware buffer
-	int bufSize = m_numFloats * sizeof(float);
+	int bufSize = m_maxIndices * sizeof(quint16);
 	if(!updateDXBuffer(device, m_buffer, m_data, bufSize)) {
 		// Failed to update buffer contents
 		return;
@@ -297,7 +474,7 @@ void D3DVertexBuffer::update()
 	m_dirty = false;
 }
 
-void D3DVertexBuffer::bind()
+void D3DIndexBuffer::bind()
 {
 	if(m_buffer == NULL)
 		return; // Buffer doesn't exist
@@ -310,19 +487,21 @@ void D3DVertexBuffer::bind()
 	ID3D10Device *device = m_context->getDevice();
 
 	// Bind the buffer
-	if(m_vertSize <= 0)
-		return; // Invalid stride
-	uint stride = m_vertSize * sizeof(float);
-	uint offset = 0;
-	device->IASetVertexBuffers(0, 1, &m_buffer, &stride, &offset);
+	device->IASetIndexBuffer(m_buffer, DXGI_FORMAT_R16_UINT, 0);
 }
 
 //=============================================================================
 // D3DTexture class
 
+/// <summary>
+/// Creates a new texture. `mipTail` contains the pixel data of every mipmap
+/// level after the first, if it's not empty then `initialData` must be set
+/// and the texture cannot be writable, targetable or staging.
+/// </summary>
 D3DTexture::D3DTexture(
 	D3DContext *context, VidgfxTexFlags flags, const QSize &size,
-	DXGI_FORMAT format, void *initialData, int stride)
+	DXGI_FORMAT format, void *initialData, int stride,
+	const QVector<QImage> &mipTail)
 	: Texture(flags, size)
 	, m_tex(NULL)
 	, m_view(NULL)
@@ -358,7 +537,7 @@ D3DTexture::D3DTexture(
 	D3D10_TEXTURE2D_DESC desc;
 	desc.Width = size.width();
 	desc.Height = size.height();
-	desc.MipLevels = 1;
+	desc.MipLevels = 1 + mipTail.size();
 	desc.ArraySize = 1;
 	desc.Format = format;
 	desc.SampleDesc.Count = 1;
@@ -384,11 +563,18 @@ D3DTexture::D3DTexture(
 	if(stride <= 0)
 		stride = size.width() * 4; // Each pixel = 32 bits = 4 bytes
 	if(initialData != NULL) {
-		D3D10_SUBRESOURCE_DATA data;
-		data.pSysMem = initialData;
-		data.SysMemPitch = stride;
-		data.SysMemSlicePitch = 0;
-		res = device->CreateTexture2D(&desc, &data, &m_tex);
+		// One subresource per mipmap level
+		QVector<D3D10_SUBRESOURCE_DATA> data(1 + mipTail.size());
+		data[0].pSysMem = initialData;
+		data[0].SysMemPitch = stride;
+		data[0].SysMemSlicePitch = 0;
+		for(int i = 0; i < mipTail.size(); i++) {
+			const QImage &img = mipTail.at(i);
+			data[i + 1].pSysMem = img.constBits();
+			data[i + 1].SysMemPitch = img.bytesPerLine();
+			data[i + 1].SysMemSlicePitch = 0;
+		}
+		res = device->CreateTexture2D(&desc, data.constData(), &m_tex);
 	}
 	else
 		res = device->CreateTexture2D(&desc, NULL, &m_tex);
@@ -398,6 +584,7 @@ D3DTexture::D3DTexture(
 			<< "Reason = " << getDXErrorCode(res);
 		return;
 	}
+	m_mipLevels = desc.MipLevels;
 
 	//-------------------------------------------------------------------------
 	// Create shader resource view
@@ -468,6 +655,9 @@ D3DTexture::D3DTexture(D3DContext *context, ID3D10Texture2D *tex)
 	if(desc.MiscFlags & D3D10_RESOURCE_MISC_GDI_COMPATIBLE)
 		m_flags |= GfxGDIFlag;
 
+	// The texture is owned by someone else who can modify it at any time
+	m_flags |= GfxExternalFlag;
+
 	// Create shader resource view
 	if(!isStaging()) {
 		D3D10_SHADER_RESOURCE_VIEW_DESC viewDesc;
@@ -523,6 +713,8 @@ void *D3DTexture::map()
 
 	m_mappedData = mapInfo.pData;
 	m_stride = mapInfo.RowPitch;
+	if(!isStaging())
+		bumpGeneration(); // The caller is about to modify the texture
 
 	return m_mappedData;
 }
@@ -612,6 +804,7 @@ void D3DTexture::releaseDC()
 	m_surface->Release();
 	m_surface = NULL;
 	m_hdc = NULL;
+	bumpGeneration(); // GDI could have modified the texture
 }
 
 //=============================================================================
@@ -765,8 +958,8 @@ D3DContext::D3DContext()
 	, m_swapChain(NULL)
 	, m_device(NULL)
 	, m_rasterizerState(NULL)
-	, m_pointClampSampler(NULL)
-	, m_bilinearClampSampler(NULL)
+	//, m_pointSamplers()
+	//, m_bilinearSamplers()
 	, m_resizeSampler(NULL)
 	, m_noBlend(NULL)
 	, m_alphaBlend(NULL)
@@ -792,7 +985,13 @@ D3DContext::D3DContext()
 	, m_rgbNv16Constants(NULL)
 	//, m_texDecalConstantsLocal()
 	, m_texDecalConstants(NULL)
-	, m_texDecalFlags(0)
+	//, m_texDecalFlags()
+	//, m_resampleConstantsLocal()
+	, m_resampleConstants(NULL)
+
+	// Input assembler
+	, m_boundTopology(GfxTriangleListTopology)
+	, m_boundVertFormat(GfxFullVertFormat)
 
 	// Shaders
 	, m_boundShader(GfxNoShader)
@@ -803,10 +1002,22 @@ D3DContext::D3DContext()
 	, m_texDecalPS(NULL)
 	, m_texDecalGbcsPS(NULL)
 	, m_texDecalRgbPS(NULL)
+	, m_texDecalMipPS(NULL)
+	, m_texResamplePS(NULL)
 	, m_texDecalIL(NULL)
 	, m_resizeVS(NULL)
 	, m_resizePS(NULL)
 	, m_resizeIL(NULL)
+	, m_resizeGizmoVS(NULL)
+	, m_resizeGizmoIL(NULL)
+	, m_instLayerVS(NULL)
+	, m_instLayerPS(NULL)
+	, m_instLayerIL(NULL)
+	, m_solidCompactVS(NULL)
+	, m_solidCompactIL(NULL)
+	, m_texDecalCompactVS(NULL)
+	, m_texDecalCompactIL(NULL)
+	, m_texDecalUnormIL(NULL)
 	, m_rgbNv16PS(NULL)
 	, m_yv12RgbPS(NULL)
 	, m_UyvyRgbPS(NULL)
@@ -815,6 +1026,17 @@ D3DContext::D3DContext()
 
 	// Advanced rendering
 	, m_mipmapBuf(NULL)
+	, m_unitQuadBuf(NULL)
+
+	// Transient vertex ring
+	, m_transientBuf(NULL)
+	, m_transientMapped(false)
+	, m_transientHead(0)
+	, m_transientUsed(0)
+	, m_transientFrameBytes(0)
+	, m_transientGeneration(0)
+	, m_transientFrames()
+	, m_transientFreeFences()
 
 	// Callbacks
 	, m_dxgi11ChangedCallbackList()
@@ -824,6 +1046,10 @@ D3DContext::D3DContext()
 	memset(m_resizeConstantsLocal, 0, sizeof(m_resizeConstantsLocal));
 	memset(m_rgbNv16ConstantsLocal, 0, sizeof(m_rgbNv16ConstantsLocal));
 	memset(m_texDecalConstantsLocal, 0, sizeof(m_texDecalConstantsLocal));
+	memset(m_texDecalFlags, 0, sizeof(m_texDecalFlags));
+	memset(m_resampleConstantsLocal, 0, sizeof(m_resampleConstantsLocal));
+	memset(m_pointSamplers, 0, sizeof(m_pointSamplers));
+	memset(m_bilinearSamplers, 0, sizeof(m_bilinearSamplers));
 }
 
 D3DContext::~D3DContext()
@@ -838,7 +1064,16 @@ D3DContext::~D3DContext()
 	emit destroying(this);
 
 	// Release advanced rendering objects
+	destroyTransientBuf();
 	deleteVertexBuffer(m_mipmapBuf);
+	deleteVertexBuffer(m_unitQuadBuf);
+	m_unitQuadBuf = NULL;
+	deleteIndexBuffer(m_quadIdxBuf);
+	m_quadIdxBuf = NULL;
+	deleteVertexBuffer(m_resizeGizmoBuf);
+	m_resizeGizmoBuf = NULL;
+	m_resizeGizmoBufValid = false;
+	clearMipCache();
 
 	// Release constant buffers
 	if(m_cameraConstants)
@@ -849,6 +1084,8 @@ D3DContext::~D3DContext()
 		m_rgbNv16Constants->Release();
 	if(m_texDecalConstants)
 		m_texDecalConstants->Release();
+	if(m_resampleConstants)
+		m_resampleConstants->Release();
 
 	// Release shaders
 	if(m_solidVS)
@@ -865,6 +1102,10 @@ D3DContext::~D3DContext()
 		m_texDecalGbcsPS->Release();
 	if(m_texDecalRgbPS)
 		m_texDecalRgbPS->Release();
+	if(m_texDecalMipPS)
+		m_texDecalMipPS->Release();
+	if(m_texResamplePS)
+		m_texResamplePS->Release();
 	if(m_texDecalIL)
 		m_texDecalIL->Release();
 	if(m_resizeVS)
@@ -873,6 +1114,26 @@ D3DContext::~D3DContext()
 		m_resizePS->Release();
 	if(m_resizeIL)
 		m_resizeIL->Release();
+	if(m_resizeGizmoVS)
+		m_resizeGizmoVS->Release();
+	if(m_resizeGizmoIL)
+		m_resizeGizmoIL->Release();
+	if(m_instLayerVS)
+		m_instLayerVS->Release();
+	if(m_instLayerPS)
+		m_instLayerPS->Release();
+	if(m_instLayerIL)
+		m_instLayerIL->Release();
+	if(m_solidCompactVS)
+		m_solidCompactVS->Release();
+	if(m_solidCompactIL)
+		m_solidCompactIL->Release();
+	if(m_texDecalCompactVS)
+		m_texDecalCompactVS->Release();
+	if(m_texDecalCompactIL)
+		m_texDecalCompactIL->Release();
+	if(m_texDecalUnormIL)
+		m_texDecalUnormIL->Release();
 	if(m_rgbNv16PS)
 		m_rgbNv16PS->Release();
 	if(m_yv12RgbPS)
@@ -897,10 +1158,12 @@ D3DContext::~D3DContext()
 	delete m_scratch2Texture;
 
 	// Release sampler states
-	if(m_pointClampSampler)
-		m_pointClampSampler->Release();
-	if(m_bilinearClampSampler)
-		m_bilinearClampSampler->Release();
+	for(int i = 0; i < NUM_ADDRESS_MODES; i++) {
+		if(m_pointSamplers[i])
+			m_pointSamplers[i]->Release();
+		if(m_bilinearSamplers[i])
+			m_bilinearSamplers[i]->Release();
+	}
 	if(m_resizeSampler)
 		m_resizeSampler->Release();
 
@@ -1190,20 +1453,32 @@ bool D3DContext::initialize(
 	sampDesc.BorderColor[3] = 0.0f;
 	sampDesc.MinLOD = 0.0f;
 	sampDesc.MaxLOD = D3D10_FLOAT32_MAX;
-	res = m_device->CreateSamplerState(&sampDesc, &m_pointClampSampler);
-	if(FAILED(res)) {
-		gfxLog(LOG_CAT, GfxLog::Critical)
-			<< "Failed to create clamped point sampler state, cannot "
-			<< "continue. Reason = " << getDXErrorCode(res);
-		return false;
-	}
-	sampDesc.Filter = D3D10_FILTER_MIN_MAG_LINEAR_MIP_POINT;
-	res = m_device->CreateSamplerState(&sampDesc, &m_bilinearClampSampler);
-	if(FAILED(res)) {
-		gfxLog(LOG_CAT, GfxLog::Critical)
-			<< "Failed to create clamped bilinear sampler state, cannot "
-			<< "continue. Reason = " << getDXErrorCode(res);
-		return false;
+	const D3D10_TEXTURE_ADDRESS_MODE addressModes[NUM_ADDRESS_MODES] = {
+		D3D10_TEXTURE_ADDRESS_CLAMP, // GfxClampAddressing
+		D3D10_TEXTURE_ADDRESS_WRAP, // GfxWrapAddressing
+		D3D10_TEXTURE_ADDRESS_MIRROR // GfxMirrorAddressing
+	};
+	for(int i = 0; i < NUM_ADDRESS_MODES; i++) {
+		sampDesc.AddressU = addressModes[i];
+		sampDesc.AddressV = addressModes[i];
+		sampDesc.AddressW = addressModes[i];
+		sampDesc.Filter = D3D10_FILTER_MIN_MAG_MIP_POINT;
+		res = m_device->CreateSamplerState(&sampDesc, &m_pointSamplers[i]);
+		if(FAILED(res)) {
+			gfxLog(LOG_CAT, GfxLog::Critical)
+				<< "Failed to create point sampler state, cannot "
+				<< "continue. Reason = " << getDXErrorCode(res);
+			return false;
+		}
+		sampDesc.Filter = D3D10_FILTER_MIN_MAG_LINEAR_MIP_POINT;
+		res = m_device->CreateSamplerState(
+			&sampDesc, &m_bilinearSamplers[i]);
+		if(FAILED(res)) {
+			gfxLog(LOG_CAT, GfxLog::Critical)
+				<< "Failed to create bilinear sampler state, cannot "
+				<< "continue. Reason = " << getDXErrorCode(res);
+			return false;
+		}
 	}
 	sampDesc.AddressU = D3D10_TEXTURE_ADDRESS_BORDER;
 	sampDesc.AddressV = D3D10_TEXTURE_ADDRESS_BORDER;
@@ -1354,6 +1629,21 @@ bool D3DContext::initialize(
 			return false;
 	}
 
+	//-------------------------------------------------------------------------
+	// Create resample cbuffer. Only written by `renderResample()` itself.
+
+	// Create hardware buffer
+	bufDesc.ByteWidth = sizeof(m_resampleConstantsLocal);
+	bufDesc.Usage = D3D10_USAGE_DYNAMIC;
+	bufDesc.BindFlags = D3D10_BIND_CONSTANT_BUFFER;
+	bufDesc.CPUAccessFlags = D3D10_CPU_ACCESS_WRITE;
+	bufDesc.MiscFlags = 0;
+	if(!createDXBuffer(m_device, &bufDesc, m_resampleConstantsLocal,
+		&m_resampleConstants)) {
+			// Failed to create buffer
+			return false;
+	}
+
 	//-------------------------------------------------------------------------
 	// Set the scratch target's initial size
 
@@ -1363,7 +1653,29 @@ bool D3DContext::initialize(
 	//-------------------------------------------------------------------------
 	// Create advanced rendering objects
 
-	m_mipmapBuf = createVertexBuffer(TexDecalRectBufSize);
+	m_mipmapBuf =
+		createVertexBuffer(TexDecalRectBufSize, GfxWriteThroughStorage);
+
+	// Unit quad that every layer instance is placed with
+	m_unitQuadBuf = createVertexBuffer(4 * 2, GfxShadowedStorage);
+	if(m_unitQuadBuf != NULL) {
+		const float unitQuad[4 * 2] = {
+			0.0f, 0.0f, // Top-left
+			1.0f, 0.0f, // Top-right
+			0.0f, 1.0f, // Bottom-left
+			1.0f, 1.0f // Bottom-right
+		};
+		m_unitQuadBuf->setNumVerts(4);
+		m_unitQuadBuf->setVertSize(2);
+		memcpy(m_unitQuadBuf->map(), unitQuad, sizeof(unitQuad));
+		m_unitQuadBuf->markDirty(0, 4 * 2);
+		m_unitQuadBuf->unmap();
+	}
+	createTransientBuf(); // Not fatal, users fall back to normal buffers
+
+	// The quad index pattern never changes so it's only uploaded once
+	m_quadIdxBuf = createIndexBuffer(QuadIdxBufNumIndices);
+	createQuadIndices(m_quadIdxBuf, MaxQuadsPerDraw);
 
 	//-------------------------------------------------------------------------
 	// Emit initialized signal
@@ -1481,23 +1793,21 @@ bool D3DContext::createScreenTarget()
 bool D3DContext::createShaders()
 {
 	// Solid colour shaders
-	const D3D10_INPUT_ELEMENT_DESC solidILDesc[] = {
-		{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0,  0, D3D10_INPUT_PER_VERTEX_DATA, 0},
-		{"COLOR",    0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 16, D3D10_INPUT_PER_VERTEX_DATA, 0},
-	};
+	D3D10_INPUT_ELEMENT_DESC solidILDesc[SolidVertLayout::NumElements];
+	describeInputLayout<SolidVertLayout>(solidILDesc);
 	if(!createVertexShaderAndInputLayout(
-		"solid-vs", &m_solidVS, &m_solidIL, solidILDesc, 2))
+		"solid-vs", &m_solidVS, &m_solidIL, solidILDesc,
+		SolidVertLayout::NumElements))
 		return false;
 	if(!createPixelShader("solid-ps", &m_solidPS))
 		return false;
 
 	// Texture decal shaders
-	const D3D10_INPUT_ELEMENT_DESC texDecalILDesc[] = {
-		{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0,  0, D3D10_INPUT_PER_VERTEX_DATA, 0},
-		{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 16, D3D10_INPUT_PER_VERTEX_DATA, 0},
-	};
+	D3D10_INPUT_ELEMENT_DESC texDecalILDesc[TexDecalVertLayout::NumElements];
+	describeInputLayout<TexDecalVertLayout>(texDecalILDesc);
 	if(!createVertexShaderAndInputLayout(
-		"texDecal-vs", &m_texDecalVS, &m_texDecalIL, texDecalILDesc, 2))
+		"texDecal-vs", &m_texDecalVS, &m_texDecalIL, texDecalILDesc,
+		TexDecalVertLayout::NumElements))
 		return false;
 	if(!createPixelShader("texDecal-ps", &m_texDecalPS))
 		return false;
@@ -1505,16 +1815,69 @@ bool D3DContext::createShaders()
 		return false;
 	if(!createPixelShader("texDecalRgb-ps", &m_texDecalRgbPS))
 		return false;
+	if(!createPixelShader("texDecalMip-ps", &m_texDecalMipPS))
+		return false;
+	if(!createPixelShader("texResample-ps", &m_texResamplePS))
+		return false;
 
 	// Resize layer shaders
-	const D3D10_INPUT_ELEMENT_DESC resizeILDesc[] = {
-		{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0,  0, D3D10_INPUT_PER_VERTEX_DATA, 0}
-	};
+	D3D10_INPUT_ELEMENT_DESC resizeILDesc[ResizeVertLayout::NumElements];
+	describeInputLayout<ResizeVertLayout>(resizeILDesc);
 	if(!createVertexShaderAndInputLayout(
-		"resize-vs", &m_resizeVS, &m_resizeIL, resizeILDesc, 1))
+		"resize-vs", &m_resizeVS, &m_resizeIL, resizeILDesc,
+		ResizeVertLayout::NumElements))
 		return false;
 	if(!createPixelShader("resize-ps", &m_resizePS))
 		return false;
+	const D3D10_INPUT_ELEMENT_DESC resizeGizmoILDesc[] = {
+		{"POSITION", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0,  0, D3D10_INPUT_PER_VERTEX_DATA, 0}
+	};
+	if(!createVertexShaderAndInputLayout(
+		"resizeGizmo-vs", &m_resizeGizmoVS, &m_resizeGizmoIL,
+		resizeGizmoILDesc, 1))
+		return false;
+
+	// Instanced layer shaders. The unit quad is in slot 0 and the instance
+	// data is in slot 1.
+	const D3D10_INPUT_ELEMENT_DESC instLayerILDesc[] = {
+		{"POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0,  0, D3D10_INPUT_PER_VERTEX_DATA, 0},
+		{"RECT",     0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1,  0, D3D10_INPUT_PER_INSTANCE_DATA, 1},
+		{"UVRECT",   0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D10_INPUT_PER_INSTANCE_DATA, 1},
+		{"COLOR",    0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D10_INPUT_PER_INSTANCE_DATA, 1},
+		{"SLOT",     0, DXGI_FORMAT_R32_FLOAT, 1, 48, D3D10_INPUT_PER_INSTANCE_DATA, 1},
+	};
+	if(!createVertexShaderAndInputLayout(
+		"instLayer-vs", &m_instLayerVS, &m_instLayerIL, instLayerILDesc, 5))
+		return false;
+	if(!createPixelShader("instLayer-ps", &m_instLayerPS))
+		return false;
+
+	// Compact vertex format shaders. The UNORM UV layout is identical to the
+	// float UV layout as far as the vertex shader is concerned so it reuses
+	// the same shader bytecode.
+	D3D10_INPUT_ELEMENT_DESC
+		solidCompactILDesc[SolidCompactVertLayout::NumElements];
+	describeInputLayout<SolidCompactVertLayout>(solidCompactILDesc);
+	if(!createVertexShaderAndInputLayout(
+		"solidCompact-vs", &m_solidCompactVS, &m_solidCompactIL,
+		solidCompactILDesc, SolidCompactVertLayout::NumElements))
+		return false;
+	D3D10_INPUT_ELEMENT_DESC
+		texDecalCompactILDesc[TexDecalCompactVertLayout::NumElements];
+	describeInputLayout<TexDecalCompactVertLayout>(texDecalCompactILDesc);
+	if(!createVertexShaderAndInputLayout(
+		"texDecalCompact-vs", &m_texDecalCompactVS, &m_texDecalCompactIL,
+		texDecalCompactILDesc, TexDecalCompactVertLayout::NumElements))
+		return false;
+	D3D10_INPUT_ELEMENT_DESC
+		texDecalUnormILDesc[TexDecalUnormVertLayout::NumElements];
+	describeInputLayout<TexDecalUnormVertLayout>(texDecalUnormILDesc);
+	ID3D10VertexShader *unormVS = NULL;
+	if(!createVertexShaderAndInputLayout(
+		"texDecalCompact-vs", &unormVS, &m_texDecalUnormIL,
+		texDecalUnormILDesc, TexDecalUnormVertLayout::NumElements))
+		return false;
+	unormVS->Release();
 
 	// Colour conversion shaders
 	if(!createPixelShader("rgb-nv16-ps", &m_rgbNv16PS))
@@ -1659,6 +2022,10 @@ void D3DContext::updateResizeConstants()
 	m_resizeConstantsLocal[1] = m_resizeRect.y();
 	m_resizeConstantsLocal[2] = m_resizeRect.width();
 	m_resizeConstantsLocal[3] = m_resizeRect.height();
+	m_resizeConstantsLocal[4] = m_resizeGizmoRect.x();
+	m_resizeConstantsLocal[5] = m_resizeGizmoRect.y();
+	m_resizeConstantsLocal[6] = m_resizeGizmoRect.width();
+	m_resizeConstantsLocal[7] = m_resizeGizmoRect.height();
 
 	// Update hardware buffer
 	if(m_resizeConstants) {
@@ -1714,9 +2081,9 @@ void D3DContext::updateTexDecalConstants()
 	m_texDecalConstantsLocal[2] = m_texDecalModulate.blueF();
 	m_texDecalConstantsLocal[3] = m_texDecalModulate.alphaF();
 	uint *uintConstants = (uint *)m_texDecalConstantsLocal;
-	uintConstants[4] = m_texDecalFlags;
-	uintConstants[5] = 0;
-	uintConstants[6] = 0;
+	uintConstants[4] = m_texDecalFlags[0];
+	uintConstants[5] = m_texDecalFlags[1];
+	uintConstants[6] = m_texDecalFlags[2];
 	uintConstants[7] = 0;
 	m_texDecalConstantsLocal[8] = m_texDecalEffects[0];
 	m_texDecalConstantsLocal[9] = m_texDecalEffects[1];
@@ -1736,12 +2103,118 @@ void D3DContext::updateTexDecalConstants()
 	m_texDecalConstantsDirty = false;
 }
 
-void D3DContext::setSwizzleInTexDecal(bool doSwizzle)
+/// <summary>
+/// Sets if the texture that is bound to `slot` stores BGRA data in a RGBA
+/// texture. Only `GfxInstancedLayerShader` reads the flags of slots other
+/// than the first.
+/// </summary>
+void D3DContext::setSwizzleInTexDecal(int slot, bool doSwizzle)
 {
 	quint32 flag = (doSwizzle ? 0xFFFFFFFF : 0);
-	if(m_texDecalFlags != flag)
+	if(m_texDecalFlags[slot] != flag)
 		m_texDecalConstantsDirty = true;
-	m_texDecalFlags = flag;
+	m_texDecalFlags[slot] = flag;
+}
+
+/// <summary>
+/// Updates and binds the constant buffers that the bound shader uses.
+/// </summary>
+void D3DContext::bindShaderConstants()
+{
+	// Update and bind our camera constants
+	updateCameraConstants();
+	m_device->VSSetConstantBuffers(0, 1, &m_cameraConstants);
+
+	// Update and bind our pixel shader constants if needed
+	if(m_boundShader == GfxResizeLayerShader) {
+		updateResizeConstants();
+		m_device->PSSetConstantBuffers(0, 1, &m_resizeConstants);
+	} else if(m_boundShader == GfxResizeGizmoShader) {
+		// The gizmo vertex shader also needs the gizmo rectangle
+		updateResizeConstants();
+		m_device->VSSetConstantBuffers(1, 1, &m_resizeConstants);
+		m_device->PSSetConstantBuffers(0, 1, &m_resizeConstants);
+	} else if(m_boundShader == GfxRgbNv16Shader) {
+		updateRgbNv16Constants();
+		m_device->PSSetConstantBuffers(0, 1, &m_rgbNv16Constants);
+	} else if(m_boundShader == GfxYv12RgbShader ||
+		m_boundShader == GfxUyvyRgbShader ||
+		m_boundShader == GfxHdycRgbShader ||
+		m_boundShader == GfxYuy2RgbShader)
+	{
+		// HACK: Reuse RgbNv16 shader cbuffer
+		m_device->PSSetConstantBuffers(0, 1, &m_rgbNv16Constants);
+	} else if(m_boundShader == GfxTexDecalShader ||
+		m_boundShader == GfxTexDecalGbcsShader ||
+		m_boundShader == GfxTexDecalRgbShader ||
+		m_boundShader == GfxTexDecalMipShader ||
+		m_boundShader == GfxInstancedLayerShader)
+	{
+		updateTexDecalConstants();
+		m_device->PSSetConstantBuffers(0, 1, &m_texDecalConstants);
+	} else if(m_boundShader == GfxTexResampleShader) {
+		// The resample constants are updated by `renderResample()`
+		updateTexDecalConstants();
+		m_device->PSSetConstantBuffers(0, 1, &m_texDecalConstants);
+		m_device->PSSetConstantBuffers(1, 1, &m_resampleConstants);
+	}
+}
+
+/// <summary>
+/// Switches the bound vertex shader and input layout to the variant of the
+/// currently bound shader that matches the specified vertex format. Only the
+/// solid and texture decal shader families have compact variants.
+/// </summary>
+void D3DContext::bindVertexFormat(VidgfxVertFormat format)
+{
+	if(m_boundVertFormat == format)
+		return; // Already bound
+
+	ID3D10VertexShader *vs = NULL;
+	ID3D10InputLayout *il = NULL;
+	switch(m_boundShader) {
+	default:
+	case GfxNoShader:
+	case GfxResizeLayerShader:
+	case GfxResizeGizmoShader:
+	case GfxInstancedLayerShader:
+		gfxLog(LOG_CAT, GfxLog::Warning) << QStringLiteral(
+			"Bound shader does not support compact vertex formats");
+		return;
+	case GfxSolidShader:
+		if(format == GfxFullVertFormat) {
+			vs = m_solidVS;
+			il = m_solidIL;
+		} else { // Colours are RGBA8 in both compact formats
+			vs = m_solidCompactVS;
+			il = m_solidCompactIL;
+		}
+		break;
+	case GfxTexDecalShader:
+	case GfxTexDecalGbcsShader:
+	case GfxTexDecalRgbShader:
+	case GfxTexDecalMipShader:
+	case GfxTexResampleShader:
+	case GfxRgbNv16Shader:
+	case GfxYv12RgbShader:
+	case GfxUyvyRgbShader:
+	case GfxHdycRgbShader:
+	case GfxYuy2RgbShader:
+		if(format == GfxFullVertFormat) {
+			vs = m_texDecalVS;
+			il = m_texDecalIL;
+		} else if(format == GfxCompactVertFormat) {
+			vs = m_texDecalCompactVS;
+			il = m_texDecalCompactIL;
+		} else {
+			vs = m_texDecalCompactVS;
+			il = m_texDecalUnormIL;
+		}
+		break;
+	}
+	m_device->IASetInputLayout(il);
+	m_device->VSSetShader(vs);
+	m_boundVertFormat = format;
 }
 
 //=============================================================================
@@ -1767,14 +2240,15 @@ void D3DContext::flush()
 //-----------------------------------------------------------------------------
 // Buffers
 
-VertexBuffer *D3DContext::createVertexBuffer(int numFloats)
+VertexBuffer *D3DContext::createVertexBuffer(
+	int numFloats, VidgfxBufStorage storage)
 {
 	if(!isValid())
 		return NULL; // DirectX must be initialized
 	if(numFloats <= 0)
 		return NULL; // Invalid size
 
-	D3DVertexBuffer *buf = new D3DVertexBuffer(this, numFloats);
+	D3DVertexBuffer *buf = new D3DVertexBuffer(this, numFloats, storage);
 	return buf;
 }
 
@@ -1785,6 +2259,24 @@ void D3DContext::deleteVertexBuffer(VertexBuffer *buf)
 	delete static_cast<D3DVertexBuffer *>(buf);
 }
 
+IndexBuffer *D3DContext::createIndexBuffer(int numIndices)
+{
+	if(!isValid())
+		return NULL; // DirectX must be initialized
+	if(numIndices <= 0)
+		return NULL; // Invalid size
+
+	D3DIndexBuffer *buf = new D3DIndexBuffer(this, numIndices);
+	return buf;
+}
+
+void D3DContext::deleteIndexBuffer(IndexBuffer *buf)
+{
+	if(buf == NULL)
+		return;
+	delete static_cast<D3DIndexBuffer *>(buf);
+}
+
 /// <summary>
 /// Creates a static texture based off the provided QImage. If `writable` is
 /// true then the texture data can be rewritten at any time. If `targetable` is
@@ -1839,6 +2331,8 @@ Texture *D3DContext::createTexture(QImage img, bool writable, bool targetable)
 		flags |= GfxWritableFlag;
 	if(targetable)
 		flags |= GfxTargetableFlag;
+	if(img.hasAlphaChannel())
+		flags |= GfxAlphaFlag;
 
 	D3DTexture *tex =
 		new D3DTexture(this, flags, img.size(), format, img.bits());
@@ -1915,29 +2409,78 @@ Texture *D3DContext::createTexture(
 }
 
 /// <summary>
-/// Creates a special texture buffer that cannot be bound with `setTexture()`
-/// but can be used to read back pixel data from the graphics hardware.
+/// Creates a static texture that contains a complete or partial mipmap chain,
+/// such as the levels of an `ImagePyramid`. `levels` starts with the full size
+/// image and each following level must be exactly half the size of the
+/// previous one, rounded down. When such a texture is rendered at a smaller
+/// size the graphics hardware selects the closest level itself so
+/// `prepareTexture()` doesn't need to generate any mipmaps.
 /// </summary>
 /// <returns>
 /// A pointer to the newly created texture or NULL on failure.
 /// </returns>
-Texture *D3DContext::createStagingTexture(const QSize &size)
+Texture *D3DContext::createMipmappedTexture(const QVector<QImage> &levels)
 {
-	if(size.isEmpty())
-		return NULL; // Cannot create empty textures
+	if(levels.isEmpty() || levels.first().isNull())
+		return NULL;
 
-	D3DTexture *tex =
-		new D3DTexture(this, GfxStagingFlag, size, DXGI_FORMAT_R8G8B8A8_UNORM);
+	// Validate the mipmap chain and convert every level to BGRA
+	QVector<QImage> imgs = levels;
+	QSize levelSize = imgs.first().size();
+	for(int i = 0; i < imgs.size(); i++) {
+		if(i > 0) {
+			levelSize = QSize(
+				qMax(1, levelSize.width() / 2), qMax(1, levelSize.height() / 2));
+		}
+		if(imgs.at(i).size() != levelSize) {
+			gfxLog(LOG_CAT, GfxLog::Warning)
+				<< "Invalid mipmap level size for texture";
+			return NULL;
+		}
+		if(imgs.at(i).format() != QImage::Format_RGB32 &&
+			imgs.at(i).format() != QImage::Format_ARGB32)
+		{
+			imgs[i] = imgs.at(i).convertToFormat(QImage::Format_ARGB32);
+		}
+	}
+
+	VidgfxTexFlags flags = 0;
+	if(levels.first().hasAlphaChannel())
+		flags |= GfxAlphaFlag;
+	QImage &base = imgs.first();
+	D3DTexture *tex = new D3DTexture(this, flags, base.size(),
+		DXGI_FORMAT_B8G8R8A8_UNORM, base.bits(), base.bytesPerLine(),
+		imgs.mid(1));
 	if(tex->isValid())
 		return tex;
 	delete tex;
 	return NULL;
 }
 
-// This method is not a part of the GraphicsContext interface but it placed
-// here as it's related to texture creation.
-Texture *D3DContext::createGDITexture(const QSize &size)
-{
+/// <summary>
+/// Creates a special texture buffer that cannot be bound with `setTexture()`
+/// but can be used to read back pixel data from the graphics hardware.
+/// </summary>
+/// <returns>
+/// A pointer to the newly created texture or NULL on failure.
+/// </returns>
+Texture *D3DContext::createStagingTexture(const QSize &size)
+{
+	if(size.isEmpty())
+		return NULL; // Cannot create empty textures
+
+	D3DTexture *tex =
+		new D3DTexture(this, GfxStagingFlag, size, DXGI_FORMAT_R8G8B8A8_UNORM);
+	if(tex->isValid())
+		return tex;
+	delete tex;
+	return NULL;
+}
+
+// This method is not a part of the GraphicsContext interface but it placed
+// here as it's related to texture creation.
+Texture *D3DContext::createGDITexture(const QSize &size)
+{
 	if(size.isEmpty())
 		return NULL; // Cannot create empty textures
 	if(!hasDxgi11())
@@ -2007,6 +2550,7 @@ void D3DContext::deleteTexture(Texture *tex)
 {
 	if(tex == NULL)
 		return;
+	purgeMipCache(tex);
 	delete static_cast<D3DTexture *>(tex);
 }
 
@@ -2034,8 +2578,8 @@ bool D3DContext::copyTextureData(
 		return false;
 	}
 	if(srcRect.x() < 0 || srcRect.y() < 0 ||
-		srcRect.right() > src->getWidth() ||
-		srcRect.bottom() > dst->getHeight())
+		srcRect.right() >= src->getWidth() ||
+		srcRect.bottom() >= src->getHeight())
 	{
 		gfxLog(LOG_CAT, GfxLog::Warning)
 			<< "Cannot copy texture data as the source rectangle doesn't fit "
@@ -2057,6 +2601,7 @@ bool D3DContext::copyTextureData(
 		dstPos.x(), dstPos.y(), 0,
 		srcTex->getTexture(), D3D10CalcSubresource(0, 0, 0),
 		&box);
+	dst->bumpGeneration();
 	return true;
 }
 
@@ -2127,6 +2672,8 @@ void D3DContext::resizeCanvasTarget(const QSize &newSize)
 	}
 
 	// Release the old textures and render targets
+	purgeMipCache(m_canvas1Texture);
+	purgeMipCache(m_canvas2Texture);
 	delete m_canvas1Texture;
 	delete m_canvas2Texture;
 	m_canvas1Texture = NULL;
@@ -2211,6 +2758,7 @@ void D3DContext::swapScreenBuffers()
 		return; // DirectX must be initialized
 
 	m_swapChain->Present(0, 0);
+	endFrame();
 }
 
 Texture *D3DContext::getTargetTexture(VidgfxRendTarget target)
@@ -2301,12 +2849,25 @@ Texture *D3DContext::prepareTexture(
 /// If this method was called with `GfxPointFilter` then it is essentially a
 /// no-op. If this method was called with `GfxBilinearFilter` then it will
 /// automatically create the least amount of mipmaps necessary to render at the
-/// specified size and then return the details of the smallest mipmap. If this
-/// method was called with `GfxBicubicFilter` then it will apply bicubic
-/// rescaling of the input to the exact specified size so the calling code does
-/// not need to worry about how to sample the returned texture (This basically
-/// forces another pass on the texture and could potentially be optimized out
-/// at a later date at the expense of more shader permutations).
+/// specified size and then return the details of the smallest mipmap unless
+/// the texture was created with `createMipmappedTexture()` in which case the
+/// texture is returned as-is. If this method was called with
+/// `GfxBicubicFilter` or `GfxLanczosFilter` then the cropped area of the input
+/// texture is rescaled to the exact specified size so the calling code does
+/// not need to worry about how to sample the returned texture. Textures that
+/// are modified frequently, such as the canvas, are rescaled every frame on
+/// the GPU with a separable two-pass filter after being reduced with mipmaps
+/// to at most twice the output size. Once it has been determined that the
+/// texture is static (See below) it is instead read back and rescaled once on
+/// the CPU with `ImageScaler`. Static textures that are downscaled with
+/// `GfxBilinearFilter` are also rescaled on the CPU using area averaging
+/// instead of our mipmaps.
+///
+/// If the input texture has not been modified since the last time it was
+/// prepared with the same parameters then the final mipmap is kept in a cache
+/// that is owned by the context and returned directly on later calls. The
+/// texture's generation counter is used to detect modifications so textures
+/// that are modified outside of Libvidgfx must call `bumpGeneration()`.
 ///
 /// WARNING: Do not use Texture::getSize() or `size` to determine texel size in
 /// later stages! Instead use `pxSizeOut` and `botRightOut` as they take into
@@ -2342,6 +2903,9 @@ Texture *D3DContext::prepareTexture(
 	// Remember original state
 	VidgfxRendTarget origTarget = m_currentTarget;
 
+	// If true then `outTex` only contains the cropped area
+	bool isCropped = false;
+
 	// TODO: Validate crop rectangle
 
 	// We do cropping inefficiently by resampling the entire texture and then
@@ -2360,12 +2924,53 @@ Texture *D3DContext::prepareTexture(
 		// We don't need to do any actual texture processing for point sampling
 		break;
 	default:
-#if 0
 	case GfxBicubicFilter:
-#endif // 0
+	case GfxLanczosFilter:
 	case GfxBilinearFilter: {
-		// Create mipmaps as required
+		// If the texture is larger than what we can sample without distortion
+		// then check if we have already created the mipmaps previously. High
+		// quality filters are worth caching for any amount of rescaling.
+		// Textures that already contain a mip tail are sampled directly as
+		// the graphics hardware selects the closest level itself
+		if(filter == GfxBilinearFilter && tex->getMipLevels() > 1)
+			break;
+
 		QSize nextSize = tex->getSize();
+		const bool isHighQual =
+			(filter == GfxBicubicFilter || filter == GfxLanczosFilter);
+		MipCacheEntry *cache = NULL;
+		if((nextSize.width() > invCropSize.width() * 2
+			|| nextSize.height() > invCropSize.height() * 2)
+			|| (isHighQual && cropRect.size() != size))
+		{
+			cache = getMipCacheEntry(tex, cropRect, size, filter);
+		}
+		if(cache != NULL && cache->tex != NULL) {
+			outTex = cache->tex;
+			relTexSize = cache->relTexSize;
+			isCropped = cache->isCropped;
+			break;
+		}
+
+		// If the texture appears to be static then rescale it on the CPU now,
+		// it'll be reused until the texture is modified. For bilinear
+		// filtering this does an exact area average in a single pass which
+		// is more accurate than our mipmaps for non-power-of-two ratios.
+		if(cache != NULL && cache->numHits > 0) {
+			Texture *scaledTex =
+				createScaledTexture(tex, cropRect, size, filter);
+			if(scaledTex != NULL) {
+				cache->tex = scaledTex;
+				cache->relTexSize = QPointF(1.0f, 1.0f);
+				cache->isCropped = true;
+				outTex = scaledTex;
+				relTexSize = cache->relTexSize;
+				isCropped = true;
+				break;
+			}
+		}
+
+		// Create mipmaps as required
 		for(;;) {
 			if(nextSize.width() <= invCropSize.width() * 2
 				&& nextSize.height() <= invCropSize.height() * 2)
@@ -2385,34 +2990,57 @@ Texture *D3DContext::prepareTexture(
 			//	<< "Creating mipmap of " << nextSize << " for target size "
 			//	<< size;
 
-			// Update the vertex buffer
-			createTexDecalRect(
-				m_mipmapBuf, QRectF(0.0f, 0.0f,
-				(qreal)nextSize.width(), (qreal)nextSize.height()),
-				relTexSize);
-
-			// Setup render target
-			resizeScratchTarget(nextSize);
-			VidgfxRendTarget target = getNextScratchTarget();
-			setRenderTarget(target);
-			QMatrix4x4 mat;
-			setViewMatrix(mat);
-			mat.ortho(
-				0.0f, nextSize.width(), nextSize.height(), 0.0f, -1.0f, 1.0f);
-			setProjectionMatrix(mat);
-
-			// Render the mipmap
-			setShader(GfxTexDecalShader);
-			setTopology(GfxTriangleStripTopology);
-			setBlending(GfxNoBlending);
-			setTexture(outTex);
-			setTextureFilter(GfxBilinearFilter);
-			drawBuffer(m_mipmapBuf);
-
-			// Update references
-			outTex = getTargetTexture(target);
-			relTexSize = getScratchTargetToTextureRatio();
+			outTex = renderMipmap(
+				outTex, relTexSize, nextSize, tex->hasAlpha(), relTexSize);
+		}
+
+		// High quality filters finish with a separable bicubic or Lanczos
+		// rescale of the cropped area to the exact output size on the GPU.
+		// The mipmaps above keep the kernel small for large downscales.
+		if(isHighQual && (outTex != tex || cropRect.size() != size)) {
+			const qreal xScale =
+				(qreal)nextSize.width() / (qreal)tex->getWidth();
+			const qreal yScale =
+				(qreal)nextSize.height() / (qreal)tex->getHeight();
+			const QRectF srcRect(
+				(qreal)cropRect.left() * xScale,
+				(qreal)cropRect.top() * yScale,
+				(qreal)cropRect.width() * xScale,
+				(qreal)cropRect.height() * yScale);
+			QPointF resRelSize;
+			Texture *resTex = renderResample(outTex, relTexSize, nextSize,
+				srcRect, size, filter, tex->hasAlpha(), resRelSize);
+			if(resTex != NULL) {
+				outTex = resTex;
+				relTexSize = resRelSize;
+				nextSize = size;
+				isCropped = true;
+			}
+		}
+
+		// If the source texture hasn't changed since the last time it was
+		// prepared then it's most likely static so copy the smallest mipmap
+		// out of the scratch texture so we don't need to regenerate it every
+		// frame
+		if(cache == NULL || cache->numHits <= 0 || cache->srcTex != tex ||
+			outTex == tex)
+		{
+			break;
 		}
+		Texture *cacheTex = createTexture(nextSize, outTex, false, false);
+		if(cacheTex == NULL)
+			break;
+		if(!copyTextureData(
+			cacheTex, outTex, QPoint(0, 0), QRect(QPoint(0, 0), nextSize)))
+		{
+			deleteTexture(cacheTex);
+			break;
+		}
+		cache->tex = cacheTex;
+		cache->relTexSize = QPointF(1.0f, 1.0f);
+		cache->isCropped = isCropped;
+		outTex = cacheTex;
+		relTexSize = cache->relTexSize;
 		break; }
 	}
 
@@ -2422,8 +3050,8 @@ Texture *D3DContext::prepareTexture(
 	// Adjust top-left and bottom-right points for cropping
 	topLeftOut = QPointF(0.0f, 0.0f);
 	botRightOut = relTexSize;
-	if(cropRect.topLeft() != QPoint(0, 0) ||
-		cropRect.size() != tex->getSize())
+	if(!isCropped && (cropRect.topLeft() != QPoint(0, 0) ||
+		cropRect.size() != tex->getSize()))
 	{
 		QPointF pxSize(
 			relTexSize.x() / (qreal)tex->getSize().width(),
@@ -2447,6 +3075,405 @@ Texture *D3DContext::prepareTexture(
 	return outTex;
 }
 
+/// <summary>
+/// Prepares the input texture for rendering at multiple sizes at once. This is
+/// equivalent to calling `prepareTexture()` for each size in `sizes` without
+/// a crop except that the mipmaps are shared between the outputs and nothing
+/// is cached. The outputs are processed from largest to smallest area and
+/// each one continues the mipmap chain of the previous output unless it's
+/// wider or taller than the previous mipmap in which case the chain is
+/// restarted from the source. With `GfxBicubicFilter` or `GfxLanczosFilter`
+/// the chain stops at the smallest level that is at least twice the output
+/// size and that level is then rescaled to the exact output size with
+/// `renderResample()`. As the resample passes use both scratch targets the
+/// level is first copied out of the scratch target so that the chain can be
+/// continued by the next output. `callback` is called as soon as an output is
+/// available with the index of the output in `sizes`, the texture to render
+/// and the texture coordinates to render it with. The texture filter is
+/// already set up when the callback is called and the original render target
+/// is restored.
+///
+/// WARNING: The mipmap and resample passes overwrite the view and projection
+/// matrices and they are not restored before the callback is called. The
+/// callback must set up its own matrices before rendering.
+///
+/// WARNING: The texture passed to the callback is only valid for the duration
+/// of the callback. The callback must not use the scratch targets or call any
+/// method that does such as `prepareTexture()`.
+/// </summary>
+void D3DContext::prepareTextureLadder(
+	Texture *tex, const QVector<QSize> &sizes, VidgfxFilter filter,
+	VidgfxContextLadderCallback *callback, void *opaque)
+{
+	if(!isValid() || tex == NULL || callback == NULL)
+		return; // Invalid input
+	VidgfxContext *context = reinterpret_cast<VidgfxContext *>(this);
+
+	// Process the outputs from largest to smallest so that each mipmap can be
+	// used as the source for the next smaller one
+	QVector<int> order;
+	order.reserve(sizes.size());
+	for(int i = 0; i < sizes.size(); i++) {
+		const QSize &size = sizes.at(i);
+		if(size.width() <= 0 || size.height() <= 0)
+			continue; // Skip invalid sizes
+		int j = 0;
+		for(; j < order.size(); j++) {
+			const QSize &other = sizes.at(order.at(j));
+			if(size.width() * size.height() > other.width() * other.height())
+				break;
+		}
+		order.insert(j, i);
+	}
+
+	const bool isHighQual =
+		(filter == GfxBicubicFilter || filter == GfxLanczosFilter);
+	VidgfxRendTarget origTarget = m_currentTarget;
+	Texture *outTex = tex;
+	Texture *levelTex = NULL; // Copy of the last level for high quality
+	QPointF relTexSize(1.0f, 1.0f);
+	QSize nextSize = tex->getSize();
+	for(int i = 0; i < order.size(); i++) {
+		const QSize &size = sizes.at(order.at(i));
+
+		// Outputs are ordered by area so a smaller output can still be wider
+		// or taller than the previous mipmap. Continuing the chain would then
+		// upscale so restart from the source instead, the earlier levels have
+		// already been overwritten in the scratch targets.
+		if(nextSize.width() < size.width() ||
+			nextSize.height() < size.height())
+		{
+			outTex = tex;
+			relTexSize = QPointF(1.0f, 1.0f);
+			nextSize = tex->getSize();
+		}
+
+		// Create mipmaps as required, continuing from where the previous
+		// output left off
+		while(filter != GfxPointFilter && tex->getMipLevels() <= 1 &&
+			(nextSize.width() > size.width() * 2 ||
+			nextSize.height() > size.height() * 2))
+		{
+			nextSize = QSize(
+				qMax((nextSize.width() + 1) / 2, size.width()),
+				qMax((nextSize.height() + 1) / 2, size.height()));
+			outTex = renderMipmap(
+				outTex, relTexSize, nextSize, tex->hasAlpha(), relTexSize);
+		}
+
+		// High quality filters rescale the level to the exact output size.
+		// The level is copied out of the scratch targets first as the
+		// resample passes overwrite them and the next output continues the
+		// chain from it.
+		Texture *emitTex = outTex;
+		QPointF emitRelSize = relTexSize;
+		if(isHighQual && nextSize != size) {
+			if(outTex != tex && outTex != levelTex) {
+				Texture *copyTex =
+					createTexture(nextSize, outTex, false, false);
+				if(copyTex != NULL && !copyTextureData(copyTex, outTex,
+					QPoint(0, 0), QRect(QPoint(0, 0), nextSize)))
+				{
+					deleteTexture(copyTex);
+					copyTex = NULL;
+				}
+				if(copyTex != NULL) {
+					if(levelTex != NULL)
+						deleteTexture(levelTex);
+					levelTex = copyTex;
+					outTex = levelTex;
+					relTexSize = QPointF(1.0f, 1.0f);
+				}
+			}
+
+			// Fall back to the bilinear mipmap if the copy failed
+			QPointF resRelSize;
+			Texture *resTex = NULL;
+			if(outTex == tex || outTex == levelTex) {
+				resTex = renderResample(outTex, relTexSize, nextSize,
+					QRectF(QPointF(0.0f, 0.0f), QSizeF(nextSize)), size,
+					filter, tex->hasAlpha(), resRelSize);
+			}
+			if(resTex != NULL) {
+				emitTex = resTex;
+				emitRelSize = resRelSize;
+			}
+		}
+
+		// Emit the output now that its texture exists
+		setRenderTarget(origTarget);
+		setTextureFilter(
+			(filter == GfxPointFilter) ? GfxPointFilter : GfxBilinearFilter);
+		const QPointF pxSize(
+			emitRelSize.x() / (qreal)size.width(),
+			emitRelSize.y() / (qreal)size.height());
+		callback(opaque, context, order.at(i),
+			reinterpret_cast<VidgfxTex *>(emitTex), pxSize,
+			QPointF(0.0f, 0.0f), emitRelSize);
+	}
+	if(levelTex != NULL)
+		deleteTexture(levelTex);
+
+	// Restore original state
+	setRenderTarget(origTarget);
+}
+
+/// <summary>
+/// Renders `tex` at half size or `size`, whichever is larger, into the next
+/// scratch target. `relTexSize` is the area of `tex` that contains valid data.
+/// If `weightAlpha` is true then the texels are averaged with premultiplied
+/// alpha so that fully transparent texels don't contribute any colour.
+/// </summary>
+/// <returns>The scratch texture that contains the mipmap</returns>
+Texture *D3DContext::renderMipmap(
+	Texture *tex, const QPointF &relTexSize, const QSize &size,
+	bool weightAlpha, QPointF &relTexSizeOut)
+{
+	// Setup render target
+	resizeScratchTarget(size);
+	VidgfxRendTarget target = getNextScratchTarget();
+	setRenderTarget(target);
+	QMatrix4x4 mat;
+	setViewMatrix(mat);
+	mat.ortho(0.0f, size.width(), size.height(), 0.0f, -1.0f, 1.0f);
+	setProjectionMatrix(mat);
+
+	// Render the mipmap. The alpha-weighted shader fetches the individual
+	// texels itself.
+	setShader(weightAlpha ? GfxTexDecalMipShader : GfxTexDecalShader);
+	setTopology(GfxTriangleStripTopology);
+	setBlending(GfxNoBlending);
+	setTexture(tex);
+	setTextureFilter(weightAlpha ? GfxPointFilter : GfxBilinearFilter);
+	drawTexDecalRect(
+		QRectF(0.0f, 0.0f, (qreal)size.width(), (qreal)size.height()),
+		relTexSize);
+
+	// Update references
+	relTexSizeOut = getScratchTargetToTextureRatio();
+	return getTargetTexture(target);
+}
+
+/// <summary>
+/// Rescales the `srcRect` area of `tex` to `size` on the GPU using a separable
+/// bicubic or Lanczos filter with the same kernels as `ImageScaler`. The
+/// horizontal pass renders every source row that `srcRect` touches into the
+/// next scratch target and the vertical pass renders the final result into
+/// the other. `srcRect` is in texels of the valid area of `tex` which is
+/// `texSize` texels large and covers `relTexSize` of the actual texture. As
+/// with `renderMipmap()` the scratch targets must already be large enough if
+/// `tex` is itself a scratch texture.
+/// </summary>
+/// <returns>The scratch texture that contains the result or NULL</returns>
+Texture *D3DContext::renderResample(
+	Texture *tex, const QPointF &relTexSize, const QSize &texSize,
+	const QRectF &srcRect, const QSize &size, VidgfxFilter filter,
+	bool weightAlpha, QPointF &relTexSizeOut)
+{
+	const float radius = (filter == GfxLanczosFilter) ? 3.0f : 2.0f;
+	const int firstCol = qMax(0, (int)floor(srcRect.left()));
+	const int endCol = qMin(texSize.width(), (int)ceil(srcRect.right()));
+	const int firstRow = qMax(0, (int)floor(srcRect.top()));
+	const int endRow = qMin(texSize.height(), (int)ceil(srcRect.bottom()));
+	const int numRows = endRow - firstRow;
+	if(endCol <= firstCol || numRows <= 0)
+		return NULL;
+
+	// Both passes must fit in the scratch textures at once
+	resizeScratchTarget(
+		QSize(size.width(), qMax(numRows, size.height())));
+
+	//-------------------------------------------------------------------------
+	// Horizontal pass
+
+	float scale = qMax(1.0f, (float)srcRect.width() / (float)size.width());
+	if(!updateResampleConstants(QPointF(
+		relTexSize.x() / (qreal)texSize.width(),
+		relTexSize.y() / (qreal)texSize.height()),
+		firstCol, endCol, scale, radius * scale, false, filter, weightAlpha))
+	{
+		return NULL;
+	}
+	QSize passSize(size.width(), numRows);
+	resizeScratchTarget(passSize);
+	VidgfxRendTarget target = getNextScratchTarget();
+	setRenderTarget(target);
+	QMatrix4x4 mat;
+	setViewMatrix(mat);
+	mat.ortho(0.0f, passSize.width(), passSize.height(), 0.0f, -1.0f, 1.0f);
+	setProjectionMatrix(mat);
+
+	// The vertex UVs are in source texels, see the shader
+	setShader(GfxTexResampleShader);
+	setTopology(GfxTriangleStripTopology);
+	setBlending(GfxNoBlending);
+	setTexture(tex);
+	setTextureFilter(GfxPointFilter);
+	drawTexDecalRect(
+		QRectF(0.0f, 0.0f, (qreal)passSize.width(), (qreal)numRows),
+		QPointF(srcRect.left(), (qreal)firstRow),
+		QPointF(srcRect.right(), (qreal)endRow));
+	Texture *passTex = getTargetTexture(target);
+	const QPointF passRelSize = getScratchTargetToTextureRatio();
+
+	//-------------------------------------------------------------------------
+	// Vertical pass
+
+	scale = qMax(1.0f, (float)srcRect.height() / (float)size.height());
+	if(!updateResampleConstants(QPointF(
+		passRelSize.x() / (qreal)passSize.width(),
+		passRelSize.y() / (qreal)passSize.height()),
+		0, numRows, scale, radius * scale, true, filter, weightAlpha))
+	{
+		return NULL;
+	}
+	resizeScratchTarget(size);
+	target = getNextScratchTarget();
+	setRenderTarget(target);
+	mat.setToIdentity();
+	mat.ortho(0.0f, size.width(), size.height(), 0.0f, -1.0f, 1.0f);
+	setProjectionMatrix(mat);
+
+	setTexture(passTex);
+	drawTexDecalRect(
+		QRectF(0.0f, 0.0f, (qreal)size.width(), (qreal)size.height()),
+		QPointF(0.0f, srcRect.top() - (qreal)firstRow),
+		QPointF((qreal)size.width(), srcRect.bottom() - (qreal)firstRow));
+
+	// Update references
+	relTexSizeOut = getScratchTargetToTextureRatio();
+	return getTargetTexture(target);
+}
+
+/// <summary>
+/// Uploads the parameters of a single `renderResample()` pass. `first` and
+/// `end` are the range of source texels along the filtered axis that the
+/// kernel is allowed to sample.
+/// </summary>
+/// <returns>True if the constants were uploaded</returns>
+bool D3DContext::updateResampleConstants(
+	const QPointF &texelToUv, int first, int end, float scale, float support,
+	bool vertical, VidgfxFilter filter, bool weightAlpha)
+{
+	m_resampleConstantsLocal[0] = texelToUv.x();
+	m_resampleConstantsLocal[1] = texelToUv.y();
+	m_resampleConstantsLocal[2] = 0.0f;
+	m_resampleConstantsLocal[3] = 0.0f;
+	m_resampleConstantsLocal[4] = (float)first;
+	m_resampleConstantsLocal[5] = (float)end;
+	m_resampleConstantsLocal[6] = scale;
+	m_resampleConstantsLocal[7] = support;
+	uint *uintConstants = (uint *)m_resampleConstantsLocal;
+	uintConstants[8] = vertical ? 1 : 0;
+	uintConstants[9] = (filter == GfxLanczosFilter) ? 1 : 0;
+	uintConstants[10] = weightAlpha ? 1 : 0;
+	uintConstants[11] = 0;
+	if(m_resampleConstants == NULL)
+		return false;
+	return updateDXBuffer(m_device, m_resampleConstants,
+		m_resampleConstantsLocal, sizeof(m_resampleConstantsLocal));
+}
+
+/// <summary>
+/// Draws a texture decal rectangle with the currently bound state using the
+/// transient vertex ring. Used by the internal rendering passes so that they
+/// don't have to share and rewrite a single vertex buffer.
+/// </summary>
+void D3DContext::drawTexDecalRect(const QRectF &rect, const QPointF &brUv)
+{
+	drawTexDecalRect(rect, QPointF(0.0f, 0.0f), brUv);
+}
+
+void D3DContext::drawTexDecalRect(
+	const QRectF &rect, const QPointF &tlUv, const QPointF &brUv)
+{
+	const QPointF trUv(brUv.x(), tlUv.y());
+	const QPointF blUv(tlUv.x(), brUv.y());
+
+	VidgfxTransientVerts verts;
+	float *data = allocTransientVerts(
+		TexDecalRectNumVerts, TexDecalVertLayout::NumFloats,
+		GfxFullVertFormat, &verts);
+	if(data != NULL) {
+		writeTexDecalRect(data, rect, tlUv, trUv, blUv, brUv);
+		drawTransientVerts(verts);
+		return;
+	}
+
+	// The ring is unavailable, fall back to the shared buffer
+	createTexDecalRect(m_mipmapBuf, rect, tlUv, trUv, blUv, brUv);
+	drawBuffer(m_mipmapBuf);
+}
+
+/// <summary>
+/// Reads back the cropped area of the texture and rescales it to the specified
+/// size on the CPU using `ImageScaler`. As reading back texture data stalls
+/// the GPU this should only be used on textures that are rarely modified.
+/// </summary>
+/// <returns>NULL if the texture could not be rescaled</returns>
+Texture *D3DContext::createScaledTexture(
+	Texture *tex, const QRect &cropRect, const QSize &size,
+	VidgfxFilter filter)
+{
+	// We can only rescale 32-bit pixel formats. As all channels are processed
+	// identically the actual channel order doesn't matter.
+	D3DTexture *srcTex = static_cast<D3DTexture *>(tex);
+	DXGI_FORMAT format = srcTex->getPixelFormat();
+	switch(format) {
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8X8_UNORM:
+		break;
+	default:
+		return NULL;
+	}
+	if(cropRect.size() == size)
+		return NULL; // Nothing to rescale
+
+	// Copy the cropped area into system memory
+	D3DTexture *stagingTex =
+		new D3DTexture(this, GfxStagingFlag, cropRect.size(), format);
+	if(!stagingTex->isValid()) {
+		delete stagingTex;
+		return NULL;
+	}
+	if(!copyTextureData(stagingTex, tex, QPoint(0, 0), cropRect)) {
+		delete stagingTex;
+		return NULL;
+	}
+	uchar *data = reinterpret_cast<uchar *>(stagingTex->map());
+	if(data == NULL) {
+		delete stagingTex;
+		return NULL;
+	}
+
+	// Do the actual rescale. `ImageScaler` premultiplies images that have an
+	// alpha channel while filtering so if the texture's alpha is meaningless
+	// we must make sure that it's ignored.
+	QImage img(data, cropRect.width(), cropRect.height(),
+		stagingTex->getStride(), tex->hasAlpha()
+		? QImage::Format_ARGB32 : QImage::Format_RGB32);
+	QImage scaledImg = ImageScaler::scale(img, size, filter);
+	stagingTex->unmap();
+	delete stagingTex;
+	if(scaledImg.isNull())
+		return NULL;
+
+	// Upload the result. If the source was swizzled then request the BGRA
+	// format again so that the new texture will be swizzled as well.
+	if(srcTex->doBgraSwizzle())
+		format = DXGI_FORMAT_B8G8R8A8_UNORM;
+	D3DTexture *outTex = new D3DTexture(
+		this, tex->hasAlpha() ? GfxAlphaFlag : 0, size, format,
+		scaledImg.bits(), scaledImg.bytesPerLine());
+	if(outTex->isValid())
+		return outTex;
+	delete outTex;
+	return NULL;
+}
+
 /// <summary>
 /// Converts the specified input texture data to a BGRX texture. WARNING: The
 /// resulting texture is on the scratch texture, if you want to keep the data
@@ -2500,11 +3527,6 @@ Texture *D3DContext::convertToBgrx(
 		// Remember original state
 		VidgfxRendTarget origTarget = m_currentTarget;
 
-		// Update the vertex buffer. NOTE: We reuse the mipmapping buffer
-		createTexDecalRect(
-			m_mipmapBuf, QRectF(0.0f, 0.0f,
-			(qreal)outSize.width(), (qreal)outSize.height()));
-
 		// Setup render target
 		resizeScratchTarget(outSize);
 		VidgfxRendTarget target = getNextScratchTarget();
@@ -2541,7 +3563,8 @@ Texture *D3DContext::convertToBgrx(
 		setBlending(GfxNoBlending);
 		setTexture(planeA, planeB, planeC);
 		setTextureFilter(GfxPointFilter);
-		drawBuffer(m_mipmapBuf);
+		drawTexDecalRect(QRectF(0.0f, 0.0f,
+			(qreal)outSize.width(), (qreal)outSize.height()));
 
 		// Restore original state
 		setRenderTarget(origTarget);
@@ -2566,11 +3589,6 @@ Texture *D3DContext::convertToBgrx(
 		// Remember original state
 		VidgfxRendTarget origTarget = m_currentTarget;
 
-		// Update the vertex buffer. NOTE: We reuse the mipmapping buffer
-		createTexDecalRect(
-			m_mipmapBuf, QRectF(0.0f, 0.0f,
-			(qreal)outSize.width(), (qreal)outSize.height()));
-
 		// Setup render target
 		resizeScratchTarget(outSize);
 		VidgfxRendTarget target = getNextScratchTarget();
@@ -2615,7 +3633,8 @@ Texture *D3DContext::convertToBgrx(
 		setBlending(GfxNoBlending);
 		setTexture(planeA);
 		setTextureFilter(GfxPointFilter);
-		drawBuffer(m_mipmapBuf);
+		drawTexDecalRect(QRectF(0.0f, 0.0f,
+			(qreal)outSize.width(), (qreal)outSize.height()));
 
 		// Restore original state
 		setRenderTarget(origTarget);
@@ -2739,11 +3758,31 @@ void D3DContext::setShader(VidgfxShader shader)
 		m_device->VSSetShader(m_texDecalVS);
 		m_device->PSSetShader(m_texDecalRgbPS);
 		break;
+	case GfxTexDecalMipShader:
+		m_device->IASetInputLayout(m_texDecalIL);
+		m_device->VSSetShader(m_texDecalVS);
+		m_device->PSSetShader(m_texDecalMipPS);
+		break;
+	case GfxTexResampleShader:
+		m_device->IASetInputLayout(m_texDecalIL);
+		m_device->VSSetShader(m_texDecalVS);
+		m_device->PSSetShader(m_texResamplePS);
+		break;
 	case GfxResizeLayerShader:
 		m_device->IASetInputLayout(m_resizeIL);
 		m_device->VSSetShader(m_resizeVS);
 		m_device->PSSetShader(m_resizePS);
 		break;
+	case GfxResizeGizmoShader:
+		m_device->IASetInputLayout(m_resizeGizmoIL);
+		m_device->VSSetShader(m_resizeGizmoVS);
+		m_device->PSSetShader(m_resizePS);
+		break;
+	case GfxInstancedLayerShader:
+		m_device->IASetInputLayout(m_instLayerIL);
+		m_device->VSSetShader(m_instLayerVS);
+		m_device->PSSetShader(m_instLayerPS);
+		break;
 	case GfxRgbNv16Shader:
 		m_device->IASetInputLayout(m_texDecalIL);
 		m_device->VSSetShader(m_texDecalVS);
@@ -2771,6 +3810,7 @@ void D3DContext::setShader(VidgfxShader shader)
 		break;
 	}
 	m_boundShader = shader;
+	m_boundVertFormat = GfxFullVertFormat;
 }
 
 void D3DContext::setTopology(VidgfxTopology topology)
@@ -2781,6 +3821,7 @@ void D3DContext::setTopology(VidgfxTopology topology)
 	switch(topology) {
 	default:
 	case GfxTriangleListTopology:
+	case GfxQuadListTopology: // Indexed triangle list
 		m_device->IASetPrimitiveTopology(
 			D3D10_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 		break;
@@ -2789,6 +3830,7 @@ void D3DContext::setTopology(VidgfxTopology topology)
 			D3D10_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
 		break;
 	}
+	m_boundTopology = topology;
 }
 
 void D3DContext::setBlending(VidgfxBlending blending)
@@ -2839,28 +3881,37 @@ void D3DContext::setTexture(Texture *texA, Texture *texB, Texture *texC)
 	m_device->PSSetShaderResources(0, num, view);
 
 	// Do we need to swizzle the RGB components as we're storing BGRA data in
-	// a RGBA texture?
-	setSwizzleInTexDecal(textureA->doBgraSwizzle());
+	// a RGBA texture? Each slot is flagged separately as instanced layers can
+	// mix textures that are stored differently.
+	setSwizzleInTexDecal(0, textureA->doBgraSwizzle());
+	setSwizzleInTexDecal(1, texB ? textureB->doBgraSwizzle() : false);
+	setSwizzleInTexDecal(2, texC ? textureC->doBgraSwizzle() : false);
 }
 
-void D3DContext::setTextureFilter(VidgfxFilter filter)
+/// <summary>
+/// Binds the sampler for the specified filter and address mode. The address
+/// mode is ignored by `GfxResizeLayerFilter` which always uses a border
+/// colour.
+/// </summary>
+void D3DContext::setTextureFilter(
+	VidgfxFilter filter, VidgfxAddressMode mode)
 {
 	if(!isValid())
 		return; // DirectX must be initialized
+	if(mode < 0 || mode >= NUM_ADDRESS_MODES)
+		mode = GfxClampAddressing;
 
 	switch(filter) {
 	case GfxPointFilter:
-		m_device->PSSetSamplers(0, 1, &m_pointClampSampler);
+		m_device->PSSetSamplers(0, 1, &m_pointSamplers[mode]);
 		break;
 	default:
-#if 0
 	case GfxBicubicFilter:
-		gfxLog(LOG_CAT, GfxLog::Warning)
-			<< "Unsupported texture filter, using bilinear.";
-		// Fall through
-#endif // 0
+	case GfxLanczosFilter:
+		// High quality filters are applied by `prepareTexture()`, the result
+		// is always sampled bilinearly
 	case GfxBilinearFilter:
-		m_device->PSSetSamplers(0, 1, &m_bilinearClampSampler);
+		m_device->PSSetSamplers(0, 1, &m_bilinearSamplers[mode]);
 		break;
 	case GfxResizeLayerFilter:
 		m_device->PSSetSamplers(0, 1, &m_resizeSampler);
@@ -2915,8 +3966,16 @@ void D3DContext::clear(const QColor &color)
 		m_device->ClearRenderTargetView(targetView[0], colorF);
 	if(targetView[1] != NULL)
 		m_device->ClearRenderTargetView(targetView[1], colorF);
+	markTargetModified();
 }
 
+/// <summary>
+/// Draws `numVertices` vertices from the buffer. If the current topology is
+/// `GfxQuadListTopology` then every 4 vertices form a quad and the draw is
+/// done with the shared quad index buffer, split into multiple draws if it
+/// contains more than `MaxQuadsPerDraw` quads. `startVertex` must be a
+/// multiple of 4 in that case.
+/// </summary>
 void D3DContext::drawBuffer(
 	VertexBuffer *buf, int numVertices, int startVertex)
 {
@@ -2930,38 +3989,315 @@ void D3DContext::drawBuffer(
 	if(numVertices == 0)
 		return; // Nothing to render
 
+	if(m_boundTopology == GfxQuadListTopology) {
+		for(int quad = 0; quad < numVertices / 4; quad += MaxQuadsPerDraw) {
+			int numQuads = qMin(numVertices / 4 - quad, MaxQuadsPerDraw);
+			drawBuffer(
+				buf, m_quadIdxBuf, numQuads * 6, 0, startVertex + quad * 4);
+		}
+		return;
+	}
+
 	// Bind the vertex buffer
 	D3DVertexBuffer *buffer = static_cast<D3DVertexBuffer *>(buf);
 	buffer->bind();
+	bindVertexFormat(buf->getVertFormat());
+	bindShaderConstants();
 
-	// Update and bind our camera constants
-	updateCameraConstants();
-	m_device->VSSetConstantBuffers(0, 1, &m_cameraConstants);
+	// Actually send the draw command
+	m_device->Draw(numVertices, startVertex);
+	markTargetModified();
+}
 
-	// Update and bind our pixel shader constants if needed
-	if(m_boundShader == GfxResizeLayerShader) {
-		updateResizeConstants();
-		m_device->PSSetConstantBuffers(0, 1, &m_resizeConstants);
-	} else if(m_boundShader == GfxRgbNv16Shader) {
-		updateRgbNv16Constants();
-		m_device->PSSetConstantBuffers(0, 1, &m_rgbNv16Constants);
-	} else if(m_boundShader == GfxYv12RgbShader ||
-		m_boundShader == GfxUyvyRgbShader ||
-		m_boundShader == GfxHdycRgbShader ||
-		m_boundShader == GfxYuy2RgbShader)
-	{
-		// HACK: Reuse RgbNv16 shader cbuffer
-		m_device->PSSetConstantBuffers(0, 1, &m_rgbNv16Constants);
-	} else if(m_boundShader == GfxTexDecalShader ||
-		m_boundShader == GfxTexDecalGbcsShader ||
-		m_boundShader == GfxTexDecalRgbShader)
-	{
-		updateTexDecalConstants();
-		m_device->PSSetConstantBuffers(0, 1, &m_texDecalConstants);
+/// <summary>
+/// Draws `numIndices` indices from `idxBuf` starting at `startIndex`.
+/// `baseVertex` is added to every index before the vertex is fetched.
+/// </summary>
+void D3DContext::drawBuffer(
+	VertexBuffer *buf, IndexBuffer *idxBuf, int numIndices, int startIndex,
+	int baseVertex)
+{
+	if(!isValid())
+		return; // DirectX must be initialized
+	if(buf == NULL || idxBuf == NULL)
+		return; // Invalid input
+
+	if(numIndices < 0)
+		numIndices = idxBuf->getNumIndices();
+	if(numIndices == 0)
+		return; // Nothing to render
+
+	// Bind the vertex and index buffers
+	D3DVertexBuffer *buffer = static_cast<D3DVertexBuffer *>(buf);
+	buffer->bind();
+	bindVertexFormat(buf->getVertFormat());
+	D3DIndexBuffer *indices = static_cast<D3DIndexBuffer *>(idxBuf);
+	indices->bind();
+	bindShaderConstants();
+
+	// Actually send the draw command
+	m_device->DrawIndexed(numIndices, startIndex, baseVertex);
+	markTargetModified();
+}
+
+/// <summary>
+/// Draws `numInstances` layer instances from `instBuf` starting at
+/// `startInstance` with a single draw call. Each instance is a unit quad that
+/// is placed at the instance's rectangle. See `createLayerInstances()` for the
+/// format of the buffer. Layers can sample any of the bound textures and are
+/// rendered with the current blending, texture filter and texture decal
+/// modulation colour. Changes the context's shader and topology.
+/// </summary>
+void D3DContext::drawInstanced(
+	VertexBuffer *instBuf, int numInstances, int startInstance)
+{
+	if(!isValid() || m_unitQuadBuf == NULL)
+		return; // DirectX must be initialized
+	if(instBuf == NULL || instBuf->getVertSize() != LayerInstNumFloats)
+		return; // Invalid input
+
+	if(numInstances < 0)
+		numInstances = instBuf->getNumVerts() - startInstance;
+	if(numInstances <= 0)
+		return; // Nothing to render
+
+	setShader(GfxInstancedLayerShader);
+	setTopology(GfxTriangleStripTopology);
+
+	// Bind the unit quad and instance buffers
+	static_cast<D3DVertexBuffer *>(m_unitQuadBuf)->bind(0);
+	static_cast<D3DVertexBuffer *>(instBuf)->bind(1);
+	bindShaderConstants();
+
+	// Actually send the draw command
+	m_device->DrawInstanced(4, numInstances, 0, startInstance);
+	markTargetModified();
+}
+
+/// <summary>
+/// Sub-allocates `numVerts` vertices of `vertSize` floats each from the
+/// transient vertex ring and returns a pointer that the vertex data must be
+/// written to. The pointer is only valid until the next call to any of the
+/// transient geometry methods while the block itself can be drawn with
+/// `drawTransientVerts()` any number of times until the end of the frame.
+/// Space is reclaimed automatically once the GPU has finished rendering the
+/// frame that the block was allocated in.
+/// </summary>
+/// <returns>NULL if the block could not be allocated</returns>
+float *D3DContext::allocTransientVerts(
+	int numVerts, int vertSize, VidgfxVertFormat format,
+	VidgfxTransientVerts *vertsOut)
+{
+	if(!isValid() || m_transientBuf == NULL)
+		return NULL; // DirectX must be initialized
+	if(numVerts <= 0 || vertSize <= 0 || vertsOut == NULL)
+		return NULL; // Invalid input
+	unmapTransientBuf();
+
+	const int bufBytes = TransientBufNumFloats * sizeof(float);
+	const int stride = vertSize * sizeof(float);
+	const int numBytes = numVerts * stride;
+	if(numBytes > bufBytes) {
+		gfxLog(LOG_CAT, GfxLog::Warning)
+			<< "Transient vertex allocation of " << numBytes
+			<< " bytes is larger than the ring buffer";
+		return NULL;
+	}
+
+	// Vertices are addressed by index so blocks must start on a multiple of
+	// the vertex stride. If the block doesn't fit before the end of the
+	// buffer then the remainder is skipped and the block starts at zero.
+	int offset = ((m_transientHead + stride - 1) / stride) * stride;
+	int consumed = offset - m_transientHead + numBytes;
+	if(offset + numBytes > bufBytes) {
+		offset = 0;
+		consumed = bufBytes - m_transientHead + numBytes;
+	}
+
+	// Reclaim the space of frames that the GPU has finished with. If the ring
+	// is still full then wait for all previous frames and as a last resort
+	// discard the entire buffer which invalidates all existing blocks.
+	D3D10_MAP mapType = D3D10_MAP_WRITE_NO_OVERWRITE;
+	retireTransientFrames(false);
+	if(m_transientUsed + consumed > bufBytes)
+		retireTransientFrames(true);
+	if(m_transientUsed + consumed > bufBytes) {
+		gfxLog(LOG_CAT, GfxLog::Warning)
+			<< "Transient vertex ring overflowed within a single frame";
+		mapType = D3D10_MAP_WRITE_DISCARD;
+		offset = 0;
+		consumed = numBytes;
+		m_transientUsed = 0;
+		m_transientFrameBytes = 0;
+		m_transientGeneration++;
+	}
+
+	// Map the buffer without synchronising with the GPU as the block is
+	// guaranteed to not be in use
+	uchar *data;
+	HRESULT res = m_transientBuf->Map(
+		mapType, 0, reinterpret_cast<void **>(&data));
+	if(FAILED(res)) {
+		gfxLog(LOG_CAT, GfxLog::Warning)
+			<< "Failed to map transient vertex buffer into RAM. "
+			<< "Reason = " << getDXErrorCode(res);
+		return NULL;
 	}
+	m_transientMapped = true;
+	m_transientHead = offset + numBytes;
+	m_transientUsed += consumed;
+	m_transientFrameBytes += consumed;
+
+	vertsOut->start_vert = offset / stride;
+	vertsOut->num_verts = numVerts;
+	vertsOut->vert_size = vertSize;
+	vertsOut->format = format;
+	vertsOut->generation = m_transientGeneration;
+	return reinterpret_cast<float *>(data + offset);
+}
+
+/// <summary>
+/// Draws a block of vertices that was allocated with `allocTransientVerts()`
+/// using the currently bound state.
+/// </summary>
+void D3DContext::drawTransientVerts(const VidgfxTransientVerts &verts)
+{
+	if(!isValid() || m_transientBuf == NULL)
+		return; // DirectX must be initialized
+	if(verts.num_verts <= 0)
+		return; // Nothing to render
+	if(verts.generation != m_transientGeneration) {
+		gfxLog(LOG_CAT, GfxLog::Warning)
+			<< "Attempted to draw a transient vertex block that has expired";
+		return;
+	}
+	unmapTransientBuf();
+
+	// Bind the ring buffer with the block's stride
+	uint stride = verts.vert_size * sizeof(float);
+	uint offset = 0;
+	m_device->IASetVertexBuffers(0, 1, &m_transientBuf, &stride, &offset);
+	bindVertexFormat(verts.format);
+	bindShaderConstants();
 
 	// Actually send the draw command
-	m_device->Draw(numVertices, startVertex);
+	if(m_boundTopology == GfxQuadListTopology) {
+		static_cast<D3DIndexBuffer *>(m_quadIdxBuf)->bind();
+		const int totalQuads = verts.num_verts / 4;
+		for(int quad = 0; quad < totalQuads; quad += MaxQuadsPerDraw) {
+			int numQuads = totalQuads - quad;
+			if(numQuads > MaxQuadsPerDraw)
+				numQuads = MaxQuadsPerDraw;
+			m_device->DrawIndexed(
+				numQuads * 6, 0, verts.start_vert + quad * 4);
+		}
+	} else
+		m_device->Draw(verts.num_verts, verts.start_vert);
+	markTargetModified();
+}
+
+/// <summary>
+/// Marks the end of a frame for the purposes of reclaiming transient vertex
+/// space. Called automatically by `swapScreenBuffers()` but must be called
+/// manually once per frame if the screen target is never presented.
+/// </summary>
+void D3DContext::endFrame()
+{
+	if(!isValid() || m_transientBuf == NULL)
+		return; // DirectX must be initialized
+	unmapTransientBuf();
+	retireTransientFrames(false);
+	if(m_transientFrameBytes == 0)
+		return; // Nothing was allocated this frame
+
+	// Insert a fence into the command stream after the frame's commands
+	ID3D10Query *fence = NULL;
+	if(!m_transientFreeFences.isEmpty())
+		fence = m_transientFreeFences.takeLast();
+	else {
+		D3D10_QUERY_DESC desc;
+		desc.Query = D3D10_QUERY_EVENT;
+		desc.MiscFlags = 0;
+		HRESULT res = m_device->CreateQuery(&desc, &fence);
+		if(FAILED(res)) {
+			// The frame's space will be reclaimed with the next frame instead
+			gfxLog(LOG_CAT, GfxLog::Warning)
+				<< "Failed to create transient vertex fence. "
+				<< "Reason = " << getDXErrorCode(res);
+			return;
+		}
+	}
+	fence->End();
+
+	TransientFrame frame;
+	frame.fence = fence;
+	frame.numBytes = m_transientFrameBytes;
+	m_transientFrames.append(frame);
+	m_transientFrameBytes = 0;
+}
+
+bool D3DContext::createTransientBuf()
+{
+	D3D10_BUFFER_DESC desc;
+	desc.ByteWidth = TransientBufNumFloats * sizeof(float);
+	desc.Usage = D3D10_USAGE_DYNAMIC;
+	desc.BindFlags = D3D10_BIND_VERTEX_BUFFER;
+	desc.CPUAccessFlags = D3D10_CPU_ACCESS_WRITE;
+	desc.MiscFlags = 0;
+	if(!createDXBuffer(m_device, &desc, NULL, &m_transientBuf)) {
+		m_transientBuf = NULL;
+		return false;
+	}
+	return true;
+}
+
+void D3DContext::destroyTransientBuf()
+{
+	unmapTransientBuf();
+	for(int i = 0; i < m_transientFrames.size(); i++)
+		m_transientFrames.at(i).fence->Release();
+	m_transientFrames.clear();
+	for(int i = 0; i < m_transientFreeFences.size(); i++)
+		m_transientFreeFences.at(i)->Release();
+	m_transientFreeFences.clear();
+	if(m_transientBuf)
+		m_transientBuf->Release();
+	m_transientBuf = NULL;
+}
+
+void D3DContext::unmapTransientBuf()
+{
+	if(!m_transientMapped)
+		return;
+	m_transientBuf->Unmap();
+	m_transientMapped = false;
+}
+
+/// <summary>
+/// Reclaims the ring space of all frames whose fence has been signalled. If
+/// `wait` is true then this blocks until all frames have been reclaimed.
+/// </summary>
+void D3DContext::retireTransientFrames(bool wait)
+{
+	while(!m_transientFrames.isEmpty()) {
+		const TransientFrame &frame = m_transientFrames.first();
+		HRESULT res;
+		if(wait) {
+			do {
+				res = frame.fence->GetData(NULL, 0, 0);
+			} while(res == S_FALSE);
+		} else {
+			res = frame.fence->GetData(
+				NULL, 0, D3D10_ASYNC_GETDATA_DONOTFLUSH);
+			if(res == S_FALSE)
+				break; // GPU is still using the frame
+		}
+
+		// A failed query (E.g. device removed) is treated as complete
+		m_transientUsed -= frame.numBytes;
+		m_transientFreeFences.append(frame.fence);
+		m_transientFrames.removeFirst();
+	}
 }
 
 void D3DContext::callDxgi11ChangedCallbacks(bool hasDxgi11)
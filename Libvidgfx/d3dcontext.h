@@ -19,7 +19,9 @@
 #define D3DCONTEXT_H
 
 #include "graphicscontext.h"
+#include <QtCore/QList>
 #include <QtCore/QSize>
+#include <QtGui/QImage>
 #include <windows.h>
 
 struct ID3D10BlendState;
@@ -27,6 +29,7 @@ struct ID3D10Buffer;
 struct ID3D10Device;
 struct ID3D10InputLayout;
 struct ID3D10PixelShader;
+struct ID3D10Query;
 struct ID3D10RasterizerState;
 struct ID3D10RenderTargetView;
 struct ID3D10SamplerState;
@@ -50,13 +53,18 @@ private: // Members -----------------------------------------------------------
 	ID3D10Buffer *	m_buffer;
 
 public: // Constructor/destructor ---------------------------------------------
-	D3DVertexBuffer(D3DContext *context, int numFloats);
+	D3DVertexBuffer(
+		D3DContext *context, int numFloats, VidgfxBufStorage storage);
 	virtual ~D3DVertexBuffer();
 
 public: // Methods ------------------------------------------------------------
 	void			update();
-	void			bind();
+	void			bind(uint slot = 0);
 	ID3D10Buffer *	getBuffer() const;
+
+public: // Interface ----------------------------------------------------------
+	virtual float *	map();
+	virtual void	unmap();
 };
 //=============================================================================
 
@@ -65,6 +73,29 @@ inline ID3D10Buffer *D3DVertexBuffer::getBuffer() const
 	return m_buffer;
 }
 
+//=============================================================================
+class D3DIndexBuffer : public IndexBuffer
+{
+private: // Members -----------------------------------------------------------
+	D3DContext *	m_context;
+	ID3D10Buffer *	m_buffer;
+
+public: // Constructor/destructor ---------------------------------------------
+	D3DIndexBuffer(D3DContext *context, int maxIndices);
+	virtual ~D3DIndexBuffer();
+
+public: // Methods ------------------------------------------------------------
+	void			update();
+	void			bind();
+	ID3D10Buffer *	getBuffer() const;
+};
+//=============================================================================
+
+inline ID3D10Buffer *D3DIndexBuffer::getBuffer() const
+{
+	return m_buffer;
+}
+
 //=============================================================================
 class D3DTexture : public Texture
 {
@@ -82,7 +113,8 @@ protected: // Members ---------------------------------------------------------
 public: // Constructor/destructor ---------------------------------------------
 	D3DTexture(
 		D3DContext *context, VidgfxTexFlags flags, const QSize &size,
-		DXGI_FORMAT format, void *initialData = NULL, int stride = 0);
+		DXGI_FORMAT format, void *initialData = NULL, int stride = 0,
+		const QVector<QImage> &mipTail = QVector<QImage>());
 	D3DTexture(D3DContext *context, ID3D10Texture2D *tex);
 	virtual ~D3DTexture();
 
@@ -154,6 +186,11 @@ private: // Datatypes ---------------------------------------------------------
 	typedef QVector<BgraTexSupportChangedCallback>
 		BgraTexSupportChangedCallbackList;
 
+	struct TransientFrame {
+		ID3D10Query *	fence; // Signalled once the GPU finishes the frame
+		int				numBytes; // Ring space used including padding
+	};
+
 private: // Members -----------------------------------------------------------
 	bool						m_hasDxgi11;
 	bool						m_hasDxgi11Valid;
@@ -162,8 +199,8 @@ private: // Members -----------------------------------------------------------
 	IDXGISwapChain *			m_swapChain;
 	ID3D10Device *				m_device;
 	ID3D10RasterizerState *		m_rasterizerState;
-	ID3D10SamplerState *		m_pointClampSampler;
-	ID3D10SamplerState *		m_bilinearClampSampler;
+	ID3D10SamplerState *		m_pointSamplers[NUM_ADDRESS_MODES];
+	ID3D10SamplerState *		m_bilinearSamplers[NUM_ADDRESS_MODES];
 	ID3D10SamplerState *		m_resizeSampler;
 	ID3D10BlendState *			m_noBlend;
 	ID3D10BlendState *			m_alphaBlend;
@@ -183,14 +220,21 @@ private: // Members -----------------------------------------------------------
 	// Constant buffers
 	float						m_cameraConstantsLocal[(4*4)*2]; // 2 4x4 matrices
 	ID3D10Buffer *				m_cameraConstants;
-	float						m_resizeConstantsLocal[4]; // 1 XYWH rectangle
+	float						m_resizeConstantsLocal[8]; // 2 XYWH rectangles
 	ID3D10Buffer *				m_resizeConstants;
 	float						m_rgbNv16ConstantsLocal[4]; // 4 horizontal offsets
 	ID3D10Buffer *				m_rgbNv16Constants;
-	// 1 RGBA colour + 1 integer for flags + 3 unused + 4 effect floats
+	// 1 RGBA colour + 3 integers for flags + 1 unused + 4 effect floats
 	float						m_texDecalConstantsLocal[12];
 	ID3D10Buffer *				m_texDecalConstants;
-	quint32						m_texDecalFlags;
+	quint32						m_texDecalFlags[3]; // One per texture slot
+	// 2 floats for texel size + 2 unused + 4 range floats + 4 integer options
+	float						m_resampleConstantsLocal[12];
+	ID3D10Buffer *				m_resampleConstants;
+
+	// Input assembler
+	VidgfxTopology				m_boundTopology;
+	VidgfxVertFormat			m_boundVertFormat;
 
 	// Shaders
 	VidgfxShader				m_boundShader;
@@ -201,10 +245,23 @@ private: // Members -----------------------------------------------------------
 	ID3D10PixelShader *			m_texDecalPS;
 	ID3D10PixelShader *			m_texDecalGbcsPS;
 	ID3D10PixelShader *			m_texDecalRgbPS;
+	ID3D10PixelShader *			m_texDecalMipPS;
+	ID3D10PixelShader *			m_texResamplePS;
 	ID3D10InputLayout *			m_texDecalIL;
 	ID3D10VertexShader *		m_resizeVS;
 	ID3D10PixelShader *			m_resizePS;
 	ID3D10InputLayout *			m_resizeIL;
+	ID3D10VertexShader *		m_resizeGizmoVS;
+	ID3D10InputLayout *			m_resizeGizmoIL;
+	ID3D10VertexShader *		m_instLayerVS;
+	ID3D10PixelShader *			m_instLayerPS;
+	ID3D10InputLayout *			m_instLayerIL;
+	// Compact vertex format variants of the solid and `texDecalVS` shaders
+	ID3D10VertexShader *		m_solidCompactVS;
+	ID3D10InputLayout *			m_solidCompactIL;
+	ID3D10VertexShader *		m_texDecalCompactVS;
+	ID3D10InputLayout *			m_texDecalCompactIL;
+	ID3D10InputLayout *			m_texDecalUnormIL;
 	// All these share `texDecalVS` and IL
 	ID3D10PixelShader *			m_rgbNv16PS;
 	ID3D10PixelShader *			m_yv12RgbPS;
@@ -214,6 +271,17 @@ private: // Members -----------------------------------------------------------
 
 	// Advanced rendering
 	VertexBuffer *				m_mipmapBuf;
+	VertexBuffer *				m_unitQuadBuf; // For `drawInstanced()`
+
+	// Transient vertex ring
+	ID3D10Buffer *				m_transientBuf;
+	bool						m_transientMapped;
+	int							m_transientHead; // In bytes
+	int							m_transientUsed; // In bytes
+	int							m_transientFrameBytes;
+	quint32						m_transientGeneration;
+	QList<TransientFrame>		m_transientFrames;
+	QList<ID3D10Query *>		m_transientFreeFences;
 
 	// Callbacks
 	Dxgi11ChangedCallbackList			m_dxgi11ChangedCallbackList;
@@ -255,15 +323,43 @@ private:
 	void			updateRgbNv16Constants();
 	void			updateTexDecalConstants();
 
-	void			setSwizzleInTexDecal(bool doSwizzle);
+	void			setSwizzleInTexDecal(int slot, bool doSwizzle);
+	void			bindShaderConstants();
+	void			bindVertexFormat(VidgfxVertFormat format);
+
+	Texture *		createScaledTexture(
+		Texture *tex, const QRect &cropRect, const QSize &size,
+		VidgfxFilter filter);
+	Texture *		renderMipmap(
+		Texture *tex, const QPointF &relTexSize, const QSize &size,
+		bool weightAlpha, QPointF &relTexSizeOut);
+	Texture *		renderResample(
+		Texture *tex, const QPointF &relTexSize, const QSize &texSize,
+		const QRectF &srcRect, const QSize &size, VidgfxFilter filter,
+		bool weightAlpha, QPointF &relTexSizeOut);
+	bool			updateResampleConstants(
+		const QPointF &texelToUv, int first, int end, float scale,
+		float support, bool vertical, VidgfxFilter filter, bool weightAlpha);
+	void			drawTexDecalRect(
+		const QRectF &rect, const QPointF &brUv = QPointF(1.0f, 1.0f));
+	void			drawTexDecalRect(
+		const QRectF &rect, const QPointF &tlUv, const QPointF &brUv);
+
+	bool			createTransientBuf();
+	void			destroyTransientBuf();
+	void			unmapTransientBuf();
+	void			retireTransientFrames(bool wait);
 
 public: // Interface ----------------------------------------------------------
 	virtual bool	isValid() const;
 	virtual void	flush();
 
 	// Buffers
-	virtual VertexBuffer *	createVertexBuffer(int size);
+	virtual VertexBuffer *	createVertexBuffer(
+		int size, VidgfxBufStorage storage = GfxShadowedStorage);
 	virtual void			deleteVertexBuffer(VertexBuffer *buf);
+	virtual IndexBuffer *	createIndexBuffer(int numIndices);
+	virtual void			deleteIndexBuffer(IndexBuffer *buf);
 	virtual Texture *		createTexture(
 		QImage img, bool writable = false, bool targetable = false);
 	virtual Texture *		createTexture(
@@ -272,6 +368,8 @@ public: // Interface ----------------------------------------------------------
 	virtual Texture *		createTexture(
 		const QSize &size, Texture *sameFormat, bool writable = false,
 		bool targetable = false);
+	virtual Texture *		createMipmappedTexture(
+		const QVector<QImage> &levels);
 	virtual Texture *		createStagingTexture(const QSize &size);
 	virtual void			deleteTexture(Texture *tex);
 	virtual bool			copyTextureData(
@@ -295,6 +393,9 @@ public: // Interface ----------------------------------------------------------
 		Texture *tex, const QRect &cropRect, const QSize &size,
 		VidgfxFilter filter, bool setFilter, QPointF &pxSizeOut,
 		QPointF &topLeftOut, QPointF &botRightOut);
+	virtual void		prepareTextureLadder(
+		Texture *tex, const QVector<QSize> &sizes, VidgfxFilter filter,
+		VidgfxContextLadderCallback *callback, void *opaque);
 	virtual Texture *	convertToBgrx(
 		VidgfxPixFormat format, Texture *planeA, Texture *planeB,
 		Texture *planeC);
@@ -306,10 +407,24 @@ public: // Interface ----------------------------------------------------------
 	virtual void		setBlending(VidgfxBlending blending);
 	virtual void		setTexture(
 		Texture *texA, Texture *texB = NULL, Texture *texC = NULL);
-	virtual void		setTextureFilter(VidgfxFilter filter);
+	virtual void		setTextureFilter(
+		VidgfxFilter filter, VidgfxAddressMode mode = GfxClampAddressing);
 	virtual void		clear(const QColor &color);
 	virtual void		drawBuffer(
 		VertexBuffer *buf, int numVertices = -1, int startVertex = 0);
+	virtual void		drawBuffer(
+		VertexBuffer *buf, IndexBuffer *idxBuf, int numIndices = -1,
+		int startIndex = 0, int baseVertex = 0);
+	virtual void		drawInstanced(
+		VertexBuffer *instBuf, int numInstances = -1,
+		int startInstance = 0);
+
+	// Transient geometry
+	virtual float *		allocTransientVerts(
+		int numVerts, int vertSize, VidgfxVertFormat format,
+		VidgfxTransientVerts *vertsOut);
+	virtual void		drawTransientVerts(const VidgfxTransientVerts &verts);
+	virtual void		endFrame();
 
 public: // Signals ------------------------------------------------------------
 	void	callDxgi11ChangedCallbacks(bool hasDxgi11);
@@ -16,12 +16,33 @@
 //*****************************************************************************
 
 #include "graphicscontext.h"
+#include "affinequadgeometry.h"
 #include "gfxlog.h"
+#include "imageorient.h"
+#include "imagesampler.h"
+#include "imagescaler.h"
+#include "outlinegeometry.h"
+#include "polylinegeometry.h"
+#include "vertexlayout.h"
 #include <QtGui/QImage>
-#include <QtGui/QVector2D>
 
 const QString LOG_CAT = QStringLiteral("Gfx");
 
+// The vertex layouts must match the buffer sizes of the C interface
+Q_STATIC_ASSERT(SolidVertLayout::NumFloats * VIDGFX_SOLID_RECT_NUM_VERTS ==
+	VIDGFX_SOLID_RECT_NUM_FLOATS);
+Q_STATIC_ASSERT(TexDecalVertLayout::NumFloats *
+	VIDGFX_TEX_DECAL_RECT_NUM_VERTS == VIDGFX_TEX_DECAL_RECT_NUM_FLOATS);
+Q_STATIC_ASSERT(TexDecalVertLayout::NumFloats * VIDGFX_SCROLL_RECT_NUM_VERTS ==
+	VIDGFX_SCROLL_RECT_NUM_FLOATS);
+Q_STATIC_ASSERT(ResizeVertLayout::NumFloats * VIDGFX_RESIZE_RECT_NUM_VERTS ==
+	VIDGFX_RESIZE_RECT_NUM_FLOATS);
+Q_STATIC_ASSERT(SolidCompactVertLayout::NumFloats *
+	VIDGFX_SOLID_RECT_NUM_VERTS == VIDGFX_SOLID_RECT_COMPACT_NUM_FLOATS);
+Q_STATIC_ASSERT(TexDecalCompactVertLayout::NumFloats *
+	VIDGFX_TEX_DECAL_RECT_NUM_VERTS ==
+	VIDGFX_TEX_DECAL_RECT_COMPACT_NUM_FLOATS);
+
 //=============================================================================
 // Helpers
 
@@ -46,174 +67,6 @@ double dblRepeat(double num, double max)
 	return tmp;
 }
 
-int triListLine(
-	float *data, const QVector2D &start, const QVector2D &end,
-	const QPointF &halfWidth, int extraDataPerVert = 0)
-{
-	int i = 0;
-
-	// Create perpendicular vector of AB with a length of `halfWidth` where
-	// `halfWidth` takes into account the viewport's aspect ratio.
-	QVector2D delta = start - end;
-	QVector2D perp = QVector2D(-delta.y(), delta.x());
-	if(!perp.isNull())
-		perp.normalize();
-	perp *= QVector2D(halfWidth);
-
-	// NOTE: Comments below assume that the line is horizontal with `a` to the
-	// left and the perpendicular vector points downwards
-
-	// Ensure that our generated triangles have a clockwise winding
-	if(perp.x() * delta.y() - perp.y() * delta.x() >= 0.0f)
-		perp = -perp;
-
-	// Calculate quad vertices
-	const QVector2D tl = start - perp; // Top-left
-	const QVector2D bl = start + perp; // Bottom-left
-	const QVector2D tr = end - perp; // Top-right
-	const QVector2D br = end + perp; // Bottom-right
-
-	//-------------------------------------------------------------------------
-	// Triangle 1
-
-	// Top-left
-	data[i++] = tl.x();
-	data[i++] = tl.y();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	i += extraDataPerVert;
-
-	// Top-right
-	data[i++] = tr.x();
-	data[i++] = tr.y();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	i += extraDataPerVert;
-
-	// Bottom-left
-	data[i++] = bl.x();
-	data[i++] = bl.y();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	i += extraDataPerVert;
-
-	//-------------------------------------------------------------------------
-	// Triangle 2
-
-	// Bottom-left
-	data[i++] = bl.x();
-	data[i++] = bl.y();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	i += extraDataPerVert;
-
-	// Top-right
-	data[i++] = tr.x();
-	data[i++] = tr.y();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	i += extraDataPerVert;
-
-	// Bottom-right
-	data[i++] = br.x();
-	data[i++] = br.y();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	i += extraDataPerVert;
-
-	//-------------------------------------------------------------------------
-
-	return i;
-}
-
-int rectOutline(float *data, const QRectF &rect, const QPointF &halfWidth)
-{
-	int i = 0;
-
-	// Top line
-	i += triListLine(&data[i],
-		QVector2D(rect.topLeft() + QPointF(halfWidth.x(), 0.0f)),
-		QVector2D(rect.topRight() - QPointF(halfWidth.x(), 0.0f)),
-		halfWidth);
-
-	// Bottom line
-	i += triListLine(&data[i],
-		QVector2D(rect.bottomLeft() + QPointF(halfWidth.x(), 0.0f)),
-		QVector2D(rect.bottomRight() - QPointF(halfWidth.x(), 0.0f)),
-		halfWidth);
-
-	// Left line
-	i += triListLine(&data[i],
-		QVector2D(rect.topLeft() - QPointF(0.0f, halfWidth.y())),
-		QVector2D(rect.bottomLeft() + QPointF(0.0f, halfWidth.y())),
-		halfWidth);
-
-	// Right line
-	i += triListLine(&data[i],
-		QVector2D(rect.topRight() - QPointF(0.0f, halfWidth.y())),
-		QVector2D(rect.bottomRight() + QPointF(0.0f, halfWidth.y())),
-		halfWidth);
-
-	return i;
-}
-
-int rectOutlineColor(
-	float *data, const QRectF &rect, const QPointF &halfWidth,
-	const QColor &tlCol, const QColor &trCol, const QColor &blCol,
-	const QColor &brCol)
-{
-	int i = 0;
-	int off = 0;
-
-	// Line triangle order = Start, End, Start, Start, End, End
-#define ADD_VERT_COLOR(off, vert, col) \
-	data[(off)+(vert)*8+4] = (col).redF(); \
-	data[(off)+(vert)*8+5] = (col).greenF(); \
-	data[(off)+(vert)*8+6] = (col).blueF(); \
-	data[(off)+(vert)*8+7] = (col).alphaF()
-#define ADD_LINE_COLOR(off, startCol, endCol) \
-	ADD_VERT_COLOR((off), 0, (startCol)); \
-	ADD_VERT_COLOR((off), 1, (endCol)); \
-	ADD_VERT_COLOR((off), 2, (startCol)); \
-	ADD_VERT_COLOR((off), 3, (startCol)); \
-	ADD_VERT_COLOR((off), 4, (endCol)); \
-	ADD_VERT_COLOR((off), 5, (endCol))
-
-	// Top line
-	off = triListLine(&data[i],
-		QVector2D(rect.topLeft() + QPointF(halfWidth.x(), 0.0f)),
-		QVector2D(rect.topRight() - QPointF(halfWidth.x(), 0.0f)),
-		halfWidth, 4);
-	ADD_LINE_COLOR(i, tlCol, trCol);
-	i += off;
-
-	// Bottom line
-	off = triListLine(&data[i],
-		QVector2D(rect.bottomLeft() + QPointF(halfWidth.x(), 0.0f)),
-		QVector2D(rect.bottomRight() - QPointF(halfWidth.x(), 0.0f)),
-		halfWidth, 4);
-	ADD_LINE_COLOR(i, blCol, brCol);
-	i += off;
-
-	// Left line
-	off = triListLine(&data[i],
-		QVector2D(rect.topLeft() - QPointF(0.0f, halfWidth.y())),
-		QVector2D(rect.bottomLeft() + QPointF(0.0f, halfWidth.y())),
-		halfWidth, 4);
-	ADD_LINE_COLOR(i, tlCol, blCol);
-	i += off;
-
-	// Right line
-	off = triListLine(&data[i],
-		QVector2D(rect.topRight() - QPointF(0.0f, halfWidth.y())),
-		QVector2D(rect.bottomRight() + QPointF(0.0f, halfWidth.y())),
-		halfWidth, 4);
-	ADD_LINE_COLOR(i, trCol, brCol);
-	i += off;
-
-	return i;
-}
-
 /// <summary>
 /// Copies the nearby colour information to the specified pixel.
 /// </summary>
@@ -293,17 +146,136 @@ bool dilutePixel(QImage &imgIn, QImage &imgOut, int x, int y, int dMax)
 /// <summary>
 /// WARNING: Create with `GraphicsContext::createVertexBuffer()` only!
 /// </summary>
-VertexBuffer::VertexBuffer(int numFloats)
-	: m_data(new float[numFloats])
+VertexBuffer::VertexBuffer(int numFloats, VidgfxBufStorage storage)
+	: m_data(NULL)
 	, m_numFloats(numFloats)
+	, m_isMapped(false)
 	, m_numVerts(0)
 	, m_vertSize(0)
 	, m_dirty(false)
+	, m_vertFormat(GfxFullVertFormat)
+	, m_storage(storage)
+	//, m_dirtyRanges()
+	, m_numDirtyRanges(0)
 {
-	memset(m_data, 0, numFloats * sizeof(float));
+	// Write-through buffers point `m_data` at the hardware buffer while mapped
+	if(m_storage == GfxShadowedStorage) {
+		m_data = new float[numFloats];
+		memset(m_data, 0, numFloats * sizeof(float));
+	}
 }
 
 VertexBuffer::~VertexBuffer()
+{
+	if(m_storage == GfxShadowedStorage)
+		delete[] m_data;
+}
+
+/// <summary>
+/// Marks the entire buffer as dirty or clears all dirty ranges.
+/// </summary>
+void VertexBuffer::setDirty(bool dirty)
+{
+	m_numDirtyRanges = 0;
+	m_dirty = false;
+	if(dirty)
+		markDirty(0, m_numFloats);
+}
+
+/// <summary>
+/// Marks `numFloats` floats starting at `firstFloat` as modified so that only
+/// the modified parts of the buffer need to be uploaded to the GPU. Ranges
+/// that overlap or touch are merged. Does nothing for write-through
+/// buffers.
+/// </summary>
+void VertexBuffer::markDirty(int firstFloat, int numFloats)
+{
+	if(m_storage != GfxShadowedStorage)
+		return; // Data is written directly to the hardware buffer
+
+	// Clamp to the size of the buffer
+	if(firstFloat < 0) {
+		numFloats += firstFloat;
+		firstFloat = 0;
+	}
+	if(firstFloat + numFloats > m_numFloats)
+		numFloats = m_numFloats - firstFloat;
+	if(numFloats <= 0)
+		return; // Nothing to mark
+	int start = firstFloat;
+	int end = firstFloat + numFloats;
+
+	// Find the existing ranges that the new range overlaps or touches
+	int i = 0;
+	while(i < m_numDirtyRanges &&
+		m_dirtyRanges[i].firstFloat + m_dirtyRanges[i].numFloats < start)
+	{
+		i++;
+	}
+	int j = i;
+	while(j < m_numDirtyRanges && m_dirtyRanges[j].firstFloat <= end) {
+		const DirtyRange &range = m_dirtyRanges[j];
+		if(range.firstFloat < start)
+			start = range.firstFloat;
+		if(range.firstFloat + range.numFloats > end)
+			end = range.firstFloat + range.numFloats;
+		j++;
+	}
+
+	// Replace ranges [i..j) with the merged range while keeping the list sorted
+	memmove(&m_dirtyRanges[i + 1], &m_dirtyRanges[j],
+		(m_numDirtyRanges - j) * sizeof(DirtyRange));
+	m_dirtyRanges[i].firstFloat = start;
+	m_dirtyRanges[i].numFloats = end - start;
+	m_numDirtyRanges += 1 - (j - i);
+	if(m_numDirtyRanges > MaxDirtyRanges)
+		mergeClosestDirtyRanges();
+	m_dirty = true;
+}
+
+/// <summary>
+/// Merges the two neighbouring dirty ranges that have the smallest gap
+/// between them. Uploading a few clean floats is cheaper than tracking an
+/// unbounded number of ranges.
+/// </summary>
+void VertexBuffer::mergeClosestDirtyRanges()
+{
+	if(m_numDirtyRanges < 2)
+		return;
+	int best = -1;
+	int bestGap = 0;
+	for(int i = 0; i < m_numDirtyRanges - 1; i++) {
+		int gap = m_dirtyRanges[i + 1].firstFloat -
+			(m_dirtyRanges[i].firstFloat + m_dirtyRanges[i].numFloats);
+		if(best < 0 || gap < bestGap) {
+			bestGap = gap;
+			best = i;
+		}
+	}
+	DirtyRange &range = m_dirtyRanges[best];
+	const DirtyRange &next = m_dirtyRanges[best + 1];
+	range.numFloats = next.firstFloat + next.numFloats - range.firstFloat;
+	memmove(&m_dirtyRanges[best + 1], &m_dirtyRanges[best + 2],
+		(m_numDirtyRanges - best - 2) * sizeof(DirtyRange));
+	m_numDirtyRanges--;
+}
+
+//=============================================================================
+// IndexBuffer class
+
+/// <summary>
+/// WARNING: Create with `GraphicsContext::createIndexBuffer()` only!
+/// </summary>
+IndexBuffer::IndexBuffer(int maxIndices)
+	: m_data(new quint16[maxIndices])
+	, m_maxIndices(maxIndices)
+	, m_numIndices(0)
+	, m_dirty(false)
+{
+	memset(m_data, 0, maxIndices * sizeof(quint16));
+}
+
+IndexBuffer::~IndexBuffer()
 {
 	delete[] m_data;
 }
@@ -323,6 +295,7 @@ TexDecalVertBuf::TexDecalVertBuf(GraphicsContext *context)
 	// Scrolling
 	, m_scrollOffset()
 	, m_roundOffset(true)
+	, m_useWrapAddressing(false)
 
 	// Texture UV
 	, m_tlUv(0.0f, 0.0f)
@@ -348,20 +321,38 @@ VertexBuffer *TexDecalVertBuf::getVertBuf()
 	if(m_context == NULL || !m_context->isValid())
 		return NULL; // No context operations can be done
 
-	// Create the vertex buffer object if it doesn't already exist
+	// Create the vertex buffer object if it doesn't already exist. Changing
+	// the texture UV can require a larger buffer when scrolling.
+	const bool split = m_hasScrolling && !isWrapScrolling();
+	if(m_vertBuf != NULL && split &&
+		m_vertBuf->getNumFloats() < ScrollRectNumFloats)
+	{
+		deleteVertBuf();
+	}
 	if(m_vertBuf == NULL) {
 		int size = GraphicsContext::TexDecalRectBufSize;
-		if(m_hasScrolling)
+		if(split)
 			size = ScrollRectBufSize;
-		m_vertBuf = m_context->createVertexBuffer(size);
+		m_vertBuf =
+			m_context->createVertexBuffer(size, GfxWriteThroughStorage);
 		if(m_vertBuf == NULL)
 			return NULL; // Failed to create vertex buffer
 	}
 
 	// Update the vertex buffer
-	if(m_hasScrolling)
+	if(split)
 		createScrollTexDecalRect(m_vertBuf);
-	else {
+	else if(m_hasScrolling) {
+		// Offset the UVs by the scroll amount and let the sampler wrap them.
+		// We assume the texture UV is orthogonal.
+		const QPointF lerp = getScrollLerp();
+		const QPointF offset(
+			-lerp.x() * (m_trUv.x() - m_tlUv.x()),
+			-lerp.y() * (m_blUv.y() - m_tlUv.y()));
+		m_context->createTexDecalRect(
+			m_vertBuf, m_rect, m_tlUv + offset, m_trUv + offset,
+			m_blUv + offset, m_brUv + offset);
+	} else {
 		m_context->createTexDecalRect(
 			m_vertBuf, m_rect, m_tlUv, m_trUv, m_blUv, m_brUv);
 	}
@@ -375,11 +366,23 @@ VertexBuffer *TexDecalVertBuf::getVertBuf()
 /// </summary>
 VidgfxTopology TexDecalVertBuf::getTopology() const
 {
-	if(m_hasScrolling)
-		return GfxTriangleListTopology;
+	if(m_hasScrolling && !isWrapScrolling())
+		return GfxQuadListTopology;
 	return GfxTriangleStripTopology;
 }
 
+/// <summary>
+/// Returns the address mode that the texture should be sampled with. This is
+/// only ever `GfxWrapAddressing` if wrap addressing was enabled with
+/// `setUseWrapAddressing()` and the caller must bind it before drawing.
+/// </summary>
+VidgfxAddressMode TexDecalVertBuf::getAddressMode() const
+{
+	if(m_hasScrolling && isWrapScrolling())
+		return GfxWrapAddressing;
+	return GfxClampAddressing;
+}
+
 void TexDecalVertBuf::deleteVertBuf()
 {
 	if(m_vertBuf == NULL)
@@ -439,6 +442,20 @@ void TexDecalVertBuf::setRoundOffset(bool round)
 	m_dirty = true;
 }
 
+/// <summary>
+/// Sets if scrolling rectangles that display exactly one repeat of the
+/// texture should be rendered as a single quad that relies on the texture
+/// being sampled with `GfxWrapAddressing`. Only enable this if the texture
+/// address mode is set to `getAddressMode()` before every draw.
+/// </summary>
+void TexDecalVertBuf::setUseWrapAddressing(bool useWrap)
+{
+	if(m_useWrapAddressing == useWrap)
+		return; // Nothing to do
+	m_useWrapAddressing = useWrap;
+	m_dirty = true;
+}
+
 void TexDecalVertBuf::setTextureUv(
 	const QPointF &topLeft, const QPointF &topRight, const QPointF &botLeft,
 	const QPointF &botRight)
@@ -488,6 +505,18 @@ void TexDecalVertBuf::setTextureUv(
 		bl = QPointF(rectBr.x(), rectTl.y());
 		br = rectTl;
 		break;
+	case GfxRotated90Orient:
+		tl = QPointF(rectTl.x(), rectBr.y());
+		tr = rectTl;
+		bl = rectBr;
+		br = QPointF(rectBr.x(), rectTl.y());
+		break;
+	case GfxRotated270Orient:
+		tl = QPointF(rectBr.x(), rectTl.y());
+		tr = rectBr;
+		bl = rectTl;
+		br = QPointF(rectTl.x(), rectBr.y());
+		break;
 	}
 
 	setTextureUv(tl, tr, bl, br);
@@ -507,23 +536,34 @@ void TexDecalVertBuf::getTextureUv(
 		*botRight = m_brUv;
 }
 
-bool TexDecalVertBuf::createScrollTexDecalRect(VertexBuffer *outBuf)
+/// <summary>
+/// Returns true if the specified texture UV displays exactly one repeat of
+/// the texture in each direction so that scrolling can be done by offsetting
+/// the UVs and sampling with `GfxWrapAddressing` instead of splitting the
+/// rectangle. We assume the texture UV is orthogonal.
+/// </summary>
+bool TexDecalVertBuf::isWrappableUv(
+	const QPointF &tlUv, const QPointF &trUv, const QPointF &blUv,
+	const QPointF &brUv)
 {
-	if(outBuf == NULL)
-		return false;
-	outBuf->setNumVerts(0);
-	if(outBuf->getNumFloats() < ScrollRectNumFloats)
-		return false;
-	outBuf->setNumVerts(ScrollRectNumVerts);
+	return qFuzzyCompare(qAbs(trUv.x() - tlUv.x()), 1.0) &&
+		qFuzzyCompare(qAbs(brUv.x() - blUv.x()), 1.0) &&
+		qFuzzyCompare(qAbs(blUv.y() - tlUv.y()), 1.0) &&
+		qFuzzyCompare(qAbs(brUv.y() - trUv.y()), 1.0);
+}
 
-	// Shader expects vertex format: X, Y, Z, -, U, V, -, -
-	outBuf->setVertSize(8);
-	float *data = outBuf->getDataPtr();
-	int i = 0;
+bool TexDecalVertBuf::isWrapScrolling() const
+{
+	return m_useWrapAddressing &&
+		isWrappableUv(m_tlUv, m_trUv, m_blUv, m_brUv);
+}
 
-	// Shared variables
-	QRectF rect;
-	QPointF tlUv, trUv, blUv, brUv;
+/// <summary>
+/// Returns the scroll offset in rectangle space, rounded to whole texels if
+/// `m_roundOffset` is set.
+/// </summary>
+QPointF TexDecalVertBuf::getScrollLerp() const
+{
 	qreal xLerp = m_scrollOffset.x();
 	qreal yLerp = m_scrollOffset.y();
 	if(m_roundOffset) {
@@ -536,6 +576,24 @@ bool TexDecalVertBuf::createScrollTexDecalRect(VertexBuffer *outBuf)
 				(qreal)qRound(yLerp * m_rect.height()) * invRectSize.height();
 		}
 	}
+	return QPointF(xLerp, yLerp);
+}
+
+bool TexDecalVertBuf::createScrollTexDecalRect(VertexBuffer *outBuf)
+{
+	if(outBuf == NULL)
+		return false;
+	float *data = TexDecalVertLayout::mapBuffer(outBuf, ScrollRectNumVerts);
+	if(data == NULL)
+		return false;
+	int i = 0;
+
+	// Shared variables
+	QRectF rect;
+	QPointF tlUv, trUv, blUv, brUv;
+	const QPointF lerp = getScrollLerp();
+	const qreal xLerp = lerp.x();
+	const qreal yLerp = lerp.y();
 
 	//-------------------------------------------------------------------------
 	// Write rectangles to the buffer
@@ -606,7 +664,8 @@ bool TexDecalVertBuf::createScrollTexDecalRect(VertexBuffer *outBuf)
 
 	//-------------------------------------------------------------------------
 
-	outBuf->setDirty(true);
+	outBuf->markDirty(0, i);
+	outBuf->unmap();
 	return true;
 }
 
@@ -614,75 +673,9 @@ int TexDecalVertBuf::writeScrollRect(
 	float *data, int i, const QRectF &rect, const QPointF &tlUv,
 	const QPointF &trUv, const QPointF &blUv, const QPointF &brUv) const
 {
-	//-------------------------------------------------------------------------
-	// Triangle 1
-
-	// Top-left
-	data[i++] = rect.left();
-	data[i++] = rect.top();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	data[i++] = tlUv.x();
-	data[i++] = tlUv.y();
-	data[i++] = 0.0f;
-	data[i++] = 0.0f;
-
-	// Top-right
-	data[i++] = rect.right();
-	data[i++] = rect.top();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	data[i++] = trUv.x();
-	data[i++] = trUv.y();
-	data[i++] = 0.0f;
-	data[i++] = 0.0f;
-
-	// Bottom-left
-	data[i++] = rect.left();
-	data[i++] = rect.bottom();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	data[i++] = blUv.x();
-	data[i++] = blUv.y();
-	data[i++] = 0.0f;
-	data[i++] = 0.0f;
-
-	//-------------------------------------------------------------------------
-	// Triangle 2
-
-	// Bottom-left
-	data[i++] = rect.left();
-	data[i++] = rect.bottom();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	data[i++] = blUv.x();
-	data[i++] = blUv.y();
-	data[i++] = 0.0f;
-	data[i++] = 0.0f;
-
-	// Top-right
-	data[i++] = rect.right();
-	data[i++] = rect.top();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	data[i++] = trUv.x();
-	data[i++] = trUv.y();
-	data[i++] = 0.0f;
-	data[i++] = 0.0f;
-
-	// Bottom-right
-	data[i++] = rect.right();
-	data[i++] = rect.bottom();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	data[i++] = brUv.x();
-	data[i++] = brUv.y();
-	data[i++] = 0.0f;
-	data[i++] = 0.0f;
-
-	//-------------------------------------------------------------------------
-
-	return i;
+	const float *end = TexDecalVertLayout::writeQuad(
+		&data[i], rect, tlUv, trUv, blUv, brUv);
+	return (int)(end - data);
 }
 
 //=============================================================================
@@ -696,6 +689,8 @@ Texture::Texture(VidgfxTexFlags flags, const QSize &size)
 	, m_mappedData(NULL)
 	, m_size(size)
 	, m_stride(0)
+	, m_generation(0)
+	, m_mipLevels(1)
 	, m_isValid(false)
 {
 }
@@ -706,12 +701,35 @@ Texture::~Texture()
 
 /// <summary>
 /// Maps the texture and copies the pixel data from the `QImage` to it if the
-/// texture is writable.
+/// texture is writable. If `orient` is not `GfxUnchangedOrient` then the
+/// orientation is applied while copying so that the image doesn't need to be
+/// reoriented by the CPU or GPU beforehand. The texture must be the size of
+/// the oriented image in that case.
 /// </summary>
-void Texture::updateData(const QImage &img)
+void Texture::updateData(const QImage &img, VidgfxOrientation orient)
 {
 	if(!isWritable() || img.isNull())
 		return;
+	if(orient != GfxUnchangedOrient) {
+		QSize size = ImageOrient::getOrientedSize(img.size(), orient);
+		if(size.width() > getWidth() || size.height() > getHeight() ||
+			img.depth() != 32)
+		{
+			gfxLog(LOG_CAT, GfxLog::Warning)
+				<< "Cannot upload a reoriented image that does not match the "
+				<< "texture";
+			return;
+		}
+		void *data = map();
+		if(data == NULL)
+			return;
+		ImageOrient::orient(
+			img.constBits(), img.bytesPerLine(),
+			reinterpret_cast<uchar *>(data), getStride(), img.size(), 4,
+			orient);
+		unmap();
+		return;
+	}
 	void *data = map();
 	if(data == NULL)
 		return;
@@ -753,21 +771,37 @@ GraphicsContext::GraphicsContext()
 	, m_userViewMat()
 	, m_userProjMat()
 	, m_cameraConstantsDirty(false)
+	, m_cullingEnabled(false)
+	//, m_cullStats() // Done below
+	, m_cullViewMat()
+	, m_cullProjMat()
+	, m_cullVisibleRect()
+	, m_cullVisibleRectValid(false)
 	//, m_userTargets() // Done below
 	, m_userTargetViewport(0, 0, 0, 0)
 	, m_resizeRect()
+	, m_resizeGizmoRect()
 	, m_resizeConstantsDirty(false)
+	, m_resizeGizmoBuf(NULL)
+	, m_resizeGizmoBufValid(false)
+	, m_resizeGizmoHandleSize(0.0f)
+	, m_resizeGizmoHalfWidth()
 	, m_rgbNv16PxSize(0.0f, 0.0f)
 	, m_rgbNv16ConstantsDirty(false)
 	, m_texDecalModulate(255, 255, 255, 255)
 	//, m_texDecalEffects() // Done below
 	, m_texDecalConstantsDirty(false)
+	, m_mipCache()
+	, m_mipCacheCounter(0)
+	, m_quadIdxBuf(NULL)
 	, m_initializedCallbackList()
 	, m_destroyingCallbackList()
 {
 	m_userTargets[0] = NULL;
 	m_userTargets[1] = NULL;
 
+	resetCullStats();
+
 	m_texDecalEffects[0] = 1.0f; // Gamma
 	m_texDecalEffects[1] = 0.0f; // Brightness
 	m_texDecalEffects[2] = 1.0f; // Contrast
@@ -800,66 +834,21 @@ bool GraphicsContext::createSolidRect(
 	VertexBuffer *outBuf, const QRectF &rect, const QColor &tlCol,
 	const QColor &trCol, const QColor &blCol, const QColor &brCol)
 {
-	if(outBuf == NULL)
-		return false;
-	outBuf->setNumVerts(0);
-	if(outBuf->getNumFloats() < SolidRectNumFloats)
+	float *data = SolidVertLayout::mapBuffer(outBuf, SolidRectNumVerts);
+	if(data == NULL)
 		return false;
-	outBuf->setNumVerts(SolidRectNumVerts);
+	int i = (int)(SolidVertLayout::writeQuad(
+		data, rect, tlCol, trCol, blCol, brCol) - data);
 
-	// Shader expects vertex format: X, Y, Z, -, R, G, B, A
-	outBuf->setVertSize(8);
-	float *data = outBuf->getDataPtr();
-	int i = 0;
-
-	// Top-left
-	data[i++] = rect.left();
-	data[i++] = rect.top();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	data[i++] = tlCol.redF();
-	data[i++] = tlCol.greenF();
-	data[i++] = tlCol.blueF();
-	data[i++] = tlCol.alphaF();
-
-	// Top-right
-	data[i++] = rect.right();
-	data[i++] = rect.top();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	data[i++] = trCol.redF();
-	data[i++] = trCol.greenF();
-	data[i++] = trCol.blueF();
-	data[i++] = trCol.alphaF();
-
-	// Bottom-left
-	data[i++] = rect.left();
-	data[i++] = rect.bottom();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	data[i++] = blCol.redF();
-	data[i++] = blCol.greenF();
-	data[i++] = blCol.blueF();
-	data[i++] = blCol.alphaF();
-
-	// Bottom-right
-	data[i++] = rect.right();
-	data[i++] = rect.bottom();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	data[i++] = brCol.redF();
-	data[i++] = brCol.greenF();
-	data[i++] = brCol.blueF();
-	data[i++] = brCol.alphaF();
-
-	outBuf->setDirty(true);
+	outBuf->markDirty(0, i);
+	outBuf->unmap();
 	return true;
 }
 
 /// <summary>
 /// Fills a `VertexBuffer` with the required data to draw a rectangle outline
 /// with a single solid colour. Designed to be rendered with
-/// `TriangleStripTopology`.
+/// `GfxQuadListTopology`.
 /// </summary>
 /// <returns>True if the buffer is valid.</returns>
 bool GraphicsContext::createSolidRectOutline(
@@ -872,7 +861,7 @@ bool GraphicsContext::createSolidRectOutline(
 /// <summary>
 /// Fills a `VertexBuffer` with the required data to draw a rectangle outline
 /// with a different solid colour for each vertex. Designed to be rendered with
-/// `TriangleStripTopology`.
+/// `GfxQuadListTopology`.
 /// </summary>
 /// <returns>True if the buffer is valid.</returns>
 bool GraphicsContext::createSolidRectOutline(
@@ -880,23 +869,19 @@ bool GraphicsContext::createSolidRectOutline(
 	const QColor &trCol, const QColor &blCol, const QColor &brCol,
 	const QPointF &halfWidth)
 {
-	if(outBuf == NULL)
-		return false;
-	outBuf->setNumVerts(0);
-	if(outBuf->getNumFloats() < SolidRectOutlineNumFloats)
+	float *data =
+		SolidVertLayout::mapBuffer(outBuf, SolidRectOutlineNumVerts);
+	if(data == NULL)
 		return false;
-	outBuf->setNumVerts(SolidRectOutlineNumVerts);
-
-	// Shader expects vertex format: X, Y, Z, -, R, G, B, A
-	outBuf->setVertSize(8);
-	float *data = outBuf->getDataPtr();
 	int i = 0;
 
 	// Add rectangle
-	i += rectOutlineColor(
-		&data[i], rect, halfWidth, tlCol, trCol, blCol, brCol);
+	const QColor cols[4] = { tlCol, trCol, blCol, brCol };
+	i += OutlineGeometry::writeRectOutline(
+		&data[i], rect, halfWidth, GfxFullVertFormat, cols);
 
-	outBuf->setDirty(true);
+	outBuf->markDirty(0, i);
+	outBuf->unmap();
 	return true;
 }
 
@@ -925,114 +910,708 @@ bool GraphicsContext::createTexDecalRect(
 	VertexBuffer *outBuf, const QRectF &rect, const QPointF &tlUv,
 	const QPointF &trUv, const QPointF &blUv, const QPointF &brUv)
 {
-	if(outBuf == NULL)
+	float *data =
+		TexDecalVertLayout::mapBuffer(outBuf, TexDecalRectNumVerts);
+	if(data == NULL)
 		return false;
-	outBuf->setNumVerts(0);
-	if(outBuf->getNumFloats() < TexDecalRectNumFloats)
+	int i = writeTexDecalRect(data, rect, tlUv, trUv, blUv, brUv);
+
+	outBuf->markDirty(0, i);
+	outBuf->unmap();
+	return true;
+}
+
+/// <summary>
+/// Writes the `TexDecalRectNumVerts` vertices of a texture decal rectangle
+/// directly to `data` in the same format as `createTexDecalRect()`. Used for
+/// writing into memory that isn't owned by a `VertexBuffer` such as
+/// transient vertices.
+/// </summary>
+/// <returns>The number of floats that were written</returns>
+int GraphicsContext::writeTexDecalRect(
+	float *data, const QRectF &rect, const QPointF &tlUv,
+	const QPointF &trUv, const QPointF &blUv, const QPointF &brUv)
+{
+	const float *end = TexDecalVertLayout::writeQuad(
+		data, rect, tlUv, trUv, blUv, brUv);
+	return (int)(end - data);
+}
+
+/// <summary>
+/// Fills a `VertexBuffer` with `numRects` filled rectangles that are each
+/// rotated, skewed or scaled by their own affine transform so that they can
+/// be rendered with a single draw call and the same view matrix. `cols` must
+/// contain 4 colours for each rectangle in the order top-left, top-right,
+/// bottom-left and bottom-right. Designed to be rendered with
+/// `GfxQuadListTopology`.
+/// </summary>
+/// <returns>True if the buffer is valid.</returns>
+bool GraphicsContext::createTransformedSolidRects(
+	VertexBuffer *outBuf, const QRectF *rects, const QTransform *transforms,
+	int numRects, const QColor *cols)
+{
+	if(outBuf == NULL || rects == NULL || transforms == NULL ||
+		cols == NULL || numRects < 0)
+	{
 		return false;
-	outBuf->setNumVerts(TexDecalRectNumVerts);
+	}
+	float *data = SolidVertLayout::mapBuffer(
+		outBuf, numRects * AffineQuadGeometry::NumVertsPerQuad);
+	if(data == NULL)
+		return false;
+	int i = AffineQuadGeometry::writeSolidQuads(
+		data, rects, transforms, numRects, cols);
+
+	outBuf->markDirty(0, i);
+	outBuf->unmap();
+	return true;
+}
+
+/// <summary>
+/// Fills a `VertexBuffer` with `numRects` texture decal rectangles that are
+/// each transformed by their own affine transform. If `uvs` is not NULL then
+/// it must contain 4 texture coordinates for each rectangle, otherwise every
+/// rectangle displays the entire texture. Designed to be rendered with
+/// `GfxQuadListTopology`.
+/// </summary>
+/// <returns>True if the buffer is valid.</returns>
+bool GraphicsContext::createTransformedTexDecalRects(
+	VertexBuffer *outBuf, const QRectF *rects, const QTransform *transforms,
+	int numRects, const QPointF *uvs)
+{
+	if(outBuf == NULL || rects == NULL || transforms == NULL ||
+		numRects < 0)
+	{
+		return false;
+	}
+	float *data = TexDecalVertLayout::mapBuffer(
+		outBuf, numRects * AffineQuadGeometry::NumVertsPerQuad);
+	if(data == NULL)
+		return false;
+	int i = AffineQuadGeometry::writeTexDecalQuads(
+		data, rects, transforms, numRects, uvs);
 
-	// Shader expects vertex format: X, Y, Z, -, U, V, -, -
-	outBuf->setVertSize(8);
-	float *data = outBuf->getDataPtr();
+	outBuf->markDirty(0, i);
+	outBuf->unmap();
+	return true;
+}
+
+/// <summary>
+/// Fills a `VertexBuffer` with the 9 slices of a nine-slice rectangle as
+/// separate quads in row order so that the whole rectangle is rendered with
+/// a single draw call. Designed to be rendered with `GfxQuadListTopology`.
+/// See `calcNineSliceLines()` for how the slices are positioned.
+/// </summary>
+/// <returns>True if the buffer is valid.</returns>
+bool GraphicsContext::createNineSliceRect(
+	VertexBuffer *outBuf, const VidgfxNineSlice &slice)
+{
+	float *data = TexDecalVertLayout::mapBuffer(outBuf, NineSliceNumVerts);
+	if(data == NULL)
+		return false;
+	float xs[4], ys[4], us[4], vs[4];
+	calcNineSliceLines(slice, xs, ys, us, vs);
 	int i = 0;
+	for(int row = 0; row < 3; row++) {
+		for(int col = 0; col < 3; col++) {
+			i += writeTexDecalRect(&data[i],
+				QRectF(QPointF(xs[col], ys[row]),
+				QPointF(xs[col + 1], ys[row + 1])),
+				QPointF(us[col], vs[row]), QPointF(us[col + 1], vs[row]),
+				QPointF(us[col], vs[row + 1]),
+				QPointF(us[col + 1], vs[row + 1]));
+		}
+	}
 
-	// Top-left
-	data[i++] = rect.left();
-	data[i++] = rect.top();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	data[i++] = tlUv.x();
-	data[i++] = tlUv.y();
-	data[i++] = 0.0f;
-	data[i++] = 0.0f;
-
-	// Top-right
-	data[i++] = rect.right();
-	data[i++] = rect.top();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	data[i++] = trUv.x();
-	data[i++] = trUv.y();
-	data[i++] = 0.0f;
-	data[i++] = 0.0f;
-
-	// Bottom-left
-	data[i++] = rect.left();
-	data[i++] = rect.bottom();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	data[i++] = blUv.x();
-	data[i++] = blUv.y();
-	data[i++] = 0.0f;
-	data[i++] = 0.0f;
-
-	// Bottom-right
-	data[i++] = rect.right();
-	data[i++] = rect.bottom();
-	data[i++] = 0.0f;
-	data[i++] = 1.0f;
-	data[i++] = brUv.x();
-	data[i++] = brUv.y();
-	data[i++] = 0.0f;
-	data[i++] = 0.0f;
+	outBuf->markDirty(0, i);
+	outBuf->unmap();
+	return true;
+}
+
+/// <summary>
+/// Fills a `VertexBuffer` with the 4x4 grid of vertices that the 9 slices of
+/// a nine-slice rectangle share in row order. Designed to be rendered with
+/// `GfxTriangleListTopology` and the indices from `createNineSliceIndices()`.
+/// </summary>
+/// <returns>True if the buffer is valid.</returns>
+bool GraphicsContext::createNineSliceGrid(
+	VertexBuffer *outBuf, const VidgfxNineSlice &slice)
+{
+	float *data =
+		TexDecalVertLayout::mapBuffer(outBuf, NineSliceGridNumVerts);
+	if(data == NULL)
+		return false;
+	float xs[4], ys[4], us[4], vs[4];
+	calcNineSliceLines(slice, xs, ys, us, vs);
+	float *out = data;
+	for(int row = 0; row < 4; row++) {
+		for(int col = 0; col < 4; col++) {
+			out = TexDecalVertLayout::writeVert(
+				out, xs[col], ys[row], QPointF(us[col], vs[row]));
+		}
+	}
+	int i = (int)(out - data);
+
+	outBuf->markDirty(0, i);
+	outBuf->unmap();
+	return true;
+}
+
+/// <summary>
+/// Fills an `IndexBuffer` with the triangles of the 9 slices of the vertex
+/// grid that `createNineSliceGrid()` outputs. Uses the same winding as
+/// `createQuadIndices()`.
+/// </summary>
+/// <returns>True if the buffer is valid.</returns>
+bool GraphicsContext::createNineSliceIndices(IndexBuffer *outBuf)
+{
+	if(outBuf == NULL)
+		return false;
+	outBuf->setNumIndices(0);
+	if(outBuf->getMaxIndices() < NineSliceNumIndices)
+		return false;
+	outBuf->setNumIndices(NineSliceNumIndices);
+
+	quint16 *data = outBuf->getDataPtr();
+	for(int row = 0; row < 3; row++) {
+		for(int col = 0; col < 3; col++) {
+			const quint16 v = (quint16)(row * 4 + col);
+			*data++ = v; // Top-left
+			*data++ = v + 1; // Top-right
+			*data++ = v + 4; // Bottom-left
+			*data++ = v + 4; // Bottom-left
+			*data++ = v + 1; // Top-right
+			*data++ = v + 5; // Bottom-right
+		}
+	}
 
 	outBuf->setDirty(true);
 	return true;
 }
 
+/// <summary>
+/// Calculates the 4 vertical (`xs`, `us`) and 4 horizontal (`ys`, `vs`) grid
+/// lines that separate the slices of a nine-slice rectangle. If the
+/// rectangle is smaller than its borders then the borders are shrunk
+/// proportionally so that the slices never overlap. The texture insets are
+/// never changed so the corners are scaled down instead of cropped.
+/// </summary>
+void GraphicsContext::calcNineSliceLines(
+	const VidgfxNineSlice &slice, float *xs, float *ys, float *us, float *vs)
+{
+	const QRectF &rect = slice.rect;
+	const float borders[4] = {
+		(float)qAbs(slice.tl_border.x()), (float)qAbs(slice.br_border.x()),
+		(float)qAbs(slice.tl_border.y()), (float)qAbs(slice.br_border.y())
+	};
+	const float sizes[2] = { (float)rect.width(), (float)rect.height() };
+	float *lines[2] = { xs, ys };
+	for(int axis = 0; axis < 2; axis++) {
+		const float size = sizes[axis];
+		const float dir = (size < 0.0f) ? -1.0f : 1.0f;
+		const float first = borders[axis * 2];
+		const float second = borders[axis * 2 + 1];
+		float scale = 1.0f;
+		if(first + second > size * dir)
+			scale = size * dir / (first + second);
+		const float start = (axis == 0) ? rect.left() : rect.top();
+		lines[axis][0] = start;
+		lines[axis][1] = start + first * scale * dir;
+		lines[axis][2] = start + size - second * scale * dir;
+		lines[axis][3] = start + size;
+	}
+
+	const QRectF &uv = slice.uv_rect;
+	us[0] = uv.left();
+	us[1] = uv.left() + slice.tl_uv_inset.x();
+	us[2] = uv.right() - slice.br_uv_inset.x();
+	us[3] = uv.right();
+	vs[0] = uv.top();
+	vs[1] = uv.top() + slice.tl_uv_inset.y();
+	vs[2] = uv.bottom() - slice.br_uv_inset.y();
+	vs[3] = uv.bottom();
+}
+
+/// <summary>
+/// Fills a `VertexBuffer` with a thick polyline of a single solid colour that
+/// connects `points` in order. See `createSolidPolyline()` with per-point
+/// colours for details.
+/// </summary>
+/// <returns>True if the buffer is valid.</returns>
+bool GraphicsContext::createSolidPolyline(
+	VertexBuffer *outBuf, const QPointF *points, int numPoints,
+	const QColor &col, float halfWidth, VidgfxLineJoin join, bool closed)
+{
+	return createPolyline(
+		outBuf, points, numPoints, &col, false, halfWidth, join, closed);
+}
+
+/// <summary>
+/// Fills a `VertexBuffer` with a thick polyline that connects `points` in
+/// order with miter or bevel joins between its segments so that the whole
+/// polyline is rendered with a single draw call. `cols` must contain one
+/// colour for each point which is interpolated along the segments. If
+/// `closed` is true then the last point is also connected to the first. The
+/// buffer must be large enough for `VIDGFX_SOLID_POLYLINE_NUM_VERTS()`
+/// vertices but the number of vertices that are actually used depends on the
+/// shape of the polyline. Designed to be rendered with `GfxQuadListTopology`.
+/// </summary>
+/// <returns>True if the buffer is valid.</returns>
+bool GraphicsContext::createSolidPolyline(
+	VertexBuffer *outBuf, const QPointF *points, int numPoints,
+	const QColor *cols, float halfWidth, VidgfxLineJoin join, bool closed)
+{
+	return createPolyline(
+		outBuf, points, numPoints, cols, true, halfWidth, join, closed);
+}
+
+/// <summary>
+/// Implements both `createSolidPolyline()` variants. `cols` is either a
+/// single colour or one colour per point depending on `colPerPoint`.
+/// </summary>
+bool GraphicsContext::createPolyline(
+	VertexBuffer *outBuf, const QPointF *points, int numPoints,
+	const QColor *cols, bool colPerPoint, float halfWidth,
+	VidgfxLineJoin join, bool closed)
+{
+	if(points == NULL || cols == NULL || numPoints < 0)
+		return false;
+	const int maxVerts =
+		PolylineGeometry::getMaxNumVerts(numPoints, closed);
+	float *data = SolidVertLayout::mapBuffer(outBuf, maxVerts);
+	if(data == NULL)
+		return false;
+	int i = PolylineGeometry::writePolyline(
+		data, points, numPoints, halfWidth, join, closed, cols, colPerPoint);
+	outBuf->setNumVerts(i / SolidVertLayout::NumFloats);
+
+	outBuf->markDirty(0, i);
+	outBuf->unmap();
+	return true;
+}
+
+/// <summary>
+/// Fills a `VertexBuffer` with the required data to draw a filled rectangle
+/// with a single solid colour using `GfxCompactVertFormat`. Designed to be
+/// rendered with the `TriangleStrip` topology.
+/// </summary>
+/// <returns>True if the buffer is valid.</returns>
+bool GraphicsContext::createSolidRectCompact(
+	VertexBuffer *outBuf, const QRectF &rect, const QColor &col)
+{
+	return createSolidRectCompact(outBuf, rect, col, col, col, col);
+}
+
+/// <summary>
+/// Fills a `VertexBuffer` with the required data to draw a filled rectangle
+/// with a different solid colour for each vertex using
+/// `GfxCompactVertFormat`. Designed to be rendered with the `TriangleStrip`
+/// topology.
+/// </summary>
+/// <returns>True if the buffer is valid.</returns>
+bool GraphicsContext::createSolidRectCompact(
+	VertexBuffer *outBuf, const QRectF &rect, const QColor &tlCol,
+	const QColor &trCol, const QColor &blCol, const QColor &brCol)
+{
+	float *data =
+		SolidCompactVertLayout::mapBuffer(outBuf, SolidRectNumVerts);
+	if(data == NULL)
+		return false;
+	int i = (int)(SolidCompactVertLayout::writeQuad(
+		data, rect, tlCol, trCol, blCol, brCol) - data);
+
+	outBuf->markDirty(0, i);
+	outBuf->unmap();
+	return true;
+}
+
+/// <summary>
+/// Fills a `VertexBuffer` with the required data to draw a rectangle outline
+/// with a single solid colour using `GfxCompactVertFormat`. Designed to be
+/// rendered with `GfxQuadListTopology`.
+/// </summary>
+/// <returns>True if the buffer is valid.</returns>
+bool GraphicsContext::createSolidRectOutlineCompact(
+	VertexBuffer *outBuf, const QRectF &rect, const QColor &col,
+	const QPointF &halfWidth)
+{
+	return createSolidRectOutlineCompact(
+		outBuf, rect, col, col, col, col, halfWidth);
+}
+
+/// <summary>
+/// Fills a `VertexBuffer` with the required data to draw a rectangle outline
+/// with a different solid colour for each vertex using
+/// `GfxCompactVertFormat`. Designed to be rendered with
+/// `GfxQuadListTopology`.
+/// </summary>
+/// <returns>True if the buffer is valid.</returns>
+bool GraphicsContext::createSolidRectOutlineCompact(
+	VertexBuffer *outBuf, const QRectF &rect, const QColor &tlCol,
+	const QColor &trCol, const QColor &blCol, const QColor &brCol,
+	const QPointF &halfWidth)
+{
+	float *data =
+		SolidCompactVertLayout::mapBuffer(outBuf, SolidRectOutlineNumVerts);
+	if(data == NULL)
+		return false;
+	int i = 0;
+
+	// Add rectangle
+	const QColor cols[4] = { tlCol, trCol, blCol, brCol };
+	i += OutlineGeometry::writeRectOutline(
+		&data[i], rect, halfWidth, GfxCompactVertFormat, cols);
+
+	outBuf->markDirty(0, i);
+	outBuf->unmap();
+	return true;
+}
+
+/// <summary>
+/// Assumes that the top-left UV coordinate is (0, 0) and the bottom-right is
+/// (1, 1).
+/// </summary>
+bool GraphicsContext::createTexDecalRectCompact(
+	VertexBuffer *outBuf, const QRectF &rect, bool unormUv)
+{
+	return createTexDecalRectCompact(
+		outBuf, rect, QPointF(0.0f, 0.0f), QPointF(1.0f, 0.0f),
+		QPointF(0.0f, 1.0f), QPointF(1.0f, 1.0f), unormUv);
+}
+
+/// <summary>
+/// Fills a `VertexBuffer` with the required data to draw a texture decal
+/// rectangle using `GfxCompactVertFormat`. If `unormUv` is true then the UVs
+/// are packed as 16-bit UNORM values using `GfxCompactUnormVertFormat`
+/// instead which limits them to the range [0..1] and reduces the size of each
+/// vertex to 3 floats.
+/// </summary>
+/// <returns>True if the buffer is valid.</returns>
+bool GraphicsContext::createTexDecalRectCompact(
+	VertexBuffer *outBuf, const QRectF &rect, const QPointF &tlUv,
+	const QPointF &trUv, const QPointF &blUv, const QPointF &brUv,
+	bool unormUv)
+{
+	float *data;
+	int i;
+	if(unormUv) {
+		data = TexDecalUnormVertLayout::mapBuffer(
+			outBuf, TexDecalRectNumVerts);
+		if(data == NULL)
+			return false;
+		i = (int)(TexDecalUnormVertLayout::writeQuad(
+			data, rect, tlUv, trUv, blUv, brUv) - data);
+	} else {
+		data = TexDecalCompactVertLayout::mapBuffer(
+			outBuf, TexDecalRectNumVerts);
+		if(data == NULL)
+			return false;
+		i = (int)(TexDecalCompactVertLayout::writeQuad(
+			data, rect, tlUv, trUv, blUv, brUv) - data);
+	}
+
+	outBuf->markDirty(0, i);
+	outBuf->unmap();
+	return true;
+}
+
 /// <summary>
 /// Fills a `VertexBuffer` with the required data to draw a the rectangle
 /// outline and handles of the resize layer graphic. Designed to be rendered
-/// with `TriangleListTopology`.
+/// with `GfxQuadListTopology`.
 /// </summary>
 /// <returns>True if the buffer is valid.</returns>
 bool GraphicsContext::createResizeRect(
 	VertexBuffer *outBuf, const QRectF &rect, float handleSize,
 	const QPointF &halfWidth)
+{
+	float *data = ResizeVertLayout::mapBuffer(outBuf, ResizeRectNumVerts);
+	if(data == NULL)
+		return false;
+	int i = 0;
+
+	// Main rectangle followed by the 9 handle rectangles in column order
+	QRectF rects[10];
+	rects[0] = rect;
+	QRectF htRect(rect.topLeft(), QSizeF(handleSize, handleSize));
+	htRect.translate(-handleSize * 0.5f, -handleSize * 0.5f);
+	for(int x = 0; x < 3; x++) {
+		for(int y = 0; y < 3; y++) {
+			rects[1 + x * 3 + y] = htRect.translated(
+				rect.width() * 0.5f * (qreal)x,
+				rect.height() * 0.5f * (qreal)y);
+		}
+	}
+	i += OutlineGeometry::writeRectOutlines(
+		&data[i], rects, 10, halfWidth, GfxFullVertFormat);
+
+	outBuf->markDirty(0, i);
+	outBuf->unmap();
+	return true;
+}
+
+/// <summary>
+/// Fills a `VertexBuffer` with the same rectangle outline and handles as
+/// `createResizeRect()` but in a form that doesn't depend on the position or
+/// size of the rectangle. Each vertex stores an offset in world units in X and
+/// Y and its position relative to the rectangle in unit space in Z and W. The
+/// rectangle is applied at draw time by `GfxResizeGizmoShader`, see
+/// `setResizeGizmoRect()`, so the buffer only needs to be regenerated when
+/// the handle size or line width changes. Designed to be rendered with
+/// `GfxQuadListTopology`.
+/// </summary>
+/// <returns>True if the buffer is valid.</returns>
+bool GraphicsContext::createResizeGizmo(
+	VertexBuffer *outBuf, float handleSize, const QPointF &halfWidth)
 {
 	if(outBuf == NULL)
 		return false;
 	outBuf->setNumVerts(0);
-	if(outBuf->getNumFloats() < ResizeRectNumFloats)
+	if(outBuf->getNumFloats() < ResizeGizmoNumFloats)
 		return false;
-	outBuf->setNumVerts(ResizeRectNumVerts);
+	outBuf->setNumVerts(ResizeGizmoNumVerts);
 
-	// Shader expects vertex format: X, Y, Z, -
+	// Shader expects vertex format: X offset, Y offset, X unit, Y unit
 	outBuf->setVertSize(4);
-	float *data = outBuf->getDataPtr();
+	outBuf->setVertFormat(GfxFullVertFormat);
+	float *data = outBuf->map();
+	if(data == NULL) {
+		outBuf->setNumVerts(0);
+		return false; // Failed to map buffer
+	}
 	int i = 0;
 
-	// Add main rectangle
-	i += rectOutline(&data[i], rect, halfWidth);
+	// Which edge of the rectangle each vertex of an outline is relative to.
+	// This order is fixed by `OutlineGeometry` (top, bottom, left and right
+	// lines).
+	static const bool isRight[OutlineGeometry::NumVertsPerOutline] = {
+		false, true, false, true, false, true, false, true,
+		false, false, false, false, true, true, true, true };
+	static const bool isBottom[OutlineGeometry::NumVertsPerOutline] = {
+		false, false, false, false, true, true, true, true,
+		false, true, false, true, false, true, false, true };
+
+	// Outlines are generated for a nominal rectangle that is large enough for
+	// the lines not to overlap and then split into unit and offset parts. A
+	// power of two size keeps the subtraction exact.
+	float size = 16.0f;
+	const float minSize =
+		4.0f * (qAbs(halfWidth.x()) + qAbs(halfWidth.y()) + handleSize);
+	while(size <= minSize)
+		size *= 2.0f;
+
+	// Main rectangle followed by the 9 handle rectangles in column order
+	const float hs = handleSize * 0.5f;
+	float outline[OutlineGeometry::NumVertsPerOutline * 4];
+	for(int r = 0; r < 10; r++) {
+		QPointF tlUnit(0.0f, 0.0f);
+		QPointF brUnit(1.0f, 1.0f);
+		QPointF tlOff(0.0f, 0.0f);
+		QPointF brOff(0.0f, 0.0f);
+		if(r > 0) {
+			const int x = (r - 1) / 3;
+			const int y = (r - 1) % 3;
+			tlUnit = brUnit = QPointF(0.5f * (float)x, 0.5f * (float)y);
+			tlOff = QPointF(-hs, -hs);
+			brOff = QPointF(hs, hs);
+		}
+		const QRectF rect(tlUnit * size + tlOff, brUnit * size + brOff);
+		OutlineGeometry::writeRectOutline(
+			outline, rect, halfWidth, GfxFullVertFormat);
+
+		for(int v = 0; v < OutlineGeometry::NumVertsPerOutline; v++) {
+			const float unitX = isRight[v] ? brUnit.x() : tlUnit.x();
+			const float unitY = isBottom[v] ? brUnit.y() : tlUnit.y();
+			data[i++] = outline[v * 4 + 0] - unitX * size;
+			data[i++] = outline[v * 4 + 1] - unitY * size;
+			data[i++] = unitX;
+			data[i++] = unitY;
+		}
+	}
 
-	// Add handle rectangles
-	QRectF htRect(rect.topLeft(), QSizeF(handleSize, handleSize));
-	htRect.translate(-handleSize * 0.5f, -handleSize * 0.5f);
-	QRectF hmRect(htRect);
-	QRectF hbRect(htRect);
-	hmRect.translate(0.0f, rect.height() * 0.5f);
-	hbRect.translate(0.0f, rect.height());
-	i += rectOutline(&data[i], htRect, halfWidth); // Top-left
-	i += rectOutline(&data[i], hmRect, halfWidth); // Middle-left
-	i += rectOutline(&data[i], hbRect, halfWidth); // Bottom-left
-	htRect.translate(rect.width() * 0.5f, 0.0f);
-	hmRect.translate(rect.width() * 0.5f, 0.0f);
-	hbRect.translate(rect.width() * 0.5f, 0.0f);
-	i += rectOutline(&data[i], htRect, halfWidth); // Top-center
-	i += rectOutline(&data[i], hmRect, halfWidth); // Middle-center
-	i += rectOutline(&data[i], hbRect, halfWidth); // Bottom-center
-	htRect.translate(rect.width() * 0.5f, 0.0f);
-	hmRect.translate(rect.width() * 0.5f, 0.0f);
-	hbRect.translate(rect.width() * 0.5f, 0.0f);
-	i += rectOutline(&data[i], htRect, halfWidth); // Top-right
-	i += rectOutline(&data[i], hmRect, halfWidth); // Middle-right
-	i += rectOutline(&data[i], hbRect, halfWidth); // Bottom-right
+	outBuf->markDirty(0, i);
+	outBuf->unmap();
+	return true;
+}
+
+/// <summary>
+/// Clips a texture decal rectangle to `clipRect`, adjusting the texture UVs of
+/// each corner so that the visible part of the texture remains in the same
+/// location. Any of the UV pointers can be NULL. Rectangles with a negative
+/// width or height are only tested and never clipped.
+/// </summary>
+/// <returns>How the rectangle was modified</returns>
+VidgfxCullResult GraphicsContext::clipTexDecalRect(
+	const QRectF &clipRect, QRectF *rect, QPointF *tlUv, QPointF *trUv,
+	QPointF *blUv, QPointF *brUv)
+{
+	if(rect == NULL)
+		return GfxRectCulled;
+	const QRectF r = *rect;
+	if(!clipRect.intersects(r.normalized()))
+		return GfxRectCulled;
+	if(r.width() <= 0.0 || r.height() <= 0.0 || clipRect.contains(r))
+		return GfxRectVisible;
+
+	// Position of the clipped rectangle relative to the original
+	const QRectF clipped = r.intersected(clipRect);
+	const qreal s0 = (clipped.left() - r.left()) / r.width();
+	const qreal s1 = (clipped.right() - r.left()) / r.width();
+	const qreal t0 = (clipped.top() - r.top()) / r.height();
+	const qreal t1 = (clipped.bottom() - r.top()) / r.height();
+
+	// Bilinearly interpolate the UVs of the new corners
+	const QPointF tl = (tlUv != NULL) ? *tlUv : QPointF(0.0, 0.0);
+	const QPointF tr = (trUv != NULL) ? *trUv : QPointF(1.0, 0.0);
+	const QPointF bl = (blUv != NULL) ? *blUv : QPointF(0.0, 1.0);
+	const QPointF br = (brUv != NULL) ? *brUv : QPointF(1.0, 1.0);
+	const QPointF top0 = tl + (tr - tl) * s0;
+	const QPointF top1 = tl + (tr - tl) * s1;
+	const QPointF bot0 = bl + (br - bl) * s0;
+	const QPointF bot1 = bl + (br - bl) * s1;
+	if(tlUv != NULL)
+		*tlUv = top0 + (bot0 - top0) * t0;
+	if(trUv != NULL)
+		*trUv = top1 + (bot1 - top1) * t0;
+	if(blUv != NULL)
+		*blUv = top0 + (bot0 - top0) * t1;
+	if(brUv != NULL)
+		*brUv = top1 + (bot1 - top1) * t1;
+
+	*rect = clipped;
+	return GfxRectClipped;
+}
+
+/// <summary>
+/// Fills a `VertexBuffer` with `numInstances` layer instances for
+/// `drawInstanced()`. Each "vertex" of the buffer is a single instance.
+/// </summary>
+/// <returns>True if the buffer is valid.</returns>
+bool GraphicsContext::createLayerInstances(
+	VertexBuffer *outBuf, const VidgfxLayerInstance *instances,
+	int numInstances)
+{
+	if(outBuf == NULL || instances == NULL || numInstances < 0)
+		return false;
+	outBuf->setNumVerts(0);
+	if(outBuf->getNumFloats() < numInstances * LayerInstNumFloats)
+		return false;
+	outBuf->setNumVerts(numInstances);
+
+	// Shader expects instance format: X, Y, W, H, U, V, UW, VH, R, G, B, A,
+	// Slot, -, -, -
+	outBuf->setVertSize(LayerInstNumFloats);
+	outBuf->setVertFormat(GfxFullVertFormat);
+	float *data = outBuf->map();
+	if(data == NULL) {
+		outBuf->setNumVerts(0);
+		return false; // Failed to map buffer
+	}
+	int i = writeLayerInstances(data, instances, numInstances);
+
+	outBuf->markDirty(0, i);
+	outBuf->unmap();
+	return true;
+}
+
+/// <summary>
+/// Writes `numInstances` layer instances directly to `data` in the same
+/// format as `createLayerInstances()`.
+/// </summary>
+/// <returns>The number of floats that were written</returns>
+int GraphicsContext::writeLayerInstances(
+	float *data, const VidgfxLayerInstance *instances, int numInstances)
+{
+	int i = 0;
+	for(int j = 0; j < numInstances; j++) {
+		const VidgfxLayerInstance &inst = instances[j];
+		data[i++] = inst.rect.x();
+		data[i++] = inst.rect.y();
+		data[i++] = inst.rect.width();
+		data[i++] = inst.rect.height();
+		data[i++] = inst.uv_rect.x();
+		data[i++] = inst.uv_rect.y();
+		data[i++] = inst.uv_rect.width();
+		data[i++] = inst.uv_rect.height();
+		data[i++] = inst.color.redF();
+		data[i++] = inst.color.greenF();
+		data[i++] = inst.color.blueF();
+		data[i++] = inst.color.alphaF();
+		data[i++] = (float)inst.tex_slot;
+		data[i++] = 0.0f;
+		data[i++] = 0.0f;
+		data[i++] = 0.0f;
+	}
+	return i;
+}
+
+/// <summary>
+/// Fills an `IndexBuffer` with the indices of `numQuads` quads that each
+/// consist of 4 vertices in the order top-left, top-right, bottom-left and
+/// bottom-right. Both triangles of each quad have a clockwise winding.
+/// </summary>
+/// <returns>True if the buffer is valid.</returns>
+bool GraphicsContext::createQuadIndices(IndexBuffer *outBuf, int numQuads)
+{
+	if(outBuf == NULL)
+		return false;
+	outBuf->setNumIndices(0);
+	if(outBuf->getMaxIndices() < numQuads * 6 || numQuads * 4 > 65536)
+		return false;
+	outBuf->setNumIndices(numQuads * 6);
+
+	quint16 *data = outBuf->getDataPtr();
+	for(int q = 0; q < numQuads; q++) {
+		const quint16 v = (quint16)(q * 4);
+		*data++ = v; // Top-left
+		*data++ = v + 1; // Top-right
+		*data++ = v + 2; // Bottom-left
+		*data++ = v + 2; // Bottom-left
+		*data++ = v + 1; // Top-right
+		*data++ = v + 3; // Bottom-right
+	}
 
 	outBuf->setDirty(true);
 	return true;
 }
 
+/// <summary>
+/// Rescales the image on the CPU to the specified size. `GfxBicubicFilter` and
+/// `GfxLanczosFilter` use the same kernels as `prepareTexture()` does on the
+/// GPU and should be used for image data that is already in system memory so
+/// that it doesn't need to be uploaded at full size. Downscaling with
+/// `GfxBilinearFilter` averages the exact area that each output pixel covers
+/// in a single pass over the source image.
+/// </summary>
+/// <returns>A null image on failure.</returns>
+QImage GraphicsContext::scaleImage(
+	const QImage &img, const QSize &size, VidgfxFilter filter)
+{
+	return ImageScaler::scale(img, size, filter);
+}
+
+/// <summary>
+/// Returns a copy of the image with the orientation applied. Rotated images
+/// have their width and height swapped.
+/// </summary>
+/// <returns>A null image on failure.</returns>
+QImage GraphicsContext::orientImage(
+	const QImage &img, VidgfxOrientation orient)
+{
+	return ImageOrient::orientImage(img, orient);
+}
+
+/// <summary>
+/// Samples a 32-bit image on the CPU with the same filtering and addressing
+/// as the GPU would use for a texture of the same image.
+/// </summary>
+quint32 GraphicsContext::sampleImage(
+	const QImage &img, const QPointF &uv, VidgfxFilter filter,
+	VidgfxAddressMode mode)
+{
+	return ImageSampler::sample(img, uv, filter, mode);
+}
+
 /// <summary>
 /// Return the smallest power-of-two that's equal or greater than `n`. Valid
 /// for unsigned 32-bit integer inputs only.
@@ -1200,6 +1779,103 @@ QMatrix4x4 GraphicsContext::getScreenProjectionMatrix() const
 	return m_screenProjMat;
 }
 
+/// <summary>
+/// Returns the area of the scene that is visible in the currently selected
+/// render target based on its view and projection matrices. As the viewport
+/// always covers the entire target this is the bounding rectangle of the
+/// normalised device coordinate range in scene space. Returns a null
+/// rectangle if the matrices cannot be inverted.
+/// </summary>
+QRectF GraphicsContext::getVisibleRect()
+{
+	const QMatrix4x4 viewMat = getViewMatrix();
+	const QMatrix4x4 projMat = getProjectionMatrix();
+	if(m_cullVisibleRectValid && m_cullViewMat == viewMat &&
+		m_cullProjMat == projMat)
+	{
+		return m_cullVisibleRect; // Matrices haven't changed
+	}
+	m_cullViewMat = viewMat;
+	m_cullProjMat = projMat;
+	m_cullVisibleRectValid = true;
+	m_cullVisibleRect = QRectF();
+
+	bool invertible = false;
+	const QMatrix4x4 invMat = (projMat * viewMat).inverted(&invertible);
+	if(!invertible)
+		return m_cullVisibleRect;
+	const QPointF corners[4] = {
+		invMat.map(QPointF(-1.0, -1.0)),
+		invMat.map(QPointF(1.0, -1.0)),
+		invMat.map(QPointF(-1.0, 1.0)),
+		invMat.map(QPointF(1.0, 1.0))
+	};
+	QPointF tl = corners[0];
+	QPointF br = corners[0];
+	for(int i = 1; i < 4; i++) {
+		tl.setX(qMin(tl.x(), corners[i].x()));
+		tl.setY(qMin(tl.y(), corners[i].y()));
+		br.setX(qMax(br.x(), corners[i].x()));
+		br.setY(qMax(br.y(), corners[i].y()));
+	}
+	m_cullVisibleRect = QRectF(tl, br);
+
+	return m_cullVisibleRect;
+}
+
+/// <summary>
+/// Tests if any part of `rect` is visible in the currently selected render
+/// target. Always returns `GfxRectVisible` if culling is disabled. The result
+/// is only valid for the current target and view so it must be tested again
+/// every frame instead of being baked into geometry that is reused.
+/// </summary>
+VidgfxCullResult GraphicsContext::cullRect(const QRectF &rect)
+{
+	if(!m_cullingEnabled)
+		return GfxRectVisible;
+	const QRectF visRect = getVisibleRect();
+	if(visRect.isNull())
+		return GfxRectVisible; // Visible area is unknown
+
+	m_cullStats.num_tested++;
+	if(visRect.intersects(rect.normalized()))
+		return GfxRectVisible;
+	m_cullStats.num_culled++;
+	return GfxRectCulled;
+}
+
+/// <summary>
+/// Clips a texture decal rectangle to the visible area of the currently
+/// selected render target, see `clipTexDecalRect()`. Does nothing and returns
+/// `GfxRectVisible` if culling is disabled. Like `cullRect()` this must be
+/// done every frame by the caller.
+/// </summary>
+VidgfxCullResult GraphicsContext::cullTexDecalRect(
+	QRectF *rect, QPointF *tlUv, QPointF *trUv, QPointF *blUv, QPointF *brUv)
+{
+	if(!m_cullingEnabled)
+		return GfxRectVisible;
+	const QRectF visRect = getVisibleRect();
+	if(visRect.isNull())
+		return GfxRectVisible; // Visible area is unknown
+
+	m_cullStats.num_tested++;
+	VidgfxCullResult res =
+		clipTexDecalRect(visRect, rect, tlUv, trUv, blUv, brUv);
+	if(res == GfxRectCulled)
+		m_cullStats.num_culled++;
+	else if(res == GfxRectClipped)
+		m_cullStats.num_clipped++;
+	return res;
+}
+
+void GraphicsContext::resetCullStats()
+{
+	m_cullStats.num_tested = 0;
+	m_cullStats.num_culled = 0;
+	m_cullStats.num_clipped = 0;
+}
+
 void GraphicsContext::setUserRenderTarget(Texture *texA, Texture *texB)
 {
 	if((texA != NULL && !texA->isTargetable()) ||
@@ -1230,6 +1906,54 @@ void GraphicsContext::setResizeLayerRect(const QRectF &rect)
 	m_resizeRect = rect;
 }
 
+/// <summary>
+/// Sets the rectangle that `GfxResizeGizmoShader` places the geometry of
+/// `createResizeGizmo()` at.
+/// </summary>
+void GraphicsContext::setResizeGizmoRect(const QRectF &rect)
+{
+	if(m_resizeGizmoRect != rect)
+		m_resizeConstantsDirty = true;
+	m_resizeGizmoRect = rect;
+}
+
+/// <summary>
+/// Draws the resize layer graphic around `rect` using a cached vertex buffer
+/// that is only regenerated when the handle size or line width changes.
+/// Moving or resizing the rectangle only updates a shader constant. The
+/// caller must have set the texture and resize layer rectangle as for
+/// `GfxResizeLayerShader`. Changes the context's shader and topology.
+/// </summary>
+void GraphicsContext::drawResizeGizmo(
+	const QRectF &rect, float handleSize, const QPointF &halfWidth)
+{
+	if(!isValid())
+		return; // Context must be initialized
+
+	// Create or update the cached geometry if required
+	if(m_resizeGizmoBuf == NULL) {
+		m_resizeGizmoBuf = createVertexBuffer(
+			ResizeGizmoNumFloats, GfxWriteThroughStorage);
+		if(m_resizeGizmoBuf == NULL)
+			return; // Failed to create vertex buffer
+		m_resizeGizmoBufValid = false;
+	}
+	if(!m_resizeGizmoBufValid || m_resizeGizmoHandleSize != handleSize ||
+		m_resizeGizmoHalfWidth != halfWidth)
+	{
+		if(!createResizeGizmo(m_resizeGizmoBuf, handleSize, halfWidth))
+			return;
+		m_resizeGizmoBufValid = true;
+		m_resizeGizmoHandleSize = handleSize;
+		m_resizeGizmoHalfWidth = halfWidth;
+	}
+
+	setResizeGizmoRect(rect);
+	setShader(GfxResizeGizmoShader);
+	setTopology(GfxQuadListTopology);
+	drawBuffer(m_resizeGizmoBuf);
+}
+
 void GraphicsContext::setRgbNv16PxSize(const QPointF &size)
 {
 	if(m_rgbNv16PxSize != size)
@@ -1311,6 +2035,12 @@ bool GraphicsContext::setTexDecalEffectsHelper(
 /// a perfect 1:1 pixel mapping to the screen. This is because bilinear
 /// filtering uses the invalid colour information of the transparent pixels
 /// when interpolating.
+///
+/// Dilution is not required for images that are only ever downscaled using
+/// `prepareTexture()` as textures that have an alpha channel are resampled
+/// with premultiplied alpha which ignores the colour of transparent pixels.
+/// It is still required when the image is magnified or rendered at a
+/// fractional offset.
 /// </summary>
 /// <returns>True if the image was successfully diluted</returns>
 bool GraphicsContext::diluteImage(QImage &img) const
@@ -1361,6 +2091,147 @@ bool GraphicsContext::diluteImage(QImage &img) const
 	return true;
 }
 
+/// <summary>
+/// Releases all textures that are cached by `prepareTexture()`. Backends must
+/// call this before releasing their hardware resources.
+/// </summary>
+void GraphicsContext::clearMipCache()
+{
+	for(int i = 0; i < m_mipCache.size(); i++) {
+		Texture *tex = m_mipCache[i].tex;
+		m_mipCache[i].tex = NULL;
+		m_mipCache[i].srcTex = NULL;
+		if(tex != NULL)
+			deleteTexture(tex);
+	}
+	m_mipCache.clear();
+}
+
+/// <summary>
+/// Returns the mipmap cache entry that matches the specified parameters,
+/// creating a new entry by recycling the least recently used one if required.
+/// If the source texture has been modified since the entry was last used then
+/// its cached texture is released. An entry only contains a texture once the
+/// source has been prepared at least twice without being modified in-between
+/// so that textures that change every frame, such as video, never waste
+/// memory or bandwidth on the cache.
+///
+/// WARNING: The returned pointer is only valid until the next call to this
+/// method.
+/// </summary>
+/// <returns>NULL if the texture cannot be cached.</returns>
+GraphicsContext::MipCacheEntry *GraphicsContext::getMipCacheEntry(
+	Texture *srcTex, const QRect &cropRect, const QSize &size,
+	VidgfxFilter filter)
+{
+	if(srcTex == NULL || srcTex->isExternal())
+		return NULL; // We cannot track modifications of external textures
+	m_mipCacheCounter++;
+
+	// Search for an existing entry while remembering which one to replace
+	int freeSlot = -1;
+	int lruSlot = -1;
+	for(int i = 0; i < m_mipCache.size(); i++) {
+		MipCacheEntry &entry = m_mipCache[i];
+		if(entry.srcTex == NULL) {
+			if(freeSlot < 0)
+				freeSlot = i;
+			continue;
+		}
+		if(entry.srcTex != srcTex || entry.cropRect != cropRect ||
+			entry.size != size || entry.filter != filter)
+		{
+			if(lruSlot < 0 || entry.lastUsed < m_mipCache.at(lruSlot).lastUsed)
+				lruSlot = i;
+			continue;
+		}
+
+		// Found a match, invalidate it if the source has changed
+		entry.lastUsed = m_mipCacheCounter;
+		if(entry.srcGeneration == srcTex->getGeneration()) {
+			entry.numHits++;
+			return &entry;
+		}
+		entry.srcGeneration = srcTex->getGeneration();
+		entry.numHits = 0;
+		entry.relTexSize = QPointF(1.0f, 1.0f);
+		entry.isCropped = false;
+		if(entry.tex != NULL) {
+			Texture *tex = entry.tex;
+			entry.tex = NULL;
+			deleteTexture(tex); // Never reallocates the list
+		}
+		return &entry;
+	}
+
+	// No match, create a new entry
+	int replace = freeSlot;
+	if(replace < 0 && m_mipCache.size() < MipCacheMaxEntries) {
+		m_mipCache.append(MipCacheEntry());
+		replace = m_mipCache.size() - 1;
+	} else if(replace < 0) {
+		replace = lruSlot;
+		Texture *tex = m_mipCache.at(replace).tex;
+		m_mipCache[replace].tex = NULL;
+		m_mipCache[replace].srcTex = NULL;
+		if(tex != NULL)
+			deleteTexture(tex);
+	}
+	MipCacheEntry &entry = m_mipCache[replace];
+	entry.srcTex = srcTex;
+	entry.srcGeneration = srcTex->getGeneration();
+	entry.cropRect = cropRect;
+	entry.size = size;
+	entry.filter = filter;
+	entry.numHits = 0;
+	entry.lastUsed = m_mipCacheCounter;
+	entry.tex = NULL;
+	entry.relTexSize = QPointF(1.0f, 1.0f);
+	entry.isCropped = false;
+	return &entry;
+}
+
+/// <summary>
+/// Removes all mipmap cache entries that were generated from `srcTex` or that
+/// refer to `srcTex` as their cached texture. Must be called whenever a
+/// texture is about to be deleted as a new texture could be created at the
+/// same address.
+/// </summary>
+void GraphicsContext::purgeMipCache(Texture *srcTex)
+{
+	if(srcTex == NULL)
+		return;
+	for(int i = 0; i < m_mipCache.size(); i++) {
+		MipCacheEntry &entry = m_mipCache[i];
+		if(entry.tex == srcTex) {
+			entry.tex = NULL;
+			entry.srcTex = NULL;
+			continue;
+		}
+		if(entry.srcTex != srcTex)
+			continue;
+		Texture *tex = entry.tex;
+		entry.tex = NULL;
+		entry.srcTex = NULL;
+		if(tex != NULL)
+			deleteTexture(tex);
+	}
+}
+
+/// <summary>
+/// Increments the generation counter of all textures that are bound to the
+/// current render target. Backends must call this whenever they render to the
+/// current target.
+/// </summary>
+void GraphicsContext::markTargetModified()
+{
+	Texture *tex = getTargetTexture(m_currentTarget);
+	if(tex != NULL)
+		tex->bumpGeneration();
+	if(m_currentTarget == GfxUserTarget && m_userTargets[1] != NULL)
+		m_userTargets[1]->bumpGeneration();
+}
+
 void GraphicsContext::callInitializedCallbacks()
 {
 	for(int i = 0; i < m_initializedCallbackList.size(); i++) {
@@ -28,34 +28,72 @@ class QRectF;
 class QSize;
 
 //=============================================================================
-// TODO: It would be beter if this class behaved similarly to `Texture` by
-// having `map()` and `unmap()` methods instead of keeping a copy of the data
-// always in memory. However some functions such as `drawTextureRect()` rely
-// on the data being in memory as well.
+/// <summary>
+/// A buffer of vertex data. Like `Texture` the buffer must be mapped with
+/// `map()` before it is written to and unmapped with `unmap()` afterwards.
+/// Shadowed buffers keep a copy of the data in system memory that can be read
+/// back at any time and upload only the dirty ranges of it. Write-through
+/// buffers write directly into the hardware buffer and should be used
+/// whenever the caller doesn't need to read the data back.
+/// </summary>
 class VertexBuffer
 {
+public: // Datatypes ----------------------------------------------------------
+	struct DirtyRange {
+		int	firstFloat;
+		int	numFloats;
+	};
+
+public: // Constants ----------------------------------------------------------
+
+	// The maximum number of separate dirty ranges that are tracked. When more
+	// ranges are marked the two that are closest together are merged.
+	static const int	MaxDirtyRanges = 8;
+
 protected: // Members ---------------------------------------------------------
 	float *	m_data;
 	int		m_numFloats;
+	bool	m_isMapped;
 	int		m_numVerts;
 	int		m_vertSize;
 	bool	m_dirty;
 
+	VidgfxVertFormat	m_vertFormat;
+	VidgfxBufStorage	m_storage;
+
+	// Sorted and non-overlapping. One extra slot is used while merging.
+	DirtyRange	m_dirtyRanges[MaxDirtyRanges + 1];
+	int			m_numDirtyRanges;
+
 protected: // Constructor/destructor ------------------------------------------
-	VertexBuffer(int numFloats);
+	VertexBuffer(int numFloats, VidgfxBufStorage storage);
 	virtual ~VertexBuffer();
 
 public: // Methods ------------------------------------------------------------
 	float *	getDataPtr() const;
 	int		getNumFloats() const;
+	VidgfxBufStorage	getStorage() const;
+	bool	isMapped() const;
 
 	void	setNumVerts(int numVerts);
 	int		getNumVerts() const;
 	void	setVertSize(int vertSize);
 	int		getVertSize() const;
+	void	setVertFormat(VidgfxVertFormat format);
+	VidgfxVertFormat	getVertFormat() const;
 
 	void	setDirty(bool dirty = true);
 	bool	isDirty() const;
+	void	markDirty(int firstFloat, int numFloats);
+	int		getNumDirtyRanges() const;
+	const DirtyRange *	getDirtyRanges() const;
+
+private:
+	void	mergeClosestDirtyRanges();
+
+public: // Interface ----------------------------------------------------------
+	virtual float *	map() = 0;
+	virtual void	unmap() = 0;
 };
 //=============================================================================
 
@@ -69,6 +107,16 @@ inline int VertexBuffer::getNumFloats() const
 	return m_numFloats;
 }
 
+inline VidgfxBufStorage VertexBuffer::getStorage() const
+{
+	return m_storage;
+}
+
+inline bool VertexBuffer::isMapped() const
+{
+	return m_isMapped;
+}
+
 inline void VertexBuffer::setNumVerts(int numVerts)
 {
 	m_numVerts = numVerts;
@@ -89,9 +137,14 @@ inline int VertexBuffer::getVertSize() const
 	return m_vertSize;
 }
 
-inline void VertexBuffer::setDirty(bool dirty)
+inline void VertexBuffer::setVertFormat(VidgfxVertFormat format)
 {
-	m_dirty = dirty;
+	m_vertFormat = format;
+}
+
+inline VidgfxVertFormat VertexBuffer::getVertFormat() const
+{
+	return m_vertFormat;
 }
 
 inline bool VertexBuffer::isDirty() const
@@ -99,17 +152,91 @@ inline bool VertexBuffer::isDirty() const
 	return m_dirty;
 }
 
+inline int VertexBuffer::getNumDirtyRanges() const
+{
+	return m_numDirtyRanges;
+}
+
+inline const VertexBuffer::DirtyRange *VertexBuffer::getDirtyRanges() const
+{
+	return m_dirtyRanges;
+}
+
+//=============================================================================
+/// <summary>
+/// A buffer of 16-bit vertex indices. Like `VertexBuffer` a copy of the data
+/// is always kept in system memory and is uploaded when the buffer is dirty.
+/// </summary>
+class IndexBuffer
+{
+protected: // Members ---------------------------------------------------------
+	quint16 *	m_data;
+	int			m_maxIndices;
+	int			m_numIndices;
+	bool		m_dirty;
+
+protected: // Constructor/destructor ------------------------------------------
+	IndexBuffer(int maxIndices);
+	virtual ~IndexBuffer();
+
+public: // Methods ------------------------------------------------------------
+	quint16 *	getDataPtr() const;
+	int			getMaxIndices() const;
+
+	void		setNumIndices(int numIndices);
+	int			getNumIndices() const;
+
+	void		setDirty(bool dirty = true);
+	bool		isDirty() const;
+};
+//=============================================================================
+
+inline quint16 *IndexBuffer::getDataPtr() const
+{
+	return m_data;
+}
+
+inline int IndexBuffer::getMaxIndices() const
+{
+	return m_maxIndices;
+}
+
+inline void IndexBuffer::setNumIndices(int numIndices)
+{
+	m_numIndices = numIndices;
+}
+
+inline int IndexBuffer::getNumIndices() const
+{
+	return m_numIndices;
+}
+
+inline void IndexBuffer::setDirty(bool dirty)
+{
+	m_dirty = dirty;
+}
+
+inline bool IndexBuffer::isDirty() const
+{
+	return m_dirty;
+}
+
 //=============================================================================
 /// <summary>
 /// A vertex buffer helper class for rendering rectangles that have a single
 /// decal texture. It is up to the user to either call `deleteVertBuf()` or
-/// delete the whole object when the graphics context is released.
+/// delete the whole object when the graphics context is released. Scrolling
+/// rectangles are split into 4 quads by default. If wrap addressing is
+/// enabled with `setUseWrapAddressing()` then scrolling rectangles that
+/// display exactly one repeat of the texture are instead rendered as a single
+/// quad with offset UVs that must be sampled with the address mode returned
+/// by `getAddressMode()`.
 /// </summary>
 class TexDecalVertBuf
 {
 private: // Constants ---------------------------------------------------------
 
-	// Buffer information for `createTexDecalRect()` (1 vertex = 8 floats)
+	// Buffer information for `createScrollTexDecalRect()` (1 vertex = 8 floats)
 	static const int	ScrollRectNumVerts = VIDGFX_SCROLL_RECT_NUM_VERTS;
 	static const int	ScrollRectNumFloats = VIDGFX_SCROLL_RECT_NUM_FLOATS;
 	static const int	ScrollRectBufSize = VIDGFX_SCROLL_RECT_BUF_SIZE;
@@ -126,6 +253,7 @@ protected: // Members ---------------------------------------------------------
 	// Scrolling
 	QPointF	m_scrollOffset; // In `m_rect` space
 	bool	m_roundOffset;
+	bool	m_useWrapAddressing;
 
 	// Texture UV
 	QPointF	m_tlUv;
@@ -141,6 +269,7 @@ public: // Methods ------------------------------------------------------------
 	void			setContext(GraphicsContext *context);
 	VertexBuffer *	getVertBuf(); // Applies settings
 	VidgfxTopology	getTopology() const;
+	VidgfxAddressMode	getAddressMode() const;
 	void			deleteVertBuf();
 
 	// Position
@@ -153,6 +282,8 @@ public: // Methods ------------------------------------------------------------
 	void	resetScrolling();
 	void	setRoundOffset(bool round);
 	bool	getRoundOffset() const;
+	void	setUseWrapAddressing(bool useWrap);
+	bool	getUseWrapAddressing() const;
 
 	// Texture UV
 	void	setTextureUv(
@@ -167,7 +298,14 @@ public: // Methods ------------------------------------------------------------
 		QPointF *topLeft, QPointF *topRight, QPointF *botLeft,
 		QPointF *botRight) const;
 
+public: // Static methods -----------------------------------------------------
+	static bool	isWrappableUv(
+		const QPointF &tlUv, const QPointF &trUv, const QPointF &blUv,
+		const QPointF &brUv);
+
 private:
+	bool	isWrapScrolling() const;
+	QPointF	getScrollLerp() const;
 	bool	createScrollTexDecalRect(VertexBuffer *outBuf);
 	int		writeScrollRect(
 		float *data, int i, const QRectF &rect, const QPointF &tlUv,
@@ -195,6 +333,11 @@ inline bool TexDecalVertBuf::getRoundOffset() const
 	return m_roundOffset;
 }
 
+inline bool TexDecalVertBuf::getUseWrapAddressing() const
+{
+	return m_useWrapAddressing;
+}
+
 inline void TexDecalVertBuf::setTextureUv(
 	const QPointF &topLeft, const QPointF &botRight, VidgfxOrientation orient)
 {
@@ -210,6 +353,8 @@ protected: // Members ---------------------------------------------------------
 	void *			m_mappedData;
 	QSize			m_size;
 	int				m_stride;
+	quint32			m_generation;
+	int				m_mipLevels;
 
 protected: // Constructor/destructor ------------------------------------------
 	Texture(VidgfxTexFlags flags, const QSize &size);
@@ -224,11 +369,19 @@ public: // Methods ------------------------------------------------------------
 	bool			isWritable() const;
 	bool			isTargetable() const;
 	bool			isStaging() const;
+	bool			isExternal() const;
+	bool			hasAlpha() const;
+	void			setHasAlpha(bool hasAlpha);
 	QSize			getSize() const;
 	int				getWidth() const;
 	int				getHeight() const;
+	int				getMipLevels() const;
+
+	void			updateData(
+		const QImage &img, VidgfxOrientation orient = GfxUnchangedOrient);
 
-	void			updateData(const QImage &img);
+	quint32			getGeneration() const;
+	void			bumpGeneration();
 
 public: // Interface ----------------------------------------------------------
 	virtual void *	map() = 0;
@@ -273,6 +426,36 @@ inline bool Texture::isStaging() const
 	return m_flags & GfxStagingFlag;
 }
 
+/// <summary>
+/// Returns true if the texture's content can be modified outside of our
+/// control (E.g. shared textures) and therefore its generation counter cannot
+/// be trusted.
+/// </summary>
+inline bool Texture::isExternal() const
+{
+	return m_flags & GfxExternalFlag;
+}
+
+/// <summary>
+/// Returns true if the texture's alpha channel contains meaningful coverage
+/// information. The colour of fully transparent pixels in such textures is
+/// ignored when the texture is downscaled so that it doesn't bleed into the
+/// visible pixels. Textures created from images that have an alpha channel
+/// have this set automatically.
+/// </summary>
+inline bool Texture::hasAlpha() const
+{
+	return m_flags & GfxAlphaFlag;
+}
+
+inline void Texture::setHasAlpha(bool hasAlpha)
+{
+	if(hasAlpha)
+		m_flags |= GfxAlphaFlag;
+	else
+		m_flags &= ~GfxAlphaFlag;
+}
+
 inline QSize Texture::getSize() const
 {
 	return m_size;
@@ -288,6 +471,30 @@ inline int Texture::getHeight() const
 	return m_size.height();
 }
 
+/// <summary>
+/// Returns the number of mipmap levels that the texture contains including the
+/// full size level. Only textures created with `createMipmappedTexture()` have
+/// more than one level.
+/// </summary>
+inline int Texture::getMipLevels() const
+{
+	return m_mipLevels;
+}
+
+/// <summary>
+/// Returns a counter that is incremented every time the texture's content is
+/// modified. Used to determine if data derived from the texture is stale.
+/// </summary>
+inline quint32 Texture::getGeneration() const
+{
+	return m_generation;
+}
+
+inline void Texture::bumpGeneration()
+{
+	m_generation++;
+}
+
 //=============================================================================
 class GraphicsContext : public QObject
 {
@@ -314,6 +521,23 @@ private: // Datatypes ---------------------------------------------------------
 	};
 	typedef QVector<DestroyingCallback> DestroyingCallbackList;
 
+protected: // Datatypes -------------------------------------------------------
+	struct MipCacheEntry {
+		Texture *		srcTex; // NULL if the entry is unused
+		quint32			srcGeneration;
+		QRect			cropRect;
+		QSize			size;
+		VidgfxFilter	filter;
+		int				numHits; // Consecutive requests with unchanged source
+		quint32			lastUsed;
+
+		// Only created once the source texture appears to be static
+		Texture *		tex;
+		QPointF			relTexSize;
+		bool			isCropped; // `tex` only contains the cropped area
+	};
+	typedef QVector<MipCacheEntry> MipCacheList;
+
 public: // Constants ----------------------------------------------------------
 
 	// The number of vertices required to represent one line
@@ -337,11 +561,65 @@ public: // Constants ----------------------------------------------------------
 	static const int	TexDecalRectNumFloats = VIDGFX_TEX_DECAL_RECT_NUM_FLOATS;
 	static const int	TexDecalRectBufSize = VIDGFX_TEX_DECAL_RECT_BUF_SIZE;
 
+	// Buffer information for `createSolidRectCompact()` (1 vertex = 3 floats)
+	static const int	SolidRectCompactNumFloats =
+		VIDGFX_SOLID_RECT_COMPACT_NUM_FLOATS;
+	static const int	SolidRectCompactBufSize =
+		VIDGFX_SOLID_RECT_COMPACT_BUF_SIZE;
+
+	// Buffer information for `createSolidRectOutlineCompact()` (1 vertex = 3
+	// floats)
+	static const int	SolidRectOutlineCompactNumFloats =
+		VIDGFX_SOLID_RECT_OUTLINE_COMPACT_NUM_FLOATS;
+	static const int	SolidRectOutlineCompactBufSize =
+		VIDGFX_SOLID_RECT_OUTLINE_COMPACT_BUF_SIZE;
+
+	// Buffer information for `createTexDecalRectCompact()` (1 vertex = 4
+	// floats, or 3 floats if the UVs are 16-bit UNORM)
+	static const int	TexDecalRectCompactNumFloats =
+		VIDGFX_TEX_DECAL_RECT_COMPACT_NUM_FLOATS;
+	static const int	TexDecalRectCompactBufSize =
+		VIDGFX_TEX_DECAL_RECT_COMPACT_BUF_SIZE;
+
 	// Buffer information for `createResizeRect()` (1 vertex = 4 floats)
 	static const int	ResizeRectNumVerts = VIDGFX_RESIZE_RECT_NUM_VERTS;
 	static const int	ResizeRectNumFloats = VIDGFX_RESIZE_RECT_NUM_FLOATS;
 	static const int	ResizeRectBufSize = VIDGFX_RESIZE_RECT_BUF_SIZE;
 
+	// Buffer information for `createResizeGizmo()` (1 vertex = 4 floats)
+	static const int	ResizeGizmoNumVerts = VIDGFX_RESIZE_GIZMO_NUM_VERTS;
+	static const int	ResizeGizmoNumFloats = VIDGFX_RESIZE_GIZMO_NUM_FLOATS;
+	static const int	ResizeGizmoBufSize = VIDGFX_RESIZE_GIZMO_BUF_SIZE;
+
+	// Buffer information for `createLayerInstances()` (1 instance = 16
+	// floats)
+	static const int	LayerInstNumFloats = VIDGFX_LAYER_INST_NUM_FLOATS;
+	static const int	LayerInstBufSize = VIDGFX_LAYER_INST_BUF_SIZE;
+	static const int	MaxLayerInstTextures = VIDGFX_MAX_LAYER_INST_TEXTURES;
+
+	// Buffer information for `createNineSliceRect()` (1 vertex = 8 floats)
+	static const int	NineSliceNumVerts = VIDGFX_NINE_SLICE_NUM_VERTS;
+	static const int	NineSliceNumFloats = VIDGFX_NINE_SLICE_NUM_FLOATS;
+	static const int	NineSliceBufSize = VIDGFX_NINE_SLICE_BUF_SIZE;
+
+	// Buffer information for `createNineSliceGrid()` (1 vertex = 8 floats)
+	static const int	NineSliceGridNumVerts =
+		VIDGFX_NINE_SLICE_GRID_NUM_VERTS;
+	static const int	NineSliceGridNumFloats =
+		VIDGFX_NINE_SLICE_GRID_NUM_FLOATS;
+	static const int	NineSliceGridBufSize = VIDGFX_NINE_SLICE_GRID_BUF_SIZE;
+	static const int	NineSliceNumIndices = VIDGFX_NINE_SLICE_NUM_INDICES;
+
+	// Size of the shared index buffer for `GfxQuadListTopology`
+	static const int	MaxQuadsPerDraw = VIDGFX_MAX_QUADS_PER_DRAW;
+	static const int	QuadIdxBufNumIndices = VIDGFX_QUAD_IDX_BUF_NUM_INDICES;
+
+	// Size of the transient vertex ring
+	static const int	TransientBufNumFloats = VIDGFX_TRANSIENT_BUF_NUM_FLOATS;
+
+	// The maximum number of prepared textures that are kept between frames
+	static const int	MipCacheMaxEntries = 32;
+
 protected: // Members ---------------------------------------------------------
 	VidgfxRendTarget	m_currentTarget;
 
@@ -355,12 +633,26 @@ protected: // Members ---------------------------------------------------------
 	QMatrix4x4		m_userProjMat;
 	bool			m_cameraConstantsDirty;
 
+	bool			m_cullingEnabled;
+	VidgfxCullStats	m_cullStats;
+	QMatrix4x4		m_cullViewMat; // Matrices of `m_cullVisibleRect`
+	QMatrix4x4		m_cullProjMat;
+	QRectF			m_cullVisibleRect;
+	bool			m_cullVisibleRectValid;
+
 	Texture *		m_userTargets[2];
 	QRect			m_userTargetViewport;
 
 	QRectF			m_resizeRect;
+	QRectF			m_resizeGizmoRect;
 	bool			m_resizeConstantsDirty;
 
+	// Cached `createResizeGizmo()` geometry
+	VertexBuffer *	m_resizeGizmoBuf;
+	bool			m_resizeGizmoBufValid;
+	float			m_resizeGizmoHandleSize;
+	QPointF			m_resizeGizmoHalfWidth;
+
 	QPointF			m_rgbNv16PxSize;
 	bool			m_rgbNv16ConstantsDirty;
 
@@ -368,6 +660,11 @@ protected: // Members ---------------------------------------------------------
 	float			m_texDecalEffects[4]; // Gamma, brightness, contrast, saturation
 	bool			m_texDecalConstantsDirty;
 
+	MipCacheList	m_mipCache;
+	quint32			m_mipCacheCounter;
+
+	IndexBuffer *	m_quadIdxBuf;
+
 	InitializedCallbackList	m_initializedCallbackList;
 	DestroyingCallbackList	m_destroyingCallbackList;
 
@@ -394,13 +691,94 @@ public: // Static methods -----------------------------------------------------
 		VertexBuffer *outBuf, const QRectF &rect, const QPointF &tlUv,
 		const QPointF &trUv, const QPointF &blUv, const QPointF &brUv);
 
+	static bool		createSolidRectCompact(
+		VertexBuffer *outBuf, const QRectF &rect, const QColor &col);
+	static bool		createSolidRectCompact(
+		VertexBuffer *outBuf, const QRectF &rect, const QColor &tlCol,
+		const QColor &trCol, const QColor &blCol, const QColor &brCol);
+
+	static bool		createSolidRectOutlineCompact(
+		VertexBuffer *outBuf, const QRectF &rect, const QColor &col,
+		const QPointF &halfWidth = QPointF(0.5f, 0.5f));
+	static bool		createSolidRectOutlineCompact(
+		VertexBuffer *outBuf, const QRectF &rect, const QColor &tlCol,
+		const QColor &trCol, const QColor &blCol, const QColor &brCol,
+		const QPointF &halfWidth = QPointF(0.5f, 0.5f));
+
+	static bool		createTexDecalRectCompact(
+		VertexBuffer *outBuf, const QRectF &rect, bool unormUv = false);
+	static bool		createTexDecalRectCompact(
+		VertexBuffer *outBuf, const QRectF &rect, const QPointF &tlUv,
+		const QPointF &trUv, const QPointF &blUv, const QPointF &brUv,
+		bool unormUv = false);
+
+	static int		writeTexDecalRect(
+		float *data, const QRectF &rect, const QPointF &tlUv,
+		const QPointF &trUv, const QPointF &blUv, const QPointF &brUv);
+
+	static bool		createTransformedSolidRects(
+		VertexBuffer *outBuf, const QRectF *rects,
+		const QTransform *transforms, int numRects, const QColor *cols);
+	static bool		createTransformedTexDecalRects(
+		VertexBuffer *outBuf, const QRectF *rects,
+		const QTransform *transforms, int numRects,
+		const QPointF *uvs = NULL);
+
+	static bool		createNineSliceRect(
+		VertexBuffer *outBuf, const VidgfxNineSlice &slice);
+	static bool		createNineSliceGrid(
+		VertexBuffer *outBuf, const VidgfxNineSlice &slice);
+	static bool		createNineSliceIndices(IndexBuffer *outBuf);
+	static void		calcNineSliceLines(
+		const VidgfxNineSlice &slice, float *xs, float *ys, float *us,
+		float *vs);
+
+	static bool		createSolidPolyline(
+		VertexBuffer *outBuf, const QPointF *points, int numPoints,
+		const QColor &col, float halfWidth = 0.5f,
+		VidgfxLineJoin join = GfxMiterJoin, bool closed = false);
+	static bool		createSolidPolyline(
+		VertexBuffer *outBuf, const QPointF *points, int numPoints,
+		const QColor *cols, float halfWidth = 0.5f,
+		VidgfxLineJoin join = GfxMiterJoin, bool closed = false);
+
 	static bool		createResizeRect(
 		VertexBuffer *outBuf, const QRectF &rect, float handleSize,
 		const QPointF &halfWidth = QPointF(0.5f, 0.5f));
 
+	static VidgfxCullResult	clipTexDecalRect(
+		const QRectF &clipRect, QRectF *rect, QPointF *tlUv, QPointF *trUv,
+		QPointF *blUv, QPointF *brUv);
+
+	static bool		createResizeGizmo(
+		VertexBuffer *outBuf, float handleSize,
+		const QPointF &halfWidth = QPointF(0.5f, 0.5f));
+
+	static bool		createLayerInstances(
+		VertexBuffer *outBuf, const VidgfxLayerInstance *instances,
+		int numInstances);
+	static int		writeLayerInstances(
+		float *data, const VidgfxLayerInstance *instances,
+		int numInstances);
+
+	static bool		createQuadIndices(IndexBuffer *outBuf, int numQuads);
+
+	static QImage	scaleImage(
+		const QImage &img, const QSize &size, VidgfxFilter filter);
+	static QImage	orientImage(const QImage &img, VidgfxOrientation orient);
+	static quint32	sampleImage(
+		const QImage &img, const QPointF &uv, VidgfxFilter filter,
+		VidgfxAddressMode mode = GfxClampAddressing);
+
 	// Helpers
 	static quint32	nextPowTwo(quint32 n);
 
+private:
+	static bool		createPolyline(
+		VertexBuffer *outBuf, const QPointF *points, int numPoints,
+		const QColor *cols, bool colPerPoint, float halfWidth,
+		VidgfxLineJoin join, bool closed);
+
 public: // Constructor/destructor ---------------------------------------------
 	GraphicsContext();
 	virtual ~GraphicsContext();
@@ -416,6 +794,16 @@ public: // Methods ------------------------------------------------------------
 	void			setScreenProjectionMatrix(const QMatrix4x4 &matrix);
 	QMatrix4x4		getScreenProjectionMatrix() const;
 
+	void			setCullingEnabled(bool enabled);
+	bool			isCullingEnabled() const;
+	QRectF			getVisibleRect();
+	VidgfxCullResult	cullRect(const QRectF &rect);
+	VidgfxCullResult	cullTexDecalRect(
+		QRectF *rect, QPointF *tlUv, QPointF *trUv, QPointF *blUv,
+		QPointF *brUv);
+	VidgfxCullStats	getCullStats() const;
+	void			resetCullStats();
+
 	void			setUserRenderTarget(Texture *texA, Texture *texB = NULL);
 	Texture *		getUserRenderTarget(int index) const;
 	void			setUserRenderTargetViewport(const QRect &rect);
@@ -424,6 +812,11 @@ public: // Methods ------------------------------------------------------------
 
 	void			setResizeLayerRect(const QRectF &rect);
 	QRectF			getResizeLayerRect() const;
+	void			setResizeGizmoRect(const QRectF &rect);
+	QRectF			getResizeGizmoRect() const;
+	void			drawResizeGizmo(
+		const QRectF &rect, float handleSize,
+		const QPointF &halfWidth = QPointF(0.5f, 0.5f));
 
 	void			setRgbNv16PxSize(const QPointF &size);
 	QPointF			getRgbNv16PxSize() const;
@@ -439,13 +832,27 @@ public: // Methods ------------------------------------------------------------
 
 	bool			diluteImage(QImage &img) const;
 
+	IndexBuffer *	getQuadIndexBuffer() const;
+
+	void			clearMipCache();
+
+protected:
+	MipCacheEntry *	getMipCacheEntry(
+		Texture *srcTex, const QRect &cropRect, const QSize &size,
+		VidgfxFilter filter);
+	void			purgeMipCache(Texture *srcTex);
+	void			markTargetModified();
+
 public: // Interface ----------------------------------------------------------
 	virtual bool	isValid() const = 0;
 	virtual void	flush() = 0;
 
 	// Buffers
-	virtual VertexBuffer *	createVertexBuffer(int size) = 0;
+	virtual VertexBuffer *	createVertexBuffer(
+		int size, VidgfxBufStorage storage = GfxShadowedStorage) = 0;
 	virtual void			deleteVertexBuffer(VertexBuffer *buf) = 0;
+	virtual IndexBuffer *	createIndexBuffer(int numIndices) = 0;
+	virtual void			deleteIndexBuffer(IndexBuffer *buf) = 0;
 	virtual Texture *		createTexture(
 		QImage img, bool writable = false, bool targetable = false) = 0;
 	virtual Texture *		createTexture(
@@ -454,6 +861,8 @@ public: // Interface ----------------------------------------------------------
 	virtual Texture *		createTexture(
 		const QSize &size, Texture *sameFormat, bool writable = false,
 		bool targetable = false) = 0;
+	virtual Texture *		createMipmappedTexture(
+		const QVector<QImage> &levels) = 0;
 	virtual Texture *		createStagingTexture(const QSize &size) = 0;
 	virtual void			deleteTexture(Texture *tex) = 0;
 	virtual bool			copyTextureData(
@@ -477,6 +886,9 @@ public: // Interface ----------------------------------------------------------
 		Texture *tex, const QRect &cropRect, const QSize &size,
 		VidgfxFilter filter, bool setFilter, QPointF &pxSizeOut,
 		QPointF &topLeftOut, QPointF &botRightOut) = 0;
+	virtual void		prepareTextureLadder(
+		Texture *tex, const QVector<QSize> &sizes, VidgfxFilter filter,
+		VidgfxContextLadderCallback *callback, void *opaque) = 0;
 	virtual Texture *	convertToBgrx(
 		VidgfxPixFormat format, Texture *planeA, Texture *planeB,
 		Texture *planeC) = 0;
@@ -488,10 +900,25 @@ public: // Interface ----------------------------------------------------------
 	virtual void		setBlending(VidgfxBlending blending) = 0;
 	virtual void		setTexture(
 		Texture *texA, Texture *texB = NULL, Texture *texC = NULL) = 0;
-	virtual void		setTextureFilter(VidgfxFilter filter) = 0;
+	virtual void		setTextureFilter(
+		VidgfxFilter filter, VidgfxAddressMode mode = GfxClampAddressing) = 0;
 	virtual void		clear(const QColor &color) = 0;
 	virtual void		drawBuffer(
 		VertexBuffer *buf, int numVertices = -1, int startVertex = 0) = 0;
+	virtual void		drawBuffer(
+		VertexBuffer *buf, IndexBuffer *idxBuf, int numIndices = -1,
+		int startIndex = 0, int baseVertex = 0) = 0;
+	virtual void		drawInstanced(
+		VertexBuffer *instBuf, int numInstances = -1,
+		int startInstance = 0) = 0;
+
+	// Transient geometry
+	virtual float *		allocTransientVerts(
+		int numVerts, int vertSize, VidgfxVertFormat format,
+		VidgfxTransientVerts *vertsOut) = 0;
+	virtual void		drawTransientVerts(
+		const VidgfxTransientVerts &verts) = 0;
+	virtual void		endFrame() = 0;
 
 public: // Signals ------------------------------------------------------------
 	void	callInitializedCallbacks();
@@ -512,6 +939,21 @@ Q_SIGNALS: // Signals ---------------------------------------------------------
 };
 //=============================================================================
 
+inline void GraphicsContext::setCullingEnabled(bool enabled)
+{
+	m_cullingEnabled = enabled;
+}
+
+inline bool GraphicsContext::isCullingEnabled() const
+{
+	return m_cullingEnabled;
+}
+
+inline VidgfxCullStats GraphicsContext::getCullStats() const
+{
+	return m_cullStats;
+}
+
 inline Texture *GraphicsContext::getUserRenderTarget(int index) const
 {
 	if(index < 0 || index > 1)
@@ -534,6 +976,11 @@ inline QRectF GraphicsContext::getResizeLayerRect() const
 	return m_resizeRect;
 }
 
+inline QRectF GraphicsContext::getResizeGizmoRect() const
+{
+	return m_resizeGizmoRect;
+}
+
 inline QPointF GraphicsContext::getRgbNv16PxSize() const
 {
 	return m_rgbNv16PxSize;
@@ -549,4 +996,15 @@ inline const float *GraphicsContext::getTexDecalEffects() const
 	return m_texDecalEffects;
 }
 
+/// <summary>
+/// Returns the shared index buffer that `GfxQuadListTopology` draws with. It
+/// contains the indices of `MaxQuadsPerDraw` quads where each quad is made
+/// from the top-left, top-right, bottom-left and bottom-right vertices in that
+/// order. NULL if the context is not initialized.
+/// </summary>
+inline IndexBuffer *GraphicsContext::getQuadIndexBuffer() const
+{
+	return m_quadIdxBuf;
+}
+
 #endif // GRAPHICSCONTEXT_H
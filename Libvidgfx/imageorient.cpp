@@ -0,0 +1,539 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#include "imageorient.h"
+#include <QtCore/QVector>
+#include <emmintrin.h>
+#include <string.h>
+
+//=============================================================================
+// Helpers
+
+/// <summary>
+/// Reverses the order of the pixels in an SSE2 register.
+/// </summary>
+template<int bpp>
+static inline __m128i reversePixels(__m128i v);
+
+template<>
+inline __m128i reversePixels<4>(__m128i v)
+{
+	return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+template<>
+inline __m128i reversePixels<2>(__m128i v)
+{
+	v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+	v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+	return _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+template<>
+inline __m128i reversePixels<1>(__m128i v)
+{
+	// SSE2 has no byte shuffle so swap the bytes in each 16-bit word first
+	v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+	return reversePixels<2>(v);
+}
+
+template<int bpp>
+static inline void copyPixel(const uchar *src, uchar *dst)
+{
+	memcpy(dst, src, bpp);
+}
+
+template<int bpp>
+static inline void swapPixels(uchar *a, uchar *b)
+{
+	uchar tmp[bpp];
+	memcpy(tmp, a, bpp);
+	memcpy(a, b, bpp);
+	memcpy(b, tmp, bpp);
+}
+
+/// <summary>
+/// Copies `width` pixels from `src` to `dst` in reverse order. The buffers
+/// must not overlap.
+/// </summary>
+template<int bpp>
+static void reverseRow(const uchar *src, uchar *dst, int width)
+{
+	const int n = 16 / bpp; // Pixels per register
+	int x = 0;
+	for(; x + n <= width; x += n) {
+		__m128i v = _mm_loadu_si128(
+			reinterpret_cast<const __m128i *>(src + x * bpp));
+		_mm_storeu_si128(
+			reinterpret_cast<__m128i *>(dst + (width - x - n) * bpp),
+			reversePixels<bpp>(v));
+	}
+	for(; x < width; x++)
+		copyPixel<bpp>(src + x * bpp, dst + (width - x - 1) * bpp);
+}
+
+/// <summary>
+/// Reverses the order of `width` pixels in place by working inwards from both
+/// ends of the row at the same time.
+/// </summary>
+template<int bpp>
+static void reverseRowInPlace(uchar *row, int width)
+{
+	const int n = 16 / bpp; // Pixels per register
+	int lo = 0;
+	int hi = width;
+	for(; hi - lo >= 2 * n; lo += n, hi -= n) {
+		__m128i *pLo = reinterpret_cast<__m128i *>(row + lo * bpp);
+		__m128i *pHi = reinterpret_cast<__m128i *>(row + (hi - n) * bpp);
+		__m128i a = _mm_loadu_si128(pLo);
+		__m128i b = _mm_loadu_si128(pHi);
+		_mm_storeu_si128(pLo, reversePixels<bpp>(b));
+		_mm_storeu_si128(pHi, reversePixels<bpp>(a));
+	}
+	for(hi--; lo < hi; lo++, hi--)
+		swapPixels<bpp>(row + lo * bpp, row + hi * bpp);
+}
+
+/// <summary>
+/// Transposes a square block of pixels that is the size of a single SSE2
+/// register row (4x4 for 32-bit and 8x8 for 16- and 8-bit pixels).
+/// `srcRows[i]` and `dstRows[i]` point to the first pixel of each row.
+/// </summary>
+template<int bpp>
+static inline void transposeBlock(const uchar **srcRows, uchar **dstRows);
+
+template<>
+inline void transposeBlock<4>(const uchar **srcRows, uchar **dstRows)
+{
+	__m128i r0 = _mm_loadu_si128(
+		reinterpret_cast<const __m128i *>(srcRows[0]));
+	__m128i r1 = _mm_loadu_si128(
+		reinterpret_cast<const __m128i *>(srcRows[1]));
+	__m128i r2 = _mm_loadu_si128(
+		reinterpret_cast<const __m128i *>(srcRows[2]));
+	__m128i r3 = _mm_loadu_si128(
+		reinterpret_cast<const __m128i *>(srcRows[3]));
+
+	__m128i t0 = _mm_unpacklo_epi32(r0, r1);
+	__m128i t1 = _mm_unpacklo_epi32(r2, r3);
+	__m128i t2 = _mm_unpackhi_epi32(r0, r1);
+	__m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(dstRows[0]),
+		_mm_unpacklo_epi64(t0, t1));
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(dstRows[1]),
+		_mm_unpackhi_epi64(t0, t1));
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(dstRows[2]),
+		_mm_unpacklo_epi64(t2, t3));
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(dstRows[3]),
+		_mm_unpackhi_epi64(t2, t3));
+}
+
+template<>
+inline void transposeBlock<2>(const uchar **srcRows, uchar **dstRows)
+{
+	__m128i r[8];
+	for(int i = 0; i < 8; i++) {
+		r[i] = _mm_loadu_si128(
+			reinterpret_cast<const __m128i *>(srcRows[i]));
+	}
+
+	// Interleave pairs of rows, then pairs of pairs and so on until each
+	// register contains two complete columns
+	__m128i a[8];
+	for(int i = 0; i < 4; i++) {
+		a[i * 2] = _mm_unpacklo_epi16(r[i * 2], r[i * 2 + 1]);
+		a[i * 2 + 1] = _mm_unpackhi_epi16(r[i * 2], r[i * 2 + 1]);
+	}
+	__m128i b[8];
+	for(int i = 0; i < 2; i++) {
+		b[i * 4 + 0] = _mm_unpacklo_epi32(a[i * 4 + 0], a[i * 4 + 2]);
+		b[i * 4 + 1] = _mm_unpackhi_epi32(a[i * 4 + 0], a[i * 4 + 2]);
+		b[i * 4 + 2] = _mm_unpacklo_epi32(a[i * 4 + 1], a[i * 4 + 3]);
+		b[i * 4 + 3] = _mm_unpackhi_epi32(a[i * 4 + 1], a[i * 4 + 3]);
+	}
+	for(int i = 0; i < 4; i++) {
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dstRows[i * 2]),
+			_mm_unpacklo_epi64(b[i], b[i + 4]));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dstRows[i * 2 + 1]),
+			_mm_unpackhi_epi64(b[i], b[i + 4]));
+	}
+}
+
+template<>
+inline void transposeBlock<1>(const uchar **srcRows, uchar **dstRows)
+{
+	__m128i r[8];
+	for(int i = 0; i < 8; i++) {
+		r[i] = _mm_loadl_epi64(
+			reinterpret_cast<const __m128i *>(srcRows[i]));
+	}
+
+	// Same as the 16-bit version except that only the low half of each
+	// register is used for the input rows
+	__m128i a[4];
+	for(int i = 0; i < 4; i++)
+		a[i] = _mm_unpacklo_epi8(r[i * 2], r[i * 2 + 1]);
+	__m128i b[4];
+	b[0] = _mm_unpacklo_epi16(a[0], a[1]);
+	b[1] = _mm_unpackhi_epi16(a[0], a[1]);
+	b[2] = _mm_unpacklo_epi16(a[2], a[3]);
+	b[3] = _mm_unpackhi_epi16(a[2], a[3]);
+	__m128i c[4];
+	c[0] = _mm_unpacklo_epi32(b[0], b[2]);
+	c[1] = _mm_unpackhi_epi32(b[0], b[2]);
+	c[2] = _mm_unpacklo_epi32(b[1], b[3]);
+	c[3] = _mm_unpackhi_epi32(b[1], b[3]);
+	for(int i = 0; i < 4; i++) {
+		_mm_storel_epi64(
+			reinterpret_cast<__m128i *>(dstRows[i * 2]), c[i]);
+		_mm_storel_epi64(
+			reinterpret_cast<__m128i *>(dstRows[i * 2 + 1]),
+			_mm_unpackhi_epi64(c[i], c[i]));
+	}
+}
+
+/// <summary>
+/// Transposes a `width`x`height` block of pixels so that row `y` of the source
+/// becomes column `y` of the destination. Strides can be negative which is how
+/// rotations are implemented. The work is split into tiles of
+/// `ImageOrient::TileSize` pixels so that both the rows that are being read
+/// and the rows that are being written stay in the cache.
+/// </summary>
+template<int bpp>
+static void transpose(
+	const uchar *src, int srcStride, uchar *dst, int dstStride, int width,
+	int height)
+{
+	const int n = (bpp == 4) ? 4 : 8; // Block size
+	const int tile = ImageOrient::TileSize;
+	const int blockWidth = width - width % n;
+	const int blockHeight = height - height % n;
+	const uchar *srcRows[8];
+	uchar *dstRows[8];
+
+	// Transpose whole blocks
+	for(int ty = 0; ty < blockHeight; ty += tile) {
+		const int tyEnd = qMin(ty + tile, blockHeight);
+		for(int tx = 0; tx < blockWidth; tx += tile) {
+			const int txEnd = qMin(tx + tile, blockWidth);
+			for(int y = ty; y < tyEnd; y += n) {
+				for(int x = tx; x < txEnd; x += n) {
+					for(int i = 0; i < n; i++) {
+						srcRows[i] = src + (y + i) * srcStride + x * bpp;
+						dstRows[i] = dst + (x + i) * dstStride + y * bpp;
+					}
+					transposeBlock<bpp>(srcRows, dstRows);
+				}
+			}
+		}
+	}
+
+	// Transpose the right and bottom edges that don't fill a whole block
+	for(int y = 0; y < height; y++) {
+		const uchar *in = src + y * srcStride;
+		const int xStart = (y < blockHeight) ? blockWidth : 0;
+		for(int x = xStart; x < width; x++)
+			copyPixel<bpp>(in + x * bpp, dst + x * dstStride + y * bpp);
+	}
+}
+
+/// <summary>
+/// Transposes a square image in place. Pairs of tiles that are mirrored along
+/// the diagonal are swapped through a temporary buffer while tiles on the
+/// diagonal are transposed through the buffer on their own.
+/// </summary>
+template<int bpp>
+static void transposeInPlace(uchar *data, int stride, int size)
+{
+	const int tile = ImageOrient::TileSize;
+	const int tmpStride = tile * bpp;
+	QVector<uchar> tmpBuf(tile * tmpStride);
+	uchar *tmp = tmpBuf.data();
+
+	for(int ty = 0; ty < size; ty += tile) {
+		const int th = qMin(tile, size - ty);
+		for(int tx = ty; tx < size; tx += tile) {
+			const int tw = qMin(tile, size - tx);
+			uchar *a = data + ty * stride + tx * bpp;
+			uchar *b = data + tx * stride + ty * bpp;
+
+			// Save tile A, write B^T over A and then A^T over B
+			for(int y = 0; y < th; y++)
+				memcpy(tmp + y * tmpStride, a + y * stride, tw * bpp);
+			if(tx != ty)
+				transpose<bpp>(b, stride, a, stride, th, tw);
+			transpose<bpp>(tmp, tmpStride, b, stride, tw, th);
+		}
+	}
+}
+
+template<int bpp>
+static void orientPixels(
+	const uchar *src, int srcStride, uchar *dst, int dstStride,
+	const QSize &size, VidgfxOrientation orient)
+{
+	const int width = size.width();
+	const int height = size.height();
+	const int rowBytes = width * bpp;
+	const uchar *lastRow = src + (height - 1) * srcStride;
+
+	switch(orient) {
+	default:
+	case GfxUnchangedOrient:
+		for(int y = 0; y < height; y++)
+			memcpy(dst + y * dstStride, src + y * srcStride, rowBytes);
+		break;
+	case GfxFlippedOrient:
+		for(int y = 0; y < height; y++)
+			memcpy(dst + y * dstStride, lastRow - y * srcStride, rowBytes);
+		break;
+	case GfxMirroredOrient:
+		for(int y = 0; y < height; y++)
+			reverseRow<bpp>(src + y * srcStride, dst + y * dstStride, width);
+		break;
+	case GfxFlippedMirroredOrient:
+		for(int y = 0; y < height; y++) {
+			reverseRow<bpp>(
+				lastRow - y * srcStride, dst + y * dstStride, width);
+		}
+		break;
+	case GfxRotated90Orient:
+		// Clockwise is a transpose of the vertically flipped source
+		transpose<bpp>(lastRow, -srcStride, dst, dstStride, width, height);
+		break;
+	case GfxRotated270Orient:
+		// Anticlockwise is a vertically flipped transpose of the source
+		transpose<bpp>(
+			src, srcStride, dst + (width - 1) * dstStride, -dstStride, width,
+			height);
+		break;
+	}
+}
+
+template<int bpp>
+static bool orientPixelsInPlace(
+	uchar *data, int stride, const QSize &size, VidgfxOrientation orient)
+{
+	const int width = size.width();
+	const int height = size.height();
+	const int rowBytes = width * bpp;
+
+	switch(orient) {
+	default:
+	case GfxUnchangedOrient:
+		break;
+	case GfxFlippedOrient: {
+		QVector<uchar> tmp(rowBytes);
+		for(int y = 0; y < height / 2; y++) {
+			uchar *a = data + y * stride;
+			uchar *b = data + (height - y - 1) * stride;
+			memcpy(tmp.data(), a, rowBytes);
+			memcpy(a, b, rowBytes);
+			memcpy(b, tmp.constData(), rowBytes);
+		}
+		break; }
+	case GfxMirroredOrient:
+		for(int y = 0; y < height; y++)
+			reverseRowInPlace<bpp>(data + y * stride, width);
+		break;
+	case GfxFlippedMirroredOrient: {
+		QVector<uchar> tmp(rowBytes);
+		for(int y = 0; y < height / 2; y++) {
+			uchar *a = data + y * stride;
+			uchar *b = data + (height - y - 1) * stride;
+			memcpy(tmp.data(), a, rowBytes);
+			reverseRow<bpp>(b, a, width);
+			reverseRow<bpp>(tmp.constData(), b, width);
+		}
+		if(height % 2)
+			reverseRowInPlace<bpp>(data + (height / 2) * stride, width);
+		break; }
+	case GfxRotated90Orient:
+	case GfxRotated270Orient:
+		// Only square images can be rotated without moving pixels between
+		// rows of different lengths
+		if(width != height)
+			return false;
+		transposeInPlace<bpp>(data, stride, width);
+		return orientPixelsInPlace<bpp>(data, stride, size,
+			orient == GfxRotated90Orient
+			? GfxMirroredOrient : GfxFlippedOrient);
+	}
+
+	return true;
+}
+
+//=============================================================================
+// ImageOrient class
+
+/// <summary>
+/// Returns true if the orientation swaps the rows and columns of the image.
+/// </summary>
+bool ImageOrient::isTransposed(VidgfxOrientation orient)
+{
+	return orient == GfxRotated90Orient || orient == GfxRotated270Orient;
+}
+
+/// <summary>
+/// Returns the size of an image of size `size` after `orient` is applied.
+/// </summary>
+QSize ImageOrient::getOrientedSize(const QSize &size, VidgfxOrientation orient)
+{
+	if(isTransposed(orient))
+		return QSize(size.height(), size.width());
+	return size;
+}
+
+/// <summary>
+/// Copies the `size` pixels from `src` to `dst` while applying `orient`. The
+/// destination must be large enough to hold `getOrientedSize()` pixels and the
+/// two buffers must not overlap. `bpp` is the number of bytes per pixel and
+/// must be 1, 2 or 4.
+/// </summary>
+/// <returns>False if the pixel size is not supported.</returns>
+bool ImageOrient::orient(
+	const uchar *src, int srcStride, uchar *dst, int dstStride,
+	const QSize &size, int bpp, VidgfxOrientation orient)
+{
+	if(size.isEmpty())
+		return true;
+	switch(bpp) {
+	case 1:
+		orientPixels<1>(src, srcStride, dst, dstStride, size, orient);
+		return true;
+	case 2:
+		orientPixels<2>(src, srcStride, dst, dstStride, size, orient);
+		return true;
+	case 4:
+		orientPixels<4>(src, srcStride, dst, dstStride, size, orient);
+		return true;
+	default:
+		return false;
+	}
+}
+
+/// <summary>
+/// Applies `orient` to the pixels in `data` without using a second image
+/// buffer. Rotations are only possible in place for square images.
+/// </summary>
+/// <returns>False if the orientation cannot be applied in place.</returns>
+bool ImageOrient::orientInPlace(
+	uchar *data, int stride, const QSize &size, int bpp,
+	VidgfxOrientation orient)
+{
+	if(size.isEmpty())
+		return true;
+	switch(bpp) {
+	case 1:
+		return orientPixelsInPlace<1>(data, stride, size, orient);
+	case 2:
+		return orientPixelsInPlace<2>(data, stride, size, orient);
+	case 4:
+		return orientPixelsInPlace<4>(data, stride, size, orient);
+	default:
+		return false;
+	}
+}
+
+/// <summary>
+/// Applies `orient` to every plane of a frame in the pixel format `format`.
+/// Chroma planes are oriented at their subsampled size. Packed 4:2:2 formats
+/// can only be flipped as mirroring or rotating them would require reordering
+/// the luma samples within each macropixel or resampling the chroma.
+/// </summary>
+/// <returns>False if the format or orientation is not supported.</returns>
+bool ImageOrient::orientPlanes(
+	VidgfxPixFormat format, const QSize &size,
+	const uchar * const *srcPlanes, const int *srcStrides,
+	uchar * const *dstPlanes, const int *dstStrides,
+	VidgfxOrientation orient)
+{
+	// Chroma planes of odd sized frames contain an extra partial sample
+	const QSize chromaSize((size.width() + 1) / 2, (size.height() + 1) / 2);
+
+	switch(format) {
+	default:
+	case GfxNoFormat:
+	case GfxRGB24Format:
+		return false;
+	case GfxRGB32Format:
+	case GfxARGB32Format:
+		return ImageOrient::orient(
+			srcPlanes[0], srcStrides[0], dstPlanes[0], dstStrides[0], size, 4,
+			orient);
+	case GfxYV12Format:
+	case GfxIYUVFormat:
+		ImageOrient::orient(
+			srcPlanes[0], srcStrides[0], dstPlanes[0], dstStrides[0], size, 1,
+			orient);
+		for(int i = 1; i < 3; i++) {
+			ImageOrient::orient(
+				srcPlanes[i], srcStrides[i], dstPlanes[i], dstStrides[i],
+				chromaSize, 1, orient);
+		}
+		return true;
+	case GfxNV12Format:
+		// The chroma plane has interleaved UV which we treat as 16-bit pixels
+		ImageOrient::orient(
+			srcPlanes[0], srcStrides[0], dstPlanes[0], dstStrides[0], size, 1,
+			orient);
+		ImageOrient::orient(
+			srcPlanes[1], srcStrides[1], dstPlanes[1], dstStrides[1],
+			chromaSize, 2, orient);
+		return true;
+	case GfxUYVYFormat:
+	case GfxHDYCFormat:
+	case GfxYUY2Format:
+		if(orient != GfxUnchangedOrient && orient != GfxFlippedOrient)
+			return false;
+		return ImageOrient::orient(
+			srcPlanes[0], srcStrides[0], dstPlanes[0], dstStrides[0],
+			QSize((size.width() + 1) / 2, size.height()), 4, orient);
+	}
+}
+
+/// <summary>
+/// Returns a copy of the image with `orient` applied. Images that are not
+/// 32-bit are converted to `QImage::Format_ARGB32` first.
+/// </summary>
+/// <returns>A null image on failure.</returns>
+QImage ImageOrient::orientImage(const QImage &img, VidgfxOrientation orient)
+{
+	if(img.isNull())
+		return QImage();
+	QImage src = img;
+	switch(img.format()) {
+	case QImage::Format_RGB32:
+	case QImage::Format_ARGB32:
+	case QImage::Format_ARGB32_Premultiplied:
+		break;
+	default:
+		src = img.convertToFormat(QImage::Format_ARGB32);
+		break;
+	}
+	if(orient == GfxUnchangedOrient)
+		return src;
+
+	QImage dst(getOrientedSize(src.size(), orient), src.format());
+	if(dst.isNull())
+		return QImage(); // Out of memory
+	ImageOrient::orient(
+		src.constBits(), src.bytesPerLine(), dst.bits(), dst.bytesPerLine(),
+		src.size(), 4, orient);
+	return dst;
+}
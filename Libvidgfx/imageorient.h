@@ -0,0 +1,62 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#ifndef IMAGEORIENT_H
+#define IMAGEORIENT_H
+
+#include "include/libvidgfx.h"
+#include <QtGui/QImage>
+
+//=============================================================================
+/// <summary>
+/// CPU kernels that apply a `VidgfxOrientation` to raw pixel buffers so that
+/// images can be reoriented at upload or conversion time. Flips and mirrors
+/// operate on whole rows while rotations are done as a transpose that is split
+/// into small tiles so that both the source and destination stay in the
+/// cache. Pixels are moved with SSE2 wherever possible. Buffers can be 8, 16
+/// or 32 bits per pixel which covers packed RGB as well as the individual
+/// planes of planar YUV formats. Strides are always in bytes. All methods are
+/// thread-safe.
+/// </summary>
+class ImageOrient
+{
+public: // Constants ----------------------------------------------------------
+
+	// Edge length in pixels of the tiles that transposes are done in
+	static const int	TileSize = 64;
+
+public: // Static methods -----------------------------------------------------
+	static bool		isTransposed(VidgfxOrientation orient);
+	static QSize	getOrientedSize(
+		const QSize &size, VidgfxOrientation orient);
+
+	static bool		orient(
+		const uchar *src, int srcStride, uchar *dst, int dstStride,
+		const QSize &size, int bpp, VidgfxOrientation orient);
+	static bool		orientInPlace(
+		uchar *data, int stride, const QSize &size, int bpp,
+		VidgfxOrientation orient);
+	static bool		orientPlanes(
+		VidgfxPixFormat format, const QSize &size,
+		const uchar * const *srcPlanes, const int *srcStrides,
+		uchar * const *dstPlanes, const int *dstStrides,
+		VidgfxOrientation orient);
+	static QImage	orientImage(const QImage &img, VidgfxOrientation orient);
+};
+//=============================================================================
+
+#endif // IMAGEORIENT_H
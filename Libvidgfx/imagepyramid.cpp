@@ -0,0 +1,195 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#include "imagepyramid.h"
+#include "imagescaler.h"
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+
+//=============================================================================
+// ImagePyramidJob class
+
+/// <summary>
+/// Builds the levels of an `ImagePyramid` on the global thread pool.
+/// </summary>
+class ImagePyramidJob : public QRunnable
+{
+protected: // Members ---------------------------------------------------------
+	ImagePyramid *	m_pyramid;
+
+public: // Constructor/destructor ---------------------------------------------
+	ImagePyramidJob(ImagePyramid *pyramid)
+		: QRunnable()
+		, m_pyramid(pyramid)
+	{
+		setAutoDelete(true);
+	}
+
+public: // Interface ----------------------------------------------------------
+	virtual void run()
+	{
+		m_pyramid->build();
+	}
+};
+
+//=============================================================================
+// ImagePyramid class
+
+/// <summary>
+/// Returns the largest size that has the same aspect ratio as `size` and fits
+/// within `maxSize`. Images are never enlarged. If `maxSize` is empty then
+/// `size` is returned unmodified.
+/// </summary>
+QSize ImagePyramid::calcReducedSize(const QSize &size, const QSize &maxSize)
+{
+	if(maxSize.isEmpty() || size.isEmpty())
+		return size;
+	if(size.width() <= maxSize.width() && size.height() <= maxSize.height())
+		return size;
+	const qreal ratio = qMin(
+		(qreal)maxSize.width() / (qreal)size.width(),
+		(qreal)maxSize.height() / (qreal)size.height());
+	return QSize(
+		qMax(1, qRound((qreal)size.width() * ratio)),
+		qMax(1, qRound((qreal)size.height() * ratio)));
+}
+
+/// <summary>
+/// Reduces the image to fit within `maxSize` and then generates every mipmap
+/// level down to 1x1 using area averaging. Level N is exactly the size that
+/// the GPU expects for that level, i.e. the size of level 0 divided by 2^N
+/// rounded down. All levels are either `QImage::Format_RGB32` or
+/// `QImage::Format_ARGB32`. This method is synchronous.
+/// </summary>
+/// <returns>An empty vector on failure.</returns>
+QVector<QImage> ImagePyramid::buildLevels(
+	const QImage &img, const QSize &maxSize)
+{
+	QVector<QImage> levels;
+	if(img.isNull())
+		return levels;
+
+	// Textures only support straight alpha
+	QImage base = img;
+	if(base.format() != QImage::Format_RGB32 &&
+		base.format() != QImage::Format_ARGB32)
+	{
+		base = base.convertToFormat(QImage::Format_ARGB32);
+	}
+
+	// Reduce the image to the largest size that it'll be displayed at
+	const QSize size = calcReducedSize(base.size(), maxSize);
+	if(size != base.size())
+		base = ImageScaler::scale(base, size, GfxBilinearFilter);
+	if(base.isNull())
+		return levels; // Out of memory
+	levels.append(base);
+
+	// Generate the mip tail, each level from the previous one
+	QSize levelSize = base.size();
+	while(levelSize.width() > 1 || levelSize.height() > 1) {
+		levelSize = QSize(
+			qMax(1, levelSize.width() / 2), qMax(1, levelSize.height() / 2));
+		QImage level = ImageScaler::scaleArea(levels.last(), levelSize);
+		if(level.isNull())
+			break; // Out of memory, a partial chain is still valid
+		levels.append(level);
+	}
+
+	return levels;
+}
+
+/// <summary>
+/// Starts building the pyramid for `img` on the global thread pool.
+/// </summary>
+ImagePyramid::ImagePyramid(const QImage &img, const QSize &maxSize)
+	: m_img(img)
+	, m_maxSize(maxSize)
+	, m_levels()
+	, m_isFinished(false)
+	, m_mutex()
+	, m_finishedCond()
+{
+	QThreadPool::globalInstance()->start(new ImagePyramidJob(this));
+}
+
+/// <summary>
+/// Blocks until the worker thread has finished with the pyramid.
+/// </summary>
+ImagePyramid::~ImagePyramid()
+{
+	waitForFinished();
+}
+
+bool ImagePyramid::isFinished() const
+{
+	QMutexLocker lock(&m_mutex);
+	return m_isFinished;
+}
+
+void ImagePyramid::waitForFinished()
+{
+	QMutexLocker lock(&m_mutex);
+	while(!m_isFinished)
+		m_finishedCond.wait(&m_mutex);
+}
+
+/// <summary>
+/// Returns the levels of the pyramid starting with the reduced image. The
+/// returned vector is empty if the pyramid is not finished yet or if it
+/// failed to build.
+/// </summary>
+QVector<QImage> ImagePyramid::getLevels() const
+{
+	QMutexLocker lock(&m_mutex);
+	if(!m_isFinished)
+		return QVector<QImage>();
+	return m_levels;
+}
+
+/// <summary>
+/// Returns the size of the reduced image. This is valid even before the
+/// pyramid is finished.
+/// </summary>
+QSize ImagePyramid::getSize() const
+{
+	QMutexLocker lock(&m_mutex);
+	if(m_isFinished) {
+		if(m_levels.isEmpty())
+			return QSize(0, 0);
+		return m_levels.first().size();
+	}
+	return calcReducedSize(m_img.size(), m_maxSize);
+}
+
+/// <summary>
+/// Called on the worker thread.
+/// </summary>
+void ImagePyramid::build()
+{
+	m_mutex.lock();
+	QImage img = m_img;
+	m_mutex.unlock();
+
+	QVector<QImage> levels = buildLevels(img, m_maxSize);
+
+	QMutexLocker lock(&m_mutex);
+	m_levels = levels;
+	m_img = QImage(); // Release the full resolution image
+	m_isFinished = true;
+	m_finishedCond.wakeAll();
+}
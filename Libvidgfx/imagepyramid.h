@@ -0,0 +1,70 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#ifndef IMAGEPYRAMID_H
+#define IMAGEPYRAMID_H
+
+#include "include/libvidgfx.h"
+#include <QtCore/QMutex>
+#include <QtCore/QVector>
+#include <QtCore/QWaitCondition>
+#include <QtGui/QImage>
+
+class ImagePyramidJob;
+
+//=============================================================================
+/// <summary>
+/// Prepares a large image for display at a known maximum size. The image is
+/// reduced to fit within the maximum size and a complete mipmap chain is
+/// generated from the result on a worker thread so that the work is only ever
+/// done once instead of every frame. Once finished the levels can be uploaded
+/// as a single texture with `GraphicsContext::createMipmappedTexture()`.
+/// </summary>
+class ImagePyramid
+{
+	friend class ImagePyramidJob;
+
+protected: // Members ---------------------------------------------------------
+	QImage			m_img; // Released once the levels are built
+	QSize			m_maxSize;
+	QVector<QImage>	m_levels;
+	bool			m_isFinished;
+	mutable QMutex	m_mutex;
+	QWaitCondition	m_finishedCond;
+
+public: // Static methods -----------------------------------------------------
+	static QSize			calcReducedSize(
+		const QSize &size, const QSize &maxSize);
+	static QVector<QImage>	buildLevels(
+		const QImage &img, const QSize &maxSize);
+
+public: // Constructor/destructor ---------------------------------------------
+	ImagePyramid(const QImage &img, const QSize &maxSize);
+	virtual ~ImagePyramid();
+
+public: // Methods ------------------------------------------------------------
+	bool			isFinished() const;
+	void			waitForFinished();
+	QVector<QImage>	getLevels() const;
+	QSize			getSize() const;
+
+private:
+	void			build();
+};
+//=============================================================================
+
+#endif // IMAGEPYRAMID_H
@@ -0,0 +1,99 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#include "imagesampler.h"
+#include <math.h>
+
+//=============================================================================
+// ImageSampler class
+
+/// <summary>
+/// Maps the texel coordinate `coord` of a texture that is `size` texels wide
+/// into the range [0..`size`) using the specified address mode.
+/// </summary>
+int ImageSampler::addressTexel(int coord, int size, VidgfxAddressMode mode)
+{
+	if(coord >= 0 && coord < size)
+		return coord; // Fast path
+	if(size <= 0)
+		return 0;
+	switch(mode) {
+	default:
+	case GfxClampAddressing:
+		return (coord < 0) ? 0 : size - 1;
+	case GfxWrapAddressing:
+		coord %= size;
+		return (coord < 0) ? coord + size : coord;
+	case GfxMirrorAddressing: {
+		const int period = size * 2;
+		coord %= period;
+		if(coord < 0)
+			coord += period;
+		return (coord < size) ? coord : period - 1 - coord; }
+	}
+}
+
+/// <summary>
+/// Samples `img` at the normalised texture coordinate `uv`. `img` must be in
+/// a 32-bit format, the returned texel is in the same format as the image.
+/// Like the GPU, each channel is interpolated independently so images should
+/// use premultiplied alpha if they are filtered bilinearly.
+/// </summary>
+/// <returns>Transparent black if the image cannot be sampled.</returns>
+quint32 ImageSampler::sample(
+	const QImage &img, const QPointF &uv, VidgfxFilter filter,
+	VidgfxAddressMode mode)
+{
+	if(img.isNull() || !is32Bit(img.format()))
+		return 0;
+	const int width = img.width();
+	const int height = img.height();
+	const float x = (float)uv.x() * (float)width;
+	const float y = (float)uv.y() * (float)height;
+
+	if(filter == GfxPointFilter) {
+		const int tx = addressTexel((int)floorf(x), width, mode);
+		const int ty = addressTexel((int)floorf(y), height, mode);
+		return ((const quint32 *)img.constScanLine(ty))[tx];
+	}
+
+	// Bilinear filtering of the 4 surrounding texel centres
+	const float fx = x - 0.5f;
+	const float fy = y - 0.5f;
+	const float x0f = floorf(fx);
+	const float y0f = floorf(fy);
+	const float wx = fx - x0f;
+	const float wy = fy - y0f;
+	const int x0 = addressTexel((int)x0f, width, mode);
+	const int x1 = addressTexel((int)x0f + 1, width, mode);
+	const quint32 *row0 = (const quint32 *)img.constScanLine(
+		addressTexel((int)y0f, height, mode));
+	const quint32 *row1 = (const quint32 *)img.constScanLine(
+		addressTexel((int)y0f + 1, height, mode));
+
+	const __m128 wx1 = _mm_set1_ps(wx);
+	const __m128 wx0 = _mm_set1_ps(1.0f - wx);
+	const __m128 top = _mm_add_ps(
+		_mm_mul_ps(unpackPixel(row0[x0]), wx0),
+		_mm_mul_ps(unpackPixel(row0[x1]), wx1));
+	const __m128 bot = _mm_add_ps(
+		_mm_mul_ps(unpackPixel(row1[x0]), wx0),
+		_mm_mul_ps(unpackPixel(row1[x1]), wx1));
+	return packPixel(_mm_add_ps(
+		_mm_mul_ps(top, _mm_set1_ps(1.0f - wy)),
+		_mm_mul_ps(bot, _mm_set1_ps(wy))));
+}
@@ -0,0 +1,85 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#ifndef IMAGESAMPLER_H
+#define IMAGESAMPLER_H
+
+#include "include/libvidgfx.h"
+#include <QtCore/QPointF>
+#include <QtGui/QImage>
+#include <emmintrin.h>
+
+//=============================================================================
+/// <summary>
+/// Samples 32-bit images on the CPU in the same way that the GPU samplers do
+/// so that CPU code paths produce the same results as rendering with
+/// `GraphicsContext::setTextureFilter()`. Texel centres are at half-integer
+/// positions, `GfxPointFilter` selects the nearest texel and every other
+/// filter is sampled bilinearly. Texture coordinates outside of the [0..1]
+/// range are resolved with a `VidgfxAddressMode`. The SSE2 pixel helpers are
+/// shared with the other CPU renderers. All methods are thread-safe.
+/// </summary>
+class ImageSampler
+{
+public: // Static methods -----------------------------------------------------
+	static int		addressTexel(int coord, int size, VidgfxAddressMode mode);
+	static quint32	sample(
+		const QImage &img, const QPointF &uv, VidgfxFilter filter,
+		VidgfxAddressMode mode);
+
+	// Pixel helpers
+	static bool		is32Bit(QImage::Format format);
+	static __m128	unpackPixel(quint32 px);
+	static quint32	packPixel(__m128 px);
+};
+//=============================================================================
+
+/// <summary>
+/// Returns true if `format` stores one 32-bit pixel per texel that can be
+/// sampled directly.
+/// </summary>
+inline bool ImageSampler::is32Bit(QImage::Format format)
+{
+	return format == QImage::Format_RGB32 ||
+		format == QImage::Format_ARGB32 ||
+		format == QImage::Format_ARGB32_Premultiplied;
+}
+
+/// <summary>
+/// Expands a 32-bit pixel into 4 floats in the range [0..255].
+/// </summary>
+inline __m128 ImageSampler::unpackPixel(quint32 px)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i tmp = _mm_cvtsi32_si128((int)px);
+	tmp = _mm_unpacklo_epi8(tmp, zero);
+	tmp = _mm_unpacklo_epi16(tmp, zero);
+	return _mm_cvtepi32_ps(tmp);
+}
+
+/// <summary>
+/// Rounds and saturates 4 floats in the range [0..255] into a 32-bit pixel.
+/// </summary>
+inline quint32 ImageSampler::packPixel(__m128 px)
+{
+	__m128i tmp = _mm_cvtps_epi32(px);
+	tmp = _mm_packs_epi32(tmp, tmp);
+	tmp = _mm_packus_epi16(tmp, tmp);
+	return (quint32)_mm_cvtsi128_si32(tmp);
+}
+
+#endif // IMAGESAMPLER_H
@@ -0,0 +1,661 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#include "imagescaler.h"
+#include <emmintrin.h>
+#include <math.h>
+#include <string.h>
+
+//=============================================================================
+// Helpers
+
+static const double PI = 3.14159265358979323846;
+
+static double sinc(double x)
+{
+	if(x == 0.0)
+		return 1.0;
+	x *= PI;
+	return sin(x) / x;
+}
+
+/// <summary>
+/// Returns the SSE2 register that, when used with `_mm_madd_epi16()` on two
+/// interleaved pixels, multiplies the first pixel by `w0` and the second by
+/// `w1`.
+/// </summary>
+static inline __m128i weightPair(qint16 w0, qint16 w1)
+{
+	return _mm_set1_epi32(
+		(int)(((quint32)(quint16)w1 << 16) | (quint32)(quint16)w0));
+}
+
+/// <summary>
+/// Converts four 32-bit fixed-point channel sums into a single 32-bit pixel.
+/// </summary>
+static inline quint32 packPixel(__m128i acc)
+{
+	const __m128i round = _mm_set1_epi32(1 << (ImageScaler::WeightBits - 1));
+	acc = _mm_srai_epi32(_mm_add_epi32(acc, round), ImageScaler::WeightBits);
+	acc = _mm_packs_epi32(acc, acc);
+	acc = _mm_packus_epi16(acc, acc);
+	return (quint32)_mm_cvtsi128_si32(acc);
+}
+
+//=============================================================================
+// ImageScaler class
+
+QList<ImageScaler::WeightTable> ImageScaler::s_weightCache;
+QMutex ImageScaler::s_weightCacheMutex;
+
+/// <summary>
+/// Rescales the image to the specified size using the specified filter. The
+/// returned image is in the same format as the input if it is a 32-bit
+/// format, otherwise it is converted to `QImage::Format_ARGB32` first.
+/// `QImage::Format_ARGB32` images are filtered with premultiplied alpha so
+/// that the colour of fully transparent pixels never bleeds into visible ones,
+/// removing the need to dilute the image beforehand. `GfxBicubicFilter` and
+/// `GfxLanczosFilter` can produce slight overshoot around hard edges which is
+/// clamped to the valid range.
+/// </summary>
+/// <returns>A null image on failure.</returns>
+QImage ImageScaler::scale(
+	const QImage &img, const QSize &size, VidgfxFilter filter)
+{
+	if(img.isNull() || size.isEmpty())
+		return QImage();
+
+	// Bilinear filtering is only defined for upscaling, when downscaling we
+	// want every source pixel to contribute equally to the output
+	if(filter != GfxPointFilter && filter != GfxBicubicFilter &&
+		filter != GfxLanczosFilter && size.width() <= img.width() &&
+		size.height() <= img.height())
+	{
+		return scaleArea(img, size);
+	}
+
+	// Nearest neighbour upscaling by an exact integer ratio is a simple
+	// replication of every pixel
+	if(filter == GfxPointFilter && size.width() >= img.width() &&
+		size.height() >= img.height() &&
+		size.width() % img.width() == 0 && size.height() % img.height() == 0)
+	{
+		return scaleInteger(img, size.width() / img.width(),
+			size.height() / img.height());
+	}
+
+	Kernel kernel;
+	switch(filter) {
+	case GfxPointFilter:
+		kernel = PointKernel;
+		break;
+	default:
+	case GfxBilinearFilter:
+		kernel = TentKernel;
+		break;
+	case GfxBicubicFilter:
+		kernel = CubicKernel;
+		break;
+	case GfxLanczosFilter:
+		kernel = LanczosKernel;
+		break;
+	}
+
+	// We only operate on 32-bit pixels
+	QImage src = to32Bit(img);
+	if(src.size() == size)
+		return src;
+	const bool premultiply =
+		(kernel != PointKernel && src.format() == QImage::Format_ARGB32);
+	if(premultiply)
+		src = src.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+	// Horizontal pass
+	QImage tmp = src;
+	if(src.width() != size.width()) {
+		tmp = QImage(size.width(), src.height(), src.format());
+		if(tmp.isNull())
+			return QImage(); // Out of memory
+		scaleHorizontal(src, tmp,
+			getWeightTable(src.width(), size.width(), kernel));
+	}
+
+	// Vertical pass
+	QImage dst = tmp;
+	if(src.height() != size.height()) {
+		dst = QImage(size, src.format());
+		if(dst.isNull())
+			return QImage(); // Out of memory
+		scaleVertical(tmp, dst,
+			getWeightTable(src.height(), size.height(), kernel));
+	}
+
+	// Negative filter lobes can result in colour values that are larger than
+	// the alpha value which is invalid for premultiplied images
+	if(dst.format() == QImage::Format_ARGB32_Premultiplied &&
+		(kernel == CubicKernel || kernel == LanczosKernel))
+	{
+		clampPremultiplied(dst);
+	}
+
+	if(premultiply)
+		return dst.convertToFormat(QImage::Format_ARGB32);
+	return dst;
+}
+
+/// <summary>
+/// Downscales the image to the specified size by averaging all the source
+/// pixels that each output pixel covers, weighted by the exact amount of
+/// coverage. Unlike repeatedly halving the image this works for any ratio and
+/// only reads each source pixel once as every source row is reduced
+/// horizontally into a small ring buffer before being accumulated into the
+/// output rows that it covers. The size must not be larger than the source.
+/// Like `scale()` images with an alpha channel are averaged with premultiplied
+/// alpha.
+/// </summary>
+/// <returns>A null image on failure.</returns>
+QImage ImageScaler::scaleArea(const QImage &img, const QSize &size)
+{
+	if(img.isNull() || size.isEmpty())
+		return QImage();
+	if(size.width() > img.width() || size.height() > img.height())
+		return QImage(); // Upscaling isn't supported
+	QImage src = to32Bit(img);
+	if(src.size() == size)
+		return src;
+	const bool premultiply = (src.format() == QImage::Format_ARGB32);
+	if(premultiply)
+		src = src.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+	QImage dst(size, src.format());
+	if(dst.isNull())
+		return QImage(); // Out of memory
+	const WeightTable hTable =
+		getWeightTable(src.width(), size.width(), AreaKernel);
+	const WeightTable vTable =
+		getWeightTable(src.height(), size.height(), AreaKernel);
+
+	// Horizontally reduced rows. As the windows of consecutive output rows
+	// never go backwards each source row only needs to be reduced once.
+	const int ringSize = vTable.numTaps;
+	const int ringStride = size.width();
+	QVector<quint32> ring(ringStride * ringSize);
+	QVector<int> ringRows(ringSize, -1);
+	QVector<const uchar *> rows(ringSize);
+	QVector<qint16> weights(ringSize);
+
+	for(int y = 0; y < size.height(); y++) {
+		const int offset = vTable.offsets.at(y);
+		const qint16 *w = vTable.weights.constData() + y * vTable.numTaps;
+
+		// Gather the source rows that contribute to this output row, skipping
+		// rows that are outside of the coverage window
+		int numRows = 0;
+		for(int k = 0; k < vTable.numTaps; k++) {
+			if(w[k] == 0)
+				continue;
+			const int srcY = offset + k;
+			const int slot = srcY % ringSize;
+			quint32 *ringRow = ring.data() + slot * ringStride;
+			if(ringRows.at(slot) != srcY) {
+				const quint32 *in =
+					reinterpret_cast<const quint32 *>(src.constScanLine(srcY));
+				filterRow(in, ringRow, hTable);
+				ringRows[slot] = srcY;
+			}
+			rows[numRows] = reinterpret_cast<const uchar *>(ringRow);
+			weights[numRows] = w[k];
+			numRows++;
+		}
+
+		filterRows(rows.constData(), weights.constData(), numRows,
+			reinterpret_cast<quint32 *>(dst.scanLine(y)), size.width());
+	}
+
+	if(premultiply)
+		return dst.convertToFormat(QImage::Format_ARGB32);
+	return dst;
+}
+
+/// <summary>
+/// Upscales the image by replicating every pixel `xFactor` times horizontally
+/// and `yFactor` times vertically. Each output row is only generated once and
+/// is then copied to the rows below it.
+/// </summary>
+/// <returns>A null image on failure.</returns>
+QImage ImageScaler::scaleInteger(const QImage &img, int xFactor, int yFactor)
+{
+	if(img.isNull() || xFactor < 1 || yFactor < 1)
+		return QImage();
+	QImage src = to32Bit(img);
+	if(xFactor == 1 && yFactor == 1)
+		return src;
+
+	const int srcWidth = src.width();
+	const int dstWidth = srcWidth * xFactor;
+	QImage dst(dstWidth, src.height() * yFactor, src.format());
+	if(dst.isNull())
+		return QImage(); // Out of memory
+	const int rowBytes = dstWidth * 4;
+
+	for(int y = 0; y < src.height(); y++) {
+		const quint32 *in =
+			reinterpret_cast<const quint32 *>(src.constScanLine(y));
+		quint32 *out = reinterpret_cast<quint32 *>(dst.scanLine(y * yFactor));
+
+		// Generate the first output row
+		int x = 0;
+		switch(xFactor) {
+		case 1:
+			memcpy(out, in, rowBytes);
+			x = srcWidth;
+			break;
+		case 2:
+			for(; x + 4 <= srcWidth; x += 4) {
+				__m128i px = _mm_loadu_si128(
+					reinterpret_cast<const __m128i *>(in + x));
+				__m128i *o = reinterpret_cast<__m128i *>(out + x * 2);
+				_mm_storeu_si128(o, _mm_unpacklo_epi32(px, px));
+				_mm_storeu_si128(o + 1, _mm_unpackhi_epi32(px, px));
+			}
+			break;
+		case 4:
+			for(; x + 4 <= srcWidth; x += 4) {
+				__m128i px = _mm_loadu_si128(
+					reinterpret_cast<const __m128i *>(in + x));
+				__m128i *o = reinterpret_cast<__m128i *>(out + x * 4);
+				_mm_storeu_si128(o, _mm_shuffle_epi32(px, 0x00));
+				_mm_storeu_si128(o + 1, _mm_shuffle_epi32(px, 0x55));
+				_mm_storeu_si128(o + 2, _mm_shuffle_epi32(px, 0xAA));
+				_mm_storeu_si128(o + 3, _mm_shuffle_epi32(px, 0xFF));
+			}
+			break;
+		default:
+			// Broadcast each pixel with whole register stores. When the factor
+			// isn't a multiple of 4 the last store overlaps the next pixel's
+			// output which is then overwritten, except for the last pixel
+			// where we'd write past the end of the row.
+			for(; x < srcWidth - 1; x++) {
+				const __m128i px = _mm_set1_epi32((int)in[x]);
+				quint32 *o = out + x * xFactor;
+				for(int k = 0; k < xFactor; k += 4)
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(o + k), px);
+			}
+			break;
+		}
+		for(; x < srcWidth; x++) {
+			quint32 *o = out + x * xFactor;
+			for(int k = 0; k < xFactor; k++)
+				o[k] = in[x];
+		}
+
+		// Replicate the row
+		for(int k = 1; k < yFactor; k++)
+			memcpy(dst.scanLine(y * yFactor + k), out, rowBytes);
+	}
+
+	return dst;
+}
+
+/// <summary>
+/// Releases all cached filter weight tables.
+/// </summary>
+void ImageScaler::clearWeightCache()
+{
+	QMutexLocker lock(&s_weightCacheMutex);
+	s_weightCache.clear();
+}
+
+/// <summary>
+/// Returns the image in a 32-bit format that our filters can process.
+/// </summary>
+QImage ImageScaler::to32Bit(const QImage &img)
+{
+	if(img.format() == QImage::Format_RGB32 ||
+		img.format() == QImage::Format_ARGB32 ||
+		img.format() == QImage::Format_ARGB32_Premultiplied)
+	{
+		return img;
+	}
+	return img.convertToFormat(QImage::Format_ARGB32);
+}
+
+/// <summary>
+/// Returns the weight table for the specified parameters from the cache,
+/// calculating it if it doesn't already exist.
+/// </summary>
+ImageScaler::WeightTable ImageScaler::getWeightTable(
+	int srcLen, int dstLen, Kernel kernel)
+{
+	QMutexLocker lock(&s_weightCacheMutex);
+
+	// Search the cache, most recently used tables are at the front
+	for(int i = 0; i < s_weightCache.size(); i++) {
+		const WeightTable &table = s_weightCache.at(i);
+		if(table.srcLen != srcLen || table.dstLen != dstLen ||
+			table.kernel != kernel)
+		{
+			continue;
+		}
+		if(i != 0)
+			s_weightCache.move(i, 0);
+		return s_weightCache.first();
+	}
+
+	// Not in the cache, calculate it now. The table is implicitly shared so
+	// returning a copy is cheap.
+	WeightTable table = calcWeightTable(srcLen, dstLen, kernel);
+	s_weightCache.prepend(table);
+	while(s_weightCache.size() > MaxCachedTables)
+		s_weightCache.removeLast();
+	return table;
+}
+
+/// <summary>
+/// Calculates the fixed-point filter weights required to rescale a line of
+/// `srcLen` pixels to `dstLen` pixels. When downscaling the filter kernel is
+/// widened by the scale factor so that every input pixel contributes to the
+/// output. Samples outside of the line are discarded and the remaining weights
+/// are renormalized so that edges do not darken.
+/// </summary>
+ImageScaler::WeightTable ImageScaler::calcWeightTable(
+	int srcLen, int dstLen, Kernel kernel)
+{
+	const double scale = (double)dstLen / (double)srcLen;
+	double filterScale = qMax(1.0, 1.0 / scale);
+	double radius;
+	switch(kernel) {
+	case PointKernel:
+		radius = 0.5;
+		filterScale = 1.0; // Nearest neighbour never averages
+		break;
+	default:
+	case TentKernel:
+		radius = 1.0;
+		break;
+	case CubicKernel:
+		radius = 2.0;
+		break;
+	case LanczosKernel:
+		radius = 3.0;
+		break;
+	case AreaKernel:
+		radius = 0.5;
+		break;
+	}
+	const double support = radius * filterScale;
+
+	WeightTable table;
+	table.srcLen = srcLen;
+	table.dstLen = dstLen;
+	table.kernel = kernel;
+	table.numTaps = qMin(srcLen, (int)ceil(support) * 2 + 1);
+	table.offsets.resize(dstLen);
+	table.weights.fill(0, dstLen * table.numTaps);
+
+	QVector<double> tmp(table.numTaps);
+	for(int i = 0; i < dstLen; i++) {
+		// Determine which source pixels are covered by the kernel. Pixel `x`
+		// has its centre at `x + 0.5`.
+		const double center = ((double)i + 0.5) / scale;
+		int first, last;
+		if(kernel == AreaKernel) {
+			// Include partially covered pixels
+			first = qMax(0, (int)floor(center - support));
+			last = qMin(srcLen, (int)ceil(center + support));
+		} else {
+			first = qMax(0, (int)(center - support + 0.5));
+			last = qMin(srcLen, (int)(center + support + 0.5));
+		}
+		last = qMin(last, first + table.numTaps);
+		if(last <= first) {
+			// Can only happen due to rounding at the far edge
+			first = qMin(first, srcLen - 1);
+			last = first + 1;
+		}
+
+		// Evaluate the kernel
+		double total = 0.0;
+		for(int x = first; x < last; x++) {
+			const double dist = ((double)x + 0.5 - center) / filterScale;
+			const double absDist = fabs(dist);
+			double w = 0.0;
+			switch(kernel) {
+			case PointKernel:
+				w = (absDist < 0.5) ? 1.0 : 0.0;
+				break;
+			default:
+			case TentKernel:
+				w = (absDist < 1.0) ? 1.0 - absDist : 0.0;
+				break;
+			case CubicKernel: {
+				// Keys cubic convolution with a = -0.5 (Catmull-Rom)
+				const double a = -0.5;
+				const double d = absDist;
+				if(d < 1.0)
+					w = ((a + 2.0) * d - (a + 3.0)) * d * d + 1.0;
+				else if(d < 2.0)
+					w = (((d - 5.0) * d + 8.0) * d - 4.0) * a;
+				break; }
+			case LanczosKernel:
+				if(absDist < 3.0)
+					w = sinc(absDist) * sinc(absDist / 3.0);
+				break;
+			case AreaKernel:
+				// Amount of the source pixel that is inside of the output
+				// pixel's footprint
+				w = qMin((double)x + 1.0, center + support) -
+					qMax((double)x, center - support);
+				w = qMax(w, 0.0);
+				break;
+			}
+			tmp[x - first] = w;
+			total += w;
+		}
+		if(total == 0.0) {
+			// Point filter exactly between two pixels, use the nearest
+			for(int x = first; x < last; x++)
+				tmp[x - first] = 0.0;
+			tmp[0] = 1.0;
+			total = 1.0;
+		}
+
+		// Keep the window inside of the source line so that the inner loops
+		// never need to do bounds checking
+		const int offset = qMin(first, srcLen - table.numTaps);
+		table.offsets[i] = offset;
+		qint16 *weights = &table.weights[i * table.numTaps];
+
+		// Convert to fixed-point while making sure that the weights always sum
+		// to exactly one so that solid colours are preserved
+		int fixedTotal = 0;
+		int largest = first - offset;
+		for(int x = first; x < last; x++) {
+			int w = (int)floor(tmp[x - first] / total * (double)WeightOne + 0.5);
+			weights[x - offset] = (qint16)w;
+			fixedTotal += w;
+			if(w > weights[largest])
+				largest = x - offset;
+		}
+		weights[largest] += (qint16)(WeightOne - fixedTotal);
+	}
+
+	return table;
+}
+
+/// <summary>
+/// Rescales a single row of pixels using the specified weight table.
+/// </summary>
+void ImageScaler::filterRow(
+	const quint32 *in, quint32 *out, const WeightTable &table)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const int numTaps = table.numTaps;
+	const int *offsets = table.offsets.constData();
+	const qint16 *weights = table.weights.constData();
+
+	for(int x = 0; x < table.dstLen; x++) {
+		const quint32 *px = in + offsets[x];
+		const qint16 *w = weights + x * numTaps;
+		__m128i acc = _mm_setzero_si128();
+
+		// Process two source pixels at a time by interleaving their channels
+		// so that `_mm_madd_epi16()` does the multiply-add
+		int k = 0;
+		for(; k + 1 < numTaps; k += 2) {
+			__m128i p = _mm_unpacklo_epi8(
+				_mm_cvtsi32_si128(px[k]), _mm_cvtsi32_si128(px[k + 1]));
+			p = _mm_unpacklo_epi8(p, zero);
+			acc = _mm_add_epi32(
+				acc, _mm_madd_epi16(p, weightPair(w[k], w[k + 1])));
+		}
+		if(k < numTaps) {
+			__m128i p = _mm_unpacklo_epi8(_mm_cvtsi32_si128(px[k]), zero);
+			p = _mm_unpacklo_epi8(p, zero);
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(p, weightPair(w[k], 0)));
+		}
+
+		out[x] = packPixel(acc);
+	}
+}
+
+/// <summary>
+/// Calculates the weighted sum of `numRows` rows of `width` pixels.
+/// </summary>
+void ImageScaler::filterRows(
+	const uchar * const *rows, const qint16 *weights, int numRows,
+	quint32 *out, int width)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi32(1 << (WeightBits - 1));
+
+	// Process four pixels at a time
+	int x = 0;
+	for(; x + 4 <= width; x += 4) {
+		__m128i acc0 = _mm_setzero_si128();
+		__m128i acc1 = _mm_setzero_si128();
+		__m128i acc2 = _mm_setzero_si128();
+		__m128i acc3 = _mm_setzero_si128();
+		for(int k = 0; k < numRows; k += 2) {
+			__m128i a = _mm_loadu_si128(
+				reinterpret_cast<const __m128i *>(rows[k] + x * 4));
+			__m128i b = zero;
+			__m128i wv = weightPair(weights[k], 0);
+			if(k + 1 < numRows) {
+				b = _mm_loadu_si128(
+					reinterpret_cast<const __m128i *>(rows[k + 1] + x * 4));
+				wv = weightPair(weights[k], weights[k + 1]);
+			}
+			__m128i lo = _mm_unpacklo_epi8(a, b);
+			__m128i hi = _mm_unpackhi_epi8(a, b);
+			acc0 = _mm_add_epi32(
+				acc0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), wv));
+			acc1 = _mm_add_epi32(
+				acc1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), wv));
+			acc2 = _mm_add_epi32(
+				acc2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), wv));
+			acc3 = _mm_add_epi32(
+				acc3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), wv));
+		}
+		acc0 = _mm_srai_epi32(_mm_add_epi32(acc0, round), WeightBits);
+		acc1 = _mm_srai_epi32(_mm_add_epi32(acc1, round), WeightBits);
+		acc2 = _mm_srai_epi32(_mm_add_epi32(acc2, round), WeightBits);
+		acc3 = _mm_srai_epi32(_mm_add_epi32(acc3, round), WeightBits);
+		__m128i res = _mm_packus_epi16(
+			_mm_packs_epi32(acc0, acc1), _mm_packs_epi32(acc2, acc3));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out + x), res);
+	}
+
+	// Process the remaining pixels individually
+	for(; x < width; x++) {
+		__m128i acc = _mm_setzero_si128();
+		for(int k = 0; k < numRows; k += 2) {
+			__m128i a = _mm_cvtsi32_si128(
+				*reinterpret_cast<const int *>(rows[k] + x * 4));
+			__m128i b = zero;
+			__m128i wv = weightPair(weights[k], 0);
+			if(k + 1 < numRows) {
+				b = _mm_cvtsi32_si128(
+					*reinterpret_cast<const int *>(rows[k + 1] + x * 4));
+				wv = weightPair(weights[k], weights[k + 1]);
+			}
+			__m128i p = _mm_unpacklo_epi8(_mm_unpacklo_epi8(a, b), zero);
+			acc = _mm_add_epi32(acc, _mm_madd_epi16(p, wv));
+		}
+		out[x] = packPixel(acc);
+	}
+}
+
+/// <summary>
+/// Rescales every row of `src` into `dst` which must have the same height.
+/// </summary>
+void ImageScaler::scaleHorizontal(
+	const QImage &src, QImage &dst, const WeightTable &table)
+{
+	for(int y = 0; y < dst.height(); y++) {
+		filterRow(reinterpret_cast<const quint32 *>(src.constScanLine(y)),
+			reinterpret_cast<quint32 *>(dst.scanLine(y)), table);
+	}
+}
+
+/// <summary>
+/// Rescales every column of `src` into `dst` which must have the same width.
+/// </summary>
+void ImageScaler::scaleVertical(
+	const QImage &src, QImage &dst, const WeightTable &table)
+{
+	const int numTaps = table.numTaps;
+	QVector<const uchar *> rows(numTaps);
+	for(int y = 0; y < table.dstLen; y++) {
+		const int offset = table.offsets.at(y);
+		for(int k = 0; k < numTaps; k++)
+			rows[k] = src.constScanLine(offset + k);
+		filterRows(rows.constData(), table.weights.constData() + y * numTaps,
+			numTaps, reinterpret_cast<quint32 *>(dst.scanLine(y)),
+			dst.width());
+	}
+}
+
+/// <summary>
+/// Makes sure that no colour channel is larger than the alpha channel.
+/// </summary>
+void ImageScaler::clampPremultiplied(QImage &img)
+{
+	const int width = img.width();
+	for(int y = 0; y < img.height(); y++) {
+		quint32 *line = reinterpret_cast<quint32 *>(img.scanLine(y));
+		int x = 0;
+		for(; x + 4 <= width; x += 4) {
+			__m128i px = _mm_loadu_si128(
+				reinterpret_cast<const __m128i *>(line + x));
+
+			// Broadcast the alpha channel to every byte of the pixel
+			__m128i a = _mm_srli_epi32(px, 24);
+			a = _mm_or_si128(a, _mm_slli_epi32(a, 8));
+			a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+
+			px = _mm_min_epu8(px, a);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(line + x), px);
+		}
+		for(; x < width; x++) {
+			const QRgb px = line[x];
+			const int a = qAlpha(px);
+			line[x] = qRgba(
+				qMin(qRed(px), a), qMin(qGreen(px), a), qMin(qBlue(px), a), a);
+		}
+	}
+}
@@ -0,0 +1,95 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#ifndef IMAGESCALER_H
+#define IMAGESCALER_H
+
+#include "include/libvidgfx.h"
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QVector>
+#include <QtGui/QImage>
+
+//=============================================================================
+/// <summary>
+/// CPU image rescaler for 32-bit images. Scaling is done separably with a
+/// horizontal pass followed by a vertical pass using fixed-point filter weights
+/// that are cached per (source length, destination length, filter) so that
+/// repeatedly scaling images of the same size only calculates the weights
+/// once. Downscaling with `GfxBilinearFilter` uses exact area averaging in a
+/// single pass over the source instead and upscaling with `GfxPointFilter` by
+/// an exact integer ratio simply replicates pixels. All methods are
+/// thread-safe.
+/// </summary>
+class ImageScaler
+{
+private: // Datatypes ---------------------------------------------------------
+	enum Kernel {
+		PointKernel = 0,
+		TentKernel,
+		CubicKernel,
+		LanczosKernel,
+		AreaKernel // Exact box coverage, downscaling only
+	};
+
+	struct WeightTable {
+		int				srcLen;
+		int				dstLen;
+		Kernel			kernel;
+		int				numTaps; // Number of weights per output pixel
+		QVector<int>	offsets; // First input pixel of each output pixel
+		QVector<qint16>	weights; // `numTaps` weights per output pixel
+	};
+
+public: // Constants ----------------------------------------------------------
+
+	// Filter weights are stored as 2.14 fixed-point numbers
+	static const int	WeightBits = 14;
+	static const int	WeightOne = (1 << WeightBits);
+
+	// The maximum number of weight tables that are kept in memory
+	static const int	MaxCachedTables = 16;
+
+protected: // Static members --------------------------------------------------
+	static QList<WeightTable>	s_weightCache;
+	static QMutex				s_weightCacheMutex;
+
+public: // Static methods -----------------------------------------------------
+	static QImage	scale(
+		const QImage &img, const QSize &size, VidgfxFilter filter);
+	static QImage	scaleArea(const QImage &img, const QSize &size);
+	static QImage	scaleInteger(const QImage &img, int xFactor, int yFactor);
+	static void		clearWeightCache();
+
+private:
+	static QImage		to32Bit(const QImage &img);
+	static WeightTable	getWeightTable(int srcLen, int dstLen, Kernel kernel);
+	static WeightTable	calcWeightTable(int srcLen, int dstLen, Kernel kernel);
+	static void			filterRow(
+		const quint32 *in, quint32 *out, const WeightTable &table);
+	static void			filterRows(
+		const uchar * const *rows, const qint16 *weights, int numRows,
+		quint32 *out, int width);
+	static void			scaleHorizontal(
+		const QImage &src, QImage &dst, const WeightTable &table);
+	static void			scaleVertical(
+		const QImage &src, QImage &dst, const WeightTable &table);
+	static void			clampPremultiplied(QImage &img);
+};
+//=============================================================================
+
+#endif // IMAGESCALER_H
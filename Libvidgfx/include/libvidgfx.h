@@ -33,6 +33,7 @@
 #include <QtCore/QString>
 #include <QtGui/QColor>
 #include <QtGui/QMatrix4x4>
+#include <QtGui/QTransform>
 #if VIDGFX_D3D_ENABLED
 #include <windows.h>
 #endif // VIDGFX_D3D_ENABLED
@@ -64,7 +65,41 @@
 // Do not use line topologies as they are unreliable and prone to bugs
 enum VidgfxTopology {
 	GfxTriangleListTopology,
-	GfxTriangleStripTopology
+	GfxTriangleStripTopology,
+	GfxQuadListTopology // 4 vertices per quad, uses the shared index buffer
+};
+
+// The memory layout of each vertex in a vertex buffer. The compact formats
+// drop the constant Z and W position components and pack colours into a
+// single 32-bit RGBA8 value. Compact formats are only supported by the solid
+// and texture decal shader families.
+enum VidgfxVertFormat {
+	GfxFullVertFormat = 0, // XYZW position + RGBA or UV, all floats
+	GfxCompactVertFormat, // XY position + RGBA8 colour or float UV
+	GfxCompactUnormVertFormat // XY position + RGBA8 colour or 16-bit UNORM UV
+};
+
+// Where the CPU-side contents of a vertex buffer live. Shadowed buffers keep
+// a copy of the data in system memory that can be read back at any time.
+// Write-through buffers have no copy and must be mapped before writing, the
+// mapped memory is write-only and its previous contents are discarded.
+enum VidgfxBufStorage {
+	GfxShadowedStorage = 0,
+	GfxWriteThroughStorage
+};
+
+// The result of testing a rectangle against the visible area of the current
+// render target.
+enum VidgfxCullResult {
+	GfxRectVisible = 0, // Entirely visible, left unmodified
+	GfxRectClipped, // Partially visible, clipped to the visible area
+	GfxRectCulled // Not visible at all, should not be rendered
+};
+
+// How `createSolidPolyline()` connects neighbouring segments of a polyline.
+enum VidgfxLineJoin {
+	GfxMiterJoin = 0, // Extend the edges until they meet
+	GfxBevelJoin // Cut the corner off with a straight edge
 };
 
 enum VidgfxRendTarget {
@@ -132,14 +167,19 @@ enum VidgfxShader {
 	GfxYv12RgbShader,
 	GfxUyvyRgbShader,
 	GfxHdycRgbShader,
-	GfxYuy2RgbShader
+	GfxYuy2RgbShader,
+	GfxTexDecalMipShader, // Alpha-weighted mipmap generation
+	GfxResizeGizmoShader, // Resize layer for `createResizeGizmo()` geometry
+	GfxInstancedLayerShader, // Layer instances, see `drawInstanced()`
+	GfxTexResampleShader // Separable bicubic/Lanczos rescale pass
 };
 
 enum VidgfxFilter {
 	// Standard filters shown to the user
 	GfxPointFilter = 0,
 	GfxBilinearFilter,
-	//GfxBicubicFilter,
+	GfxBicubicFilter,
+	GfxLanczosFilter,
 
 	NUM_STANDARD_TEXTURE_FILTERS, // Must be after all standard filters
 
@@ -149,12 +189,23 @@ enum VidgfxFilter {
 static const char * const VidgfxFilterStrs[] = {
 	"Nearest neighbour",
 	"Bilinear",
-	//"Bicubic",
+	"Bicubic",
+	"Lanczos",
 };
 static const char * const VidgfxFilterQualStrs[] = {
 	"Low (Nearest neighbour)",
 	"Medium (Bilinear)",
-	//"High (Bicubic)",
+	"High (Bicubic)",
+	"Very high (Lanczos)",
+};
+
+// How texture coordinates outside of the [0..1] range are resolved
+enum VidgfxAddressMode {
+	GfxClampAddressing = 0, // Repeat the edge texels
+	GfxWrapAddressing, // Tile the texture
+	GfxMirrorAddressing, // Tile the texture, flipping every other tile
+
+	NUM_ADDRESS_MODES // Must be last
 };
 
 enum VidgfxBlending {
@@ -168,14 +219,18 @@ enum VidgfxTexFlags_ {
 	GfxWritableFlag = (1 << 0),
 	GfxTargetableFlag = (1 << 1),
 	GfxStagingFlag = (1 << 2),
-	GfxGDIFlag = (1 << 3) // Used by `D3DContext` only
+	GfxGDIFlag = (1 << 3), // Used by `D3DContext` only
+	GfxExternalFlag = (1 << 4), // Content can be modified outside of Libvidgfx
+	GfxAlphaFlag = (1 << 5) // Alpha channel contains meaningful coverage
 };
 
 enum VidgfxOrientation {
 	GfxUnchangedOrient = 0,
 	GfxFlippedOrient,
 	GfxMirroredOrient,
-	GfxFlippedMirroredOrient
+	GfxFlippedMirroredOrient,
+	GfxRotated90Orient, // Clockwise, swaps width and height
+	GfxRotated270Orient // Anticlockwise, swaps width and height
 };
 
 enum VidgfxLogLvl {
@@ -191,7 +246,57 @@ enum VidgfxLogLvl {
 DECLARE_OPAQUE(VidgfxContext);
 DECLARE_OPAQUE(VidgfxTex);
 DECLARE_OPAQUE(VidgfxVertBuf);
+DECLARE_OPAQUE(VidgfxIdxBuf);
 DECLARE_OPAQUE(VidgfxTexDecalBuf);
+DECLARE_OPAQUE(VidgfxSpriteBatch);
+DECLARE_OPAQUE(VidgfxScrollDecalMgr);
+DECLARE_OPAQUE(VidgfxSoftLayerRend);
+DECLARE_OPAQUE(VidgfxNineSliceBuf);
+DECLARE_OPAQUE(VidgfxCmdList);
+
+// A block of vertices in the graphics context's transient vertex ring. See
+// `vidgfx_context_alloc_transient_verts()`.
+struct VidgfxTransientVerts {
+	int					start_vert;
+	int					num_verts;
+	int					vert_size; // In floats
+	VidgfxVertFormat	format;
+	quint32				generation; // Used to detect stale blocks
+};
+
+// Statistics of the viewport culling done by the graphics context. See
+// `vidgfx_context_get_cull_stats()`.
+struct VidgfxCullStats {
+	int	num_tested;
+	int	num_culled;
+	int	num_clipped;
+};
+
+// A single textured or solid rectangle that is rendered by
+// `vidgfx_context_draw_instanced()`. `tex_slot` selects which of the bound
+// textures the layer samples (0-2) or -1 for a solid colour.
+struct VidgfxLayerInstance {
+	QRectF	rect;
+	QRectF	uv_rect;
+	QColor	color; // Modulates the texture
+	int		tex_slot;
+};
+
+// A rectangle that is split into a 3x3 grid of slices so that its corners
+// keep their size when the rectangle is resized, see
+// `vidgfx_create_nine_slice_rect()`. The borders are the sizes of the left
+// and top (`tl_border`) and right and bottom (`br_border`) slices in world
+// units, the UV insets are the same sizes in texture space within `uv_rect`.
+struct VidgfxNineSlice {
+	QRectF	rect;
+	QPointF	tl_border;
+	QPointF	br_border;
+	QRectF	uv_rect;
+	QPointF	tl_uv_inset;
+	QPointF	br_uv_inset;
+};
+
+DECLARE_OPAQUE(VidgfxImgPyramid);
 DECLARE_OPAQUE(VidgfxD3DContext);
 DECLARE_OPAQUE(VidgfxD3DTex);
 #undef DECLARE_OPAQUE
@@ -229,6 +334,14 @@ API_EXPORT float *vidgfx_vertbuf_get_data_ptr(
 	VidgfxVertBuf *buf);
 API_EXPORT int vidgfx_vertbuf_get_num_floats(
 	VidgfxVertBuf *buf);
+API_EXPORT VidgfxBufStorage vidgfx_vertbuf_get_storage(
+	VidgfxVertBuf *buf);
+API_EXPORT bool vidgfx_vertbuf_is_mapped(
+	VidgfxVertBuf *buf);
+API_EXPORT float *vidgfx_vertbuf_map(
+	VidgfxVertBuf *buf);
+API_EXPORT void vidgfx_vertbuf_unmap(
+	VidgfxVertBuf *buf);
 
 API_EXPORT void vidgfx_vertbuf_set_num_verts(
 	VidgfxVertBuf *buf,
@@ -240,19 +353,52 @@ API_EXPORT void vidgfx_vertbuf_set_vert_size(
 	int vert_size);
 API_EXPORT int vidgfx_vertbuf_get_vert_size(
 	VidgfxVertBuf *buf);
+API_EXPORT void vidgfx_vertbuf_set_vert_format(
+	VidgfxVertBuf *buf,
+	VidgfxVertFormat format);
+API_EXPORT VidgfxVertFormat vidgfx_vertbuf_get_vert_format(
+	VidgfxVertBuf *buf);
 
 API_EXPORT void vidgfx_vertbuf_set_dirty(
 	VidgfxVertBuf *buf,
 	bool dirty = true);
 API_EXPORT bool vidgfx_vertbuf_is_dirty(
 	VidgfxVertBuf *buf);
+API_EXPORT void vidgfx_vertbuf_mark_dirty(
+	VidgfxVertBuf *buf,
+	int first_float,
+	int num_floats);
+
+//=============================================================================
+// IndexBuffer C interface
+
+//-----------------------------------------------------------------------------
+// Methods
+
+API_EXPORT quint16 *vidgfx_idxbuf_get_data_ptr(
+	VidgfxIdxBuf *buf);
+API_EXPORT int vidgfx_idxbuf_get_max_indices(
+	VidgfxIdxBuf *buf);
+
+API_EXPORT void vidgfx_idxbuf_set_num_indices(
+	VidgfxIdxBuf *buf,
+	int num_indices);
+API_EXPORT int vidgfx_idxbuf_get_num_indices(
+	VidgfxIdxBuf *buf);
+
+API_EXPORT void vidgfx_idxbuf_set_dirty(
+	VidgfxIdxBuf *buf,
+	bool dirty = true);
+API_EXPORT bool vidgfx_idxbuf_is_dirty(
+	VidgfxIdxBuf *buf);
 
 //=============================================================================
 // TexDecalVertBuf C interface
 
-// Buffer information for `vidgfx_create_tex_decal_rect()`. 4 rectangles of 6
-// vertices where each vertex is 8 floats.
-#define VIDGFX_SCROLL_RECT_NUM_VERTS (4 * 6)
+// Buffer information for `vidgfx_create_tex_decal_rect()`. 4 quads of 4
+// vertices where each vertex is 8 floats. Must be rendered with
+// `GfxQuadListTopology`.
+#define VIDGFX_SCROLL_RECT_NUM_VERTS (4 * 4)
 #define VIDGFX_SCROLL_RECT_NUM_FLOATS (VIDGFX_SCROLL_RECT_NUM_VERTS * 8)
 #define VIDGFX_SCROLL_RECT_BUF_SIZE \
 	(VIDGFX_SCROLL_RECT_NUM_FLOATS * sizeof(float))
@@ -275,6 +421,8 @@ API_EXPORT VidgfxVertBuf *vidgfx_texdecalbuf_get_vert_buf(
 	VidgfxTexDecalBuf *buf); // Applies settings
 API_EXPORT VidgfxTopology vidgfx_texdecalbuf_get_topology(
 	VidgfxTexDecalBuf *buf);
+API_EXPORT VidgfxAddressMode vidgfx_texdecalbuf_get_address_mode(
+	VidgfxTexDecalBuf *buf);
 API_EXPORT void vidgfx_texdecalbuf_destroy_vert_buf(
 	VidgfxTexDecalBuf *buf);
 
@@ -300,6 +448,11 @@ API_EXPORT void vidgfx_texdecalbuf_set_round_offset(
 	bool round);
 API_EXPORT bool vidgfx_texdecalbuf_get_round_offset(
 	VidgfxTexDecalBuf *buf);
+API_EXPORT void vidgfx_texdecalbuf_set_use_wrap_addressing(
+	VidgfxTexDecalBuf *buf,
+	bool use_wrap);
+API_EXPORT bool vidgfx_texdecalbuf_get_use_wrap_addressing(
+	VidgfxTexDecalBuf *buf);
 
 // Texture UV
 API_EXPORT void vidgfx_texdecalbuf_set_tex_uv(
@@ -324,6 +477,449 @@ API_EXPORT void vidgfx_texdecalbuf_get_tex_uv(
 	QPointF *bot_left,
 	QPointF *bot_right);
 
+//=============================================================================
+// NineSliceVertBuf C interface
+
+//-----------------------------------------------------------------------------
+// Constructor/destructor
+
+API_EXPORT VidgfxNineSliceBuf *vidgfx_nineslicebuf_new(
+	VidgfxContext *context = NULL);
+API_EXPORT void vidgfx_nineslicebuf_destroy(
+	VidgfxNineSliceBuf *buf);
+
+//-----------------------------------------------------------------------------
+// Methods
+
+API_EXPORT void vidgfx_nineslicebuf_set_context(
+	VidgfxNineSliceBuf *buf,
+	VidgfxContext *context);
+API_EXPORT VidgfxVertBuf *vidgfx_nineslicebuf_get_vert_buf(
+	VidgfxNineSliceBuf *buf); // Applies settings
+API_EXPORT VidgfxIdxBuf *vidgfx_nineslicebuf_get_idx_buf(
+	VidgfxNineSliceBuf *buf);
+API_EXPORT VidgfxTopology vidgfx_nineslicebuf_get_topology(
+	VidgfxNineSliceBuf *buf);
+API_EXPORT void vidgfx_nineslicebuf_destroy_bufs(
+	VidgfxNineSliceBuf *buf);
+API_EXPORT void vidgfx_nineslicebuf_draw(
+	VidgfxNineSliceBuf *buf);
+
+// Position
+API_EXPORT void vidgfx_nineslicebuf_set_rect(
+	VidgfxNineSliceBuf *buf,
+	const QRectF &rect);
+API_EXPORT QRectF vidgfx_nineslicebuf_get_rect(
+	VidgfxNineSliceBuf *buf);
+API_EXPORT void vidgfx_nineslicebuf_set_borders(
+	VidgfxNineSliceBuf *buf,
+	const QPointF &top_left,
+	const QPointF &bot_right);
+API_EXPORT void vidgfx_nineslicebuf_get_borders(
+	VidgfxNineSliceBuf *buf,
+	QPointF *top_left,
+	QPointF *bot_right);
+
+// Texture UV
+API_EXPORT void vidgfx_nineslicebuf_set_tex_uv(
+	VidgfxNineSliceBuf *buf,
+	const QRectF &norm_rect);
+API_EXPORT QRectF vidgfx_nineslicebuf_get_tex_uv(
+	VidgfxNineSliceBuf *buf);
+API_EXPORT void vidgfx_nineslicebuf_set_tex_insets(
+	VidgfxNineSliceBuf *buf,
+	const QPointF &top_left,
+	const QPointF &bot_right);
+API_EXPORT void vidgfx_nineslicebuf_get_tex_insets(
+	VidgfxNineSliceBuf *buf,
+	QPointF *top_left,
+	QPointF *bot_right);
+
+//=============================================================================
+// SpriteBatch C interface
+
+//-----------------------------------------------------------------------------
+// Constructor/destructor
+
+API_EXPORT VidgfxSpriteBatch *vidgfx_spritebatch_new(
+	VidgfxContext *context = NULL);
+API_EXPORT void vidgfx_spritebatch_destroy(
+	VidgfxSpriteBatch *batch);
+
+//-----------------------------------------------------------------------------
+// Methods
+
+API_EXPORT void vidgfx_spritebatch_set_context(
+	VidgfxSpriteBatch *batch,
+	VidgfxContext *context);
+API_EXPORT void vidgfx_spritebatch_destroy_vert_buf(
+	VidgfxSpriteBatch *batch);
+API_EXPORT void vidgfx_spritebatch_clear(
+	VidgfxSpriteBatch *batch);
+API_EXPORT int vidgfx_spritebatch_get_num_verts(
+	VidgfxSpriteBatch *batch);
+API_EXPORT int vidgfx_spritebatch_get_num_draw_calls(
+	VidgfxSpriteBatch *batch);
+API_EXPORT void vidgfx_spritebatch_draw(
+	VidgfxSpriteBatch *batch);
+
+// State
+API_EXPORT void vidgfx_spritebatch_set_tex_shader(
+	VidgfxSpriteBatch *batch,
+	VidgfxShader shader);
+API_EXPORT VidgfxShader vidgfx_spritebatch_get_tex_shader(
+	VidgfxSpriteBatch *batch);
+API_EXPORT void vidgfx_spritebatch_set_blending(
+	VidgfxSpriteBatch *batch,
+	VidgfxBlending blending);
+API_EXPORT VidgfxBlending vidgfx_spritebatch_get_blending(
+	VidgfxSpriteBatch *batch);
+API_EXPORT void vidgfx_spritebatch_set_tex(
+	VidgfxSpriteBatch *batch,
+	VidgfxTex *tex);
+API_EXPORT VidgfxTex *vidgfx_spritebatch_get_tex(
+	VidgfxSpriteBatch *batch);
+API_EXPORT void vidgfx_spritebatch_set_tex_filter(
+	VidgfxSpriteBatch *batch,
+	VidgfxFilter filter);
+API_EXPORT VidgfxFilter vidgfx_spritebatch_get_tex_filter(
+	VidgfxSpriteBatch *batch);
+API_EXPORT void vidgfx_spritebatch_set_tex_address_mode(
+	VidgfxSpriteBatch *batch,
+	VidgfxAddressMode mode);
+API_EXPORT VidgfxAddressMode vidgfx_spritebatch_get_tex_address_mode(
+	VidgfxSpriteBatch *batch);
+
+// Rectangles
+API_EXPORT void vidgfx_spritebatch_add_solid_rect(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect,
+	const QColor &col);
+API_EXPORT void vidgfx_spritebatch_add_solid_rect(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect,
+	const QColor &tl_col,
+	const QColor &tr_col,
+	const QColor &bl_col,
+	const QColor &br_col);
+API_EXPORT void vidgfx_spritebatch_add_solid_rect_outline(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect,
+	const QColor &col,
+	const QPointF &half_width = QPointF(0.5f, 0.5f));
+API_EXPORT void vidgfx_spritebatch_add_solid_rect_outline(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect,
+	const QColor &tl_col,
+	const QColor &tr_col,
+	const QColor &bl_col,
+	const QColor &br_col,
+	const QPointF &half_width = QPointF(0.5f, 0.5f));
+API_EXPORT void vidgfx_spritebatch_add_tex_decal_rect(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect);
+API_EXPORT void vidgfx_spritebatch_add_tex_decal_rect(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect,
+	const QPointF &tl_uv,
+	const QPointF &tr_uv,
+	const QPointF &bl_uv,
+	const QPointF &br_uv);
+API_EXPORT void vidgfx_spritebatch_add_solid_rect(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect,
+	const QTransform &transform,
+	const QColor &col);
+API_EXPORT void vidgfx_spritebatch_add_solid_rect(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect,
+	const QTransform &transform,
+	const QColor &tl_col,
+	const QColor &tr_col,
+	const QColor &bl_col,
+	const QColor &br_col);
+API_EXPORT void vidgfx_spritebatch_add_tex_decal_rect(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect,
+	const QTransform &transform);
+API_EXPORT void vidgfx_spritebatch_add_tex_decal_rect(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect,
+	const QTransform &transform,
+	const QPointF &tl_uv,
+	const QPointF &tr_uv,
+	const QPointF &bl_uv,
+	const QPointF &br_uv);
+
+// Polylines
+API_EXPORT void vidgfx_spritebatch_add_solid_polyline(
+	VidgfxSpriteBatch *batch,
+	const QPointF *points,
+	int num_points,
+	const QColor &col,
+	float half_width = 0.5f,
+	VidgfxLineJoin join = GfxMiterJoin,
+	bool closed = false);
+API_EXPORT void vidgfx_spritebatch_add_solid_polyline(
+	VidgfxSpriteBatch *batch,
+	const QPointF *points,
+	int num_points,
+	const QColor *cols,
+	float half_width = 0.5f,
+	VidgfxLineJoin join = GfxMiterJoin,
+	bool closed = false);
+
+//=============================================================================
+// ScrollDecalManager C interface
+
+//-----------------------------------------------------------------------------
+// Constructor/destructor
+
+API_EXPORT VidgfxScrollDecalMgr *vidgfx_scrolldecalmgr_new(
+	VidgfxContext *context = NULL);
+API_EXPORT void vidgfx_scrolldecalmgr_destroy(
+	VidgfxScrollDecalMgr *mgr);
+
+//-----------------------------------------------------------------------------
+// Methods
+
+API_EXPORT void vidgfx_scrolldecalmgr_set_context(
+	VidgfxScrollDecalMgr *mgr,
+	VidgfxContext *context);
+API_EXPORT void vidgfx_scrolldecalmgr_destroy_vert_buf(
+	VidgfxScrollDecalMgr *mgr);
+API_EXPORT int vidgfx_scrolldecalmgr_get_num_verts(
+	VidgfxScrollDecalMgr *mgr);
+API_EXPORT int vidgfx_scrolldecalmgr_get_num_draw_calls(
+	VidgfxScrollDecalMgr *mgr);
+API_EXPORT void vidgfx_scrolldecalmgr_draw(
+	VidgfxScrollDecalMgr *mgr);
+
+// State
+API_EXPORT void vidgfx_scrolldecalmgr_set_tex_shader(
+	VidgfxScrollDecalMgr *mgr,
+	VidgfxShader shader);
+API_EXPORT VidgfxShader vidgfx_scrolldecalmgr_get_tex_shader(
+	VidgfxScrollDecalMgr *mgr);
+API_EXPORT void vidgfx_scrolldecalmgr_set_blending(
+	VidgfxScrollDecalMgr *mgr,
+	VidgfxBlending blending);
+API_EXPORT VidgfxBlending vidgfx_scrolldecalmgr_get_blending(
+	VidgfxScrollDecalMgr *mgr);
+API_EXPORT void vidgfx_scrolldecalmgr_set_tex_filter(
+	VidgfxScrollDecalMgr *mgr,
+	VidgfxFilter filter);
+API_EXPORT VidgfxFilter vidgfx_scrolldecalmgr_get_tex_filter(
+	VidgfxScrollDecalMgr *mgr);
+API_EXPORT void vidgfx_scrolldecalmgr_set_round_offset(
+	VidgfxScrollDecalMgr *mgr,
+	bool round);
+API_EXPORT bool vidgfx_scrolldecalmgr_get_round_offset(
+	VidgfxScrollDecalMgr *mgr);
+
+// Decals
+API_EXPORT int vidgfx_scrolldecalmgr_add_decal(
+	VidgfxScrollDecalMgr *mgr,
+	VidgfxTex *tex,
+	const QRectF &rect);
+API_EXPORT void vidgfx_scrolldecalmgr_remove_decal(
+	VidgfxScrollDecalMgr *mgr,
+	int id);
+API_EXPORT void vidgfx_scrolldecalmgr_clear(
+	VidgfxScrollDecalMgr *mgr);
+API_EXPORT int vidgfx_scrolldecalmgr_get_num_decals(
+	VidgfxScrollDecalMgr *mgr);
+API_EXPORT void vidgfx_scrolldecalmgr_set_decal_tex(
+	VidgfxScrollDecalMgr *mgr,
+	int id,
+	VidgfxTex *tex);
+API_EXPORT VidgfxTex *vidgfx_scrolldecalmgr_get_decal_tex(
+	VidgfxScrollDecalMgr *mgr,
+	int id);
+API_EXPORT void vidgfx_scrolldecalmgr_set_decal_rect(
+	VidgfxScrollDecalMgr *mgr,
+	int id,
+	const QRectF &rect);
+API_EXPORT QRectF vidgfx_scrolldecalmgr_get_decal_rect(
+	VidgfxScrollDecalMgr *mgr,
+	int id);
+API_EXPORT void vidgfx_scrolldecalmgr_set_decal_tex_uv(
+	VidgfxScrollDecalMgr *mgr,
+	int id,
+	const QPointF &top_left,
+	const QPointF &top_right,
+	const QPointF &bot_left,
+	const QPointF &bot_right);
+API_EXPORT void vidgfx_scrolldecalmgr_get_decal_tex_uv(
+	VidgfxScrollDecalMgr *mgr,
+	int id,
+	QPointF *top_left,
+	QPointF *top_right,
+	QPointF *bot_left,
+	QPointF *bot_right);
+
+// Scrolling
+API_EXPORT void vidgfx_scrolldecalmgr_scroll_decal_by(
+	VidgfxScrollDecalMgr *mgr,
+	int id,
+	const QPointF &delta);
+API_EXPORT void vidgfx_scrolldecalmgr_scroll_decal_by(
+	VidgfxScrollDecalMgr *mgr,
+	int id,
+	float x_delta,
+	float y_delta);
+API_EXPORT void vidgfx_scrolldecalmgr_reset_decal_scrolling(
+	VidgfxScrollDecalMgr *mgr,
+	int id);
+API_EXPORT QPointF vidgfx_scrolldecalmgr_get_decal_scroll_offset(
+	VidgfxScrollDecalMgr *mgr,
+	int id);
+API_EXPORT void vidgfx_scrolldecalmgr_set_decal_scroll_speed(
+	VidgfxScrollDecalMgr *mgr,
+	int id,
+	const QPointF &speed);
+API_EXPORT QPointF vidgfx_scrolldecalmgr_get_decal_scroll_speed(
+	VidgfxScrollDecalMgr *mgr,
+	int id);
+API_EXPORT void vidgfx_scrolldecalmgr_advance(
+	VidgfxScrollDecalMgr *mgr,
+	float time);
+
+//=============================================================================
+// SoftwareLayerRenderer C interface
+
+//-----------------------------------------------------------------------------
+// Constructor/destructor
+
+API_EXPORT VidgfxSoftLayerRend *vidgfx_softlayerrend_new(
+	QImage *target = NULL);
+API_EXPORT void vidgfx_softlayerrend_destroy(
+	VidgfxSoftLayerRend *rend);
+
+//-----------------------------------------------------------------------------
+// Methods
+
+API_EXPORT void vidgfx_softlayerrend_set_target(
+	VidgfxSoftLayerRend *rend,
+	QImage *target);
+API_EXPORT QImage *vidgfx_softlayerrend_get_target(
+	VidgfxSoftLayerRend *rend);
+API_EXPORT void vidgfx_softlayerrend_set_view_rect(
+	VidgfxSoftLayerRend *rend,
+	const QRectF &rect);
+API_EXPORT QRectF vidgfx_softlayerrend_get_view_rect(
+	VidgfxSoftLayerRend *rend);
+API_EXPORT void vidgfx_softlayerrend_set_blending(
+	VidgfxSoftLayerRend *rend,
+	VidgfxBlending blending);
+API_EXPORT VidgfxBlending vidgfx_softlayerrend_get_blending(
+	VidgfxSoftLayerRend *rend);
+API_EXPORT void vidgfx_softlayerrend_set_tex(
+	VidgfxSoftLayerRend *rend,
+	const QImage *tex_a,
+	const QImage *tex_b = NULL,
+	const QImage *tex_c = NULL);
+API_EXPORT const QImage *vidgfx_softlayerrend_get_tex(
+	VidgfxSoftLayerRend *rend,
+	int slot);
+API_EXPORT void vidgfx_softlayerrend_set_tex_filter(
+	VidgfxSoftLayerRend *rend,
+	VidgfxFilter filter,
+	VidgfxAddressMode mode = GfxClampAddressing);
+API_EXPORT VidgfxFilter vidgfx_softlayerrend_get_tex_filter(
+	VidgfxSoftLayerRend *rend);
+API_EXPORT VidgfxAddressMode vidgfx_softlayerrend_get_tex_address_mode(
+	VidgfxSoftLayerRend *rend);
+API_EXPORT void vidgfx_softlayerrend_set_mod_color(
+	VidgfxSoftLayerRend *rend,
+	const QColor &color);
+API_EXPORT QColor vidgfx_softlayerrend_get_mod_color(
+	VidgfxSoftLayerRend *rend);
+API_EXPORT void vidgfx_softlayerrend_clear(
+	VidgfxSoftLayerRend *rend,
+	const QColor &color);
+API_EXPORT bool vidgfx_softlayerrend_draw_instances(
+	VidgfxSoftLayerRend *rend,
+	const float *data,
+	int num_instances);
+API_EXPORT bool vidgfx_softlayerrend_draw_instances(
+	VidgfxSoftLayerRend *rend,
+	VidgfxVertBuf *inst_buf,
+	int num_instances = -1,
+	int start_instance = 0);
+
+//=============================================================================
+// CommandList C interface
+
+//-----------------------------------------------------------------------------
+// Constructor/destructor
+
+API_EXPORT VidgfxCmdList *vidgfx_cmdlist_new();
+API_EXPORT void vidgfx_cmdlist_destroy(
+	VidgfxCmdList *list);
+
+//-----------------------------------------------------------------------------
+// Methods
+
+API_EXPORT void vidgfx_cmdlist_reset(
+	VidgfxCmdList *list);
+API_EXPORT int vidgfx_cmdlist_get_num_cmds(
+	VidgfxCmdList *list);
+API_EXPORT void vidgfx_cmdlist_submit(
+	VidgfxCmdList *list,
+	VidgfxContext *context);
+API_EXPORT int vidgfx_cmdlist_get_num_binds(
+	VidgfxCmdList *list);
+
+// Ordering
+API_EXPORT void vidgfx_cmdlist_begin_sort_group(
+	VidgfxCmdList *list);
+API_EXPORT void vidgfx_cmdlist_end_sort_group(
+	VidgfxCmdList *list);
+
+// Recording
+API_EXPORT void vidgfx_cmdlist_set_render_target(
+	VidgfxCmdList *list,
+	VidgfxRendTarget target);
+API_EXPORT void vidgfx_cmdlist_set_shader(
+	VidgfxCmdList *list,
+	VidgfxShader shader);
+API_EXPORT void vidgfx_cmdlist_set_topology(
+	VidgfxCmdList *list,
+	VidgfxTopology topology);
+API_EXPORT void vidgfx_cmdlist_set_blending(
+	VidgfxCmdList *list,
+	VidgfxBlending blending);
+API_EXPORT void vidgfx_cmdlist_set_tex(
+	VidgfxCmdList *list,
+	VidgfxTex *tex_a,
+	VidgfxTex *tex_b = NULL,
+	VidgfxTex *tex_c = NULL);
+API_EXPORT void vidgfx_cmdlist_set_tex_filter(
+	VidgfxCmdList *list,
+	VidgfxFilter filter,
+	VidgfxAddressMode mode = GfxClampAddressing);
+API_EXPORT void vidgfx_cmdlist_clear(
+	VidgfxCmdList *list,
+	const QColor &color);
+API_EXPORT void vidgfx_cmdlist_draw_buf(
+	VidgfxCmdList *list,
+	VidgfxVertBuf *buf,
+	int num_vertices = -1,
+	int start_vertex = 0);
+API_EXPORT void vidgfx_cmdlist_draw_buf(
+	VidgfxCmdList *list,
+	VidgfxVertBuf *buf,
+	VidgfxIdxBuf *idx_buf,
+	int num_indices = -1,
+	int start_index = 0,
+	int base_vertex = 0);
+API_EXPORT void vidgfx_cmdlist_draw_instanced(
+	VidgfxCmdList *list,
+	VidgfxVertBuf *inst_buf,
+	int num_instances = -1,
+	int start_instance = 0);
+
 //=============================================================================
 // Texture C interface
 
@@ -345,6 +941,11 @@ API_EXPORT bool vidgfx_tex_is_targetable(
 	VidgfxTex *tex);
 API_EXPORT bool vidgfx_tex_is_staging(
 	VidgfxTex *tex);
+API_EXPORT bool vidgfx_tex_has_alpha(
+	VidgfxTex *tex);
+API_EXPORT void vidgfx_tex_set_has_alpha(
+	VidgfxTex *tex,
+	bool hasAlpha);
 API_EXPORT QSize vidgfx_tex_get_size(
 	VidgfxTex *tex);
 API_EXPORT int vidgfx_tex_get_width(
@@ -354,7 +955,13 @@ API_EXPORT int vidgfx_tex_get_height(
 
 API_EXPORT void vidgfx_tex_update_data(
 	VidgfxTex *tex,
-	const QImage &img);
+	const QImage &img,
+	VidgfxOrientation orient = GfxUnchangedOrient);
+
+API_EXPORT quint32 vidgfx_tex_get_generation(
+	VidgfxTex *tex);
+API_EXPORT void vidgfx_tex_bump_generation(
+	VidgfxTex *tex);
 
 //-----------------------------------------------------------------------------
 // Interface
@@ -367,11 +974,36 @@ API_EXPORT void vidgfx_tex_unmap(
 API_EXPORT bool vidgfx_tex_is_srgb_hack(
 	VidgfxTex *tex);
 
+//=============================================================================
+// ImagePyramid C interface
+
+//-----------------------------------------------------------------------------
+// Constructor/destructor
+
+API_EXPORT VidgfxImgPyramid *vidgfx_imgpyramid_new(
+	const QImage &img,
+	const QSize &max_size); // Starts building on a worker thread
+API_EXPORT void vidgfx_imgpyramid_destroy(
+	VidgfxImgPyramid *pyramid);
+
+//-----------------------------------------------------------------------------
+// Methods
+
+API_EXPORT bool vidgfx_imgpyramid_is_finished(
+	VidgfxImgPyramid *pyramid);
+API_EXPORT void vidgfx_imgpyramid_wait_for_finished(
+	VidgfxImgPyramid *pyramid);
+API_EXPORT QSize vidgfx_imgpyramid_get_size(
+	VidgfxImgPyramid *pyramid);
+
 //=============================================================================
 // GraphicsContext C interface
 
-// The number of vertices required to represent one line
-#define VIDGFX_NUM_VERTS_PER_LINE (6)
+// The number of vertices required to represent one line. Lines are quads that
+// must be rendered with `GfxQuadListTopology`, this was 6 vertices rendered
+// with `GfxTriangleListTopology` before v0.6.0. Applies to the outline,
+// resize rectangle, resize gizmo and polyline buffers as well.
+#define VIDGFX_NUM_VERTS_PER_LINE (4)
 
 // The number of vertices required to represent one rectangle
 #define VIDGFX_NUM_VERTS_PER_RECT (4 * VIDGFX_NUM_VERTS_PER_LINE)
@@ -395,12 +1027,79 @@ API_EXPORT bool vidgfx_tex_is_srgb_hack(
 #define VIDGFX_TEX_DECAL_RECT_BUF_SIZE \
 	(VIDGFX_TEX_DECAL_RECT_NUM_FLOATS * sizeof(float))
 
+// Buffer information for `createSolidRectCompact()` (1 vertex = 3 floats)
+#define VIDGFX_SOLID_RECT_COMPACT_NUM_FLOATS (VIDGFX_SOLID_RECT_NUM_VERTS * 3)
+#define VIDGFX_SOLID_RECT_COMPACT_BUF_SIZE \
+	(VIDGFX_SOLID_RECT_COMPACT_NUM_FLOATS * sizeof(float))
+
+// Buffer information for `createSolidRectOutlineCompact()` (1 vertex = 3
+// floats)
+#define VIDGFX_SOLID_RECT_OUTLINE_COMPACT_NUM_FLOATS \
+	(VIDGFX_SOLID_RECT_OUTLINE_NUM_VERTS * 3)
+#define VIDGFX_SOLID_RECT_OUTLINE_COMPACT_BUF_SIZE \
+	(VIDGFX_SOLID_RECT_OUTLINE_COMPACT_NUM_FLOATS * sizeof(float))
+
+// Buffer information for `createTexDecalRectCompact()` (1 vertex = 4 floats,
+// or 3 floats if the UVs are 16-bit UNORM)
+#define VIDGFX_TEX_DECAL_RECT_COMPACT_NUM_FLOATS \
+	(VIDGFX_TEX_DECAL_RECT_NUM_VERTS * 4)
+#define VIDGFX_TEX_DECAL_RECT_COMPACT_BUF_SIZE \
+	(VIDGFX_TEX_DECAL_RECT_COMPACT_NUM_FLOATS * sizeof(float))
+
 // Buffer information for `createResizeRect()` (1 vertex = 4 floats)
 #define VIDGFX_RESIZE_RECT_NUM_VERTS (10 * VIDGFX_NUM_VERTS_PER_RECT)
 #define VIDGFX_RESIZE_RECT_NUM_FLOATS (VIDGFX_RESIZE_RECT_NUM_VERTS * 4)
 #define VIDGFX_RESIZE_RECT_BUF_SIZE \
 	(VIDGFX_RESIZE_RECT_NUM_FLOATS * sizeof(float))
 
+// Buffer information for `createResizeGizmo()` (1 vertex = 4 floats)
+#define VIDGFX_RESIZE_GIZMO_NUM_VERTS VIDGFX_RESIZE_RECT_NUM_VERTS
+#define VIDGFX_RESIZE_GIZMO_NUM_FLOATS VIDGFX_RESIZE_RECT_NUM_FLOATS
+#define VIDGFX_RESIZE_GIZMO_BUF_SIZE VIDGFX_RESIZE_RECT_BUF_SIZE
+
+// Buffer information for `createLayerInstances()`. Each instance is 16 floats
+// and is rendered as a 4 vertex triangle strip.
+#define VIDGFX_LAYER_INST_NUM_FLOATS (16)
+#define VIDGFX_LAYER_INST_BUF_SIZE \
+	(VIDGFX_LAYER_INST_NUM_FLOATS * sizeof(float))
+
+// The number of bound textures that layer instances can select between
+#define VIDGFX_MAX_LAYER_INST_TEXTURES (3)
+
+// Buffer information for `createNineSliceRect()` (1 vertex = 8 floats)
+#define VIDGFX_NINE_SLICE_NUM_VERTS (9 * 4)
+#define VIDGFX_NINE_SLICE_NUM_FLOATS (VIDGFX_NINE_SLICE_NUM_VERTS * 8)
+#define VIDGFX_NINE_SLICE_BUF_SIZE \
+	(VIDGFX_NINE_SLICE_NUM_FLOATS * sizeof(float))
+
+// Buffer information for `createNineSliceGrid()` (1 vertex = 8 floats) and
+// the indices of `createNineSliceIndices()`
+#define VIDGFX_NINE_SLICE_GRID_NUM_VERTS (4 * 4)
+#define VIDGFX_NINE_SLICE_GRID_NUM_FLOATS \
+	(VIDGFX_NINE_SLICE_GRID_NUM_VERTS * 8)
+#define VIDGFX_NINE_SLICE_GRID_BUF_SIZE \
+	(VIDGFX_NINE_SLICE_GRID_NUM_FLOATS * sizeof(float))
+#define VIDGFX_NINE_SLICE_NUM_INDICES (9 * 6)
+
+// Buffer information for `createSolidPolyline()` (1 vertex = 8 floats). This
+// is the worst case where every corner of the polyline is bevelled.
+#define VIDGFX_SOLID_POLYLINE_NUM_VERTS(num_points, closed) \
+	((num_points) < 2 ? 0 : ((closed) ? 2 * (num_points) : \
+	2 * (num_points) - 3) * VIDGFX_NUM_VERTS_PER_LINE)
+#define VIDGFX_SOLID_POLYLINE_NUM_FLOATS(num_points, closed) \
+	(VIDGFX_SOLID_POLYLINE_NUM_VERTS(num_points, closed) * 8)
+#define VIDGFX_SOLID_POLYLINE_BUF_SIZE(num_points, closed) \
+	(VIDGFX_SOLID_POLYLINE_NUM_FLOATS(num_points, closed) * sizeof(float))
+
+// The number of quads in the shared quad index buffer. Draws with
+// `GfxQuadListTopology` that contain more quads are split automatically.
+#define VIDGFX_MAX_QUADS_PER_DRAW (16384)
+#define VIDGFX_QUAD_IDX_BUF_NUM_INDICES (VIDGFX_MAX_QUADS_PER_DRAW * 6)
+
+// The size of the transient vertex ring that short-lived geometry is
+// sub-allocated from (1 MB)
+#define VIDGFX_TRANSIENT_BUF_NUM_FLOATS (256 * 1024)
+
 //-----------------------------------------------------------------------------
 // Static methods
 
@@ -445,13 +1144,137 @@ API_EXPORT bool vidgfx_create_tex_decal_rect(
 	const QPointF &bl_uv,
 	const QPointF &br_uv);
 
+API_EXPORT bool vidgfx_create_solid_rect_compact(
+	VidgfxVertBuf *out_buf,
+	const QRectF &rect,
+	const QColor &col);
+API_EXPORT bool vidgfx_create_solid_rect_compact(
+	VidgfxVertBuf *out_buf,
+	const QRectF &rect,
+	const QColor &tl_col,
+	const QColor &tr_col,
+	const QColor &bl_col,
+	const QColor &br_col);
+
+API_EXPORT bool vidgfx_create_solid_rect_outline_compact(
+	VidgfxVertBuf *out_buf,
+	const QRectF &rect,
+	const QColor &col,
+	const QPointF &half_width = QPointF(0.5f, 0.5f));
+API_EXPORT bool vidgfx_create_solid_rect_outline_compact(
+	VidgfxVertBuf *out_buf,
+	const QRectF &rect,
+	const QColor &tl_col,
+	const QColor &tr_col,
+	const QColor &bl_col,
+	const QColor &br_col,
+	const QPointF &half_width = QPointF(0.5f, 0.5f));
+
+API_EXPORT bool vidgfx_create_tex_decal_rect_compact(
+	VidgfxVertBuf *out_buf,
+	const QRectF &rect,
+	bool unorm_uv = false);
+API_EXPORT bool vidgfx_create_tex_decal_rect_compact(
+	VidgfxVertBuf *out_buf,
+	const QRectF &rect,
+	const QPointF &tl_uv,
+	const QPointF &tr_uv,
+	const QPointF &bl_uv,
+	const QPointF &br_uv,
+	bool unorm_uv = false);
+
 API_EXPORT bool vidgfx_create_resize_rect(
 	VidgfxVertBuf *out_buf,
 	const QRectF &rect,
 	float handle_size,
 	const QPointF &half_width = QPointF(0.5f, 0.5f));
+API_EXPORT bool vidgfx_create_resize_gizmo(
+	VidgfxVertBuf *out_buf,
+	float handle_size,
+	const QPointF &half_width = QPointF(0.5f, 0.5f));
+
+API_EXPORT int vidgfx_write_tex_decal_rect(
+	float *data,
+	const QRectF &rect,
+	const QPointF &tl_uv,
+	const QPointF &tr_uv,
+	const QPointF &bl_uv,
+	const QPointF &br_uv);
+
+API_EXPORT bool vidgfx_create_transformed_solid_rects(
+	VidgfxVertBuf *out_buf,
+	const QRectF *rects,
+	const QTransform *transforms,
+	int num_rects,
+	const QColor *cols);
+API_EXPORT bool vidgfx_create_transformed_tex_decal_rects(
+	VidgfxVertBuf *out_buf,
+	const QRectF *rects,
+	const QTransform *transforms,
+	int num_rects,
+	const QPointF *uvs = NULL);
+
+API_EXPORT bool vidgfx_create_nine_slice_rect(
+	VidgfxVertBuf *out_buf,
+	const VidgfxNineSlice &slice);
+API_EXPORT bool vidgfx_create_nine_slice_grid(
+	VidgfxVertBuf *out_buf,
+	const VidgfxNineSlice &slice);
+API_EXPORT bool vidgfx_create_nine_slice_indices(
+	VidgfxIdxBuf *out_buf);
+
+API_EXPORT bool vidgfx_create_solid_polyline(
+	VidgfxVertBuf *out_buf,
+	const QPointF *points,
+	int num_points,
+	const QColor &col,
+	float half_width = 0.5f,
+	VidgfxLineJoin join = GfxMiterJoin,
+	bool closed = false);
+API_EXPORT bool vidgfx_create_solid_polyline(
+	VidgfxVertBuf *out_buf,
+	const QPointF *points,
+	int num_points,
+	const QColor *cols,
+	float half_width = 0.5f,
+	VidgfxLineJoin join = GfxMiterJoin,
+	bool closed = false);
+
+API_EXPORT VidgfxCullResult vidgfx_clip_tex_decal_rect(
+	const QRectF &clip_rect,
+	QRectF *rect,
+	QPointF *tl_uv = NULL,
+	QPointF *tr_uv = NULL,
+	QPointF *bl_uv = NULL,
+	QPointF *br_uv = NULL);
+
+API_EXPORT bool vidgfx_create_layer_instances(
+	VidgfxVertBuf *out_buf,
+	const VidgfxLayerInstance *instances,
+	int num_instances);
+API_EXPORT int vidgfx_write_layer_instances(
+	float *data,
+	const VidgfxLayerInstance *instances,
+	int num_instances);
+
+API_EXPORT bool vidgfx_create_quad_indices(
+	VidgfxIdxBuf *out_buf,
+	int num_quads);
 
 // Helpers
+API_EXPORT QImage vidgfx_scale_img(
+	const QImage &img,
+	const QSize &size,
+	VidgfxFilter filter);
+API_EXPORT QImage vidgfx_orient_img(
+	const QImage &img,
+	VidgfxOrientation orient);
+API_EXPORT quint32 vidgfx_sample_img(
+	const QImage &img,
+	const QPointF &uv,
+	VidgfxFilter filter,
+	VidgfxAddressMode mode = GfxClampAddressing);
+
 API_EXPORT quint32 vidgfx_next_pow_two(
 	quint32 n);
 
@@ -480,6 +1303,28 @@ API_EXPORT void vidgfx_context_set_screen_proj_mat(
 API_EXPORT QMatrix4x4 vidgfx_context_get_screen_proj_mat(
 	VidgfxContext *context);
 
+API_EXPORT void vidgfx_context_set_culling_enabled(
+	VidgfxContext *context,
+	bool enabled);
+API_EXPORT bool vidgfx_context_is_culling_enabled(
+	VidgfxContext *context);
+API_EXPORT QRectF vidgfx_context_get_visible_rect(
+	VidgfxContext *context);
+API_EXPORT VidgfxCullResult vidgfx_context_cull_rect(
+	VidgfxContext *context,
+	const QRectF &rect);
+API_EXPORT VidgfxCullResult vidgfx_context_cull_tex_decal_rect(
+	VidgfxContext *context,
+	QRectF *rect,
+	QPointF *tl_uv,
+	QPointF *tr_uv,
+	QPointF *bl_uv,
+	QPointF *br_uv);
+API_EXPORT VidgfxCullStats vidgfx_context_get_cull_stats(
+	VidgfxContext *context);
+API_EXPORT void vidgfx_context_reset_cull_stats(
+	VidgfxContext *context);
+
 API_EXPORT void vidgfx_context_set_user_render_target(
 	VidgfxContext *context,
 	VidgfxTex *tex_a,
@@ -501,6 +1346,16 @@ API_EXPORT void vidgfx_context_set_resize_layer_rect(
 	const QRectF &rect);
 API_EXPORT QRectF vidgfx_context_get_resize_layer_rect(
 	VidgfxContext *context);
+API_EXPORT void vidgfx_context_set_resize_gizmo_rect(
+	VidgfxContext *context,
+	const QRectF &rect);
+API_EXPORT QRectF vidgfx_context_get_resize_gizmo_rect(
+	VidgfxContext *context);
+API_EXPORT void vidgfx_context_draw_resize_gizmo(
+	VidgfxContext *context,
+	const QRectF &rect,
+	float handle_size,
+	const QPointF &half_width = QPointF(0.5f, 0.5f));
 
 API_EXPORT void vidgfx_context_set_rgb_nv16_px_size(
 	VidgfxContext *context,
@@ -544,10 +1399,19 @@ API_EXPORT void vidgfx_context_flush(
 // Buffers
 API_EXPORT VidgfxVertBuf *vidgfx_context_new_vertbuf(
 	VidgfxContext *context,
-	int size);
+	int size,
+	VidgfxBufStorage storage = GfxShadowedStorage);
 API_EXPORT void vidgfx_context_destroy_vertbuf(
 	VidgfxContext *context,
 	VidgfxVertBuf *buf);
+API_EXPORT VidgfxIdxBuf *vidgfx_context_new_idxbuf(
+	VidgfxContext *context,
+	int num_indices);
+API_EXPORT void vidgfx_context_destroy_idxbuf(
+	VidgfxContext *context,
+	VidgfxIdxBuf *buf);
+API_EXPORT VidgfxIdxBuf *vidgfx_context_get_quad_idxbuf(
+	VidgfxContext *context);
 API_EXPORT VidgfxTex *vidgfx_context_new_tex(
 	VidgfxContext *context,
 	QImage img,
@@ -565,6 +1429,9 @@ API_EXPORT VidgfxTex *vidgfx_context_new_tex(
 	VidgfxTex *same_format,
 	bool writable = false,
 	bool targetable = false);
+API_EXPORT VidgfxTex *vidgfx_context_new_mipmapped_tex(
+	VidgfxContext *context,
+	VidgfxImgPyramid *pyramid); // NULL if the pyramid isn't finished
 API_EXPORT VidgfxTex *vidgfx_context_new_staging_tex(
 	VidgfxContext *context,
 	const QSize &size);
@@ -617,6 +1484,18 @@ API_EXPORT VidgfxTex *vidgfx_context_prepare_tex(
 	QPointF &px_size_out,
 	QPointF &top_left_out,
 	QPointF &bot_right_out);
+typedef void VidgfxContextLadderCallback(
+	void *opaque, VidgfxContext *context, int index, VidgfxTex *tex,
+	const QPointF &px_size, const QPointF &top_left,
+	const QPointF &bot_right);
+API_EXPORT void vidgfx_context_prepare_tex_ladder(
+	VidgfxContext *context,
+	VidgfxTex *tex,
+	const QSize *sizes,
+	int num_sizes,
+	VidgfxFilter filter,
+	VidgfxContextLadderCallback *callback,
+	void *opaque);
 API_EXPORT VidgfxTex *vidgfx_context_convert_to_bgrx(
 	VidgfxContext *context,
 	VidgfxPixFormat format,
@@ -644,7 +1523,8 @@ API_EXPORT void vidgfx_context_set_tex(
 	VidgfxTex *tex_c = NULL);
 API_EXPORT void vidgfx_context_set_tex_filter(
 	VidgfxContext *context,
-	VidgfxFilter filter);
+	VidgfxFilter filter,
+	VidgfxAddressMode mode = GfxClampAddressing);
 API_EXPORT void vidgfx_context_clear(
 	VidgfxContext *context,
 	const QColor &color);
@@ -653,6 +1533,31 @@ API_EXPORT void vidgfx_context_draw_buf(
 	VidgfxVertBuf *buf,
 	int num_vertices = -1,
 	int start_vertex = 0);
+API_EXPORT void vidgfx_context_draw_buf(
+	VidgfxContext *context,
+	VidgfxVertBuf *buf,
+	VidgfxIdxBuf *idx_buf,
+	int num_indices = -1,
+	int start_index = 0,
+	int base_vertex = 0);
+API_EXPORT void vidgfx_context_draw_instanced(
+	VidgfxContext *context,
+	VidgfxVertBuf *inst_buf,
+	int num_instances = -1,
+	int start_instance = 0);
+
+// Transient geometry
+API_EXPORT float *vidgfx_context_alloc_transient_verts(
+	VidgfxContext *context,
+	int num_verts,
+	int vert_size,
+	VidgfxVertFormat format,
+	VidgfxTransientVerts *verts_out);
+API_EXPORT void vidgfx_context_draw_transient_verts(
+	VidgfxContext *context,
+	const VidgfxTransientVerts &verts);
+API_EXPORT void vidgfx_context_end_frame(
+	VidgfxContext *context);
 
 //-----------------------------------------------------------------------------
 // Signals
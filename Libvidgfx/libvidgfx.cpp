@@ -16,8 +16,14 @@
 //*****************************************************************************
 
 #include "include/libvidgfx.h"
+#include "commandlist.h"
 #include "d3dcontext.h"
 #include "gfxlog.h"
+#include "imagepyramid.h"
+#include "nineslicevertbuf.h"
+#include "scrolldecalmanager.h"
+#include "softwarelayerrenderer.h"
+#include "spritebatch.h"
 #include <iostream>
 #ifdef Q_OS_WIN
 #include <windows.h>
@@ -134,6 +140,34 @@ int vidgfx_vertbuf_get_num_floats(
 	return ptr->getNumFloats();
 }
 
+VidgfxBufStorage vidgfx_vertbuf_get_storage(
+	VidgfxVertBuf *buf)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(buf);
+	return ptr->getStorage();
+}
+
+bool vidgfx_vertbuf_is_mapped(
+	VidgfxVertBuf *buf)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(buf);
+	return ptr->isMapped();
+}
+
+float *vidgfx_vertbuf_map(
+	VidgfxVertBuf *buf)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(buf);
+	return ptr->map();
+}
+
+void vidgfx_vertbuf_unmap(
+	VidgfxVertBuf *buf)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(buf);
+	ptr->unmap();
+}
+
 void vidgfx_vertbuf_set_num_verts(
 	VidgfxVertBuf *buf,
 	int num_verts)
@@ -164,6 +198,21 @@ int vidgfx_vertbuf_get_vert_size(
 	return ptr->getVertSize();
 }
 
+void vidgfx_vertbuf_set_vert_format(
+	VidgfxVertBuf *buf,
+	VidgfxVertFormat format)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(buf);
+	ptr->setVertFormat(format);
+}
+
+VidgfxVertFormat vidgfx_vertbuf_get_vert_format(
+	VidgfxVertBuf *buf)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(buf);
+	return ptr->getVertFormat();
+}
+
 void vidgfx_vertbuf_set_dirty(
 	VidgfxVertBuf *buf,
 	bool dirty)
@@ -179,6 +228,65 @@ bool vidgfx_vertbuf_is_dirty(
 	return ptr->isDirty();
 }
 
+void vidgfx_vertbuf_mark_dirty(
+	VidgfxVertBuf *buf,
+	int first_float,
+	int num_floats)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(buf);
+	ptr->markDirty(first_float, num_floats);
+}
+
+//=============================================================================
+// IndexBuffer C interface
+
+//-----------------------------------------------------------------------------
+// Methods
+
+quint16 *vidgfx_idxbuf_get_data_ptr(
+	VidgfxIdxBuf *buf)
+{
+	IndexBuffer *ptr = reinterpret_cast<IndexBuffer *>(buf);
+	return ptr->getDataPtr();
+}
+
+int vidgfx_idxbuf_get_max_indices(
+	VidgfxIdxBuf *buf)
+{
+	IndexBuffer *ptr = reinterpret_cast<IndexBuffer *>(buf);
+	return ptr->getMaxIndices();
+}
+
+void vidgfx_idxbuf_set_num_indices(
+	VidgfxIdxBuf *buf,
+	int num_indices)
+{
+	IndexBuffer *ptr = reinterpret_cast<IndexBuffer *>(buf);
+	ptr->setNumIndices(num_indices);
+}
+
+int vidgfx_idxbuf_get_num_indices(
+	VidgfxIdxBuf *buf)
+{
+	IndexBuffer *ptr = reinterpret_cast<IndexBuffer *>(buf);
+	return ptr->getNumIndices();
+}
+
+void vidgfx_idxbuf_set_dirty(
+	VidgfxIdxBuf *buf,
+	bool dirty)
+{
+	IndexBuffer *ptr = reinterpret_cast<IndexBuffer *>(buf);
+	ptr->setDirty(dirty);
+}
+
+bool vidgfx_idxbuf_is_dirty(
+	VidgfxIdxBuf *buf)
+{
+	IndexBuffer *ptr = reinterpret_cast<IndexBuffer *>(buf);
+	return ptr->isDirty();
+}
+
 //=============================================================================
 // TexDecalVertBuf C interface
 
@@ -228,6 +336,13 @@ VidgfxTopology vidgfx_texdecalbuf_get_topology(
 	return ptr->getTopology();
 }
 
+VidgfxAddressMode vidgfx_texdecalbuf_get_address_mode(
+	VidgfxTexDecalBuf *buf)
+{
+	TexDecalVertBuf *ptr = reinterpret_cast<TexDecalVertBuf *>(buf);
+	return ptr->getAddressMode();
+}
+
 void vidgfx_texdecalbuf_destroy_vert_buf(
 	VidgfxTexDecalBuf *buf)
 {
@@ -291,6 +406,21 @@ bool vidgfx_texdecalbuf_get_round_offset(
 	return ptr->getRoundOffset();
 }
 
+void vidgfx_texdecalbuf_set_use_wrap_addressing(
+	VidgfxTexDecalBuf *buf,
+	bool use_wrap)
+{
+	TexDecalVertBuf *ptr = reinterpret_cast<TexDecalVertBuf *>(buf);
+	ptr->setUseWrapAddressing(use_wrap);
+}
+
+bool vidgfx_texdecalbuf_get_use_wrap_addressing(
+	VidgfxTexDecalBuf *buf)
+{
+	TexDecalVertBuf *ptr = reinterpret_cast<TexDecalVertBuf *>(buf);
+	return ptr->getUseWrapAddressing();
+}
+
 // Texture UV
 void vidgfx_texdecalbuf_set_tex_uv(
 	VidgfxTexDecalBuf *buf,
@@ -334,113 +464,1220 @@ void vidgfx_texdecalbuf_get_tex_uv(
 }
 
 //=============================================================================
-// Texture C interface
+// NineSliceVertBuf C interface
+
+//-----------------------------------------------------------------------------
+// Constructor/destructor
+
+VidgfxNineSliceBuf *vidgfx_nineslicebuf_new(
+	VidgfxContext *context)
+{
+	GraphicsContext *con = reinterpret_cast<GraphicsContext *>(context);
+	NineSliceVertBuf *vertBuf = new NineSliceVertBuf(con);
+	return reinterpret_cast<VidgfxNineSliceBuf *>(vertBuf);
+}
+
+void vidgfx_nineslicebuf_destroy(
+	VidgfxNineSliceBuf *buf)
+{
+	NineSliceVertBuf *vertBuf = reinterpret_cast<NineSliceVertBuf *>(buf);
+	if(vertBuf != NULL)
+		delete vertBuf;
+}
 
 //-----------------------------------------------------------------------------
 // Methods
 
-bool vidgfx_tex_is_valid(
-	VidgfxTex *tex)
+void vidgfx_nineslicebuf_set_context(
+	VidgfxNineSliceBuf *buf,
+	VidgfxContext *context)
 {
-	if(tex == NULL)
-		return false;
-	Texture *ptr = reinterpret_cast<Texture *>(tex);
-	return ptr->isValid();
+	NineSliceVertBuf *ptr = reinterpret_cast<NineSliceVertBuf *>(buf);
+	GraphicsContext *con = reinterpret_cast<GraphicsContext *>(context);
+	ptr->setContext(con);
 }
 
-bool vidgfx_tex_is_mapped(
-	VidgfxTex *tex)
+VidgfxVertBuf *vidgfx_nineslicebuf_get_vert_buf(
+	VidgfxNineSliceBuf *buf)
 {
-	Texture *ptr = reinterpret_cast<Texture *>(tex);
-	return ptr->isMapped();
+	NineSliceVertBuf *ptr = reinterpret_cast<NineSliceVertBuf *>(buf);
+	VertexBuffer *ret = ptr->getVertBuf();
+	return reinterpret_cast<VidgfxVertBuf *>(ret);
 }
 
-void *vidgfx_tex_get_data_ptr(
-	VidgfxTex *tex)
+VidgfxIdxBuf *vidgfx_nineslicebuf_get_idx_buf(
+	VidgfxNineSliceBuf *buf)
 {
-	Texture *ptr = reinterpret_cast<Texture *>(tex);
-	return ptr->getDataPtr();
+	NineSliceVertBuf *ptr = reinterpret_cast<NineSliceVertBuf *>(buf);
+	IndexBuffer *ret = ptr->getIdxBuf();
+	return reinterpret_cast<VidgfxIdxBuf *>(ret);
 }
 
-int vidgfx_tex_get_stride(
-	VidgfxTex *tex)
+VidgfxTopology vidgfx_nineslicebuf_get_topology(
+	VidgfxNineSliceBuf *buf)
 {
-	Texture *ptr = reinterpret_cast<Texture *>(tex);
-	return ptr->getStride();
+	NineSliceVertBuf *ptr = reinterpret_cast<NineSliceVertBuf *>(buf);
+	return ptr->getTopology();
 }
 
-bool vidgfx_tex_is_writable(
-	VidgfxTex *tex)
+void vidgfx_nineslicebuf_destroy_bufs(
+	VidgfxNineSliceBuf *buf)
 {
-	Texture *ptr = reinterpret_cast<Texture *>(tex);
-	return ptr->isWritable();
+	NineSliceVertBuf *ptr = reinterpret_cast<NineSliceVertBuf *>(buf);
+	ptr->deleteBuffers();
 }
 
-bool vidgfx_tex_is_targetable(
-	VidgfxTex *tex)
+void vidgfx_nineslicebuf_draw(
+	VidgfxNineSliceBuf *buf)
 {
-	Texture *ptr = reinterpret_cast<Texture *>(tex);
-	return ptr->isTargetable();
+	NineSliceVertBuf *ptr = reinterpret_cast<NineSliceVertBuf *>(buf);
+	ptr->draw();
 }
 
-bool vidgfx_tex_is_staging(
-	VidgfxTex *tex)
+// Position
+void vidgfx_nineslicebuf_set_rect(
+	VidgfxNineSliceBuf *buf,
+	const QRectF &rect)
 {
-	Texture *ptr = reinterpret_cast<Texture *>(tex);
-	return ptr->isStaging();
+	NineSliceVertBuf *ptr = reinterpret_cast<NineSliceVertBuf *>(buf);
+	ptr->setRect(rect);
 }
 
-QSize vidgfx_tex_get_size(
-	VidgfxTex *tex)
+QRectF vidgfx_nineslicebuf_get_rect(
+	VidgfxNineSliceBuf *buf)
 {
-	Texture *ptr = reinterpret_cast<Texture *>(tex);
-	return ptr->getSize();
+	NineSliceVertBuf *ptr = reinterpret_cast<NineSliceVertBuf *>(buf);
+	return ptr->getRect();
 }
 
-int vidgfx_tex_get_width(
-	VidgfxTex *tex)
+void vidgfx_nineslicebuf_set_borders(
+	VidgfxNineSliceBuf *buf,
+	const QPointF &top_left,
+	const QPointF &bot_right)
 {
-	Texture *ptr = reinterpret_cast<Texture *>(tex);
-	return ptr->getWidth();
+	NineSliceVertBuf *ptr = reinterpret_cast<NineSliceVertBuf *>(buf);
+	ptr->setBorders(top_left, bot_right);
 }
 
-int vidgfx_tex_get_height(
-	VidgfxTex *tex)
+void vidgfx_nineslicebuf_get_borders(
+	VidgfxNineSliceBuf *buf,
+	QPointF *top_left,
+	QPointF *bot_right)
 {
-	Texture *ptr = reinterpret_cast<Texture *>(tex);
-	return ptr->getHeight();
+	NineSliceVertBuf *ptr = reinterpret_cast<NineSliceVertBuf *>(buf);
+	ptr->getBorders(top_left, bot_right);
 }
 
-void vidgfx_tex_update_data(
-	VidgfxTex *tex,
-	const QImage &img)
+// Texture UV
+void vidgfx_nineslicebuf_set_tex_uv(
+	VidgfxNineSliceBuf *buf,
+	const QRectF &norm_rect)
 {
-	Texture *ptr = reinterpret_cast<Texture *>(tex);
-	ptr->updateData(img);
+	NineSliceVertBuf *ptr = reinterpret_cast<NineSliceVertBuf *>(buf);
+	ptr->setTextureUv(norm_rect);
+}
+
+QRectF vidgfx_nineslicebuf_get_tex_uv(
+	VidgfxNineSliceBuf *buf)
+{
+	NineSliceVertBuf *ptr = reinterpret_cast<NineSliceVertBuf *>(buf);
+	return ptr->getTextureUv();
+}
+
+void vidgfx_nineslicebuf_set_tex_insets(
+	VidgfxNineSliceBuf *buf,
+	const QPointF &top_left,
+	const QPointF &bot_right)
+{
+	NineSliceVertBuf *ptr = reinterpret_cast<NineSliceVertBuf *>(buf);
+	ptr->setTextureInsets(top_left, bot_right);
+}
+
+void vidgfx_nineslicebuf_get_tex_insets(
+	VidgfxNineSliceBuf *buf,
+	QPointF *top_left,
+	QPointF *bot_right)
+{
+	NineSliceVertBuf *ptr = reinterpret_cast<NineSliceVertBuf *>(buf);
+	ptr->getTextureInsets(top_left, bot_right);
 }
 
+//=============================================================================
+// SpriteBatch C interface
+
 //-----------------------------------------------------------------------------
-// Interface
+// Constructor/destructor
 
-void *vidgfx_tex_map(
+VidgfxSpriteBatch *vidgfx_spritebatch_new(
+	VidgfxContext *context)
+{
+	GraphicsContext *con = reinterpret_cast<GraphicsContext *>(context);
+	SpriteBatch *batch = new SpriteBatch(con);
+	return reinterpret_cast<VidgfxSpriteBatch *>(batch);
+}
+
+void vidgfx_spritebatch_destroy(
+	VidgfxSpriteBatch *batch)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	if(ptr != NULL)
+		delete ptr;
+}
+
+//-----------------------------------------------------------------------------
+// Methods
+
+void vidgfx_spritebatch_set_context(
+	VidgfxSpriteBatch *batch,
+	VidgfxContext *context)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	GraphicsContext *con = reinterpret_cast<GraphicsContext *>(context);
+	ptr->setContext(con);
+}
+
+void vidgfx_spritebatch_destroy_vert_buf(
+	VidgfxSpriteBatch *batch)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->deleteVertBuf();
+}
+
+void vidgfx_spritebatch_clear(
+	VidgfxSpriteBatch *batch)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->clear();
+}
+
+int vidgfx_spritebatch_get_num_verts(
+	VidgfxSpriteBatch *batch)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	return ptr->getNumVerts();
+}
+
+int vidgfx_spritebatch_get_num_draw_calls(
+	VidgfxSpriteBatch *batch)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	return ptr->getNumDrawCalls();
+}
+
+void vidgfx_spritebatch_draw(
+	VidgfxSpriteBatch *batch)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->draw();
+}
+
+void vidgfx_spritebatch_set_tex_shader(
+	VidgfxSpriteBatch *batch,
+	VidgfxShader shader)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->setTexShader(shader);
+}
+
+VidgfxShader vidgfx_spritebatch_get_tex_shader(
+	VidgfxSpriteBatch *batch)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	return ptr->getTexShader();
+}
+
+void vidgfx_spritebatch_set_blending(
+	VidgfxSpriteBatch *batch,
+	VidgfxBlending blending)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->setBlending(blending);
+}
+
+VidgfxBlending vidgfx_spritebatch_get_blending(
+	VidgfxSpriteBatch *batch)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	return ptr->getBlending();
+}
+
+void vidgfx_spritebatch_set_tex(
+	VidgfxSpriteBatch *batch,
 	VidgfxTex *tex)
 {
-	Texture *ptr = reinterpret_cast<Texture *>(tex);
-	return ptr->map();
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->setTexture(reinterpret_cast<Texture *>(tex));
+}
+
+VidgfxTex *vidgfx_spritebatch_get_tex(
+	VidgfxSpriteBatch *batch)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	return reinterpret_cast<VidgfxTex *>(ptr->getTexture());
+}
+
+void vidgfx_spritebatch_set_tex_filter(
+	VidgfxSpriteBatch *batch,
+	VidgfxFilter filter)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->setTextureFilter(filter);
+}
+
+VidgfxFilter vidgfx_spritebatch_get_tex_filter(
+	VidgfxSpriteBatch *batch)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	return ptr->getTextureFilter();
+}
+
+void vidgfx_spritebatch_set_tex_address_mode(
+	VidgfxSpriteBatch *batch,
+	VidgfxAddressMode mode)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->setTextureAddressMode(mode);
+}
+
+VidgfxAddressMode vidgfx_spritebatch_get_tex_address_mode(
+	VidgfxSpriteBatch *batch)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	return ptr->getTextureAddressMode();
+}
+
+void vidgfx_spritebatch_add_solid_rect(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect,
+	const QColor &col)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->addSolidRect(rect, col);
+}
+
+void vidgfx_spritebatch_add_solid_rect(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect,
+	const QColor &tl_col,
+	const QColor &tr_col,
+	const QColor &bl_col,
+	const QColor &br_col)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->addSolidRect(rect, tl_col, tr_col, bl_col, br_col);
+}
+
+void vidgfx_spritebatch_add_solid_rect_outline(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect,
+	const QColor &col,
+	const QPointF &half_width)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->addSolidRectOutline(rect, col, half_width);
+}
+
+void vidgfx_spritebatch_add_solid_rect_outline(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect,
+	const QColor &tl_col,
+	const QColor &tr_col,
+	const QColor &bl_col,
+	const QColor &br_col,
+	const QPointF &half_width)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->addSolidRectOutline(
+		rect, tl_col, tr_col, bl_col, br_col, half_width);
+}
+
+void vidgfx_spritebatch_add_tex_decal_rect(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->addTexDecalRect(rect);
+}
+
+void vidgfx_spritebatch_add_tex_decal_rect(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect,
+	const QPointF &tl_uv,
+	const QPointF &tr_uv,
+	const QPointF &bl_uv,
+	const QPointF &br_uv)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->addTexDecalRect(rect, tl_uv, tr_uv, bl_uv, br_uv);
+}
+
+void vidgfx_spritebatch_add_solid_rect(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect,
+	const QTransform &transform,
+	const QColor &col)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->addSolidRect(rect, transform, col);
+}
+
+void vidgfx_spritebatch_add_solid_rect(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect,
+	const QTransform &transform,
+	const QColor &tl_col,
+	const QColor &tr_col,
+	const QColor &bl_col,
+	const QColor &br_col)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->addSolidRect(rect, transform, tl_col, tr_col, bl_col, br_col);
+}
+
+void vidgfx_spritebatch_add_tex_decal_rect(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect,
+	const QTransform &transform)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->addTexDecalRect(rect, transform);
+}
+
+void vidgfx_spritebatch_add_tex_decal_rect(
+	VidgfxSpriteBatch *batch,
+	const QRectF &rect,
+	const QTransform &transform,
+	const QPointF &tl_uv,
+	const QPointF &tr_uv,
+	const QPointF &bl_uv,
+	const QPointF &br_uv)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->addTexDecalRect(rect, transform, tl_uv, tr_uv, bl_uv, br_uv);
+}
+
+void vidgfx_spritebatch_add_solid_polyline(
+	VidgfxSpriteBatch *batch,
+	const QPointF *points,
+	int num_points,
+	const QColor &col,
+	float half_width,
+	VidgfxLineJoin join,
+	bool closed)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->addSolidPolyline(points, num_points, col, half_width, join, closed);
+}
+
+void vidgfx_spritebatch_add_solid_polyline(
+	VidgfxSpriteBatch *batch,
+	const QPointF *points,
+	int num_points,
+	const QColor *cols,
+	float half_width,
+	VidgfxLineJoin join,
+	bool closed)
+{
+	SpriteBatch *ptr = reinterpret_cast<SpriteBatch *>(batch);
+	ptr->addSolidPolyline(points, num_points, cols, half_width, join, closed);
+}
+
+//=============================================================================
+// ScrollDecalManager C interface
+
+//-----------------------------------------------------------------------------
+// Constructor/destructor
+
+VidgfxScrollDecalMgr *vidgfx_scrolldecalmgr_new(
+	VidgfxContext *context)
+{
+	GraphicsContext *con = reinterpret_cast<GraphicsContext *>(context);
+	ScrollDecalManager *mgr = new ScrollDecalManager(con);
+	return reinterpret_cast<VidgfxScrollDecalMgr *>(mgr);
+}
+
+void vidgfx_scrolldecalmgr_destroy(
+	VidgfxScrollDecalMgr *mgr)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	if(ptr != NULL)
+		delete ptr;
+}
+
+//-----------------------------------------------------------------------------
+// Methods
+
+void vidgfx_scrolldecalmgr_set_context(
+	VidgfxScrollDecalMgr *mgr,
+	VidgfxContext *context)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	GraphicsContext *con = reinterpret_cast<GraphicsContext *>(context);
+	ptr->setContext(con);
+}
+
+void vidgfx_scrolldecalmgr_destroy_vert_buf(
+	VidgfxScrollDecalMgr *mgr)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	ptr->deleteVertBuf();
+}
+
+int vidgfx_scrolldecalmgr_get_num_verts(
+	VidgfxScrollDecalMgr *mgr)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	return ptr->getNumVerts();
+}
+
+int vidgfx_scrolldecalmgr_get_num_draw_calls(
+	VidgfxScrollDecalMgr *mgr)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	return ptr->getNumDrawCalls();
+}
+
+void vidgfx_scrolldecalmgr_draw(
+	VidgfxScrollDecalMgr *mgr)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	ptr->draw();
+}
+
+void vidgfx_scrolldecalmgr_set_tex_shader(
+	VidgfxScrollDecalMgr *mgr,
+	VidgfxShader shader)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	ptr->setTexShader(shader);
+}
+
+VidgfxShader vidgfx_scrolldecalmgr_get_tex_shader(
+	VidgfxScrollDecalMgr *mgr)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	return ptr->getTexShader();
+}
+
+void vidgfx_scrolldecalmgr_set_blending(
+	VidgfxScrollDecalMgr *mgr,
+	VidgfxBlending blending)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	ptr->setBlending(blending);
+}
+
+VidgfxBlending vidgfx_scrolldecalmgr_get_blending(
+	VidgfxScrollDecalMgr *mgr)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	return ptr->getBlending();
+}
+
+void vidgfx_scrolldecalmgr_set_tex_filter(
+	VidgfxScrollDecalMgr *mgr,
+	VidgfxFilter filter)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	ptr->setTextureFilter(filter);
+}
+
+VidgfxFilter vidgfx_scrolldecalmgr_get_tex_filter(
+	VidgfxScrollDecalMgr *mgr)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	return ptr->getTextureFilter();
+}
+
+void vidgfx_scrolldecalmgr_set_round_offset(
+	VidgfxScrollDecalMgr *mgr,
+	bool round)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	ptr->setRoundOffset(round);
+}
+
+bool vidgfx_scrolldecalmgr_get_round_offset(
+	VidgfxScrollDecalMgr *mgr)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	return ptr->getRoundOffset();
+}
+
+int vidgfx_scrolldecalmgr_add_decal(
+	VidgfxScrollDecalMgr *mgr,
+	VidgfxTex *tex,
+	const QRectF &rect)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	return ptr->addDecal(reinterpret_cast<Texture *>(tex), rect);
+}
+
+void vidgfx_scrolldecalmgr_remove_decal(
+	VidgfxScrollDecalMgr *mgr,
+	int id)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	ptr->removeDecal(id);
+}
+
+void vidgfx_scrolldecalmgr_clear(
+	VidgfxScrollDecalMgr *mgr)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	ptr->clear();
+}
+
+int vidgfx_scrolldecalmgr_get_num_decals(
+	VidgfxScrollDecalMgr *mgr)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	return ptr->getNumDecals();
+}
+
+void vidgfx_scrolldecalmgr_set_decal_tex(
+	VidgfxScrollDecalMgr *mgr,
+	int id,
+	VidgfxTex *tex)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	ptr->setDecalTexture(id, reinterpret_cast<Texture *>(tex));
+}
+
+VidgfxTex *vidgfx_scrolldecalmgr_get_decal_tex(
+	VidgfxScrollDecalMgr *mgr,
+	int id)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	return reinterpret_cast<VidgfxTex *>(ptr->getDecalTexture(id));
+}
+
+void vidgfx_scrolldecalmgr_set_decal_rect(
+	VidgfxScrollDecalMgr *mgr,
+	int id,
+	const QRectF &rect)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	ptr->setDecalRect(id, rect);
+}
+
+QRectF vidgfx_scrolldecalmgr_get_decal_rect(
+	VidgfxScrollDecalMgr *mgr,
+	int id)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	return ptr->getDecalRect(id);
+}
+
+void vidgfx_scrolldecalmgr_set_decal_tex_uv(
+	VidgfxScrollDecalMgr *mgr,
+	int id,
+	const QPointF &top_left,
+	const QPointF &top_right,
+	const QPointF &bot_left,
+	const QPointF &bot_right)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	ptr->setDecalTextureUv(id, top_left, top_right, bot_left, bot_right);
+}
+
+void vidgfx_scrolldecalmgr_get_decal_tex_uv(
+	VidgfxScrollDecalMgr *mgr,
+	int id,
+	QPointF *top_left,
+	QPointF *top_right,
+	QPointF *bot_left,
+	QPointF *bot_right)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	ptr->getDecalTextureUv(id, top_left, top_right, bot_left, bot_right);
+}
+
+void vidgfx_scrolldecalmgr_scroll_decal_by(
+	VidgfxScrollDecalMgr *mgr,
+	int id,
+	const QPointF &delta)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	ptr->scrollDecalBy(id, delta);
+}
+
+void vidgfx_scrolldecalmgr_scroll_decal_by(
+	VidgfxScrollDecalMgr *mgr,
+	int id,
+	float x_delta,
+	float y_delta)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	ptr->scrollDecalBy(id, QPointF(x_delta, y_delta));
+}
+
+void vidgfx_scrolldecalmgr_reset_decal_scrolling(
+	VidgfxScrollDecalMgr *mgr,
+	int id)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	ptr->resetDecalScrolling(id);
+}
+
+QPointF vidgfx_scrolldecalmgr_get_decal_scroll_offset(
+	VidgfxScrollDecalMgr *mgr,
+	int id)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	return ptr->getDecalScrollOffset(id);
+}
+
+void vidgfx_scrolldecalmgr_set_decal_scroll_speed(
+	VidgfxScrollDecalMgr *mgr,
+	int id,
+	const QPointF &speed)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	ptr->setDecalScrollSpeed(id, speed);
+}
+
+QPointF vidgfx_scrolldecalmgr_get_decal_scroll_speed(
+	VidgfxScrollDecalMgr *mgr,
+	int id)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	return ptr->getDecalScrollSpeed(id);
+}
+
+void vidgfx_scrolldecalmgr_advance(
+	VidgfxScrollDecalMgr *mgr,
+	float time)
+{
+	ScrollDecalManager *ptr = reinterpret_cast<ScrollDecalManager *>(mgr);
+	ptr->advance(time);
+}
+
+//=============================================================================
+// SoftwareLayerRenderer C interface
+
+//-----------------------------------------------------------------------------
+// Constructor/destructor
+
+VidgfxSoftLayerRend *vidgfx_softlayerrend_new(
+	QImage *target)
+{
+	SoftwareLayerRenderer *rend = new SoftwareLayerRenderer(target);
+	return reinterpret_cast<VidgfxSoftLayerRend *>(rend);
+}
+
+void vidgfx_softlayerrend_destroy(
+	VidgfxSoftLayerRend *rend)
+{
+	SoftwareLayerRenderer *ptr =
+		reinterpret_cast<SoftwareLayerRenderer *>(rend);
+	if(ptr != NULL)
+		delete ptr;
+}
+
+//-----------------------------------------------------------------------------
+// Methods
+
+void vidgfx_softlayerrend_set_target(
+	VidgfxSoftLayerRend *rend,
+	QImage *target)
+{
+	SoftwareLayerRenderer *ptr =
+		reinterpret_cast<SoftwareLayerRenderer *>(rend);
+	ptr->setTarget(target);
+}
+
+QImage *vidgfx_softlayerrend_get_target(
+	VidgfxSoftLayerRend *rend)
+{
+	SoftwareLayerRenderer *ptr =
+		reinterpret_cast<SoftwareLayerRenderer *>(rend);
+	return ptr->getTarget();
+}
+
+void vidgfx_softlayerrend_set_view_rect(
+	VidgfxSoftLayerRend *rend,
+	const QRectF &rect)
+{
+	SoftwareLayerRenderer *ptr =
+		reinterpret_cast<SoftwareLayerRenderer *>(rend);
+	ptr->setViewRect(rect);
+}
+
+QRectF vidgfx_softlayerrend_get_view_rect(
+	VidgfxSoftLayerRend *rend)
+{
+	SoftwareLayerRenderer *ptr =
+		reinterpret_cast<SoftwareLayerRenderer *>(rend);
+	return ptr->getViewRect();
+}
+
+void vidgfx_softlayerrend_set_blending(
+	VidgfxSoftLayerRend *rend,
+	VidgfxBlending blending)
+{
+	SoftwareLayerRenderer *ptr =
+		reinterpret_cast<SoftwareLayerRenderer *>(rend);
+	ptr->setBlending(blending);
+}
+
+VidgfxBlending vidgfx_softlayerrend_get_blending(
+	VidgfxSoftLayerRend *rend)
+{
+	SoftwareLayerRenderer *ptr =
+		reinterpret_cast<SoftwareLayerRenderer *>(rend);
+	return ptr->getBlending();
+}
+
+void vidgfx_softlayerrend_set_tex(
+	VidgfxSoftLayerRend *rend,
+	const QImage *tex_a,
+	const QImage *tex_b,
+	const QImage *tex_c)
+{
+	SoftwareLayerRenderer *ptr =
+		reinterpret_cast<SoftwareLayerRenderer *>(rend);
+	ptr->setTexture(tex_a, tex_b, tex_c);
+}
+
+const QImage *vidgfx_softlayerrend_get_tex(
+	VidgfxSoftLayerRend *rend,
+	int slot)
+{
+	SoftwareLayerRenderer *ptr =
+		reinterpret_cast<SoftwareLayerRenderer *>(rend);
+	return ptr->getTexture(slot);
+}
+
+void vidgfx_softlayerrend_set_tex_filter(
+	VidgfxSoftLayerRend *rend,
+	VidgfxFilter filter,
+	VidgfxAddressMode mode)
+{
+	SoftwareLayerRenderer *ptr =
+		reinterpret_cast<SoftwareLayerRenderer *>(rend);
+	ptr->setTextureFilter(filter, mode);
+}
+
+VidgfxFilter vidgfx_softlayerrend_get_tex_filter(
+	VidgfxSoftLayerRend *rend)
+{
+	SoftwareLayerRenderer *ptr =
+		reinterpret_cast<SoftwareLayerRenderer *>(rend);
+	return ptr->getTextureFilter();
+}
+
+VidgfxAddressMode vidgfx_softlayerrend_get_tex_address_mode(
+	VidgfxSoftLayerRend *rend)
+{
+	SoftwareLayerRenderer *ptr =
+		reinterpret_cast<SoftwareLayerRenderer *>(rend);
+	return ptr->getTextureAddressMode();
+}
+
+void vidgfx_softlayerrend_set_mod_color(
+	VidgfxSoftLayerRend *rend,
+	const QColor &color)
+{
+	SoftwareLayerRenderer *ptr =
+		reinterpret_cast<SoftwareLayerRenderer *>(rend);
+	ptr->setModColor(color);
+}
+
+QColor vidgfx_softlayerrend_get_mod_color(
+	VidgfxSoftLayerRend *rend)
+{
+	SoftwareLayerRenderer *ptr =
+		reinterpret_cast<SoftwareLayerRenderer *>(rend);
+	return ptr->getModColor();
+}
+
+void vidgfx_softlayerrend_clear(
+	VidgfxSoftLayerRend *rend,
+	const QColor &color)
+{
+	SoftwareLayerRenderer *ptr =
+		reinterpret_cast<SoftwareLayerRenderer *>(rend);
+	ptr->clear(color);
+}
+
+bool vidgfx_softlayerrend_draw_instances(
+	VidgfxSoftLayerRend *rend,
+	const float *data,
+	int num_instances)
+{
+	SoftwareLayerRenderer *ptr =
+		reinterpret_cast<SoftwareLayerRenderer *>(rend);
+	return ptr->drawInstances(data, num_instances);
+}
+
+bool vidgfx_softlayerrend_draw_instances(
+	VidgfxSoftLayerRend *rend,
+	VidgfxVertBuf *inst_buf,
+	int num_instances,
+	int start_instance)
+{
+	SoftwareLayerRenderer *ptr =
+		reinterpret_cast<SoftwareLayerRenderer *>(rend);
+	VertexBuffer *buf = reinterpret_cast<VertexBuffer *>(inst_buf);
+	return ptr->drawInstances(buf, num_instances, start_instance);
+}
+
+//=============================================================================
+// CommandList C interface
+
+//-----------------------------------------------------------------------------
+// Constructor/destructor
+
+VidgfxCmdList *vidgfx_cmdlist_new()
+{
+	CommandList *list = new CommandList();
+	return reinterpret_cast<VidgfxCmdList *>(list);
+}
+
+void vidgfx_cmdlist_destroy(
+	VidgfxCmdList *list)
+{
+	CommandList *ptr = reinterpret_cast<CommandList *>(list);
+	if(ptr != NULL)
+		delete ptr;
+}
+
+//-----------------------------------------------------------------------------
+// Methods
+
+void vidgfx_cmdlist_reset(
+	VidgfxCmdList *list)
+{
+	CommandList *ptr = reinterpret_cast<CommandList *>(list);
+	ptr->reset();
+}
+
+int vidgfx_cmdlist_get_num_cmds(
+	VidgfxCmdList *list)
+{
+	CommandList *ptr = reinterpret_cast<CommandList *>(list);
+	return ptr->getNumCommands();
+}
+
+void vidgfx_cmdlist_submit(
+	VidgfxCmdList *list,
+	VidgfxContext *context)
+{
+	CommandList *ptr = reinterpret_cast<CommandList *>(list);
+	GraphicsContext *con = reinterpret_cast<GraphicsContext *>(context);
+	ptr->submit(con);
+}
+
+int vidgfx_cmdlist_get_num_binds(
+	VidgfxCmdList *list)
+{
+	CommandList *ptr = reinterpret_cast<CommandList *>(list);
+	return ptr->getNumBinds();
+}
+
+//-----------------------------------------------------------------------------
+// Ordering
+
+void vidgfx_cmdlist_begin_sort_group(
+	VidgfxCmdList *list)
+{
+	CommandList *ptr = reinterpret_cast<CommandList *>(list);
+	ptr->beginSortGroup();
+}
+
+void vidgfx_cmdlist_end_sort_group(
+	VidgfxCmdList *list)
+{
+	CommandList *ptr = reinterpret_cast<CommandList *>(list);
+	ptr->endSortGroup();
+}
+
+//-----------------------------------------------------------------------------
+// Recording
+
+void vidgfx_cmdlist_set_render_target(
+	VidgfxCmdList *list,
+	VidgfxRendTarget target)
+{
+	CommandList *ptr = reinterpret_cast<CommandList *>(list);
+	ptr->setRenderTarget(target);
+}
+
+void vidgfx_cmdlist_set_shader(
+	VidgfxCmdList *list,
+	VidgfxShader shader)
+{
+	CommandList *ptr = reinterpret_cast<CommandList *>(list);
+	ptr->setShader(shader);
+}
+
+void vidgfx_cmdlist_set_topology(
+	VidgfxCmdList *list,
+	VidgfxTopology topology)
+{
+	CommandList *ptr = reinterpret_cast<CommandList *>(list);
+	ptr->setTopology(topology);
+}
+
+void vidgfx_cmdlist_set_blending(
+	VidgfxCmdList *list,
+	VidgfxBlending blending)
+{
+	CommandList *ptr = reinterpret_cast<CommandList *>(list);
+	ptr->setBlending(blending);
+}
+
+void vidgfx_cmdlist_set_tex(
+	VidgfxCmdList *list,
+	VidgfxTex *tex_a,
+	VidgfxTex *tex_b,
+	VidgfxTex *tex_c)
+{
+	CommandList *ptr = reinterpret_cast<CommandList *>(list);
+	Texture *texA = reinterpret_cast<Texture *>(tex_a);
+	Texture *texB = reinterpret_cast<Texture *>(tex_b);
+	Texture *texC = reinterpret_cast<Texture *>(tex_c);
+	ptr->setTexture(texA, texB, texC);
+}
+
+void vidgfx_cmdlist_set_tex_filter(
+	VidgfxCmdList *list,
+	VidgfxFilter filter,
+	VidgfxAddressMode mode)
+{
+	CommandList *ptr = reinterpret_cast<CommandList *>(list);
+	ptr->setTextureFilter(filter, mode);
+}
+
+void vidgfx_cmdlist_clear(
+	VidgfxCmdList *list,
+	const QColor &color)
+{
+	CommandList *ptr = reinterpret_cast<CommandList *>(list);
+	ptr->clear(color);
+}
+
+void vidgfx_cmdlist_draw_buf(
+	VidgfxCmdList *list,
+	VidgfxVertBuf *buf,
+	int num_vertices,
+	int start_vertex)
+{
+	CommandList *ptr = reinterpret_cast<CommandList *>(list);
+	VertexBuffer *vertBuf = reinterpret_cast<VertexBuffer *>(buf);
+	ptr->drawBuffer(vertBuf, num_vertices, start_vertex);
+}
+
+void vidgfx_cmdlist_draw_buf(
+	VidgfxCmdList *list,
+	VidgfxVertBuf *buf,
+	VidgfxIdxBuf *idx_buf,
+	int num_indices,
+	int start_index,
+	int base_vertex)
+{
+	CommandList *ptr = reinterpret_cast<CommandList *>(list);
+	VertexBuffer *vertBuf = reinterpret_cast<VertexBuffer *>(buf);
+	IndexBuffer *idxBuf = reinterpret_cast<IndexBuffer *>(idx_buf);
+	ptr->drawBuffer(vertBuf, idxBuf, num_indices, start_index, base_vertex);
+}
+
+void vidgfx_cmdlist_draw_instanced(
+	VidgfxCmdList *list,
+	VidgfxVertBuf *inst_buf,
+	int num_instances,
+	int start_instance)
+{
+	CommandList *ptr = reinterpret_cast<CommandList *>(list);
+	VertexBuffer *buf = reinterpret_cast<VertexBuffer *>(inst_buf);
+	ptr->drawInstanced(buf, num_instances, start_instance);
+}
+
+//=============================================================================
+// Texture C interface
+
+//-----------------------------------------------------------------------------
+// Methods
+
+bool vidgfx_tex_is_valid(
+	VidgfxTex *tex)
+{
+	if(tex == NULL)
+		return false;
+	Texture *ptr = reinterpret_cast<Texture *>(tex);
+	return ptr->isValid();
+}
+
+bool vidgfx_tex_is_mapped(
+	VidgfxTex *tex)
+{
+	Texture *ptr = reinterpret_cast<Texture *>(tex);
+	return ptr->isMapped();
+}
+
+void *vidgfx_tex_get_data_ptr(
+	VidgfxTex *tex)
+{
+	Texture *ptr = reinterpret_cast<Texture *>(tex);
+	return ptr->getDataPtr();
+}
+
+int vidgfx_tex_get_stride(
+	VidgfxTex *tex)
+{
+	Texture *ptr = reinterpret_cast<Texture *>(tex);
+	return ptr->getStride();
+}
+
+bool vidgfx_tex_is_writable(
+	VidgfxTex *tex)
+{
+	Texture *ptr = reinterpret_cast<Texture *>(tex);
+	return ptr->isWritable();
+}
+
+bool vidgfx_tex_is_targetable(
+	VidgfxTex *tex)
+{
+	Texture *ptr = reinterpret_cast<Texture *>(tex);
+	return ptr->isTargetable();
+}
+
+bool vidgfx_tex_is_staging(
+	VidgfxTex *tex)
+{
+	Texture *ptr = reinterpret_cast<Texture *>(tex);
+	return ptr->isStaging();
+}
+
+bool vidgfx_tex_has_alpha(
+	VidgfxTex *tex)
+{
+	Texture *ptr = reinterpret_cast<Texture *>(tex);
+	return ptr->hasAlpha();
+}
+
+void vidgfx_tex_set_has_alpha(
+	VidgfxTex *tex,
+	bool hasAlpha)
+{
+	Texture *ptr = reinterpret_cast<Texture *>(tex);
+	ptr->setHasAlpha(hasAlpha);
+}
+
+QSize vidgfx_tex_get_size(
+	VidgfxTex *tex)
+{
+	Texture *ptr = reinterpret_cast<Texture *>(tex);
+	return ptr->getSize();
+}
+
+int vidgfx_tex_get_width(
+	VidgfxTex *tex)
+{
+	Texture *ptr = reinterpret_cast<Texture *>(tex);
+	return ptr->getWidth();
+}
+
+int vidgfx_tex_get_height(
+	VidgfxTex *tex)
+{
+	Texture *ptr = reinterpret_cast<Texture *>(tex);
+	return ptr->getHeight();
+}
+
+void vidgfx_tex_update_data(
+	VidgfxTex *tex,
+	const QImage &img,
+	VidgfxOrientation orient)
+{
+	Texture *ptr = reinterpret_cast<Texture *>(tex);
+	ptr->updateData(img, orient);
+}
+
+quint32 vidgfx_tex_get_generation(
+	VidgfxTex *tex)
+{
+	Texture *ptr = reinterpret_cast<Texture *>(tex);
+	return ptr->getGeneration();
+}
+
+void vidgfx_tex_bump_generation(
+	VidgfxTex *tex)
+{
+	Texture *ptr = reinterpret_cast<Texture *>(tex);
+	ptr->bumpGeneration();
+}
+
+//-----------------------------------------------------------------------------
+// Interface
+
+void *vidgfx_tex_map(
+	VidgfxTex *tex)
+{
+	Texture *ptr = reinterpret_cast<Texture *>(tex);
+	return ptr->map();
+}
+
+void vidgfx_tex_unmap(
+	VidgfxTex *tex)
+{
+	Texture *ptr = reinterpret_cast<Texture *>(tex);
+	ptr->unmap();
+}
+
+bool vidgfx_tex_is_srgb_hack(
+	VidgfxTex *tex)
+{
+	Texture *ptr = reinterpret_cast<Texture *>(tex);
+	return ptr->isSrgbHack();
+}
+
+//=============================================================================
+// ImagePyramid C interface
+
+//-----------------------------------------------------------------------------
+// Constructor/destructor
+
+VidgfxImgPyramid *vidgfx_imgpyramid_new(
+	const QImage &img,
+	const QSize &max_size)
+{
+	ImagePyramid *pyramid = new ImagePyramid(img, max_size);
+	return reinterpret_cast<VidgfxImgPyramid *>(pyramid);
+}
+
+void vidgfx_imgpyramid_destroy(
+	VidgfxImgPyramid *pyramid)
+{
+	ImagePyramid *ptr = reinterpret_cast<ImagePyramid *>(pyramid);
+	if(ptr != NULL)
+		delete ptr;
+}
+
+//-----------------------------------------------------------------------------
+// Methods
+
+bool vidgfx_imgpyramid_is_finished(
+	VidgfxImgPyramid *pyramid)
+{
+	ImagePyramid *ptr = reinterpret_cast<ImagePyramid *>(pyramid);
+	return ptr->isFinished();
 }
 
-void vidgfx_tex_unmap(
-	VidgfxTex *tex)
+void vidgfx_imgpyramid_wait_for_finished(
+	VidgfxImgPyramid *pyramid)
 {
-	Texture *ptr = reinterpret_cast<Texture *>(tex);
-	ptr->unmap();
+	ImagePyramid *ptr = reinterpret_cast<ImagePyramid *>(pyramid);
+	ptr->waitForFinished();
 }
 
-bool vidgfx_tex_is_srgb_hack(
-	VidgfxTex *tex)
+QSize vidgfx_imgpyramid_get_size(
+	VidgfxImgPyramid *pyramid)
 {
-	Texture *ptr = reinterpret_cast<Texture *>(tex);
-	return ptr->isSrgbHack();
+	ImagePyramid *ptr = reinterpret_cast<ImagePyramid *>(pyramid);
+	return ptr->getSize();
 }
 
 //=============================================================================
@@ -526,6 +1763,76 @@ bool vidgfx_create_tex_decal_rect(
 		ptr, rect, tl_uv, tr_uv, bl_uv, br_uv);
 }
 
+bool vidgfx_create_solid_rect_compact(
+	VidgfxVertBuf *out_buf,
+	const QRectF &rect,
+	const QColor &col)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(out_buf);
+	return GraphicsContext::createSolidRectCompact(ptr, rect, col);
+}
+
+bool vidgfx_create_solid_rect_compact(
+	VidgfxVertBuf *out_buf,
+	const QRectF &rect,
+	const QColor &tl_col,
+	const QColor &tr_col,
+	const QColor &bl_col,
+	const QColor &br_col)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(out_buf);
+	return GraphicsContext::createSolidRectCompact(
+		ptr, rect, tl_col, tr_col, bl_col, br_col);
+}
+
+bool vidgfx_create_solid_rect_outline_compact(
+	VidgfxVertBuf *out_buf,
+	const QRectF &rect,
+	const QColor &col,
+	const QPointF &half_width)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(out_buf);
+	return GraphicsContext::createSolidRectOutlineCompact(
+		ptr, rect, col, half_width);
+}
+
+bool vidgfx_create_solid_rect_outline_compact(
+	VidgfxVertBuf *out_buf,
+	const QRectF &rect,
+	const QColor &tl_col,
+	const QColor &tr_col,
+	const QColor &bl_col,
+	const QColor &br_col,
+	const QPointF &half_width)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(out_buf);
+	return GraphicsContext::createSolidRectOutlineCompact(
+		ptr, rect, tl_col, tr_col, bl_col, br_col, half_width);
+}
+
+bool vidgfx_create_tex_decal_rect_compact(
+	VidgfxVertBuf *out_buf,
+	const QRectF &rect,
+	bool unorm_uv)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(out_buf);
+	return GraphicsContext::createTexDecalRectCompact(ptr, rect, unorm_uv);
+}
+
+bool vidgfx_create_tex_decal_rect_compact(
+	VidgfxVertBuf *out_buf,
+	const QRectF &rect,
+	const QPointF &tl_uv,
+	const QPointF &tr_uv,
+	const QPointF &bl_uv,
+	const QPointF &br_uv,
+	bool unorm_uv)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(out_buf);
+	return GraphicsContext::createTexDecalRectCompact(
+		ptr, rect, tl_uv, tr_uv, bl_uv, br_uv, unorm_uv);
+}
+
 bool vidgfx_create_resize_rect(
 	VidgfxVertBuf *out_buf,
 	const QRectF &rect,
@@ -537,6 +1844,165 @@ bool vidgfx_create_resize_rect(
 		ptr, rect, handle_size, half_width);
 }
 
+bool vidgfx_create_resize_gizmo(
+	VidgfxVertBuf *out_buf,
+	float handle_size,
+	const QPointF &half_width)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(out_buf);
+	return GraphicsContext::createResizeGizmo(ptr, handle_size, half_width);
+}
+
+int vidgfx_write_tex_decal_rect(
+	float *data,
+	const QRectF &rect,
+	const QPointF &tl_uv,
+	const QPointF &tr_uv,
+	const QPointF &bl_uv,
+	const QPointF &br_uv)
+{
+	return GraphicsContext::writeTexDecalRect(
+		data, rect, tl_uv, tr_uv, bl_uv, br_uv);
+}
+
+bool vidgfx_create_transformed_solid_rects(
+	VidgfxVertBuf *out_buf,
+	const QRectF *rects,
+	const QTransform *transforms,
+	int num_rects,
+	const QColor *cols)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(out_buf);
+	return GraphicsContext::createTransformedSolidRects(
+		ptr, rects, transforms, num_rects, cols);
+}
+
+bool vidgfx_create_transformed_tex_decal_rects(
+	VidgfxVertBuf *out_buf,
+	const QRectF *rects,
+	const QTransform *transforms,
+	int num_rects,
+	const QPointF *uvs)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(out_buf);
+	return GraphicsContext::createTransformedTexDecalRects(
+		ptr, rects, transforms, num_rects, uvs);
+}
+
+bool vidgfx_create_nine_slice_rect(
+	VidgfxVertBuf *out_buf,
+	const VidgfxNineSlice &slice)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(out_buf);
+	return GraphicsContext::createNineSliceRect(ptr, slice);
+}
+
+bool vidgfx_create_nine_slice_grid(
+	VidgfxVertBuf *out_buf,
+	const VidgfxNineSlice &slice)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(out_buf);
+	return GraphicsContext::createNineSliceGrid(ptr, slice);
+}
+
+bool vidgfx_create_nine_slice_indices(
+	VidgfxIdxBuf *out_buf)
+{
+	IndexBuffer *ptr = reinterpret_cast<IndexBuffer *>(out_buf);
+	return GraphicsContext::createNineSliceIndices(ptr);
+}
+
+bool vidgfx_create_solid_polyline(
+	VidgfxVertBuf *out_buf,
+	const QPointF *points,
+	int num_points,
+	const QColor &col,
+	float half_width,
+	VidgfxLineJoin join,
+	bool closed)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(out_buf);
+	return GraphicsContext::createSolidPolyline(
+		ptr, points, num_points, col, half_width, join, closed);
+}
+
+bool vidgfx_create_solid_polyline(
+	VidgfxVertBuf *out_buf,
+	const QPointF *points,
+	int num_points,
+	const QColor *cols,
+	float half_width,
+	VidgfxLineJoin join,
+	bool closed)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(out_buf);
+	return GraphicsContext::createSolidPolyline(
+		ptr, points, num_points, cols, half_width, join, closed);
+}
+
+VidgfxCullResult vidgfx_clip_tex_decal_rect(
+	const QRectF &clip_rect,
+	QRectF *rect,
+	QPointF *tl_uv,
+	QPointF *tr_uv,
+	QPointF *bl_uv,
+	QPointF *br_uv)
+{
+	return GraphicsContext::clipTexDecalRect(
+		clip_rect, rect, tl_uv, tr_uv, bl_uv, br_uv);
+}
+
+bool vidgfx_create_layer_instances(
+	VidgfxVertBuf *out_buf,
+	const VidgfxLayerInstance *instances,
+	int num_instances)
+{
+	VertexBuffer *ptr = reinterpret_cast<VertexBuffer *>(out_buf);
+	return GraphicsContext::createLayerInstances(
+		ptr, instances, num_instances);
+}
+
+int vidgfx_write_layer_instances(
+	float *data,
+	const VidgfxLayerInstance *instances,
+	int num_instances)
+{
+	return GraphicsContext::writeLayerInstances(
+		data, instances, num_instances);
+}
+
+bool vidgfx_create_quad_indices(
+	VidgfxIdxBuf *out_buf,
+	int num_quads)
+{
+	IndexBuffer *ptr = reinterpret_cast<IndexBuffer *>(out_buf);
+	return GraphicsContext::createQuadIndices(ptr, num_quads);
+}
+
+QImage vidgfx_scale_img(
+	const QImage &img,
+	const QSize &size,
+	VidgfxFilter filter)
+{
+	return GraphicsContext::scaleImage(img, size, filter);
+}
+
+QImage vidgfx_orient_img(
+	const QImage &img,
+	VidgfxOrientation orient)
+{
+	return GraphicsContext::orientImage(img, orient);
+}
+
+quint32 vidgfx_sample_img(
+	const QImage &img,
+	const QPointF &uv,
+	VidgfxFilter filter,
+	VidgfxAddressMode mode)
+{
+	return GraphicsContext::sampleImage(img, uv, filter, mode);
+}
+
 quint32 vidgfx_next_pow_two(
 	quint32 n)
 {
@@ -606,6 +2072,62 @@ QMatrix4x4 vidgfx_context_get_screen_proj_mat(
 	return ptr->getScreenProjectionMatrix();
 }
 
+void vidgfx_context_set_culling_enabled(
+	VidgfxContext *context,
+	bool enabled)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	ptr->setCullingEnabled(enabled);
+}
+
+bool vidgfx_context_is_culling_enabled(
+	VidgfxContext *context)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	return ptr->isCullingEnabled();
+}
+
+QRectF vidgfx_context_get_visible_rect(
+	VidgfxContext *context)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	return ptr->getVisibleRect();
+}
+
+VidgfxCullResult vidgfx_context_cull_rect(
+	VidgfxContext *context,
+	const QRectF &rect)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	return ptr->cullRect(rect);
+}
+
+VidgfxCullResult vidgfx_context_cull_tex_decal_rect(
+	VidgfxContext *context,
+	QRectF *rect,
+	QPointF *tl_uv,
+	QPointF *tr_uv,
+	QPointF *bl_uv,
+	QPointF *br_uv)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	return ptr->cullTexDecalRect(rect, tl_uv, tr_uv, bl_uv, br_uv);
+}
+
+VidgfxCullStats vidgfx_context_get_cull_stats(
+	VidgfxContext *context)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	return ptr->getCullStats();
+}
+
+void vidgfx_context_reset_cull_stats(
+	VidgfxContext *context)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	ptr->resetCullStats();
+}
+
 void vidgfx_context_set_user_render_target(
 	VidgfxContext *context,
 	VidgfxTex *tex_a,
@@ -664,6 +2186,31 @@ QRectF vidgfx_context_get_resize_layer_rect(
 	return ptr->getResizeLayerRect();
 }
 
+void vidgfx_context_set_resize_gizmo_rect(
+	VidgfxContext *context,
+	const QRectF &rect)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	ptr->setResizeGizmoRect(rect);
+}
+
+QRectF vidgfx_context_get_resize_gizmo_rect(
+	VidgfxContext *context)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	return ptr->getResizeGizmoRect();
+}
+
+void vidgfx_context_draw_resize_gizmo(
+	VidgfxContext *context,
+	const QRectF &rect,
+	float handle_size,
+	const QPointF &half_width)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	ptr->drawResizeGizmo(rect, handle_size, half_width);
+}
+
 void vidgfx_context_set_rgb_nv16_px_size(
 	VidgfxContext *context,
 	const QPointF &size)
@@ -753,10 +2300,11 @@ void vidgfx_context_flush(
 
 VidgfxVertBuf *vidgfx_context_new_vertbuf(
 	VidgfxContext *context,
-	int size)
+	int size,
+	VidgfxBufStorage storage)
 {
 	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
-	VertexBuffer *ret = ptr->createVertexBuffer(size);
+	VertexBuffer *ret = ptr->createVertexBuffer(size, storage);
 	return reinterpret_cast<VidgfxVertBuf *>(ret);
 }
 
@@ -769,6 +2317,31 @@ void vidgfx_context_destroy_vertbuf(
 	ptr->deleteVertexBuffer(vertBuf);
 }
 
+VidgfxIdxBuf *vidgfx_context_new_idxbuf(
+	VidgfxContext *context,
+	int num_indices)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	IndexBuffer *ret = ptr->createIndexBuffer(num_indices);
+	return reinterpret_cast<VidgfxIdxBuf *>(ret);
+}
+
+void vidgfx_context_destroy_idxbuf(
+	VidgfxContext *context,
+	VidgfxIdxBuf *buf)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	IndexBuffer *idxBuf = reinterpret_cast<IndexBuffer *>(buf);
+	ptr->deleteIndexBuffer(idxBuf);
+}
+
+VidgfxIdxBuf *vidgfx_context_get_quad_idxbuf(
+	VidgfxContext *context)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	return reinterpret_cast<VidgfxIdxBuf *>(ptr->getQuadIndexBuffer());
+}
+
 VidgfxTex *vidgfx_context_new_tex(
 	VidgfxContext *context,
 	QImage img,
@@ -804,6 +2377,16 @@ VidgfxTex *vidgfx_context_new_tex(
 	return reinterpret_cast<VidgfxTex *>(ret);
 }
 
+VidgfxTex *vidgfx_context_new_mipmapped_tex(
+	VidgfxContext *context,
+	VidgfxImgPyramid *pyramid)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	ImagePyramid *pyr = reinterpret_cast<ImagePyramid *>(pyramid);
+	Texture *ret = ptr->createMipmappedTexture(pyr->getLevels());
+	return reinterpret_cast<VidgfxTex *>(ret);
+}
+
 VidgfxTex *vidgfx_context_new_staging_tex(
 	VidgfxContext *context,
 	const QSize &size)
@@ -924,6 +2507,23 @@ VidgfxTex *vidgfx_context_prepare_tex(
 	return reinterpret_cast<VidgfxTex *>(ret);
 }
 
+void vidgfx_context_prepare_tex_ladder(
+	VidgfxContext *context,
+	VidgfxTex *tex,
+	const QSize *sizes,
+	int num_sizes,
+	VidgfxFilter filter,
+	VidgfxContextLadderCallback *callback,
+	void *opaque)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	Texture *texture = reinterpret_cast<Texture *>(tex);
+	QVector<QSize> sizeVec(num_sizes);
+	for(int i = 0; i < num_sizes; i++)
+		sizeVec[i] = sizes[i];
+	ptr->prepareTextureLadder(texture, sizeVec, filter, callback, opaque);
+}
+
 VidgfxTex *vidgfx_context_convert_to_bgrx(
 	VidgfxContext *context,
 	VidgfxPixFormat format,
@@ -986,10 +2586,11 @@ void vidgfx_context_set_tex(
 
 void vidgfx_context_set_tex_filter(
 	VidgfxContext *context,
-	VidgfxFilter filter)
+	VidgfxFilter filter,
+	VidgfxAddressMode mode)
 {
 	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
-	ptr->setTextureFilter(filter);
+	ptr->setTextureFilter(filter, mode);
 }
 
 void vidgfx_context_clear(
@@ -1011,6 +2612,57 @@ void vidgfx_context_draw_buf(
 	ptr->drawBuffer(vertBuf, num_vertices, start_vertex);
 }
 
+void vidgfx_context_draw_buf(
+	VidgfxContext *context,
+	VidgfxVertBuf *buf,
+	VidgfxIdxBuf *idx_buf,
+	int num_indices,
+	int start_index,
+	int base_vertex)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	VertexBuffer *vertBuf = reinterpret_cast<VertexBuffer *>(buf);
+	IndexBuffer *idxBuf = reinterpret_cast<IndexBuffer *>(idx_buf);
+	ptr->drawBuffer(vertBuf, idxBuf, num_indices, start_index, base_vertex);
+}
+
+void vidgfx_context_draw_instanced(
+	VidgfxContext *context,
+	VidgfxVertBuf *inst_buf,
+	int num_instances,
+	int start_instance)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	VertexBuffer *instBuf = reinterpret_cast<VertexBuffer *>(inst_buf);
+	ptr->drawInstanced(instBuf, num_instances, start_instance);
+}
+
+float *vidgfx_context_alloc_transient_verts(
+	VidgfxContext *context,
+	int num_verts,
+	int vert_size,
+	VidgfxVertFormat format,
+	VidgfxTransientVerts *verts_out)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	return ptr->allocTransientVerts(num_verts, vert_size, format, verts_out);
+}
+
+void vidgfx_context_draw_transient_verts(
+	VidgfxContext *context,
+	const VidgfxTransientVerts &verts)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	ptr->drawTransientVerts(verts);
+}
+
+void vidgfx_context_end_frame(
+	VidgfxContext *context)
+{
+	GraphicsContext *ptr = reinterpret_cast<GraphicsContext *>(context);
+	ptr->endFrame();
+}
+
 //-----------------------------------------------------------------------------
 // Signals
 
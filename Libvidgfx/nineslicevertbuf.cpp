@@ -0,0 +1,220 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#include "nineslicevertbuf.h"
+#include "graphicscontext.h"
+#include "vertexlayout.h"
+
+//=============================================================================
+// NineSliceVertBuf class
+
+NineSliceVertBuf::NineSliceVertBuf(GraphicsContext *context)
+	: m_context(context)
+	, m_vertBuf(NULL)
+	, m_idxBuf(NULL)
+	, m_dirty(true)
+	, m_slice()
+	//, m_xs() // Written when the vertex buffer is created
+	//, m_ys()
+	//, m_us()
+	//, m_vs()
+{
+	m_slice.uv_rect = QRectF(0.0, 0.0, 1.0, 1.0);
+}
+
+NineSliceVertBuf::~NineSliceVertBuf()
+{
+	if(m_vertBuf != NULL || m_idxBuf != NULL)
+		deleteBuffers();
+}
+
+/// <summary>
+/// Retrieves the vertex buffer, creating and/or updating it if required.
+/// </summary>
+VertexBuffer *NineSliceVertBuf::getVertBuf()
+{
+	if(!m_dirty)
+		return m_vertBuf;
+	if(m_context == NULL || !m_context->isValid())
+		return NULL; // No context operations can be done
+
+	if(m_vertBuf == NULL) {
+		// Shadowed storage so that only the moved vertices are uploaded
+		m_vertBuf = m_context->createVertexBuffer(
+			GraphicsContext::NineSliceGridNumFloats, GfxShadowedStorage);
+		if(m_vertBuf == NULL)
+			return NULL; // Failed to create vertex buffer
+		GraphicsContext::createNineSliceGrid(m_vertBuf, m_slice);
+		GraphicsContext::calcNineSliceLines(m_slice, m_xs, m_ys, m_us, m_vs);
+	} else
+		updateVertBuf();
+
+	m_dirty = false;
+	return m_vertBuf;
+}
+
+/// <summary>
+/// Retrieves the index buffer, creating it if required. The indices never
+/// change.
+/// </summary>
+IndexBuffer *NineSliceVertBuf::getIdxBuf()
+{
+	if(m_idxBuf != NULL)
+		return m_idxBuf;
+	if(m_context == NULL || !m_context->isValid())
+		return NULL; // No context operations can be done
+
+	m_idxBuf = m_context->createIndexBuffer(
+		GraphicsContext::NineSliceNumIndices);
+	if(m_idxBuf == NULL)
+		return NULL; // Failed to create index buffer
+	GraphicsContext::createNineSliceIndices(m_idxBuf);
+	return m_idxBuf;
+}
+
+void NineSliceVertBuf::deleteBuffers()
+{
+	if(m_context == NULL || !m_context->isValid())
+		return;
+	if(m_vertBuf != NULL)
+		m_context->deleteVertexBuffer(m_vertBuf);
+	if(m_idxBuf != NULL)
+		m_context->deleteIndexBuffer(m_idxBuf);
+	m_vertBuf = NULL;
+	m_idxBuf = NULL;
+	m_dirty = true;
+}
+
+/// <summary>
+/// Renders all 9 slices with a single draw call using the context's current
+/// shader and texture. Changes the context's topology.
+/// </summary>
+void NineSliceVertBuf::draw()
+{
+	VertexBuffer *vertBuf = getVertBuf();
+	IndexBuffer *idxBuf = getIdxBuf();
+	if(vertBuf == NULL || idxBuf == NULL)
+		return;
+	m_context->setTopology(getTopology());
+	m_context->drawBuffer(vertBuf, idxBuf);
+}
+
+void NineSliceVertBuf::setRect(const QRectF &rect)
+{
+	if(m_slice.rect == rect)
+		return; // Nothing to do
+	m_slice.rect = rect;
+	m_dirty = true;
+}
+
+/// <summary>
+/// Sets the size of the left and top slices (`topLeft`) and the right and
+/// bottom slices (`botRight`) in world units.
+/// </summary>
+void NineSliceVertBuf::setBorders(
+	const QPointF &topLeft, const QPointF &botRight)
+{
+	if(m_slice.tl_border == topLeft && m_slice.br_border == botRight)
+		return; // Nothing to do
+	m_slice.tl_border = topLeft;
+	m_slice.br_border = botRight;
+	m_dirty = true;
+}
+
+void NineSliceVertBuf::getBorders(QPointF *topLeft, QPointF *botRight) const
+{
+	if(topLeft != NULL)
+		*topLeft = m_slice.tl_border;
+	if(botRight != NULL)
+		*botRight = m_slice.br_border;
+}
+
+/// <summary>
+/// Sets the area of the texture that the whole rectangle displays.
+/// </summary>
+void NineSliceVertBuf::setTextureUv(const QRectF &normRect)
+{
+	if(m_slice.uv_rect == normRect)
+		return; // Nothing to do
+	m_slice.uv_rect = normRect;
+	m_dirty = true;
+}
+
+/// <summary>
+/// Sets the size of the texture's border slices in normalized texture
+/// coordinates.
+/// </summary>
+void NineSliceVertBuf::setTextureInsets(
+	const QPointF &topLeft, const QPointF &botRight)
+{
+	if(m_slice.tl_uv_inset == topLeft && m_slice.br_uv_inset == botRight)
+		return; // Nothing to do
+	m_slice.tl_uv_inset = topLeft;
+	m_slice.br_uv_inset = botRight;
+	m_dirty = true;
+}
+
+void NineSliceVertBuf::getTextureInsets(
+	QPointF *topLeft, QPointF *botRight) const
+{
+	if(topLeft != NULL)
+		*topLeft = m_slice.tl_uv_inset;
+	if(botRight != NULL)
+		*botRight = m_slice.br_uv_inset;
+}
+
+/// <summary>
+/// Rewrites only the vertices whose grid lines moved since the buffer was
+/// last updated and marks just those vertices as dirty.
+/// </summary>
+void NineSliceVertBuf::updateVertBuf()
+{
+	float xs[4], ys[4], us[4], vs[4];
+	GraphicsContext::calcNineSliceLines(m_slice, xs, ys, us, vs);
+	bool colMoved[4];
+	bool rowMoved[4];
+	bool anyMoved = false;
+	for(int i = 0; i < 4; i++) {
+		colMoved[i] = (xs[i] != m_xs[i] || us[i] != m_us[i]);
+		rowMoved[i] = (ys[i] != m_ys[i] || vs[i] != m_vs[i]);
+		anyMoved = anyMoved || colMoved[i] || rowMoved[i];
+	}
+	if(!anyMoved)
+		return; // Nothing to upload
+
+	float *data = m_vertBuf->map();
+	if(data == NULL)
+		return; // Failed to map buffer
+	for(int row = 0; row < 4; row++) {
+		for(int col = 0; col < 4; col++) {
+			if(!colMoved[col] && !rowMoved[row])
+				continue; // Vertex is unchanged
+			const int i = (row * 4 + col) * TexDecalVertLayout::NumFloats;
+			TexDecalVertLayout::writeVert(
+				&data[i], xs[col], ys[row], QPointF(us[col], vs[row]));
+			m_vertBuf->markDirty(i, TexDecalVertLayout::NumFloats);
+		}
+	}
+	m_vertBuf->unmap();
+
+	for(int i = 0; i < 4; i++) {
+		m_xs[i] = xs[i];
+		m_ys[i] = ys[i];
+		m_us[i] = us[i];
+		m_vs[i] = vs[i];
+	}
+}
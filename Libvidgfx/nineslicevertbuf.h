@@ -0,0 +1,105 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#ifndef NINESLICEVERTBUF_H
+#define NINESLICEVERTBUF_H
+
+#include "include/libvidgfx.h"
+#include <QtCore/QPointF>
+#include <QtCore/QRectF>
+
+class GraphicsContext;
+class IndexBuffer;
+class VertexBuffer;
+
+//=============================================================================
+/// <summary>
+/// A vertex buffer helper class for rendering borders, lower-thirds and other
+/// rectangles whose corners must keep their size when the rectangle is
+/// resized. All 9 slices share a 4x4 grid of vertices and are rendered with
+/// a single indexed draw call. When the rectangle or its borders change only
+/// the vertices on the grid lines that actually moved are rewritten and
+/// uploaded, e.g. resizing a rectangle from its bottom-right corner only
+/// updates the right and bottom slices. It is up to the user to either call
+/// `deleteBuffers()` or delete the whole object when the graphics context is
+/// released.
+/// </summary>
+class NineSliceVertBuf
+{
+protected: // Members ---------------------------------------------------------
+	GraphicsContext *	m_context;
+	VertexBuffer *		m_vertBuf;
+	IndexBuffer *		m_idxBuf;
+	bool				m_dirty;
+	VidgfxNineSlice		m_slice;
+
+	// The grid lines that are currently in the vertex buffer
+	float	m_xs[4];
+	float	m_ys[4];
+	float	m_us[4];
+	float	m_vs[4];
+
+public: // Constructor/destructor ---------------------------------------------
+	NineSliceVertBuf(GraphicsContext *context = NULL);
+	virtual ~NineSliceVertBuf();
+
+public: // Methods ------------------------------------------------------------
+	void			setContext(GraphicsContext *context);
+	VertexBuffer *	getVertBuf(); // Applies settings
+	IndexBuffer *	getIdxBuf();
+	VidgfxTopology	getTopology() const;
+	void			deleteBuffers();
+	void			draw();
+
+	// Position
+	void	setRect(const QRectF &rect);
+	QRectF	getRect() const;
+	void	setBorders(const QPointF &topLeft, const QPointF &botRight);
+	void	getBorders(QPointF *topLeft, QPointF *botRight) const;
+
+	// Texture UV
+	void	setTextureUv(const QRectF &normRect);
+	QRectF	getTextureUv() const;
+	void	setTextureInsets(const QPointF &topLeft, const QPointF &botRight);
+	void	getTextureInsets(QPointF *topLeft, QPointF *botRight) const;
+
+private:
+	void	updateVertBuf();
+};
+//=============================================================================
+
+inline void NineSliceVertBuf::setContext(GraphicsContext *context)
+{
+	m_context = context;
+}
+
+inline VidgfxTopology NineSliceVertBuf::getTopology() const
+{
+	return GfxTriangleListTopology;
+}
+
+inline QRectF NineSliceVertBuf::getRect() const
+{
+	return m_slice.rect;
+}
+
+inline QRectF NineSliceVertBuf::getTextureUv() const
+{
+	return m_slice.uv_rect;
+}
+
+#endif // NINESLICEVERTBUF_H
@@ -0,0 +1,231 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#include "outlinegeometry.h"
+#include "vertexlayout.h"
+#include <emmintrin.h>
+#include <math.h>
+#include <string.h>
+
+// The SSE writers below store whole vertices of these layouts directly
+Q_STATIC_ASSERT(SolidVertLayout::NumFloats == 8);
+Q_STATIC_ASSERT(ResizeVertLayout::NumFloats == 4);
+Q_STATIC_ASSERT(SolidCompactVertLayout::NumFloats == 3);
+
+//=============================================================================
+// Helpers
+
+/// <summary>
+/// The colours of an outline in both float and packed RGBA8 form. Indexed by
+/// corner in the order top-left, top-right, bottom-left, bottom-right.
+/// </summary>
+struct OutlineColors {
+	__m128	floatCol[4];
+	quint32	packedCol[4];
+};
+
+enum OutlineCorner {
+	TopLeftCorner = 0,
+	TopRightCorner,
+	BottomLeftCorner,
+	BottomRightCorner
+};
+
+static inline float signOf(float v)
+{
+	if(v > 0.0f)
+		return 1.0f;
+	if(v < 0.0f)
+		return -1.0f;
+	return 0.0f;
+}
+
+static void convertColors(const QColor *cols, OutlineColors *out)
+{
+	for(int i = 0; i < 4; i++) {
+		const QColor &col = cols[i];
+		out->floatCol[i] = _mm_setr_ps(
+			col.redF(), col.greenF(), col.blueF(), col.alphaF());
+		out->packedCol[i] = packColorRgba8(col);
+	}
+}
+
+/// <summary>
+/// Writes the 4 vertices of a single line quad. `x` and `y` hold the position
+/// of each vertex in lanes 0-3. The line starts with colour `a` and ends with
+/// colour `b`, i.e. the colours of the 4 vertices are A, B, A, B.
+/// </summary>
+/// <returns>A pointer to just after the last written float</returns>
+static inline float *writeLineQuad(
+	float *out, __m128 x, __m128 y, const OutlineColors *cols,
+	OutlineCorner a, OutlineCorner b, bool compact)
+{
+	const __m128 zw = _mm_setr_ps(0.0f, 1.0f, 0.0f, 1.0f);
+	const __m128 xy01 = _mm_unpacklo_ps(x, y); // X0 Y0 X1 Y1
+	const __m128 xy23 = _mm_unpackhi_ps(x, y); // X2 Y2 X3 Y3
+
+	if(compact) {
+		// X, Y, RGBA8 or X, Y
+		if(cols == NULL) {
+			_mm_storeu_ps(&out[0], xy01);
+			_mm_storeu_ps(&out[4], xy23);
+			return &out[8];
+		}
+		_mm_storel_pi((__m64 *)&out[0], xy01);
+		memcpy(&out[2], &cols->packedCol[a], sizeof(quint32));
+		_mm_storeh_pi((__m64 *)&out[3], xy01);
+		memcpy(&out[5], &cols->packedCol[b], sizeof(quint32));
+		_mm_storel_pi((__m64 *)&out[6], xy23);
+		memcpy(&out[8], &cols->packedCol[a], sizeof(quint32));
+		_mm_storeh_pi((__m64 *)&out[9], xy23);
+		memcpy(&out[11], &cols->packedCol[b], sizeof(quint32));
+		return &out[12];
+	}
+
+	// X, Y, Z, -, R, G, B, A or X, Y, Z, -
+	const __m128 v0 = _mm_movelh_ps(xy01, zw); // X0 Y0 0 1
+	const __m128 v1 = _mm_movehl_ps(zw, xy01); // X1 Y1 0 1
+	const __m128 v2 = _mm_movelh_ps(xy23, zw); // X2 Y2 0 1
+	const __m128 v3 = _mm_movehl_ps(zw, xy23); // X3 Y3 0 1
+	if(cols == NULL) {
+		_mm_storeu_ps(&out[0], v0);
+		_mm_storeu_ps(&out[4], v1);
+		_mm_storeu_ps(&out[8], v2);
+		_mm_storeu_ps(&out[12], v3);
+		return &out[16];
+	}
+	_mm_storeu_ps(&out[0], v0);
+	_mm_storeu_ps(&out[4], cols->floatCol[a]);
+	_mm_storeu_ps(&out[8], v1);
+	_mm_storeu_ps(&out[12], cols->floatCol[b]);
+	_mm_storeu_ps(&out[16], v2);
+	_mm_storeu_ps(&out[20], cols->floatCol[a]);
+	_mm_storeu_ps(&out[24], v3);
+	_mm_storeu_ps(&out[28], cols->floatCol[b]);
+	return &out[32];
+}
+
+/// <summary>
+/// Writes the 16 vertices of a rectangle outline in the order top, bottom,
+/// left and right line. The vertices of each line are identical to what a
+/// generic line generator produces for an axis-aligned line including the
+/// winding order and degenerate cases.
+/// </summary>
+static float *writeOutline(
+	float *out, const QRectF &rect, float hx, float hy,
+	const OutlineColors *cols, bool compact)
+{
+	const float l = rect.left();
+	const float r = rect.right();
+	const float t = rect.top();
+	const float b = rect.bottom();
+
+	// Horizontal lines go from `x0` to `x1` and vertical lines from `y0` to
+	// `y1`. The perpendicular of a line points towards its right-hand side so
+	// its direction depends on the direction of the line.
+	const float x0 = l + hx;
+	const float x1 = r - hx;
+	const float y0 = t - hy;
+	const float y1 = b + hy;
+	const float py = signOf(x0 - x1) * fabsf(hy);
+	const float px = signOf(y0 - y1) * fabsf(hx);
+
+	const __m128 horzX = _mm_setr_ps(x0, x1, x0, x1);
+	const __m128 horzOffY = _mm_setr_ps(-py, -py, py, py);
+	const __m128 vertY = _mm_setr_ps(y0, y1, y0, y1);
+	const __m128 vertOffX = _mm_setr_ps(px, px, -px, -px);
+
+	// Top line
+	out = writeLineQuad(out,
+		horzX, _mm_add_ps(_mm_set1_ps(t), horzOffY),
+		cols, TopLeftCorner, TopRightCorner, compact);
+
+	// Bottom line
+	out = writeLineQuad(out,
+		horzX, _mm_add_ps(_mm_set1_ps(b), horzOffY),
+		cols, BottomLeftCorner, BottomRightCorner, compact);
+
+	// Left line
+	out = writeLineQuad(out,
+		_mm_add_ps(_mm_set1_ps(l), vertOffX), vertY,
+		cols, TopLeftCorner, BottomLeftCorner, compact);
+
+	// Right line
+	out = writeLineQuad(out,
+		_mm_add_ps(_mm_set1_ps(r), vertOffX), vertY,
+		cols, TopRightCorner, BottomRightCorner, compact);
+
+	return out;
+}
+
+//=============================================================================
+// OutlineGeometry class
+
+/// <summary>
+/// Returns the number of floats per vertex that the `write*()` methods output
+/// for the specified vertex format.
+/// </summary>
+int OutlineGeometry::getVertSize(VidgfxVertFormat format, bool hasColor)
+{
+	if(format == GfxFullVertFormat) {
+		return hasColor
+			? (int)SolidVertLayout::NumFloats
+			: (int)ResizeVertLayout::NumFloats;
+	}
+	return hasColor
+		? (int)SolidCompactVertLayout::NumFloats : (int)PosXY::NumFloats;
+}
+
+/// <summary>
+/// Writes a single rectangle outline to `data`. If `cols` is not NULL then it
+/// must point to 4 colours in the order top-left, top-right, bottom-left and
+/// bottom-right. `format` must be either `GfxFullVertFormat` or
+/// `GfxCompactVertFormat`.
+/// </summary>
+/// <returns>The number of floats that were written</returns>
+int OutlineGeometry::writeRectOutline(
+	float *data, const QRectF &rect, const QPointF &halfWidth,
+	VidgfxVertFormat format, const QColor *cols)
+{
+	return writeRectOutlines(data, &rect, 1, halfWidth, format, cols);
+}
+
+/// <summary>
+/// Writes `numRects` rectangle outlines to `data` that all share the same line
+/// width and colours.
+/// </summary>
+/// <returns>The number of floats that were written</returns>
+int OutlineGeometry::writeRectOutlines(
+	float *data, const QRectF *rects, int numRects, const QPointF &halfWidth,
+	VidgfxVertFormat format, const QColor *cols)
+{
+	if(data == NULL || rects == NULL || numRects <= 0)
+		return 0;
+
+	OutlineColors colors;
+	if(cols != NULL)
+		convertColors(cols, &colors);
+	const OutlineColors *colPtr = (cols != NULL) ? &colors : NULL;
+
+	const float hx = halfWidth.x();
+	const float hy = halfWidth.y();
+	const bool compact = (format != GfxFullVertFormat);
+	float *out = data;
+	for(int i = 0; i < numRects; i++)
+		out = writeOutline(out, rects[i], hx, hy, colPtr, compact);
+	return (int)(out - data);
+}
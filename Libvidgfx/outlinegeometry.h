@@ -0,0 +1,52 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#ifndef OUTLINEGEOMETRY_H
+#define OUTLINEGEOMETRY_H
+
+#include "include/libvidgfx.h"
+#include <QtCore/QRectF>
+#include <QtGui/QColor>
+
+//=============================================================================
+/// <summary>
+/// Generates the vertices of axis-aligned rectangle outlines. Each outline
+/// consists of 4 line quads (top, bottom, left and right) that are designed
+/// to be rendered with `GfxQuadListTopology`. As every line is either
+/// horizontal or vertical the perpendicular offsets are known without
+/// normalising anything so the 16 vertices of an outline are calculated with
+/// a handful of SSE2 operations. Colours are converted once per call instead
+/// of once per vertex.
+/// </summary>
+class OutlineGeometry
+{
+public: // Constants ----------------------------------------------------------
+	static const int	NumVertsPerOutline = 4 * VIDGFX_NUM_VERTS_PER_LINE;
+
+public: // Static methods -----------------------------------------------------
+	static int	getVertSize(VidgfxVertFormat format, bool hasColor);
+	static int	writeRectOutline(
+		float *data, const QRectF &rect, const QPointF &halfWidth,
+		VidgfxVertFormat format, const QColor *cols = NULL);
+	static int	writeRectOutlines(
+		float *data, const QRectF *rects, int numRects,
+		const QPointF &halfWidth, VidgfxVertFormat format,
+		const QColor *cols = NULL);
+};
+//=============================================================================
+
+#endif // OUTLINEGEOMETRY_H
@@ -0,0 +1,280 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#include "polylinegeometry.h"
+#include "vertexlayout.h"
+#include <QtCore/QVector>
+#include <emmintrin.h>
+#include <math.h>
+
+//=============================================================================
+// Helpers
+
+/// <summary>
+/// A single colour in float form. Stored unaligned as it lives in a
+/// `QVector`.
+/// </summary>
+struct PolylineColor {
+	float	floatCol[4];
+};
+
+/// <summary>
+/// The 4 corners of a segment quad in the order start-left, end-left,
+/// start-right and end-right where "left" is the negative side of the
+/// segment's perpendicular.
+/// </summary>
+struct SegmentQuad {
+	float	x[4];
+	float	y[4];
+};
+
+/// <summary>
+/// The triangle that fills the outside of a bevelled corner. `x[0]` and
+/// `y[0]` is the inner vertex followed by the outer vertices of the incoming
+/// and outgoing segments.
+/// </summary>
+struct BevelTri {
+	bool	valid;
+	float	x[3];
+	float	y[3];
+};
+
+static void convertColor(const QColor &col, PolylineColor *out)
+{
+	out->floatCol[0] = col.redF();
+	out->floatCol[1] = col.greenF();
+	out->floatCol[2] = col.blueF();
+	out->floatCol[3] = col.alphaF();
+}
+
+/// <summary>
+/// Returns the colour of point `i` where `colors` contains either a single
+/// colour for every point or one colour per point.
+/// </summary>
+static inline const PolylineColor *colorAt(
+	const QVector<PolylineColor> &colors, int i)
+{
+	return &colors.at(colors.size() == 1 ? 0 : i);
+}
+
+/// <summary>
+/// Writes a single vertex in the `SolidVertLayout` format.
+/// </summary>
+/// <returns>A pointer to just after the last written float</returns>
+static inline float *writeVert(
+	float *out, float x, float y, const PolylineColor *col)
+{
+	_mm_storeu_ps(&out[0], _mm_setr_ps(x, y, 0.0f, 1.0f));
+	_mm_storeu_ps(&out[PosXYZW::NumFloats], _mm_loadu_ps(col->floatCol));
+	return &out[SolidVertLayout::NumFloats];
+}
+
+/// <summary>
+/// Writes the 4 vertices of a single quad. The colours of the 4 vertices are
+/// A, B, A, B.
+/// </summary>
+/// <returns>A pointer to just after the last written float</returns>
+static inline float *writeQuad(
+	float *out, const float *x, const float *y, const PolylineColor *a,
+	const PolylineColor *b)
+{
+	out = writeVert(out, x[0], y[0], a);
+	out = writeVert(out, x[1], y[1], b);
+	out = writeVert(out, x[2], y[2], a);
+	out = writeVert(out, x[3], y[3], b);
+	return out;
+}
+
+/// <summary>
+/// Calculates the unit perpendiculars of `num` segments 4 segments at a time.
+/// `x` and `y` contain the direction of each segment on input and the
+/// perpendicular that points to its right-hand side on output. Both arrays
+/// must be padded to a multiple of 4 elements with non-zero directions.
+/// </summary>
+static void calcPerpendiculars(float *x, float *y, int num)
+{
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 zero = _mm_setzero_ps();
+	for(int i = 0; i < num; i += 4) {
+		const __m128 dx = _mm_loadu_ps(&x[i]);
+		const __m128 dy = _mm_loadu_ps(&y[i]);
+		const __m128 lenSq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+		const __m128 invLen = _mm_div_ps(one, _mm_sqrt_ps(lenSq));
+		_mm_storeu_ps(&x[i], _mm_mul_ps(_mm_sub_ps(zero, dy), invLen));
+		_mm_storeu_ps(&y[i], _mm_mul_ps(dx, invLen));
+	}
+}
+
+//=============================================================================
+// PolylineGeometry class
+
+/// <summary>
+/// Returns the largest number of vertices that `writePolyline()` can output
+/// for a polyline with `numPoints` points. This is the exact number when
+/// every corner is bevelled.
+/// </summary>
+int PolylineGeometry::getMaxNumVerts(int numPoints, bool closed)
+{
+	if(numPoints < 2)
+		return 0;
+	const int numSegs = closed ? numPoints : numPoints - 1;
+	const int numJoins = closed ? numPoints : numPoints - 2;
+	return (numSegs + numJoins) * VIDGFX_NUM_VERTS_PER_LINE;
+}
+
+/// <summary>
+/// Writes a polyline that connects `points` in order to `data`. If `closed`
+/// is true then the last point is also connected to the first. Consecutive
+/// duplicate points are ignored. `cols` must point to either a single colour
+/// or, if `colPerPoint` is true, one colour for each point that is
+/// interpolated along the segments. `data` must have space for
+/// `getMaxNumVerts()` vertices in the format that the solid shader expects.
+/// </summary>
+/// <returns>The number of floats that were written</returns>
+int PolylineGeometry::writePolyline(
+	float *data, const QPointF *points, int numPoints, float halfWidth,
+	VidgfxLineJoin join, bool closed, const QColor *cols, bool colPerPoint)
+{
+	if(data == NULL || points == NULL || cols == NULL || numPoints < 2)
+		return 0;
+
+	// Remove consecutive duplicate points as they have no direction
+	QVector<int> idx;
+	idx.reserve(numPoints);
+	for(int i = 0; i < numPoints; i++) {
+		if(idx.isEmpty() || points[i] != points[idx.last()])
+			idx.append(i);
+	}
+	if(closed && idx.size() > 2 && points[idx.first()] == points[idx.last()])
+		idx.removeLast();
+	const int n = idx.size();
+	if(n < 2)
+		return 0;
+	if(n < 3)
+		closed = false; // Would double back on itself
+	const int numSegs = closed ? n : n - 1;
+
+	// Convert colours once per point instead of once per vertex
+	QVector<PolylineColor> colors(colPerPoint ? n : 1);
+	for(int i = 0; i < colors.size(); i++)
+		convertColor(cols[colPerPoint ? idx.at(i) : 0], &colors[i]);
+
+	// Calculate the perpendicular of every segment, the arrays are padded
+	// with a dummy direction so that the SSE loop never divides by zero
+	const int numPadded = (numSegs + 3) & ~3;
+	QVector<float> nx(numPadded, 1.0f);
+	QVector<float> ny(numPadded, 0.0f);
+	for(int s = 0; s < numSegs; s++) {
+		const QPointF &a = points[idx.at(s)];
+		const QPointF &b = points[idx.at((s + 1) % n)];
+		nx[s] = (float)(b.x() - a.x());
+		ny[s] = (float)(b.y() - a.y());
+	}
+	calcPerpendiculars(nx.data(), ny.data(), numPadded);
+
+	// Start with butt ends on every segment
+	QVector<SegmentQuad> quads(numSegs);
+	for(int s = 0; s < numSegs; s++) {
+		const QPointF &a = points[idx.at(s)];
+		const QPointF &b = points[idx.at((s + 1) % n)];
+		const float ox = nx.at(s) * halfWidth;
+		const float oy = ny.at(s) * halfWidth;
+		SegmentQuad &q = quads[s];
+		q.x[0] = (float)a.x() - ox;
+		q.y[0] = (float)a.y() - oy;
+		q.x[1] = (float)b.x() - ox;
+		q.y[1] = (float)b.y() - oy;
+		q.x[2] = (float)a.x() + ox;
+		q.y[2] = (float)a.y() + oy;
+		q.x[3] = (float)b.x() + ox;
+		q.y[3] = (float)b.y() + oy;
+	}
+
+	// Join segments at every inner point. The join at point `k` connects
+	// the end of segment `k - 1` to the start of segment `k`.
+	const float limitSq = (float)(MiterLimit * MiterLimit);
+	QVector<BevelTri> bevels(n);
+	for(int k = 0; k < n; k++) {
+		BevelTri &bevel = bevels[k];
+		bevel.valid = false;
+		if(!closed && (k == 0 || k == n - 1))
+			continue; // Butt cap
+		const int s0 = (k + n - 1) % n;
+		const int s1 = k;
+		const float px = (float)points[idx.at(k)].x();
+		const float py = (float)points[idx.at(k)].y();
+		const float n0x = nx.at(s0);
+		const float n0y = ny.at(s0);
+		const float n1x = nx.at(s1);
+		const float n1y = ny.at(s1);
+
+		// The miter offset is `(n0 + n1) / (1 + n0.n1)` times the half width
+		// and is `sqrt(2 / (1 + n0.n1))` times the half width long
+		const float denom = 1.0f + n0x * n1x + n0y * n1y;
+		const bool miterOk = denom * limitSq >= 2.0f;
+		const float mx = miterOk ? (n0x + n1x) * halfWidth / denom : 0.0f;
+		const float my = miterOk ? (n0y + n1y) * halfWidth / denom : 0.0f;
+		SegmentQuad &q0 = quads[s0];
+		SegmentQuad &q1 = quads[s1];
+		if(join == GfxMiterJoin && miterOk) {
+			q0.x[1] = q1.x[0] = px - mx;
+			q0.y[1] = q1.y[0] = py - my;
+			q0.x[3] = q1.x[2] = px + mx;
+			q0.y[3] = q1.y[2] = py + my;
+			continue;
+		}
+
+		// The outgoing segment turns towards the inner side of the corner
+		const float turn = n0x * n1y - n0y * n1x; // d1.n0
+		if(turn == 0.0f && denom > 1.0f)
+			continue; // Straight line, the butt ends already match
+		const float side = (turn > 0.0f) ? 1.0f : -1.0f;
+		const int inner = (side > 0.0f) ? 2 : 0;
+		const int outer = 2 - inner;
+		if(miterOk) {
+			// The inner edges meet at the miter point
+			q0.x[inner + 1] = q1.x[inner] = px + side * mx;
+			q0.y[inner + 1] = q1.y[inner] = py + side * my;
+		}
+		bevel.valid = true;
+		bevel.x[0] = miterOk ? px + side * mx : px;
+		bevel.y[0] = miterOk ? py + side * my : py;
+		bevel.x[1] = q0.x[outer + 1];
+		bevel.y[1] = q0.y[outer + 1];
+		bevel.x[2] = q1.x[outer];
+		bevel.y[2] = q1.y[outer];
+	}
+
+	// Write each segment followed by the bevel at its end
+	float *out = data;
+	for(int s = 0; s < numSegs; s++) {
+		const int k = (s + 1) % n;
+		out = writeQuad(out, quads.at(s).x, quads.at(s).y,
+			colorAt(colors, s), colorAt(colors, k));
+
+		const BevelTri &bevel = bevels.at(k);
+		if(!bevel.valid)
+			continue;
+
+		// Degenerate quad where the first and third vertices are identical
+		const float x[4] = { bevel.x[0], bevel.x[1], bevel.x[0], bevel.x[2] };
+		const float y[4] = { bevel.y[0], bevel.y[1], bevel.y[0], bevel.y[2] };
+		out = writeQuad(out, x, y, colorAt(colors, k), colorAt(colors, k));
+	}
+
+	return (int)(out - data);
+}
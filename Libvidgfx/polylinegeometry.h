@@ -0,0 +1,51 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#ifndef POLYLINEGEOMETRY_H
+#define POLYLINEGEOMETRY_H
+
+#include "include/libvidgfx.h"
+#include <QtCore/QPointF>
+#include <QtGui/QColor>
+
+//=============================================================================
+/// <summary>
+/// Generates the vertices of thick polylines with any number of connected
+/// segments. Each segment is a line quad with the same vertex order as the
+/// lines of `OutlineGeometry` and segments are connected with either miter or
+/// bevel joins. Bevel joins add one extra quad with a degenerate vertex per
+/// corner so that the whole polyline can be rendered with
+/// `GfxQuadListTopology`. Miters that would extend further than
+/// `MiterLimit` times the half width from the corner are bevelled instead.
+/// The end points of open polylines have butt caps. The perpendiculars of 4
+/// segments are calculated at once with SSE2.
+/// </summary>
+class PolylineGeometry
+{
+public: // Constants ----------------------------------------------------------
+	static const int	MiterLimit = 4;
+
+public: // Static methods -----------------------------------------------------
+	static int	getMaxNumVerts(int numPoints, bool closed);
+	static int	writePolyline(
+		float *data, const QPointF *points, int numPoints, float halfWidth,
+		VidgfxLineJoin join, bool closed, const QColor *cols,
+		bool colPerPoint = false);
+};
+//=============================================================================
+
+#endif // POLYLINEGEOMETRY_H
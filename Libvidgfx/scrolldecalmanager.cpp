@@ -0,0 +1,605 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#include "scrolldecalmanager.h"
+#include "graphicscontext.h"
+#include "vertexlayout.h"
+#include <emmintrin.h>
+
+// Every decal is written with the texture decal vertex layout
+Q_STATIC_ASSERT(ScrollDecalManager::NumFloatsPerVert ==
+	TexDecalVertLayout::NumFloats);
+
+//=============================================================================
+// Helpers
+
+/// <summary>
+/// Writes the 4 vertices of an axis-aligned quad for `GfxQuadListTopology` in
+/// the same order as `TexDecalVertBuf::writeScrollRect()`.
+/// </summary>
+static inline float *writeQuad(
+	float *data, float l, float t, float r, float b, float tlU, float tlV,
+	float trU, float trV, float blU, float blV, float brU, float brV)
+{
+	typedef TexDecalVertLayout Layout;
+	data = Layout::writeVert(data, l, t, QPointF(tlU, tlV)); // Top-left
+	data = Layout::writeVert(data, r, t, QPointF(trU, trV)); // Top-right
+	data = Layout::writeVert(data, l, b, QPointF(blU, blV)); // Bottom-left
+	data = Layout::writeVert(data, r, b, QPointF(brU, brV)); // Bottom-right
+	return data;
+}
+
+/// <summary>
+/// Loops `num` within the range [0..1) in the same way as
+/// `dblRepeat(num, 1.0)`.
+/// </summary>
+static inline float repeatUnit(float num)
+{
+	const float tmp = num - (float)((int)num);
+	if(tmp < 0.0f)
+		return 1.0f + tmp;
+	return tmp;
+}
+
+/// <summary>
+/// Vectorised version of `repeatUnit()`.
+/// </summary>
+static inline __m128 repeatUnit(__m128 num)
+{
+	const __m128 trunc = _mm_cvtepi32_ps(_mm_cvttps_epi32(num));
+	const __m128 tmp = _mm_sub_ps(num, trunc);
+	const __m128 neg = _mm_cmplt_ps(tmp, _mm_setzero_ps());
+	return _mm_add_ps(tmp, _mm_and_ps(neg, _mm_set1_ps(1.0f)));
+}
+
+/// <summary>
+/// Vectorised version of `qRound(a * b) / b` for non-negative `a` and
+/// positive `b`.
+/// </summary>
+static inline __m128 roundToGrid(__m128 a, __m128 b)
+{
+	const __m128 scaled = _mm_add_ps(_mm_mul_ps(a, b), _mm_set1_ps(0.5f));
+	const __m128 rounded = _mm_cvtepi32_ps(_mm_cvttps_epi32(scaled));
+	return _mm_div_ps(rounded, b);
+}
+
+static inline __m128 select(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+//=============================================================================
+// ScrollDecalManager class
+
+ScrollDecalManager::ScrollDecalManager(GraphicsContext *context)
+	: m_context(context)
+	, m_vertBuf(NULL)
+	, m_numDecals(0)
+	, m_roundOffset(true)
+	, m_dirty(false)
+	, m_layoutDirty(false)
+	//, m_arrays()
+	, m_textures()
+
+	// Layout of the vertex buffer
+	, m_startVerts()
+	, m_wrapDecals()
+	, m_batches()
+	, m_numVerts(0)
+
+	// Render state
+	, m_texShader(GfxTexDecalShader)
+	, m_blending(GfxAlphaBlending)
+	, m_filter(GfxBilinearFilter)
+{
+}
+
+ScrollDecalManager::~ScrollDecalManager()
+{
+	if(m_vertBuf != NULL)
+		deleteVertBuf();
+}
+
+void ScrollDecalManager::deleteVertBuf()
+{
+	if(m_vertBuf == NULL)
+		return;
+	if(m_context == NULL || !m_context->isValid())
+		return;
+	m_context->deleteVertexBuffer(m_vertBuf);
+	m_vertBuf = NULL;
+	m_dirty = true;
+}
+
+int ScrollDecalManager::getNumVerts()
+{
+	updateLayout();
+	return m_numVerts;
+}
+
+int ScrollDecalManager::getNumDrawCalls()
+{
+	updateLayout();
+	return m_batches.size();
+}
+
+/// <summary>
+/// Renders every decal that has a texture to the current render target,
+/// regenerating the geometry of all decals first if anything has changed
+/// since the last time that they were drawn. Changes the context's shader,
+/// topology, blending, texture and texture filter.
+/// </summary>
+void ScrollDecalManager::draw()
+{
+	if(m_context == NULL || !m_context->isValid())
+		return; // No context operations can be done
+	updateLayout();
+	if(m_numVerts <= 0)
+		return; // Nothing to render
+	if(!updateGeometry())
+		return; // Failed to update vertex buffer
+
+	// Issue one draw call per texture and address mode. Split decals must
+	// be clamped as their quads can sample the very edge of the texture.
+	m_context->setShader(m_texShader);
+	m_context->setTopology(GfxQuadListTopology);
+	m_context->setBlending(m_blending);
+	for(int i = 0; i < m_batches.size(); i++) {
+		const Batch &batch = m_batches.at(i);
+		if(i == 0 || batch.wrap != m_batches.at(i - 1).wrap) {
+			m_context->setTextureFilter(m_filter,
+				batch.wrap ? GfxWrapAddressing : GfxClampAddressing);
+		}
+		m_context->setTexture(batch.tex);
+		m_context->drawBuffer(m_vertBuf, batch.numVerts, batch.startVert);
+	}
+}
+
+/// <summary>
+/// Enable or disable rounding of texture coordinates in UV space so that the
+/// texture's texels remain in the same position when scrolling. Applies to
+/// all decals. Enabled by default.
+/// </summary>
+void ScrollDecalManager::setRoundOffset(bool round)
+{
+	if(m_roundOffset == round)
+		return; // Nothing to do
+	m_roundOffset = round;
+	m_dirty = true;
+}
+
+/// <summary>
+/// Adds a decal that displays the entire texture `tex` without scrolling.
+/// </summary>
+/// <returns>The ID of the new decal</returns>
+int ScrollDecalManager::addDecal(Texture *tex, const QRectF &rect)
+{
+	const int id = m_numDecals;
+	resizeArrays(m_numDecals + 1);
+	m_textures[id] = tex;
+	setDecalRect(id, rect);
+	setDecalTextureUv(
+		id, QPointF(0.0f, 0.0f), QPointF(1.0f, 0.0f), QPointF(0.0f, 1.0f),
+		QPointF(1.0f, 1.0f));
+	m_layoutDirty = true;
+	m_dirty = true;
+	return id;
+}
+
+/// <summary>
+/// Removes the decal `id`. The last decal is moved into the removed decal's
+/// slot so its ID changes to `id`.
+/// </summary>
+void ScrollDecalManager::removeDecal(int id)
+{
+	if(id < 0 || id >= m_numDecals)
+		return; // Invalid ID
+	const int last = m_numDecals - 1;
+	for(int i = 0; i < NumArrays; i++)
+		m_arrays[i][id] = m_arrays[i].at(last);
+	m_textures[id] = m_textures.at(last);
+	resizeArrays(last);
+	m_layoutDirty = true;
+	m_dirty = true;
+}
+
+/// <summary>
+/// Removes all decals. The vertex buffer is kept so that it can be reused.
+/// </summary>
+void ScrollDecalManager::clear()
+{
+	resizeArrays(0);
+	m_layoutDirty = true;
+	m_dirty = true;
+}
+
+void ScrollDecalManager::setDecalTexture(int id, Texture *tex)
+{
+	if(id < 0 || id >= m_numDecals)
+		return; // Invalid ID
+	if(m_textures.at(id) == tex)
+		return; // Nothing to do
+	m_textures[id] = tex;
+	m_layoutDirty = true;
+	m_dirty = true;
+}
+
+Texture *ScrollDecalManager::getDecalTexture(int id) const
+{
+	if(id < 0 || id >= m_numDecals)
+		return NULL; // Invalid ID
+	return m_textures.at(id);
+}
+
+void ScrollDecalManager::setDecalRect(int id, const QRectF &rect)
+{
+	if(id < 0 || id >= m_numDecals)
+		return; // Invalid ID
+	setValue(LeftArray, id, rect.left());
+	setValue(TopArray, id, rect.top());
+	setValue(WidthArray, id, rect.width());
+	setValue(HeightArray, id, rect.height());
+	m_dirty = true;
+}
+
+QRectF ScrollDecalManager::getDecalRect(int id) const
+{
+	if(id < 0 || id >= m_numDecals)
+		return QRectF(); // Invalid ID
+	return QRectF(
+		getValue(LeftArray, id), getValue(TopArray, id),
+		getValue(WidthArray, id), getValue(HeightArray, id));
+}
+
+void ScrollDecalManager::setDecalTextureUv(
+	int id, const QPointF &topLeft, const QPointF &topRight,
+	const QPointF &botLeft, const QPointF &botRight)
+{
+	if(id < 0 || id >= m_numDecals)
+		return; // Invalid ID
+	setValue(TlUArray, id, topLeft.x());
+	setValue(TlVArray, id, topLeft.y());
+	setValue(TrUArray, id, topRight.x());
+	setValue(TrVArray, id, topRight.y());
+	setValue(BlUArray, id, botLeft.x());
+	setValue(BlVArray, id, botLeft.y());
+	setValue(BrUArray, id, botRight.x());
+	setValue(BrVArray, id, botRight.y());
+	m_layoutDirty = true; // Number of vertices can change
+	m_dirty = true;
+}
+
+void ScrollDecalManager::getDecalTextureUv(
+	int id, QPointF *topLeft, QPointF *topRight, QPointF *botLeft,
+	QPointF *botRight) const
+{
+	if(id < 0 || id >= m_numDecals)
+		return; // Invalid ID
+	if(topLeft != NULL)
+		*topLeft = QPointF(getValue(TlUArray, id), getValue(TlVArray, id));
+	if(topRight != NULL)
+		*topRight = QPointF(getValue(TrUArray, id), getValue(TrVArray, id));
+	if(botLeft != NULL)
+		*botLeft = QPointF(getValue(BlUArray, id), getValue(BlVArray, id));
+	if(botRight != NULL)
+		*botRight = QPointF(getValue(BrUArray, id), getValue(BrVArray, id));
+}
+
+void ScrollDecalManager::scrollDecalBy(int id, const QPointF &delta)
+{
+	if(id < 0 || id >= m_numDecals)
+		return; // Invalid ID
+	if(delta.isNull())
+		return; // Nothing to do
+
+	// Keep within a sane range so we don't get resolution errors after a long
+	// period of time
+	setValue(ScrollXArray, id,
+		repeatUnit(getValue(ScrollXArray, id) + (float)delta.x()));
+	setValue(ScrollYArray, id,
+		repeatUnit(getValue(ScrollYArray, id) + (float)delta.y()));
+	m_dirty = true;
+}
+
+void ScrollDecalManager::resetDecalScrolling(int id)
+{
+	if(id < 0 || id >= m_numDecals)
+		return; // Invalid ID
+	setValue(ScrollXArray, id, 0.0f);
+	setValue(ScrollYArray, id, 0.0f);
+	m_dirty = true;
+}
+
+QPointF ScrollDecalManager::getDecalScrollOffset(int id) const
+{
+	if(id < 0 || id >= m_numDecals)
+		return QPointF(); // Invalid ID
+	return QPointF(getValue(ScrollXArray, id), getValue(ScrollYArray, id));
+}
+
+/// <summary>
+/// Sets the amount that `advance()` scrolls the decal per unit of time in
+/// rectangle space, i.e. a speed of 1.0 scrolls the entire rectangle.
+/// </summary>
+void ScrollDecalManager::setDecalScrollSpeed(int id, const QPointF &speed)
+{
+	if(id < 0 || id >= m_numDecals)
+		return; // Invalid ID
+	setValue(SpeedXArray, id, speed.x());
+	setValue(SpeedYArray, id, speed.y());
+}
+
+QPointF ScrollDecalManager::getDecalScrollSpeed(int id) const
+{
+	if(id < 0 || id >= m_numDecals)
+		return QPointF(); // Invalid ID
+	return QPointF(getValue(SpeedXArray, id), getValue(SpeedYArray, id));
+}
+
+/// <summary>
+/// Scrolls every decal by its scroll speed multiplied by `time` in a single
+/// pass.
+/// </summary>
+void ScrollDecalManager::advance(float time)
+{
+	if(m_numDecals <= 0 || time == 0.0f)
+		return; // Nothing to do
+
+	float *scrollX = m_arrays[ScrollXArray].data();
+	float *scrollY = m_arrays[ScrollYArray].data();
+	const float *speedX = m_arrays[SpeedXArray].constData();
+	const float *speedY = m_arrays[SpeedYArray].constData();
+	const __m128 t = _mm_set1_ps(time);
+	for(int i = 0; i < m_numDecals; i += 4) {
+		__m128 x = _mm_loadu_ps(&scrollX[i]);
+		__m128 y = _mm_loadu_ps(&scrollY[i]);
+		x = _mm_add_ps(x, _mm_mul_ps(_mm_loadu_ps(&speedX[i]), t));
+		y = _mm_add_ps(y, _mm_mul_ps(_mm_loadu_ps(&speedY[i]), t));
+		_mm_storeu_ps(&scrollX[i], repeatUnit(x));
+		_mm_storeu_ps(&scrollY[i], repeatUnit(y));
+	}
+	m_dirty = true;
+}
+
+/// <summary>
+/// Resizes every decal array so that it can hold `numDecals` decals rounded
+/// up to a multiple of 4. New and padding entries are zero.
+/// </summary>
+void ScrollDecalManager::resizeArrays(int numDecals)
+{
+	const int oldPadded = m_arrays[0].size();
+	const int padded = (numDecals + 3) & ~3;
+	for(int i = 0; i < NumArrays; i++) {
+		QVector<float> &arr = m_arrays[i];
+		arr.resize(padded);
+		for(int j = numDecals; j < padded && j < oldPadded; j++)
+			arr[j] = 0.0f;
+	}
+	m_textures.resize(numDecals);
+	m_numDecals = numDecals;
+}
+
+/// <summary>
+/// Groups the decals by texture and assigns each decal its location in the
+/// vertex buffer. Decals without a texture are not rendered.
+/// </summary>
+void ScrollDecalManager::updateLayout()
+{
+	if(!m_layoutDirty)
+		return;
+	m_layoutDirty = false;
+	m_batches.clear();
+	m_startVerts.resize(m_numDecals);
+	m_wrapDecals.resize(m_numDecals);
+
+	// Count the decals of each texture and address mode. The number of
+	// different textures is expected to be small so a linear search is used.
+	for(int i = 0; i < m_numDecals; i++) {
+		Texture *tex = m_textures.at(i);
+		m_startVerts[i] = -1;
+		if(tex == NULL)
+			continue;
+		QPointF tlUv, trUv, blUv, brUv;
+		getDecalTextureUv(i, &tlUv, &trUv, &blUv, &brUv);
+		m_wrapDecals[i] =
+			TexDecalVertBuf::isWrappableUv(tlUv, trUv, blUv, brUv);
+		int j = 0;
+		for(; j < m_batches.size(); j++) {
+			const Batch &batch = m_batches.at(j);
+			if(batch.tex == tex && batch.wrap == m_wrapDecals.at(i))
+				break;
+		}
+		if(j == m_batches.size()) {
+			Batch batch;
+			batch.tex = tex;
+			batch.wrap = m_wrapDecals.at(i);
+			batch.startVert = 0;
+			batch.numVerts = 0;
+			m_batches.append(batch);
+		}
+		m_startVerts[i] = j; // Temporarily the batch index
+		m_batches[j].numVerts += m_wrapDecals.at(i)
+			? NumVertsPerWrapDecal : NumVertsPerSplitDecal;
+	}
+
+	// Assign the location of each batch and decal
+	m_numVerts = 0;
+	for(int j = 0; j < m_batches.size(); j++) {
+		Batch &batch = m_batches[j];
+		batch.startVert = m_numVerts;
+		m_numVerts += batch.numVerts;
+		batch.numVerts = 0;
+	}
+	for(int i = 0; i < m_numDecals; i++) {
+		if(m_startVerts.at(i) < 0)
+			continue;
+		Batch &batch = m_batches[m_startVerts.at(i)];
+		m_startVerts[i] = batch.startVert + batch.numVerts;
+		batch.numVerts += m_wrapDecals.at(i)
+			? NumVertsPerWrapDecal : NumVertsPerSplitDecal;
+	}
+}
+
+/// <summary>
+/// Regenerates the geometry of every decal into the shared vertex buffer,
+/// creating or enlarging the buffer if required. The layout must be up to
+/// date.
+/// </summary>
+/// <returns>True if the vertex buffer is ready to be rendered</returns>
+bool ScrollDecalManager::updateGeometry()
+{
+	// (Re)create the vertex buffer if it isn't large enough. As the entire
+	// buffer is rewritten whenever anything changes no system memory copy is
+	// required.
+	const int numFloats = m_numVerts * NumFloatsPerVert;
+	if(m_vertBuf != NULL && m_vertBuf->getNumFloats() < numFloats)
+		deleteVertBuf();
+	if(m_vertBuf == NULL) {
+		int size = GraphicsContext::nextPowTwo(numFloats);
+		if(size < MinBufFloats)
+			size = MinBufFloats;
+		m_vertBuf =
+			m_context->createVertexBuffer(size, GfxWriteThroughStorage);
+		if(m_vertBuf == NULL)
+			return false; // Failed to create vertex buffer
+		m_dirty = true;
+	}
+	if(!m_dirty)
+		return true; // Buffer is up-to-date
+
+	float *data = TexDecalVertLayout::mapBuffer(m_vertBuf, m_numVerts);
+	if(data == NULL)
+		return false;
+
+	const float *arr[NumArrays];
+	for(int i = 0; i < NumArrays; i++)
+		arr[i] = m_arrays[i].constData();
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 roundMask =
+		m_roundOffset ? _mm_cmpeq_ps(zero, zero) : zero;
+
+	// Calculate the split point and UV offset of 4 decals at once and then
+	// write out the vertices of each decal to its location in the buffer
+	for(int i = 0; i < m_numDecals; i += 4) {
+		const __m128 l = _mm_loadu_ps(&arr[LeftArray][i]);
+		const __m128 t = _mm_loadu_ps(&arr[TopArray][i]);
+		const __m128 w = _mm_loadu_ps(&arr[WidthArray][i]);
+		const __m128 h = _mm_loadu_ps(&arr[HeightArray][i]);
+		__m128 xLerp = _mm_loadu_ps(&arr[ScrollXArray][i]);
+		__m128 yLerp = _mm_loadu_ps(&arr[ScrollYArray][i]);
+
+		// We assume the texture UV is orthogonal. Empty rectangles are never
+		// rounded.
+		const __m128 notEmpty = _mm_and_ps(roundMask,
+			_mm_and_ps(_mm_cmpgt_ps(w, zero), _mm_cmpgt_ps(h, zero)));
+		const __m128 safeW = select(notEmpty, w, _mm_set1_ps(1.0f));
+		const __m128 safeH = select(notEmpty, h, _mm_set1_ps(1.0f));
+		xLerp = select(notEmpty, roundToGrid(xLerp, safeW), xLerp);
+		yLerp = select(notEmpty, roundToGrid(yLerp, safeH), yLerp);
+
+		// Positions
+		float pos[6][4];
+		_mm_storeu_ps(pos[0], l);
+		_mm_storeu_ps(pos[1], _mm_add_ps(l, _mm_mul_ps(w, xLerp)));
+		_mm_storeu_ps(pos[2], _mm_add_ps(l, w));
+		_mm_storeu_ps(pos[3], t);
+		_mm_storeu_ps(pos[4], _mm_add_ps(t, _mm_mul_ps(h, yLerp)));
+		_mm_storeu_ps(pos[5], _mm_add_ps(t, h));
+
+		// Texture UVs at the split point
+		const __m128 tlU = _mm_loadu_ps(&arr[TlUArray][i]);
+		const __m128 tlV = _mm_loadu_ps(&arr[TlVArray][i]);
+		const __m128 trU = _mm_loadu_ps(&arr[TrUArray][i]);
+		const __m128 trV = _mm_loadu_ps(&arr[TrVArray][i]);
+		const __m128 blU = _mm_loadu_ps(&arr[BlUArray][i]);
+		const __m128 blV = _mm_loadu_ps(&arr[BlVArray][i]);
+		const __m128 brU = _mm_loadu_ps(&arr[BrUArray][i]);
+		const __m128 brV = _mm_loadu_ps(&arr[BrVArray][i]);
+		float mid[4][4];
+		_mm_storeu_ps(mid[0],
+			_mm_add_ps(trU, _mm_mul_ps(xLerp, _mm_sub_ps(tlU, trU))));
+		_mm_storeu_ps(mid[1],
+			_mm_add_ps(brU, _mm_mul_ps(xLerp, _mm_sub_ps(blU, brU))));
+		_mm_storeu_ps(mid[2],
+			_mm_add_ps(blV, _mm_mul_ps(yLerp, _mm_sub_ps(tlV, blV))));
+		_mm_storeu_ps(mid[3],
+			_mm_add_ps(brV, _mm_mul_ps(yLerp, _mm_sub_ps(trV, brV))));
+
+		// Texture UV offsets of decals that are rendered as a single quad
+		float off[2][4];
+		_mm_storeu_ps(off[0], _mm_mul_ps(xLerp, _mm_sub_ps(tlU, trU)));
+		_mm_storeu_ps(off[1], _mm_mul_ps(yLerp, _mm_sub_ps(tlV, blV)));
+
+		const int num = qMin(4, m_numDecals - i);
+		for(int j = 0; j < num; j++) {
+			const int id = i + j;
+			if(m_startVerts.at(id) < 0)
+				continue; // Decal isn't rendered
+			float *out = &data[m_startVerts.at(id) * NumFloatsPerVert];
+			const float left = pos[0][j];
+			const float splitX = pos[1][j];
+			const float right = pos[2][j];
+			const float top = pos[3][j];
+			const float splitY = pos[4][j];
+			const float bottom = pos[5][j];
+			const float midTopU = mid[0][j];
+			const float midBotU = mid[1][j];
+			const float midLeftV = mid[2][j];
+			const float midRightV = mid[3][j];
+
+			if(m_wrapDecals.at(id)) {
+				const float offU = off[0][j];
+				const float offV = off[1][j];
+				out = writeQuad(out, left, top, right, bottom,
+					arr[TlUArray][id] + offU, arr[TlVArray][id] + offV,
+					arr[TrUArray][id] + offU, arr[TrVArray][id] + offV,
+					arr[BlUArray][id] + offU, arr[BlVArray][id] + offV,
+					arr[BrUArray][id] + offU, arr[BrVArray][id] + offV);
+				continue;
+			}
+
+			// Top-left rectangle
+			out = writeQuad(out, left, top, splitX, splitY,
+				midTopU, midLeftV, arr[TrUArray][id], midRightV,
+				midBotU, arr[BlVArray][id],
+				arr[BrUArray][id], arr[BrVArray][id]);
+
+			// Top-right rectangle
+			out = writeQuad(out, splitX, top, right, splitY,
+				arr[TlUArray][id], midLeftV, midTopU, midRightV,
+				arr[BlUArray][id], arr[BlVArray][id],
+				midBotU, arr[BrVArray][id]);
+
+			// Bottom-left rectangle
+			out = writeQuad(out, left, splitY, splitX, bottom,
+				midTopU, arr[TlVArray][id], arr[TrUArray][id],
+				arr[TrVArray][id], midBotU, midLeftV,
+				arr[BrUArray][id], midRightV);
+
+			// Bottom-right rectangle
+			out = writeQuad(out, splitX, splitY, right, bottom,
+				arr[TlUArray][id], arr[TlVArray][id], midTopU,
+				arr[TrVArray][id], arr[BlUArray][id], midLeftV,
+				midBotU, midRightV);
+		}
+	}
+
+	m_vertBuf->markDirty(0, numFloats);
+	m_vertBuf->unmap();
+	m_dirty = false;
+	return true;
+}
@@ -0,0 +1,220 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#ifndef SCROLLDECALMANAGER_H
+#define SCROLLDECALMANAGER_H
+
+#include "include/libvidgfx.h"
+#include <QtCore/QPointF>
+#include <QtCore/QRectF>
+#include <QtCore/QVector>
+
+class GraphicsContext;
+class Texture;
+class VertexBuffer;
+
+//=============================================================================
+/// <summary>
+/// Manages any number of scrolling texture decals, such as news tickers, as a
+/// single unit. The state of every decal is kept in structure-of-arrays float
+/// storage so that advancing the scroll offsets and regenerating the geometry
+/// of all decals is done 4 decals at a time with SSE2 into one shared vertex
+/// buffer. Each decal generates the same geometry as `TexDecalVertBuf` does
+/// when scrolling with wrap addressing enabled, i.e. a single quad with offset
+/// UVs that is sampled with `GfxWrapAddressing` if the decal displays exactly
+/// one repeat of its texture and 4 quads that are sampled with
+/// `GfxClampAddressing` otherwise. Decals that share both a texture and an
+/// address mode are rendered with a single draw call, the groups are drawn in
+/// the order that they first appear. Decal IDs are indices into the manager and
+/// removing a decal moves the last decal into the removed decal's ID. It is up
+/// to the user to either call `deleteVertBuf()` or delete the whole object when
+/// the graphics context is released.
+/// </summary>
+class ScrollDecalManager
+{
+protected: // Datatypes -------------------------------------------------------
+	struct Batch {
+		Texture *	tex;
+		bool		wrap; // Decals are single quads that need wrapping
+		int			startVert;
+		int			numVerts;
+	};
+
+	enum DecalArray {
+		LeftArray = 0,
+		TopArray,
+		WidthArray,
+		HeightArray,
+		TlUArray,
+		TlVArray,
+		TrUArray,
+		TrVArray,
+		BlUArray,
+		BlVArray,
+		BrUArray,
+		BrVArray,
+		ScrollXArray, // In rectangle space
+		ScrollYArray,
+		SpeedXArray, // In rectangle space per unit of time
+		SpeedYArray,
+
+		NumArrays // Must be last
+	};
+
+public: // Constants ----------------------------------------------------------
+
+	// Each decal is rendered as either 1 or 4 quads (1 vertex = 8 floats)
+	static const int	NumVertsPerWrapDecal = 4;
+	static const int	NumVertsPerSplitDecal = VIDGFX_SCROLL_RECT_NUM_VERTS;
+	static const int	NumFloatsPerVert = 8;
+
+	// The smallest vertex buffer that is allocated in floats
+	static const int	MinBufFloats = 16 * VIDGFX_SCROLL_RECT_NUM_FLOATS;
+
+protected: // Members ---------------------------------------------------------
+	GraphicsContext *	m_context;
+	VertexBuffer *		m_vertBuf;
+	int					m_numDecals;
+	bool				m_roundOffset;
+	bool				m_dirty; // Geometry needs to be regenerated
+	bool				m_layoutDirty; // Batches need to be rebuilt
+
+	// Decal state. Each array is padded to a multiple of 4 decals.
+	QVector<float>		m_arrays[NumArrays];
+	QVector<Texture *>	m_textures;
+
+	// Layout of the vertex buffer
+	QVector<int>		m_startVerts; // -1 if the decal isn't rendered
+	QVector<bool>		m_wrapDecals; // Decal is rendered as a single quad
+	QVector<Batch>		m_batches;
+	int					m_numVerts;
+
+	// Render state
+	VidgfxShader	m_texShader;
+	VidgfxBlending	m_blending;
+	VidgfxFilter	m_filter;
+
+public: // Constructor/destructor ---------------------------------------------
+	ScrollDecalManager(GraphicsContext *context = NULL);
+	virtual ~ScrollDecalManager();
+
+public: // Methods ------------------------------------------------------------
+	void	setContext(GraphicsContext *context);
+	void	deleteVertBuf();
+	int		getNumVerts();
+	int		getNumDrawCalls();
+	void	draw();
+
+	// State
+	void			setTexShader(VidgfxShader shader);
+	VidgfxShader	getTexShader() const;
+	void			setBlending(VidgfxBlending blending);
+	VidgfxBlending	getBlending() const;
+	void			setTextureFilter(VidgfxFilter filter);
+	VidgfxFilter	getTextureFilter() const;
+	void			setRoundOffset(bool round);
+	bool			getRoundOffset() const;
+
+	// Decals
+	int		addDecal(Texture *tex, const QRectF &rect);
+	void	removeDecal(int id);
+	void	clear();
+	int		getNumDecals() const;
+	void	setDecalTexture(int id, Texture *tex);
+	Texture *	getDecalTexture(int id) const;
+	void	setDecalRect(int id, const QRectF &rect);
+	QRectF	getDecalRect(int id) const;
+	void	setDecalTextureUv(
+		int id, const QPointF &topLeft, const QPointF &topRight,
+		const QPointF &botLeft, const QPointF &botRight);
+	void	getDecalTextureUv(
+		int id, QPointF *topLeft, QPointF *topRight, QPointF *botLeft,
+		QPointF *botRight) const;
+
+	// Scrolling
+	void	scrollDecalBy(int id, const QPointF &delta);
+	void	resetDecalScrolling(int id);
+	QPointF	getDecalScrollOffset(int id) const;
+	void	setDecalScrollSpeed(int id, const QPointF &speed);
+	QPointF	getDecalScrollSpeed(int id) const;
+	void	advance(float time);
+
+private:
+	float	getValue(DecalArray arr, int id) const;
+	void	setValue(DecalArray arr, int id, float value);
+	void	resizeArrays(int numDecals);
+	void	updateLayout();
+	bool	updateGeometry();
+};
+//=============================================================================
+
+inline void ScrollDecalManager::setContext(GraphicsContext *context)
+{
+	m_context = context;
+}
+
+inline void ScrollDecalManager::setTexShader(VidgfxShader shader)
+{
+	m_texShader = shader;
+}
+
+inline VidgfxShader ScrollDecalManager::getTexShader() const
+{
+	return m_texShader;
+}
+
+inline void ScrollDecalManager::setBlending(VidgfxBlending blending)
+{
+	m_blending = blending;
+}
+
+inline VidgfxBlending ScrollDecalManager::getBlending() const
+{
+	return m_blending;
+}
+
+inline void ScrollDecalManager::setTextureFilter(VidgfxFilter filter)
+{
+	m_filter = filter;
+}
+
+inline VidgfxFilter ScrollDecalManager::getTextureFilter() const
+{
+	return m_filter;
+}
+
+inline bool ScrollDecalManager::getRoundOffset() const
+{
+	return m_roundOffset;
+}
+
+inline int ScrollDecalManager::getNumDecals() const
+{
+	return m_numDecals;
+}
+
+inline float ScrollDecalManager::getValue(DecalArray arr, int id) const
+{
+	return m_arrays[arr].at(id);
+}
+
+inline void ScrollDecalManager::setValue(DecalArray arr, int id, float value)
+{
+	m_arrays[arr][id] = value;
+}
+
+#endif // SCROLLDECALMANAGER_H
@@ -0,0 +1,266 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#include "softwarelayerrenderer.h"
+#include "gfxlog.h"
+#include "graphicscontext.h"
+#include "imagesampler.h"
+#include <emmintrin.h>
+#include <math.h>
+
+const QString LOG_CAT = QStringLiteral("Gfx");
+
+//=============================================================================
+// Helpers
+
+/// <summary>
+/// Returns the pixel range [`start`..`end`) whose centres are inside of the
+/// span between `a` and `b`. Uses the same top-left rule as the rasterizer so
+/// that adjacent layers never cover the same pixel twice.
+/// </summary>
+static inline void coveredPixels(
+	float a, float b, int size, int *start, int *end)
+{
+	const float lo = (a < b) ? a : b;
+	const float hi = (a < b) ? b : a;
+	*start = qBound(0, (int)ceilf(lo - 0.5f), size);
+	*end = qBound(0, (int)ceilf(hi - 0.5f), size);
+}
+
+//=============================================================================
+// SoftwareLayerRenderer class
+
+SoftwareLayerRenderer::SoftwareLayerRenderer(QImage *target)
+	: m_target(target)
+	, m_viewRect()
+	, m_blending(GfxNoBlending)
+	//, m_textures() // Zeroed below
+	, m_filter(GfxBilinearFilter)
+	, m_addressMode(GfxClampAddressing)
+	, m_modColor(Qt::white)
+{
+	for(int i = 0; i < VIDGFX_MAX_LAYER_INST_TEXTURES; i++)
+		m_textures[i] = NULL;
+}
+
+SoftwareLayerRenderer::~SoftwareLayerRenderer()
+{
+}
+
+void SoftwareLayerRenderer::setTarget(QImage *target)
+{
+	m_target = target;
+}
+
+/// <summary>
+/// Sets the area of the world that is mapped to the entire target. An empty
+/// rectangle maps one world unit to one target pixel, starting at the origin.
+/// </summary>
+void SoftwareLayerRenderer::setViewRect(const QRectF &rect)
+{
+	m_viewRect = rect;
+}
+
+QRectF SoftwareLayerRenderer::getViewRect() const
+{
+	if(!m_viewRect.isEmpty() || m_target == NULL)
+		return m_viewRect;
+	return QRectF(QPointF(0.0, 0.0), QSizeF(m_target->size()));
+}
+
+void SoftwareLayerRenderer::setBlending(VidgfxBlending blending)
+{
+	m_blending = blending;
+}
+
+/// <summary>
+/// Binds up to three textures that instances select with their texture slot.
+/// The images are not copied and must remain valid while they are bound.
+/// </summary>
+void SoftwareLayerRenderer::setTexture(
+	const QImage *texA, const QImage *texB, const QImage *texC)
+{
+	m_textures[0] = texA;
+	m_textures[1] = texB;
+	m_textures[2] = texC;
+}
+
+const QImage *SoftwareLayerRenderer::getTexture(int slot) const
+{
+	if(slot < 0 || slot >= VIDGFX_MAX_LAYER_INST_TEXTURES)
+		return NULL;
+	return m_textures[slot];
+}
+
+void SoftwareLayerRenderer::setTextureFilter(
+	VidgfxFilter filter, VidgfxAddressMode mode)
+{
+	m_filter = filter;
+	m_addressMode = mode;
+}
+
+void SoftwareLayerRenderer::setModColor(const QColor &color)
+{
+	m_modColor = color;
+}
+
+void SoftwareLayerRenderer::clear(const QColor &color)
+{
+	if(m_target == NULL)
+		return;
+	m_target->fill(color);
+}
+
+/// <summary>
+/// Renders `numInstances` layer instances in the format that
+/// `GraphicsContext::writeLayerInstances()` outputs. Instances are rendered
+/// in order.
+/// </summary>
+/// <returns>False if the target is invalid.</returns>
+bool SoftwareLayerRenderer::drawInstances(const float *data, int numInstances)
+{
+	if(m_target == NULL || m_target->isNull() ||
+		!ImageSampler::is32Bit(m_target->format()))
+	{
+		gfxLog(LOG_CAT, GfxLog::Warning) << QStringLiteral(
+			"Software layer renderer target must be a 32-bit image");
+		return false;
+	}
+	if(data == NULL || numInstances <= 0)
+		return true; // Nothing to render
+
+	for(int i = 0; i < numInstances; i++)
+		drawInstance(&data[i * GraphicsContext::LayerInstNumFloats]);
+	return true;
+}
+
+/// <summary>
+/// Renders the instances of a buffer that was filled with
+/// `GraphicsContext::createLayerInstances()`. As the data is read back from
+/// system memory the buffer must use `GfxShadowedStorage`.
+/// </summary>
+/// <returns>False if the target or buffer is invalid.</returns>
+bool SoftwareLayerRenderer::drawInstances(
+	VertexBuffer *instBuf, int numInstances, int startInstance)
+{
+	if(instBuf == NULL || instBuf->getDataPtr() == NULL ||
+		instBuf->getVertSize() != GraphicsContext::LayerInstNumFloats)
+	{
+		gfxLog(LOG_CAT, GfxLog::Warning) << QStringLiteral(
+			"Cannot read layer instances from vertex buffer");
+		return false;
+	}
+	if(startInstance < 0)
+		return false;
+	const int numAvail = instBuf->getNumVerts() - startInstance;
+	if(numInstances < 0 || numInstances > numAvail)
+		numInstances = numAvail;
+	return drawInstances(
+		&instBuf->getDataPtr()[
+			startInstance * GraphicsContext::LayerInstNumFloats],
+		numInstances);
+}
+
+/// <summary>
+/// Renders a single instance. The target must be valid.
+/// </summary>
+void SoftwareLayerRenderer::drawInstance(const float *inst)
+{
+	const int width = m_target->width();
+	const int height = m_target->height();
+	const QRectF view = getViewRect();
+	if(view.isEmpty())
+		return;
+	const float scaleX = (float)width / (float)view.width();
+	const float scaleY = (float)height / (float)view.height();
+
+	// Position of the instance in pixels. The width and height can be
+	// negative in which case the texture is flipped.
+	const float px = (inst[0] - (float)view.left()) * scaleX;
+	const float py = (inst[1] - (float)view.top()) * scaleY;
+	const float pw = inst[2] * scaleX;
+	const float ph = inst[3] * scaleY;
+	if(pw == 0.0f || ph == 0.0f)
+		return; // Zero area
+	int x0, x1, y0, y1;
+	coveredPixels(px, px + pw, width, &x0, &x1);
+	coveredPixels(py, py + ph, height, &y0, &y1);
+	if(x0 >= x1 || y0 >= y1)
+		return; // Not visible
+
+	// Select texture. A negative slot renders the colour only and, like the
+	// GPU, sampling an unbound texture results in transparent black.
+	const int slot = (int)inst[12];
+	const QImage *tex = (slot >= 0) ? getTexture(slot) : NULL;
+	const bool texHasAlpha =
+		(tex != NULL && tex->format() != QImage::Format_RGB32);
+
+	// Combined instance and modulation colour in the same B, G, R, A lane
+	// order as 32-bit images
+	const __m128 inv255 = _mm_set1_ps(1.0f / 255.0f);
+	const __m128 col = _mm_setr_ps(
+		inst[10] * (float)m_modColor.blueF(),
+		inst[9] * (float)m_modColor.greenF(),
+		inst[8] * (float)m_modColor.redF(),
+		inst[11] * (float)m_modColor.alphaF());
+	const __m128 untextured =
+		(slot < 0) ? _mm_set1_ps(255.0f) : _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const quint32 opaque = (m_target->format() == QImage::Format_RGB32)
+		? 0xFF000000U : 0U;
+
+	for(int y = y0; y < y1; y++) {
+		const float v = inst[5] + inst[7] * (((float)y + 0.5f - py) / ph);
+		quint32 *row = (quint32 *)m_target->scanLine(y);
+		for(int x = x0; x < x1; x++) {
+			const float u =
+				inst[4] + inst[6] * (((float)x + 0.5f - px) / pw);
+
+			// Sample texture and apply colour
+			__m128 src = untextured;
+			if(tex != NULL) {
+				quint32 texel = ImageSampler::sample(
+					*tex, QPointF(u, v), m_filter, m_addressMode);
+				if(!texHasAlpha)
+					texel |= 0xFF000000U;
+				src = ImageSampler::unpackPixel(texel);
+			}
+			src = _mm_mul_ps(src, col);
+
+			// Blend with the target. The output alpha is always the source
+			// alpha.
+			if(m_blending != GfxNoBlending) {
+				const __m128 srcA = _mm_mul_ps(
+					_mm_shuffle_ps(src, src, _MM_SHUFFLE(3, 3, 3, 3)),
+					inv255);
+				const __m128 dst = _mm_mul_ps(
+					ImageSampler::unpackPixel(row[x]), _mm_sub_ps(one, srcA));
+				__m128 rgb = src;
+				if(m_blending == GfxAlphaBlending)
+					rgb = _mm_mul_ps(src, srcA);
+				rgb = _mm_add_ps(rgb, dst);
+
+				// Replace the alpha lane with the source alpha
+				const __m128 rgbA = _mm_shuffle_ps(
+					rgb, src, _MM_SHUFFLE(3, 3, 2, 2)); // B2 B2 A3 A3
+				src = _mm_shuffle_ps(
+					rgb, rgbA, _MM_SHUFFLE(2, 0, 1, 0)); // B G R A
+			}
+			row[x] = ImageSampler::packPixel(src) | opaque;
+		}
+	}
+}
@@ -0,0 +1,108 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#ifndef SOFTWARELAYERRENDERER_H
+#define SOFTWARELAYERRENDERER_H
+
+#include "include/libvidgfx.h"
+#include <QtCore/QRectF>
+#include <QtGui/QColor>
+#include <QtGui/QImage>
+
+class VertexBuffer;
+
+//=============================================================================
+/// <summary>
+/// Renders layer instances on the CPU into a 32-bit `QImage` with the same
+/// results as `GraphicsContext::drawInstanced()`. This allows scenes that are
+/// built from layer instances to be rendered in headless environments and to
+/// be tested without a graphics device. The renderer mirrors the subset of
+/// context state that instanced layers use: the bound textures, the texture
+/// filter and address mode, the blending mode and the texture decal
+/// modulation colour. Pixels are covered using pixel centres and textures are
+/// sampled with `ImageSampler`. All textures and the target must be in a
+/// 32-bit format.
+/// </summary>
+class SoftwareLayerRenderer
+{
+protected: // Members ---------------------------------------------------------
+	QImage *			m_target;
+	QRectF				m_viewRect;
+	VidgfxBlending		m_blending;
+	const QImage *		m_textures[VIDGFX_MAX_LAYER_INST_TEXTURES];
+	VidgfxFilter		m_filter;
+	VidgfxAddressMode	m_addressMode;
+	QColor				m_modColor;
+
+public: // Constructor/destructor ---------------------------------------------
+	SoftwareLayerRenderer(QImage *target = NULL);
+	virtual ~SoftwareLayerRenderer();
+
+public: // Methods ------------------------------------------------------------
+	void			setTarget(QImage *target);
+	QImage *		getTarget() const;
+	void			setViewRect(const QRectF &rect);
+	QRectF			getViewRect() const;
+	void			setBlending(VidgfxBlending blending);
+	VidgfxBlending	getBlending() const;
+	void			setTexture(
+		const QImage *texA, const QImage *texB = NULL,
+		const QImage *texC = NULL);
+	const QImage *	getTexture(int slot) const;
+	void			setTextureFilter(
+		VidgfxFilter filter, VidgfxAddressMode mode = GfxClampAddressing);
+	VidgfxFilter		getTextureFilter() const;
+	VidgfxAddressMode	getTextureAddressMode() const;
+	void			setModColor(const QColor &color);
+	QColor			getModColor() const;
+
+	void	clear(const QColor &color);
+	bool	drawInstances(const float *data, int numInstances);
+	bool	drawInstances(
+		VertexBuffer *instBuf, int numInstances = -1, int startInstance = 0);
+
+private:
+	void	drawInstance(const float *inst);
+};
+//=============================================================================
+
+inline QImage *SoftwareLayerRenderer::getTarget() const
+{
+	return m_target;
+}
+
+inline VidgfxBlending SoftwareLayerRenderer::getBlending() const
+{
+	return m_blending;
+}
+
+inline VidgfxFilter SoftwareLayerRenderer::getTextureFilter() const
+{
+	return m_filter;
+}
+
+inline VidgfxAddressMode SoftwareLayerRenderer::getTextureAddressMode() const
+{
+	return m_addressMode;
+}
+
+inline QColor SoftwareLayerRenderer::getModColor() const
+{
+	return m_modColor;
+}
+
+#endif // SOFTWARELAYERRENDERER_H
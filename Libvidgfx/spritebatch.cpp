@@ -0,0 +1,318 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#include "spritebatch.h"
+#include "affinequadgeometry.h"
+#include "graphicscontext.h"
+#include "outlinegeometry.h"
+#include "polylinegeometry.h"
+#include "vertexlayout.h"
+#include <string.h>
+
+// Solid and textured rectangles share the same vertex buffer
+Q_STATIC_ASSERT(SpriteBatch::NumFloatsPerVert == SolidVertLayout::NumFloats);
+Q_STATIC_ASSERT(
+	SpriteBatch::NumFloatsPerVert == TexDecalVertLayout::NumFloats);
+
+//=============================================================================
+// SpriteBatch class
+
+SpriteBatch::SpriteBatch(GraphicsContext *context)
+	: m_context(context)
+	, m_vertBuf(NULL)
+	, m_data()
+	, m_numVerts(0)
+	, m_batches()
+	, m_dirty(false)
+
+	// State of rectangles that are added next
+	, m_texShader(GfxTexDecalShader)
+	, m_blending(GfxAlphaBlending)
+	, m_tex(NULL)
+	, m_filter(GfxBilinearFilter)
+	, m_addressMode(GfxClampAddressing)
+{
+}
+
+SpriteBatch::~SpriteBatch()
+{
+	if(m_vertBuf != NULL)
+		deleteVertBuf();
+}
+
+void SpriteBatch::deleteVertBuf()
+{
+	if(m_vertBuf == NULL)
+		return;
+	if(m_context == NULL || !m_context->isValid())
+		return;
+	m_context->deleteVertexBuffer(m_vertBuf);
+	m_vertBuf = NULL;
+}
+
+/// <summary>
+/// Removes all rectangles from the batch. The vertex buffer is kept so that
+/// it can be reused when the batch is rebuilt.
+/// </summary>
+void SpriteBatch::clear()
+{
+	m_numVerts = 0;
+	m_batches.clear();
+	m_dirty = true;
+}
+
+/// <summary>
+/// Renders every rectangle in the batch to the current render target. The
+/// vertex data is only uploaded if rectangles were added since the last time
+/// the batch was drawn so static batches can be drawn every frame without
+/// being rebuilt. If the context has culling enabled then every batch whose
+/// bounds aren't visible in the current render target is skipped. As this is
+/// tested every time the batch is drawn static batches stay correct when the
+/// render target or view changes. Changes the context's shader, topology,
+/// blending, texture and texture filter.
+/// </summary>
+void SpriteBatch::draw()
+{
+	if(m_numVerts <= 0)
+		return; // Nothing to render
+	if(m_context == NULL || !m_context->isValid())
+		return; // No context operations can be done
+
+	// (Re)create the vertex buffer if it isn't large enough
+	const int numFloats = m_numVerts * NumFloatsPerVert;
+	if(m_vertBuf != NULL && m_vertBuf->getNumFloats() < numFloats)
+		deleteVertBuf();
+	if(m_vertBuf == NULL) {
+		int size = GraphicsContext::nextPowTwo(numFloats);
+		if(size < MinBufFloats)
+			size = MinBufFloats;
+		// Shadowed storage as the previous contents are compared below
+		m_vertBuf = m_context->createVertexBuffer(size, GfxShadowedStorage);
+		if(m_vertBuf == NULL)
+			return; // Failed to create vertex buffer
+		m_dirty = true;
+	}
+
+	// Update the vertex buffer. Batches are usually rebuilt every frame with
+	// only a few rectangles changing so only the quads that differ from what
+	// is already in the buffer are marked as dirty.
+	if(m_dirty) {
+		const int quadFloats = NumVertsPerQuad * NumFloatsPerVert;
+		float *dst = m_vertBuf->getDataPtr();
+		const float *src = m_data.constData();
+		for(int off = 0; off < numFloats; off += quadFloats) {
+			const int size = quadFloats * sizeof(float);
+			if(memcmp(&dst[off], &src[off], size) == 0)
+				continue; // Quad is unchanged
+			memcpy(&dst[off], &src[off], size);
+			m_vertBuf->markDirty(off, quadFloats);
+		}
+		m_vertBuf->setNumVerts(m_numVerts);
+		m_vertBuf->setVertSize(NumFloatsPerVert);
+		m_vertBuf->setVertFormat(GfxFullVertFormat);
+		m_dirty = false;
+	}
+
+	// Issue one draw call per run of rectangles with the same state
+	m_context->setTopology(GfxQuadListTopology);
+	for(int i = 0; i < m_batches.size(); i++) {
+		const Batch &batch = m_batches.at(i);
+		if(m_context->cullRect(batch.bounds) == GfxRectCulled)
+			continue;
+		m_context->setShader(batch.shader);
+		m_context->setBlending(batch.blending);
+		if(batch.tex != NULL) {
+			m_context->setTexture(batch.tex);
+			m_context->setTextureFilter(batch.filter, batch.addressMode);
+		}
+		m_context->drawBuffer(m_vertBuf, batch.numVerts, batch.startVert);
+	}
+}
+
+/// <summary>
+/// Adds a filled rectangle with a different solid colour for each corner.
+/// </summary>
+void SpriteBatch::addSolidRect(
+	const QRectF &rect, const QColor &tlCol, const QColor &trCol,
+	const QColor &blCol, const QColor &brCol)
+{
+	float *data = appendQuads(1, GfxSolidShader, NULL, rect);
+	SolidVertLayout::writeQuad(data, rect, tlCol, trCol, blCol, brCol);
+}
+
+/// <summary>
+/// Adds a rectangle outline with a different solid colour for each corner.
+/// The outline is centered on the edge of the rectangle and generates the
+/// same geometry as `GraphicsContext::createSolidRectOutline()`.
+/// </summary>
+void SpriteBatch::addSolidRectOutline(
+	const QRectF &rect, const QColor &tlCol, const QColor &trCol,
+	const QColor &blCol, const QColor &brCol, const QPointF &halfWidth)
+{
+	const qreal hx = qAbs(halfWidth.x());
+	const qreal hy = qAbs(halfWidth.y());
+	const QColor cols[4] = { tlCol, trCol, blCol, brCol };
+	float *data = appendQuads(4, GfxSolidShader, NULL,
+		rect.normalized().adjusted(-hx, -hy, hx, hy));
+	OutlineGeometry::writeRectOutline(
+		data, rect, halfWidth, GfxFullVertFormat, cols);
+}
+
+/// <summary>
+/// Adds a rectangle that displays the current texture with the current
+/// texture shader. Does nothing if no texture is set.
+/// </summary>
+void SpriteBatch::addTexDecalRect(
+	const QRectF &rect, const QPointF &tlUv, const QPointF &trUv,
+	const QPointF &blUv, const QPointF &brUv)
+{
+	if(m_tex == NULL)
+		return;
+
+	float *data = appendQuads(1, m_texShader, m_tex, rect);
+	TexDecalVertLayout::writeQuad(data, rect, tlUv, trUv, blUv, brUv);
+}
+
+/// <summary>
+/// Adds a filled rectangle that is transformed by the affine part of
+/// `transform` with a different solid colour for each corner. The rectangle
+/// shares the batch with untransformed rectangles of the same state.
+/// </summary>
+void SpriteBatch::addSolidRect(
+	const QRectF &rect, const QTransform &transform, const QColor &tlCol,
+	const QColor &trCol, const QColor &blCol, const QColor &brCol)
+{
+	const QColor cols[4] = { tlCol, trCol, blCol, brCol };
+	float *data = appendQuads(1, GfxSolidShader, NULL,
+		AffineQuadGeometry::mapBounds(rect, transform));
+	AffineQuadGeometry::writeSolidQuads(data, &rect, &transform, 1, cols);
+}
+
+/// <summary>
+/// Adds a rectangle that displays the current texture and is transformed by
+/// the affine part of `transform`. Does nothing if no texture is set.
+/// </summary>
+void SpriteBatch::addTexDecalRect(
+	const QRectF &rect, const QTransform &transform, const QPointF &tlUv,
+	const QPointF &trUv, const QPointF &blUv, const QPointF &brUv)
+{
+	if(m_tex == NULL)
+		return;
+
+	const QPointF uvs[4] = { tlUv, trUv, blUv, brUv };
+	float *data = appendQuads(1, m_texShader, m_tex,
+		AffineQuadGeometry::mapBounds(rect, transform));
+	AffineQuadGeometry::writeTexDecalQuads(data, &rect, &transform, 1, uvs);
+}
+
+/// <summary>
+/// Adds a solid polyline with the same geometry as
+/// `GraphicsContext::createSolidPolyline()`. `cols` is either a single colour
+/// or one colour per point depending on `colPerPoint`. The bounds of the
+/// polyline are those of its points expanded by the longest possible miter.
+/// </summary>
+void SpriteBatch::addPolyline(
+	const QPointF *points, int numPoints, const QColor *cols,
+	bool colPerPoint, float halfWidth, VidgfxLineJoin join, bool closed)
+{
+	if(points == NULL || cols == NULL || numPoints < 2)
+		return;
+
+	qreal l = points[0].x();
+	qreal r = l;
+	qreal t = points[0].y();
+	qreal b = t;
+	for(int i = 1; i < numPoints; i++) {
+		l = qMin(l, points[i].x());
+		r = qMax(r, points[i].x());
+		t = qMin(t, points[i].y());
+		b = qMax(b, points[i].y());
+	}
+	const qreal margin = qAbs(halfWidth) * (qreal)PolylineGeometry::MiterLimit;
+	const QRectF bounds = QRectF(QPointF(l, t), QPointF(r, b)).adjusted(
+		-margin, -margin, margin, margin);
+
+	// Reserve space for the worst case and return what wasn't used
+	const int maxQuads = PolylineGeometry::getMaxNumVerts(
+		numPoints, closed) / NumVertsPerQuad;
+	float *data = appendQuads(maxQuads, GfxSolidShader, NULL, bounds);
+	const int numFloats = PolylineGeometry::writePolyline(
+		data, points, numPoints, halfWidth, join, closed, cols, colPerPoint);
+	releaseQuads(
+		maxQuads - numFloats / (NumVertsPerQuad * NumFloatsPerVert));
+}
+
+/// <summary>
+/// Reserves space for `numQuads` quads at the end of the vertex data and
+/// either extends the last batch or starts a new one if its state doesn't
+/// match. `bounds` is the screen space area that the quads cover and is used
+/// to cull the batch when it is drawn.
+/// </summary>
+/// <returns>A pointer to where the quads should be written.</returns>
+float *SpriteBatch::appendQuads(
+	int numQuads, VidgfxShader shader, Texture *tex, const QRectF &bounds)
+{
+	const int numVerts = numQuads * NumVertsPerQuad;
+	const int start = m_numVerts;
+
+	// Grow the vertex data geometrically
+	const int numFloats = (start + numVerts) * NumFloatsPerVert;
+	if(m_data.size() < numFloats)
+		m_data.resize(qMax(numFloats, m_data.size() * 2));
+
+	// Merge with the previous batch if possible
+	Batch *last = m_batches.isEmpty() ? NULL : &m_batches.last();
+	if(last != NULL && last->shader == shader &&
+		last->blending == m_blending && last->tex == tex &&
+		(tex == NULL || (last->filter == m_filter &&
+		last->addressMode == m_addressMode)))
+	{
+		last->numVerts += numVerts;
+		last->bounds |= bounds.normalized();
+	} else {
+		Batch batch;
+		batch.shader = shader;
+		batch.blending = m_blending;
+		batch.tex = tex;
+		batch.filter = m_filter;
+		batch.addressMode = m_addressMode;
+		batch.startVert = start;
+		batch.numVerts = numVerts;
+		batch.bounds = bounds.normalized();
+		m_batches.append(batch);
+	}
+
+	m_numVerts += numVerts;
+	m_dirty = true;
+	return m_data.data() + start * NumFloatsPerVert;
+}
+
+/// <summary>
+/// Returns the last `numQuads` quads that were reserved with `appendQuads()`
+/// but never written. Removes the last batch if it becomes empty.
+/// </summary>
+void SpriteBatch::releaseQuads(int numQuads)
+{
+	if(numQuads <= 0 || m_batches.isEmpty())
+		return;
+	const int numVerts = numQuads * NumVertsPerQuad;
+	Batch &last = m_batches.last();
+	last.numVerts -= numVerts;
+	m_numVerts -= numVerts;
+	if(last.numVerts <= 0)
+		m_batches.removeLast();
+}
@@ -0,0 +1,269 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+#include "include/libvidgfx.h"
+#include <QtCore/QVector>
+#include <QtGui/QColor>
+
+class GraphicsContext;
+class Texture;
+class VertexBuffer;
+
+//=============================================================================
+/// <summary>
+/// Collects any number of solid, outlined and textured rectangles into a
+/// single vertex buffer so that they can be rendered with as few draw calls as
+/// possible. Each rectangle remembers the shader, blending, texture, filter
+/// and address mode that were set when it was added and a new draw call is
+/// only issued when that state differs from the previous rectangle.
+/// Rectangles are always drawn in the order that they were added. If the
+/// context has culling enabled then each draw call is culled by the bounds of
+/// its rectangles when the batch is drawn, individual rectangles are never
+/// culled or clipped. Rectangles can also be rotated, skewed or scaled by an
+/// affine transform without breaking the batch. Solid polylines share the
+/// batch with solid rectangles. It is up to the user to either call
+/// `deleteVertBuf()` or delete the whole object when the graphics context is
+/// released.
+/// </summary>
+class SpriteBatch
+{
+protected: // Datatypes -------------------------------------------------------
+	struct Batch {
+		VidgfxShader	shader;
+		VidgfxBlending	blending;
+		Texture *		tex; // NULL for solid rectangles
+		VidgfxFilter	filter;
+		VidgfxAddressMode	addressMode;
+		int				startVert;
+		int				numVerts;
+		QRectF			bounds; // Union of the bounds of every quad
+	};
+
+public: // Constants ----------------------------------------------------------
+
+	// Rectangles are rendered as quad lists (1 vertex = 8 floats)
+	static const int	NumVertsPerQuad = 4;
+	static const int	NumFloatsPerVert = 8;
+
+	// The smallest vertex buffer that is allocated in floats
+	static const int	MinBufFloats = 64 * NumVertsPerQuad * NumFloatsPerVert;
+
+protected: // Members ---------------------------------------------------------
+	GraphicsContext *	m_context;
+	VertexBuffer *		m_vertBuf;
+	QVector<float>		m_data;
+	int					m_numVerts;
+	QVector<Batch>		m_batches;
+	bool				m_dirty;
+
+	// State of rectangles that are added next
+	VidgfxShader	m_texShader;
+	VidgfxBlending	m_blending;
+	Texture *		m_tex;
+	VidgfxFilter	m_filter;
+	VidgfxAddressMode	m_addressMode;
+
+public: // Constructor/destructor ---------------------------------------------
+	SpriteBatch(GraphicsContext *context = NULL);
+	virtual ~SpriteBatch();
+
+public: // Methods ------------------------------------------------------------
+	void	setContext(GraphicsContext *context);
+	void	deleteVertBuf();
+	void	clear();
+	int		getNumVerts() const;
+	int		getNumDrawCalls() const;
+	void	draw();
+
+	// State
+	void			setTexShader(VidgfxShader shader);
+	VidgfxShader	getTexShader() const;
+	void			setBlending(VidgfxBlending blending);
+	VidgfxBlending	getBlending() const;
+	void			setTexture(Texture *tex);
+	Texture *		getTexture() const;
+	void			setTextureFilter(VidgfxFilter filter);
+	VidgfxFilter	getTextureFilter() const;
+	void				setTextureAddressMode(VidgfxAddressMode mode);
+	VidgfxAddressMode	getTextureAddressMode() const;
+
+	// Rectangles
+	void	addSolidRect(const QRectF &rect, const QColor &col);
+	void	addSolidRect(
+		const QRectF &rect, const QColor &tlCol, const QColor &trCol,
+		const QColor &blCol, const QColor &brCol);
+	void	addSolidRectOutline(
+		const QRectF &rect, const QColor &col,
+		const QPointF &halfWidth = QPointF(0.5f, 0.5f));
+	void	addSolidRectOutline(
+		const QRectF &rect, const QColor &tlCol, const QColor &trCol,
+		const QColor &blCol, const QColor &brCol,
+		const QPointF &halfWidth = QPointF(0.5f, 0.5f));
+	void	addTexDecalRect(const QRectF &rect);
+	void	addTexDecalRect(
+		const QRectF &rect, const QPointF &tlUv, const QPointF &trUv,
+		const QPointF &blUv, const QPointF &brUv);
+
+	// Transformed rectangles
+	void	addSolidRect(
+		const QRectF &rect, const QTransform &transform, const QColor &col);
+	void	addSolidRect(
+		const QRectF &rect, const QTransform &transform,
+		const QColor &tlCol, const QColor &trCol, const QColor &blCol,
+		const QColor &brCol);
+	void	addTexDecalRect(const QRectF &rect, const QTransform &transform);
+	void	addTexDecalRect(
+		const QRectF &rect, const QTransform &transform,
+		const QPointF &tlUv, const QPointF &trUv, const QPointF &blUv,
+		const QPointF &brUv);
+
+	// Polylines
+	void	addSolidPolyline(
+		const QPointF *points, int numPoints, const QColor &col,
+		float halfWidth = 0.5f, VidgfxLineJoin join = GfxMiterJoin,
+		bool closed = false);
+	void	addSolidPolyline(
+		const QPointF *points, int numPoints, const QColor *cols,
+		float halfWidth = 0.5f, VidgfxLineJoin join = GfxMiterJoin,
+		bool closed = false);
+
+private:
+	float *	appendQuads(
+		int numQuads, VidgfxShader shader, Texture *tex,
+		const QRectF &bounds);
+	void	releaseQuads(int numQuads);
+	void	addPolyline(
+		const QPointF *points, int numPoints, const QColor *cols,
+		bool colPerPoint, float halfWidth, VidgfxLineJoin join, bool closed);
+};
+//=============================================================================
+
+inline void SpriteBatch::setContext(GraphicsContext *context)
+{
+	m_context = context;
+}
+
+inline int SpriteBatch::getNumVerts() const
+{
+	return m_numVerts;
+}
+
+inline int SpriteBatch::getNumDrawCalls() const
+{
+	return m_batches.size();
+}
+
+inline void SpriteBatch::setTexShader(VidgfxShader shader)
+{
+	m_texShader = shader;
+}
+
+inline VidgfxShader SpriteBatch::getTexShader() const
+{
+	return m_texShader;
+}
+
+inline void SpriteBatch::setBlending(VidgfxBlending blending)
+{
+	m_blending = blending;
+}
+
+inline VidgfxBlending SpriteBatch::getBlending() const
+{
+	return m_blending;
+}
+
+inline void SpriteBatch::setTexture(Texture *tex)
+{
+	m_tex = tex;
+}
+
+inline Texture *SpriteBatch::getTexture() const
+{
+	return m_tex;
+}
+
+inline void SpriteBatch::setTextureFilter(VidgfxFilter filter)
+{
+	m_filter = filter;
+}
+
+inline VidgfxFilter SpriteBatch::getTextureFilter() const
+{
+	return m_filter;
+}
+
+inline void SpriteBatch::setTextureAddressMode(VidgfxAddressMode mode)
+{
+	m_addressMode = mode;
+}
+
+inline VidgfxAddressMode SpriteBatch::getTextureAddressMode() const
+{
+	return m_addressMode;
+}
+
+inline void SpriteBatch::addSolidRect(const QRectF &rect, const QColor &col)
+{
+	addSolidRect(rect, col, col, col, col);
+}
+
+inline void SpriteBatch::addSolidRect(
+	const QRectF &rect, const QTransform &transform, const QColor &col)
+{
+	addSolidRect(rect, transform, col, col, col, col);
+}
+
+inline void SpriteBatch::addSolidRectOutline(
+	const QRectF &rect, const QColor &col, const QPointF &halfWidth)
+{
+	addSolidRectOutline(rect, col, col, col, col, halfWidth);
+}
+
+inline void SpriteBatch::addSolidPolyline(
+	const QPointF *points, int numPoints, const QColor &col,
+	float halfWidth, VidgfxLineJoin join, bool closed)
+{
+	addPolyline(points, numPoints, &col, false, halfWidth, join, closed);
+}
+
+inline void SpriteBatch::addSolidPolyline(
+	const QPointF *points, int numPoints, const QColor *cols,
+	float halfWidth, VidgfxLineJoin join, bool closed)
+{
+	addPolyline(points, numPoints, cols, true, halfWidth, join, closed);
+}
+
+inline void SpriteBatch::addTexDecalRect(const QRectF &rect)
+{
+	addTexDecalRect(
+		rect, QPointF(0.0f, 0.0f), QPointF(1.0f, 0.0f), QPointF(0.0f, 1.0f),
+		QPointF(1.0f, 1.0f));
+}
+
+inline void SpriteBatch::addTexDecalRect(
+	const QRectF &rect, const QTransform &transform)
+{
+	addTexDecalRect(
+		rect, transform, QPointF(0.0f, 0.0f), QPointF(1.0f, 0.0f),
+		QPointF(0.0f, 1.0f), QPointF(1.0f, 1.0f));
+}
+
+#endif // SPRITEBATCH_H
@@ -0,0 +1,329 @@
+//*****************************************************************************
+// Libvidgfx: A graphics library for video compositing
+//
+// Copyright (C) 2014 Lucas Murray <lucas@polyflare.com>
+// All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation; either version 2 of the License, or (at your option)
+// any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+// FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+// more details.
+//*****************************************************************************
+
+#ifndef VERTEXLAYOUT_H
+#define VERTEXLAYOUT_H
+
+#include "graphicscontext.h"
+#include <QtCore/QRectF>
+#include <QtGui/QColor>
+#include <string.h>
+
+//=============================================================================
+// Packing helpers
+
+/// <summary>
+/// Packs a colour into a single 32-bit RGBA8 value with red in the lowest
+/// byte. This matches `DXGI_FORMAT_R8G8B8A8_UNORM` on little-endian systems.
+/// </summary>
+inline quint32 packColorRgba8(const QColor &col)
+{
+	return (quint32)col.red() | ((quint32)col.green() << 8) |
+		((quint32)col.blue() << 16) | ((quint32)col.alpha() << 24);
+}
+
+/// <summary>
+/// Packs a UV coordinate into two 16-bit UNORM values with U in the lower
+/// half. Coordinates are clamped to the range [0..1].
+/// </summary>
+inline quint32 packUvUnorm16(const QPointF &uv)
+{
+	quint32 u = (quint32)qRound(qBound(0.0, uv.x(), 1.0) * 65535.0);
+	quint32 v = (quint32)qRound(qBound(0.0, uv.y(), 1.0) * 65535.0);
+	return u | (v << 16);
+}
+
+/// <summary>
+/// Stores a packed 32-bit value in a float slot of a vertex buffer. The bits
+/// are copied as-is as the value is not a valid float in general.
+/// </summary>
+inline void writePacked(float *data, quint32 packed)
+{
+	memcpy(data, &packed, sizeof(packed));
+}
+
+//=============================================================================
+// Vertex elements
+
+/// <summary>
+/// The format of a single vertex element as the vertex shader sees it,
+/// independent of the graphics API.
+/// </summary>
+enum VertElementFormat {
+	Float2Element = 0,
+	Float3Element,
+	Float4Element,
+	Unorm8x4Element,
+	Unorm16x2Element
+};
+
+/// <summary>
+/// Describes a single element of a vertex layout. Converted to the input
+/// layout description of the graphics API by the backend.
+/// </summary>
+struct VertElement {
+	const char *		semantic;
+	VertElementFormat	format;
+	int					offset; // In bytes from the start of the vertex
+};
+
+/// <summary>
+/// Full position: X, Y, Z, -. Z is always 0 and the last float is padding
+/// that the shader doesn't read.
+/// </summary>
+struct PosXYZW
+{
+	enum { NumFloats = 4, ElementFormat = Float3Element };
+	static inline void write(float *out, float x, float y)
+	{
+		out[0] = x;
+		out[1] = y;
+		out[2] = 0.0f;
+		out[3] = 1.0f;
+	}
+};
+
+/// <summary>
+/// Compact position: X, Y.
+/// </summary>
+struct PosXY
+{
+	enum { NumFloats = 2, ElementFormat = Float2Element };
+	static inline void write(float *out, float x, float y)
+	{
+		out[0] = x;
+		out[1] = y;
+	}
+};
+
+/// <summary>
+/// No vertex data other than the position.
+/// </summary>
+struct NoAttrib
+{
+	typedef int Value;
+	enum { NumFloats = 0, NumElements = 0, ElementFormat = Float4Element };
+	static inline const char *getSemantic() { return NULL; }
+	static inline void write(float *out, const Value &val)
+	{
+		Q_UNUSED(out);
+		Q_UNUSED(val);
+	}
+};
+
+/// <summary>
+/// Float colour: R, G, B, A.
+/// </summary>
+struct ColorRgbaF
+{
+	typedef QColor Value;
+	enum { NumFloats = 4, NumElements = 1, ElementFormat = Float4Element };
+	static inline const char *getSemantic() { return "COLOR"; }
+	static inline void write(float *out, const Value &col)
+	{
+		out[0] = col.redF();
+		out[1] = col.greenF();
+		out[2] = col.blueF();
+		out[3] = col.alphaF();
+	}
+};
+
+/// <summary>
+/// Packed colour: RGBA8.
+/// </summary>
+struct ColorRgba8
+{
+	typedef QColor Value;
+	enum { NumFloats = 1, NumElements = 1, ElementFormat = Unorm8x4Element };
+	static inline const char *getSemantic() { return "COLOR"; }
+	static inline void write(float *out, const Value &col)
+	{
+		writePacked(out, packColorRgba8(col));
+	}
+};
+
+/// <summary>
+/// Float UV padded to the size of a colour: U, V, -, -.
+/// </summary>
+struct UvPaddedF
+{
+	typedef QPointF Value;
+	enum { NumFloats = 4, NumElements = 1, ElementFormat = Float2Element };
+	static inline const char *getSemantic() { return "TEXCOORD"; }
+	static inline void write(float *out, const Value &uv)
+	{
+		out[0] = uv.x();
+		out[1] = uv.y();
+		out[2] = 0.0f;
+		out[3] = 0.0f;
+	}
+};
+
+/// <summary>
+/// Float UV: U, V.
+/// </summary>
+struct UvF
+{
+	typedef QPointF Value;
+	enum { NumFloats = 2, NumElements = 1, ElementFormat = Float2Element };
+	static inline const char *getSemantic() { return "TEXCOORD"; }
+	static inline void write(float *out, const Value &uv)
+	{
+		out[0] = uv.x();
+		out[1] = uv.y();
+	}
+};
+
+/// <summary>
+/// Packed UV: UV16.
+/// </summary>
+struct UvUnorm16
+{
+	typedef QPointF Value;
+	enum { NumFloats = 1, NumElements = 1, ElementFormat = Unorm16x2Element };
+	static inline const char *getSemantic() { return "TEXCOORD"; }
+	static inline void write(float *out, const Value &uv)
+	{
+		writePacked(out, packUvUnorm16(uv));
+	}
+};
+
+//=============================================================================
+/// <summary>
+/// A vertex layout that consists of a position followed by an optional
+/// attribute. The size of the vertex and the offset of the attribute are
+/// known at compile time so the writers are fully inlined without any stride
+/// arithmetic and the same type describes the input layout that the backend
+/// creates for the matching vertex shader. New layouts are added by
+/// combining the existing position and attribute types or by adding new ones
+/// with the same members.
+/// </summary>
+template<typename Pos, typename Attrib, VidgfxVertFormat Format>
+class VertLayout
+{
+public: // Datatypes ----------------------------------------------------------
+	typedef typename Attrib::Value	AttribValue;
+
+public: // Constants ----------------------------------------------------------
+	enum {
+		NumFloats = Pos::NumFloats + Attrib::NumFloats,
+		NumElements = 1 + Attrib::NumElements
+	};
+
+public: // Static methods -----------------------------------------------------
+	static void		getElements(VertElement *out);
+	static float *	mapBuffer(VertexBuffer *outBuf, int numVerts);
+
+	static float *	writeVert(
+		float *out, float x, float y,
+		const AttribValue &attrib = AttribValue());
+	static float *	writeQuad(
+		float *out, const QRectF &rect, const AttribValue &tl,
+		const AttribValue &tr, const AttribValue &bl,
+		const AttribValue &br);
+};
+//=============================================================================
+
+// Layouts that the shaders expect, the comment is the format of each vertex
+typedef VertLayout<PosXYZW, ColorRgbaF, GfxFullVertFormat>
+	SolidVertLayout; // X, Y, Z, -, R, G, B, A
+typedef VertLayout<PosXYZW, UvPaddedF, GfxFullVertFormat>
+	TexDecalVertLayout; // X, Y, Z, -, U, V, -, -
+typedef VertLayout<PosXYZW, NoAttrib, GfxFullVertFormat>
+	ResizeVertLayout; // X, Y, Z, -
+typedef VertLayout<PosXY, ColorRgba8, GfxCompactVertFormat>
+	SolidCompactVertLayout; // X, Y, RGBA8
+typedef VertLayout<PosXY, UvF, GfxCompactVertFormat>
+	TexDecalCompactVertLayout; // X, Y, U, V
+typedef VertLayout<PosXY, UvUnorm16, GfxCompactUnormVertFormat>
+	TexDecalUnormVertLayout; // X, Y, UV16
+
+/// <summary>
+/// Writes the description of every element of the layout to `out` which must
+/// have space for `NumElements` elements.
+/// </summary>
+template<typename Pos, typename Attrib, VidgfxVertFormat Format>
+void VertLayout<Pos, Attrib, Format>::getElements(VertElement *out)
+{
+	out[0].semantic = "POSITION";
+	out[0].format = (VertElementFormat)Pos::ElementFormat;
+	out[0].offset = 0;
+	if(Attrib::NumElements == 0)
+		return;
+	out[1].semantic = Attrib::getSemantic();
+	out[1].format = (VertElementFormat)Attrib::ElementFormat;
+	out[1].offset = Pos::NumFloats * sizeof(float);
+}
+
+/// <summary>
+/// Resizes `outBuf` to `numVerts` vertices of this layout, sets its vertex
+/// size and format and maps it for writing. If the buffer is too small or
+/// cannot be mapped then it is left empty.
+/// </summary>
+/// <returns>The mapped data or NULL on failure</returns>
+template<typename Pos, typename Attrib, VidgfxVertFormat Format>
+float *VertLayout<Pos, Attrib, Format>::mapBuffer(
+	VertexBuffer *outBuf, int numVerts)
+{
+	if(outBuf == NULL)
+		return NULL;
+	outBuf->setNumVerts(0);
+	if(outBuf->getNumFloats() < numVerts * NumFloats)
+		return NULL;
+	outBuf->setNumVerts(numVerts);
+	outBuf->setVertSize(NumFloats);
+	outBuf->setVertFormat(Format);
+	float *data = outBuf->map();
+	if(data == NULL) {
+		outBuf->setNumVerts(0);
+		return NULL; // Failed to map buffer
+	}
+	return data;
+}
+
+/// <returns>A pointer to just after the last written float</returns>
+template<typename Pos, typename Attrib, VidgfxVertFormat Format>
+inline float *VertLayout<Pos, Attrib, Format>::writeVert(
+	float *out, float x, float y, const AttribValue &attrib)
+{
+	Pos::write(out, x, y);
+	Attrib::write(&out[Pos::NumFloats], attrib);
+	return &out[NumFloats];
+}
+
+/// <summary>
+/// Writes the 4 corners of `rect` in the order top-left, top-right,
+/// bottom-left and bottom-right.
+/// </summary>
+/// <returns>A pointer to just after the last written float</returns>
+template<typename Pos, typename Attrib, VidgfxVertFormat Format>
+inline float *VertLayout<Pos, Attrib, Format>::writeQuad(
+	float *out, const QRectF &rect, const AttribValue &tl,
+	const AttribValue &tr, const AttribValue &bl, const AttribValue &br)
+{
+	const float l = rect.left();
+	const float t = rect.top();
+	const float r = rect.right();
+	const float b = rect.bottom();
+	out = writeVert(out, l, t, tl);
+	out = writeVert(out, r, t, tr);
+	out = writeVert(out, l, b, bl);
+	out = writeVert(out, r, b, br);
+	return out;
+}
+
+#endif // VERTEXLAYOUT_H